@@ -312,12 +312,7 @@ void CSGObject::update_parameter_hash()
 {
 	SG_DEBUG("entering\n")
 
-	uint32_t carry=0;
-	uint32_t length=0;
-
-	m_hash=0;
-	get_parameter_incremental_hash(m_hash, carry, length);
-	m_hash=CHash::FinalizeIncrementalMurmurHash3(m_hash, carry, length);
+	m_hash=compute_parameter_hash();
 
 	SG_DEBUG("leaving\n")
 }
@@ -326,15 +321,20 @@ bool CSGObject::parameter_hash_changed()
 {
 	SG_DEBUG("entering\n")
 
+	uint32_t hash=compute_parameter_hash();
+
+	SG_DEBUG("leaving\n")
+	return (m_hash!=hash);
+}
+
+uint32_t CSGObject::compute_parameter_hash()
+{
 	uint32_t hash=0;
 	uint32_t carry=0;
 	uint32_t length=0;
 
 	get_parameter_incremental_hash(hash, carry, length);
-	hash=CHash::FinalizeIncrementalMurmurHash3(hash, carry, length);
-
-	SG_DEBUG("leaving\n")
-	return (m_hash!=hash);
+	return CHash::FinalizeIncrementalMurmurHash3(hash, carry, length);
 }
 
 Parallel* CSGObject::get_global_parallel()
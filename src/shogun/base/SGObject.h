@@ -724,6 +724,13 @@ public:
 	 */
 	virtual bool parameter_hash_changed();
 
+	/** Computes the hash of the current parameter combination without
+	 * storing it
+	 *
+	 * @return hash of the current parameter combination
+	 */
+	uint32_t compute_parameter_hash();
+
 	/** Deep comparison of two objects.
 	 *
 	 * @param other object to compare with
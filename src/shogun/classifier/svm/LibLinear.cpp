@@ -7,7 +7,9 @@
  */
 #include <shogun/lib/config.h>
 
+#include <shogun/base/Parallel.h>
 #include <shogun/base/Parameter.h>
+#include <shogun/base/init.h>
 #include <shogun/base/progress.h>
 #include <shogun/classifier/svm/LibLinear.h>
 #include <shogun/features/DotFeatures.h>
@@ -51,6 +53,7 @@ void CLibLinear::init()
 	set_epsilon(1e-5);
 	/** Prevent default bias computation*/
 	set_compute_bias(false);
+	m_parallel_dual = false;
 
 	SG_ADD(&C1, "C1", "C Cost constant 1.", MS_AVAILABLE);
 	SG_ADD(&C2, "C2", "C Cost constant 2.", MS_AVAILABLE);
@@ -64,6 +67,9 @@ void CLibLinear::init()
 	SG_ADD(
 	    (machine_int_t*)&liblinear_solver_type, "liblinear_solver_type",
 	    "Type of LibLinear solver.", MS_NOT_AVAILABLE);
+	SG_ADD(
+	    &m_parallel_dual, "parallel_dual",
+	    "Whether dual coordinate descent runs in parallel.", MS_NOT_AVAILABLE);
 }
 
 CLibLinear::~CLibLinear()
@@ -268,8 +274,7 @@ void CLibLinear::solve_l2r_l1l2_svc(
 {
 	int l = prob->l;
 	int w_size = prob->n;
-	int i, s, iter = 0;
-	double C, d, G;
+	int i, iter = 0;
 	double* QD = SG_MALLOC(double, l);
 	int* index = SG_MALLOC(int, l);
 	double* alpha = SG_MALLOC(double, l);
@@ -277,7 +282,6 @@ void CLibLinear::solve_l2r_l1l2_svc(
 	int active_size = l;
 
 	// PG: projected gradient, for shrinking and stopping
-	double PG;
 	double PGmax_old = CMath::INFTY;
 	double PGmin_old = -CMath::INFTY;
 	double PGmax_new, PGmin_new;
@@ -324,6 +328,27 @@ void CLibLinear::solve_l2r_l1l2_svc(
 		index[i] = i;
 	}
 
+	// the examples are split into partitions that are swept concurrently,
+	// each with its own active set [part_begin, part_active)
+	int32_t num_parts = 1;
+	if (m_parallel_dual)
+	{
+		num_parts = CMath::min(get_global_parallel()->get_num_threads(), l);
+
+		// spread the examples randomly over the partitions
+		if (num_parts > 1)
+			CMath::permute(SGVector<int32_t>(index, l, false));
+	}
+	SGVector<int32_t> part_begin(num_parts);
+	SGVector<int32_t> part_end(num_parts);
+	SGVector<int32_t> part_active(num_parts);
+	for (int32_t t = 0; t < num_parts; t++)
+	{
+		part_begin[t] = int64_t(l) * t / num_parts;
+		part_end[t] = int64_t(l) * (t + 1) / num_parts;
+		part_active[t] = part_end[t];
+	}
+
 	auto pb = progress(range(10));
 	CTime start_time;
 	while (iter < get_max_iterations())
@@ -336,75 +361,109 @@ void CLibLinear::solve_l2r_l1l2_svc(
 		PGmax_new = -CMath::INFTY;
 		PGmin_new = CMath::INFTY;
 
-		for (i = 0; i < active_size; i++)
+		for (int32_t t = 0; t < num_parts; t++)
 		{
-			int j = CMath::random(i, active_size - 1);
-			CMath::swap(index[i], index[j]);
+			for (i = part_begin[t]; i < part_active[t]; i++)
+			{
+				int j = CMath::random(i, part_active[t] - 1);
+				CMath::swap(index[i], index[j]);
+			}
 		}
 
-		for (s = 0; s < active_size; s++)
+#pragma omp parallel for if (num_parts > 1)                                    \
+    reduction(max : PGmax_new) reduction(min : PGmin_new)
+		for (int32_t t = 0; t < num_parts; t++)
 		{
-			i = index[s];
-			int32_t yi = y[i];
+			for (int32_t s = part_begin[t]; s < part_active[t]; s++)
+			{
+				int32_t i = index[s];
+				int32_t yi = y[i];
 
-			G = prob->x->dense_dot(i, w.vector, n);
-			if (prob->use_bias)
-				G += w.vector[n];
+				double G = prob->x->dense_dot(i, w.vector, n);
+				if (prob->use_bias)
+					G += w.vector[n];
 
-			if (linear_term.vector)
-				G = G * yi + linear_term.vector[i];
-			else
-				G = G * yi - 1;
+				if (linear_term.vector)
+					G = G * yi + linear_term.vector[i];
+				else
+					G = G * yi - 1;
 
-			C = upper_bound[GETI(i)];
-			G += alpha[i] * diag[GETI(i)];
+				double C = upper_bound[GETI(i)];
+				G += alpha[i] * diag[GETI(i)];
 
-			PG = 0;
-			if (alpha[i] == 0)
-			{
-				if (G > PGmax_old)
+				double PG = 0;
+				if (alpha[i] == 0)
 				{
-					active_size--;
-					CMath::swap(index[s], index[active_size]);
-					s--;
-					continue;
+					if (G > PGmax_old)
+					{
+						part_active[t]--;
+						CMath::swap(index[s], index[part_active[t]]);
+						s--;
+						continue;
+					}
+					else if (G < 0)
+						PG = G;
 				}
-				else if (G < 0)
-					PG = G;
-			}
-			else if (alpha[i] == C)
-			{
-				if (G < PGmin_old)
+				else if (alpha[i] == C)
 				{
-					active_size--;
-					CMath::swap(index[s], index[active_size]);
-					s--;
-					continue;
+					if (G < PGmin_old)
+					{
+						part_active[t]--;
+						CMath::swap(index[s], index[part_active[t]]);
+						s--;
+						continue;
+					}
+					else if (G > 0)
+						PG = G;
 				}
-				else if (G > 0)
+				else
 					PG = G;
-			}
-			else
-				PG = G;
 
-			PGmax_new = CMath::max(PGmax_new, PG);
-			PGmin_new = CMath::min(PGmin_new, PG);
+				PGmax_new = CMath::max(PGmax_new, PG);
+				PGmin_new = CMath::min(PGmin_new, PG);
 
-			if (fabs(PG) > 1.0e-12)
-			{
-				double alpha_old = alpha[i];
-				alpha[i] = CMath::min(CMath::max(alpha[i] - G / QD[i], 0.0), C);
-				d = (alpha[i] - alpha_old) * yi;
+				if (fabs(PG) > 1.0e-12)
+				{
+					double alpha_old = alpha[i];
+					alpha[i] =
+					    CMath::min(CMath::max(alpha[i] - G / QD[i], 0.0), C);
+					double d = (alpha[i] - alpha_old) * yi;
 
-				prob->x->add_to_dense_vec(d, i, w.vector, n);
+					if (num_parts > 1)
+					{
+						int32_t idx;
+						float64_t val;
+						void* it = prob->x->get_feature_iterator(i);
+						while (prob->x->get_next_feature(idx, val, it))
+						{
+#pragma omp atomic
+							w.vector[idx] += d * val;
+						}
+						prob->x->free_feature_iterator(it);
 
-				if (prob->use_bias)
-					w.vector[n] += d;
+						if (prob->use_bias)
+						{
+#pragma omp atomic
+							w.vector[n] += d;
+						}
+					}
+					else
+					{
+						prob->x->add_to_dense_vec(d, i, w.vector, n);
+
+						if (prob->use_bias)
+							w.vector[n] += d;
+					}
+				}
 			}
 		}
 
 		iter++;
 
+		active_size = 0;
+		for (int32_t t = 0; t < num_parts; t++)
+			active_size += part_active[t] - part_begin[t];
+
 		float64_t gap=PGmax_new - PGmin_new;
 		pb.print_absolute(
 		    gap, -CMath::log10(gap), -CMath::log10(1), -CMath::log10(eps));
@@ -415,7 +474,8 @@ void CLibLinear::solve_l2r_l1l2_svc(
 				break;
 			else
 			{
-				active_size = l;
+				for (int32_t t = 0; t < num_parts; t++)
+					part_active[t] = part_end[t];
 				PGmax_old = CMath::INFTY;
 				PGmin_old = -CMath::INFTY;
 				continue;
@@ -179,6 +179,17 @@ namespace shogun
 			return "LibLinear";
 		}
 
+		/** only the primal trust region solvers do without random
+		 * permutations of the examples
+		 *
+		 * @return whether training draws random numbers
+		 */
+		virtual bool train_uses_global_random() const
+		{
+			return liblinear_solver_type!=L2R_LR &&
+				liblinear_solver_type!=L2R_L2LOSS_SVC;
+		}
+
 		/** get the maximum number of iterations liblinear is allowed to do */
 		inline int32_t get_max_iterations()
 		{
@@ -191,6 +202,27 @@ namespace shogun
 			max_iterations = max_iter;
 		}
 
+		/** set whether the dual coordinate descent solvers for L1 and L2
+		 * loss SVMs (L2R_L1LOSS_SVC_DUAL, L2R_L2LOSS_SVC_DUAL) run in
+		 * parallel. The examples are then split into one partition per
+		 * thread, each of which is shrunk and swept by its own thread,
+		 * reading the shared weight vector without locks and updating it
+		 * atomically (PASSCoDe-Atomic, Hsieh et al. 2015). Solutions are
+		 * not bit-for-bit reproducible in this mode. Default is false.
+		 *
+		 * @param parallel_dual whether to use parallel coordinate descent
+		 */
+		inline void set_parallel_dual(bool parallel_dual)
+		{
+			m_parallel_dual = parallel_dual;
+		}
+
+		/** @return whether dual coordinate descent runs in parallel */
+		inline bool get_parallel_dual()
+		{
+			return m_parallel_dual;
+		}
+
 		/** set the linear term for qp */
 		void set_linear_term(const SGVector<float64_t> linear_term);
 
@@ -260,6 +292,9 @@ namespace shogun
 
 		/** solver type */
 		LIBLINEAR_SOLVER_TYPE liblinear_solver_type;
+
+		/** whether dual coordinate descent runs in parallel */
+		bool m_parallel_dual;
 	};
 
 } /* namespace shogun  */
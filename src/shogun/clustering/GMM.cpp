@@ -14,12 +14,17 @@
 #include <shogun/distance/EuclideanDistance.h>
 #include <shogun/labels/MulticlassLabels.h>
 #include <shogun/mathematics/Math.h>
+#include <shogun/mathematics/eigen3.h>
 #include <shogun/mathematics/linalg/LinalgNamespace.h>
 #include <shogun/multiclass/KNN.h>
 #include <vector>
 
 using namespace shogun;
 using namespace std;
+using namespace Eigen;
+
+/** number of feature vectors processed together in the E and M steps */
+static const int32_t GMM_BLOCK_SIZE=256;
 
 CGMM::CGMM() : CDistribution(), m_components(),	m_coefficients()
 {
@@ -153,29 +158,18 @@ float64_t CGMM::train_em(float64_t min_cov, int32_t max_iter, float64_t min_chan
 	while (iter<max_iter)
 	{
 		log_likelihood_prev=log_likelihood_cur;
-		log_likelihood_cur=0;
 
+		compute_log_joint(logPxy, logPx);
+		log_likelihood_cur=linalg::sum(logPx);
+
+		int32_t num_components=int32_t(m_components.size());
+#pragma omp parallel for
 		for (int32_t i=0; i<num_vectors; i++)
 		{
-			logPx[i]=0;
-			SGVector<float64_t> v=dotdata->get_computed_dot_feature_vector(i);
-			for (int32_t j=0; j<int32_t(m_components.size()); j++)
-			{
-				logPxy[index_t(i * m_components.size() + j)] =
-				    m_components[j]->compute_log_PDF(v) +
-				    std::log(m_coefficients[j]);
-				logPx[i] +=
-				    std::exp(logPxy[index_t(i * m_components.size() + j)]);
-			}
-
-			logPx[i] = std::log(logPx[i]);
-			log_likelihood_cur+=logPx[i];
-
-			for (int32_t j=0; j<int32_t(m_components.size()); j++)
+			for (int32_t j=0; j<num_components; j++)
 			{
-				//logPost[i*m_components.vlen+j]=logPxy[i*m_components.vlen+j]-logPx[i];
-				alpha.matrix[i * m_components.size() + j] = std::exp(
-				    logPxy[index_t(i * m_components.size() + j)] - logPx[i]);
+				alpha.matrix[i * num_components + j] = std::exp(
+				    logPxy[index_t(i * num_components + j)] - logPx[i]);
 			}
 		}
 
@@ -223,21 +217,9 @@ float64_t CGMM::train_smem(int32_t max_iter, int32_t max_cand, float64_t min_cov
 		linalg::zero(logPostSum);
 		linalg::zero(logPostSum2);
 		linalg::zero(logPostSumSum);
+		compute_log_joint(logPxy, logPx);
 		for (int32_t i=0; i<num_vectors; i++)
 		{
-			logPx[i]=0;
-			SGVector<float64_t> v=dotdata->get_computed_dot_feature_vector(i);
-			for (int32_t j=0; j<int32_t(m_components.size()); j++)
-			{
-				logPxy[index_t(i * m_components.size() + j)] =
-				    m_components[j]->compute_log_PDF(v) +
-				    std::log(m_coefficients[j]);
-				logPx[i] +=
-				    std::exp(logPxy[index_t(i * m_components.size() + j)]);
-			}
-
-			logPx[i] = std::log(logPx[i]);
-
 			for (int32_t j=0; j<int32_t(m_components.size()); j++)
 			{
 				logPost[index_t(i * m_components.size() + j)] =
@@ -534,90 +516,223 @@ void CGMM::partial_em(int32_t comp1, int32_t comp2, int32_t comp3, float64_t min
 	delete partial_candidate;
 }
 
-void CGMM::max_likelihood(SGMatrix<float64_t> alpha, float64_t min_cov)
+void CGMM::get_block(int32_t start, int32_t num_vectors, SGMatrix<float64_t> block)
 {
 	CDotFeatures* dotdata=(CDotFeatures *) features;
-	int32_t num_dim=dotdata->get_dim_feature_space();
+	int32_t num_dim=block.num_rows;
 
-	float64_t alpha_sum;
-	float64_t alpha_sum_sum=0;
+	for (int32_t i=0; i<num_vectors; i++)
+	{
+		float64_t* col=block.get_column_vector(i);
+		memset(col, 0, sizeof(float64_t)*num_dim);
+		dotdata->add_to_dense_vec(1.0, start+i, col, num_dim);
+	}
+}
 
-	for (int32_t i=0; i<alpha.num_cols; i++)
+void CGMM::compute_log_joint(SGVector<float64_t> logPxy, SGVector<float64_t> logPx)
+{
+	CDotFeatures* dotdata=(CDotFeatures *) features;
+	int32_t num_vectors=dotdata->get_num_vectors();
+	int32_t num_dim=dotdata->get_dim_feature_space();
+	int32_t num_components=int32_t(m_components.size());
+
+	/* With Sigma=U*diag(d)*U', the Mahalanobis distance of x is
+	 * ||diag(d)^(-1/2)*U'*(x-mu)||^2, so for full covariances each component
+	 * maps a whole block of vectors with a single matrix product */
+	vector<VectorXd> means(num_components);
+	vector<MatrixXd> projections(num_components);
+	vector<VectorXd> scales(num_components);
+	SGVector<float64_t> log_constants(num_components);
+	for (int32_t j=0; j<num_components; j++)
 	{
-		alpha_sum=0;
-		SGVector<float64_t> mean_sum(num_dim);
-		linalg::zero(mean_sum);
+		SGVector<float64_t> mean=m_components[j]->get_mean();
+		means[j]=Map<VectorXd>(mean.vector, mean.vlen);
+
+		SGVector<float64_t> d=m_components[j]->get_d();
+		Map<VectorXd> map_d(d.vector, d.vlen);
+
+		float64_t log_det;
+		if (m_components[j]->get_cov_type()==SPHERICAL)
+			log_det=num_dim*std::log(d[0]);
+		else
+			log_det=map_d.array().log().sum();
 
-		for (int32_t j=0; j<alpha.num_rows; j++)
+		log_constants[j]=std::log(m_coefficients[j])-
+			0.5*(num_dim*std::log(2*M_PI)+log_det);
+		scales[j]=map_d.array().rsqrt();
+
+		if (m_components[j]->get_cov_type()==FULL)
 		{
-			alpha_sum+=alpha.matrix[j*alpha.num_cols+i];
-			SGVector<float64_t> v=dotdata->get_computed_dot_feature_vector(j);
-			linalg::add(
-			    v, mean_sum, mean_sum, alpha.matrix[j * alpha.num_cols + i],
-			    1.0);
+			SGMatrix<float64_t> u=m_components[j]->get_u();
+			Map<MatrixXd> map_u(u.matrix, u.num_rows, u.num_cols);
+			projections[j]=scales[j].asDiagonal()*map_u.transpose();
 		}
+	}
 
-		linalg::scale(mean_sum, mean_sum, 1.0 / alpha_sum);
+#pragma omp parallel
+	{
+		SGMatrix<float64_t> block(num_dim, GMM_BLOCK_SIZE);
+		MatrixXd centered;
+		VectorXd sq_dists;
 
-		m_components[i]->set_mean(mean_sum);
+#pragma omp for schedule(dynamic)
+		for (int32_t b=0; b<num_vectors; b+=GMM_BLOCK_SIZE)
+		{
+			int32_t num_block=CMath::min(GMM_BLOCK_SIZE, num_vectors-b);
+			get_block(b, num_block, block);
+			Map<MatrixXd> X(block.matrix, num_dim, num_block);
 
-		SGMatrix<float64_t> cov_sum;
+			for (int32_t j=0; j<num_components; j++)
+			{
+				centered=X.colwise()-means[j];
 
-		ECovType cov_type = m_components[i]->get_cov_type();
-		if (cov_type==FULL)
-		{
-			cov_sum = SGMatrix<float64_t>(num_dim, num_dim);
-			linalg::zero(cov_sum);
+				switch (m_components[j]->get_cov_type())
+				{
+					case FULL:
+						sq_dists=(projections[j]*centered).colwise().squaredNorm();
+						break;
+					case DIAG:
+						sq_dists=(scales[j].asDiagonal()*centered).colwise().squaredNorm();
+						break;
+					case SPHERICAL:
+						sq_dists=centered.colwise().squaredNorm()*
+							CMath::sq(scales[j][0]);
+						break;
+				}
+
+				for (int32_t i=0; i<num_block; i++)
+				{
+					logPxy[index_t((b+i)*num_components+j)]=
+						log_constants[j]-0.5*sq_dists[i];
+				}
+			}
+
+			/* log-sum-exp, shifted by the largest term to avoid underflow */
+			for (int32_t i=0; i<num_block; i++)
+			{
+				float64_t* logPxy_i=logPxy.vector+index_t(b+i)*num_components;
+				float64_t max_log=CMath::max(logPxy_i, num_components);
+
+				float64_t sum=0;
+				for (int32_t j=0; j<num_components; j++)
+					sum+=std::exp(logPxy_i[j]-max_log);
+
+				logPx[b+i]=max_log+std::log(sum);
+			}
 		}
-		else if(cov_type==DIAG)
+	}
+}
+
+void CGMM::max_likelihood(SGMatrix<float64_t> alpha, float64_t min_cov)
+{
+	CDotFeatures* dotdata=(CDotFeatures *) features;
+	int32_t num_dim=dotdata->get_dim_feature_space();
+	int32_t num_vectors=alpha.num_rows;
+	int32_t num_components=alpha.num_cols;
+
+	/* alpha is stored with the components of a vector next to each other,
+	 * so a block of vectors is a num_components x num_block matrix */
+	MatrixXd means=MatrixXd::Zero(num_dim, num_components);
+	VectorXd alpha_sums=VectorXd::Zero(num_components);
+
+#pragma omp parallel
+	{
+		SGMatrix<float64_t> block(num_dim, GMM_BLOCK_SIZE);
+		MatrixXd local_means=MatrixXd::Zero(num_dim, num_components);
+		VectorXd local_sums=VectorXd::Zero(num_components);
+
+#pragma omp for schedule(dynamic) nowait
+		for (int32_t b=0; b<num_vectors; b+=GMM_BLOCK_SIZE)
 		{
-			cov_sum = SGMatrix<float64_t>(1, num_dim);
-			linalg::zero(cov_sum);
+			int32_t num_block=CMath::min(GMM_BLOCK_SIZE, num_vectors-b);
+			get_block(b, num_block, block);
+			Map<MatrixXd> X(block.matrix, num_dim, num_block);
+			Map<MatrixXd> A(alpha.matrix+index_t(b)*num_components,
+				num_components, num_block);
+
+			local_means.noalias()+=X*A.transpose();
+			local_sums+=A.rowwise().sum();
 		}
-		else if(cov_type==SPHERICAL)
+
+#pragma omp critical
 		{
-			cov_sum = SGMatrix<float64_t>(1, 1);
-			linalg::zero(cov_sum);
+			means+=local_means;
+			alpha_sums+=local_sums;
 		}
+	}
 
-		for (int32_t j=0; j<alpha.num_rows; j++)
-		{
-			SGVector<float64_t> v=dotdata->get_computed_dot_feature_vector(j);
+	for (int32_t i=0; i<num_components; i++)
+		means.col(i)/=alpha_sums[i];
 
-			linalg::add(v, mean_sum, v, 1.0, -1.0);
-			switch (cov_type)
-			{
-				case FULL:
-				    linalg::dger(
-				        alpha.matrix[j * alpha.num_cols + i], v, v, cov_sum);
-				    break;
-			    case DIAG:
-			    {
-				    auto temp_matrix = SGMatrix<float64_t>(v.vector, 1, v.vlen);
-				    auto temp_result = linalg::matrix_prod(
-				        temp_matrix, temp_matrix, true, false);
-				    cov_sum = temp_result.get_diagonal_vector().clone();
-				    linalg::scale(
-				        cov_sum, cov_sum, alpha.matrix[j * alpha.num_cols + i]);
-			    }
+	/* weighted scatter of every component around its mean, full covariances
+	 * are stored flattened in a column */
+	bool has_full=false;
+	for (int32_t i=0; i<num_components; i++)
+		has_full|=m_components[i]->get_cov_type()==FULL;
+	int32_t cov_size=has_full ? num_dim*num_dim : num_dim;
+	MatrixXd cov_sums=MatrixXd::Zero(cov_size, num_components);
 
-			    break;
-			    case SPHERICAL:
-				    float64_t temp = 0;
+#pragma omp parallel
+	{
+		SGMatrix<float64_t> block(num_dim, GMM_BLOCK_SIZE);
+		MatrixXd local_cov_sums=MatrixXd::Zero(cov_size, num_components);
+		MatrixXd centered;
 
-				    temp = linalg::dot(v, v);
+#pragma omp for schedule(dynamic) nowait
+		for (int32_t b=0; b<num_vectors; b+=GMM_BLOCK_SIZE)
+		{
+			int32_t num_block=CMath::min(GMM_BLOCK_SIZE, num_vectors-b);
+			get_block(b, num_block, block);
+			Map<MatrixXd> X(block.matrix, num_dim, num_block);
+			Map<MatrixXd> A(alpha.matrix+index_t(b)*num_components,
+				num_components, num_block);
+
+			for (int32_t i=0; i<num_components; i++)
+			{
+				centered=X.colwise()-means.col(i);
+				VectorXd weights=A.row(i).transpose();
 
-				    cov_sum(0, 0) +=
-				        temp * alpha.matrix[j * alpha.num_cols + i];
-				    break;
+				switch (m_components[i]->get_cov_type())
+				{
+					case FULL:
+					{
+						Map<MatrixXd> cov(local_cov_sums.col(i).data(),
+							num_dim, num_dim);
+						cov.noalias()+=centered*weights.asDiagonal()*
+							centered.transpose();
+						break;
+					}
+					case DIAG:
+						local_cov_sums.col(i).head(num_dim)+=
+							centered.array().square().matrix()*weights;
+						break;
+					case SPHERICAL:
+						local_cov_sums(0, i)+=
+							centered.colwise().squaredNorm().dot(weights);
+						break;
+				}
 			}
 		}
 
-		switch (cov_type)
+#pragma omp critical
+		cov_sums+=local_cov_sums;
+	}
+
+#pragma omp parallel for
+	for (int32_t i=0; i<num_components; i++)
+	{
+		float64_t alpha_sum=alpha_sums[i];
+		SGVector<float64_t> mean_sum(num_dim);
+		Map<VectorXd>(mean_sum.vector, num_dim)=means.col(i);
+		m_components[i]->set_mean(mean_sum);
+
+		switch (m_components[i]->get_cov_type())
 		{
 			case FULL:
 		    {
-			    linalg::scale(cov_sum, cov_sum, 1.0 / alpha_sum);
+			    SGMatrix<float64_t> cov_sum(num_dim, num_dim);
+			    Map<VectorXd>(cov_sum.matrix, cov_size)=
+				    cov_sums.col(i)/alpha_sum;
 
 			    SGVector<float64_t> d0(num_dim);
 			    linalg::eigen_solver_symmetric(cov_sum, d0, cov_sum);
@@ -631,29 +746,31 @@ void CGMM::max_likelihood(SGMatrix<float64_t> alpha, float64_t min_cov)
 			    break;
 		    }
 		    case DIAG:
+		    {
+			    SGVector<float64_t> d0(num_dim);
 			    for (int32_t j = 0; j < num_dim; j++)
-			    {
-				    cov_sum(0, j) /= alpha_sum;
-				    cov_sum(0, j) = CMath::max(min_cov, cov_sum(0, j));
-			    }
+				    d0[j] = CMath::max(min_cov, cov_sums(j, i) / alpha_sum);
 
-			    m_components[i]->set_d(cov_sum.get_row_vector(0));
+			    m_components[i]->set_d(d0);
 
 			    break;
+		    }
 		    case SPHERICAL:
-			    cov_sum[0] /= alpha_sum * num_dim;
-			    cov_sum[0] = CMath::max(min_cov, cov_sum[0]);
+		    {
+			    SGVector<float64_t> d0(1);
+			    d0[0] = CMath::max(
+			        min_cov, cov_sums(0, i) / (alpha_sum * num_dim));
 
-			    m_components[i]->set_d(cov_sum.get_row_vector(0));
+			    m_components[i]->set_d(d0);
 
 			    break;
+		    }
 		}
 
 		m_coefficients.vector[i]=alpha_sum;
-		alpha_sum_sum+=alpha_sum;
 	}
 
-	linalg::scale(m_coefficients, m_coefficients, 1.0 / alpha_sum_sum);
+	linalg::scale(m_coefficients, m_coefficients, 1.0 / alpha_sums.sum());
 }
 
 int32_t CGMM::get_num_model_parameters()
@@ -225,6 +225,25 @@ class CGMM : public CDistribution
 		/** Initialize parameters for serialization */
 		void register_params();
 
+		/** computes the log joint probabilities of all the feature vectors
+		 * and components, evaluating every component on blocks of vectors
+		 * at once, in parallel over the blocks
+		 *
+		 * @param logPxy filled with \f$\log(\pi_j)+\log(N(x_i|\mu_j,\Sigma_j))\f$
+		 * at i*num_components+j
+		 * @param logPx filled with \f$\log(p(x_i))\f$, computed with the
+		 * log-sum-exp trick
+		 */
+		void compute_log_joint(SGVector<float64_t> logPxy, SGVector<float64_t> logPx);
+
+		/** copies feature vectors into the columns of a dense block
+		 *
+		 * @param start index of the first vector
+		 * @param num_vectors number of vectors to copy
+		 * @param block matrix of at least num_vectors columns
+		 */
+		void get_block(int32_t start, int32_t num_vectors, SGMatrix<float64_t> block);
+
 		/** apply the partial EM algorithm on 3 components
 		 *
 		 * @param comp1 index of first component
@@ -9,20 +9,274 @@
 #include <shogun/base/progress.h>
 #include <shogun/clustering/Hierarchical.h>
 #include <shogun/distance/Distance.h>
+#include <shogun/features/DotFeatures.h>
 #include <shogun/features/Features.h>
 #include <shogun/labels/Labels.h>
 #include <shogun/mathematics/Math.h>
 
+#include <algorithm>
+
 using namespace shogun;
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
-struct pair
+struct merge_step
 {
-	/** index 1 */
+	/** element of the first cluster */
 	int32_t idx1;
-	/** index 2 */
+	/** element of the second cluster */
 	int32_t idx2;
+	/** linkage distance between the clusters */
+	float64_t dist;
 };
+
+/** finds the minimum of dist(j) over the indices j in [0,num) for which
+ * valid(j) holds, computed in parallel. Ties go to the smallest index.
+ * Returns -1 if there is no valid index
+ */
+template <class Valid, class Dist>
+static int32_t parallel_arg_min(
+	int32_t num, Valid valid, Dist dist, float64_t& min_dist)
+{
+	int32_t best=-1;
+	min_dist=CMath::INFTY;
+
+#pragma omp parallel
+	{
+		int32_t local_best=-1;
+		float64_t local_min=CMath::INFTY;
+
+#pragma omp for nowait
+		for (int32_t j=0; j<num; j++)
+		{
+			if (!valid(j))
+				continue;
+
+			float64_t d=dist(j);
+			if (local_best==-1 || d<local_min)
+			{
+				local_min=d;
+				local_best=j;
+			}
+		}
+
+#pragma omp critical
+		{
+			if (local_best!=-1 && (best==-1 || local_min<min_dist ||
+				(local_min==min_dist && local_best<best)))
+			{
+				min_dist=local_min;
+				best=local_best;
+			}
+		}
+	}
+
+	return best;
+}
+
+/** single linkage from the minimum spanning tree, built with Prim's
+ * algorithm. Only keeps the distance of every point to the tree.
+ */
+static void single_linkage(CDistance* distance, int32_t num, merge_step* steps)
+{
+	SGVector<float64_t> min_dist(num);
+	SGVector<float64_t>::fill_vector(min_dist.vector, num, CMath::INFTY);
+	SGVector<int32_t> parent(num);
+	SGVector<bool> in_tree(num);
+	in_tree.set_const(false);
+
+	int32_t current=0;
+	in_tree[current]=true;
+	for (int32_t l=0; l<num-1; l++)
+	{
+		float64_t d;
+		int32_t next=parallel_arg_min(num,
+			[&](int32_t j) { return !in_tree[j]; },
+			[&](int32_t j)
+			{
+				float64_t dj=distance->distance(current, j);
+				if (dj<min_dist[j])
+				{
+					min_dist[j]=dj;
+					parent[j]=current;
+				}
+				return min_dist[j];
+			}, d);
+
+		steps[l].idx1=parent[next];
+		steps[l].idx2=next;
+		steps[l].dist=d;
+		in_tree[next]=true;
+		current=next;
+	}
+}
+
+/** nearest-neighbor chain algorithm. Clusters are identified by the index of
+ * one of their elements, on a merge the second cluster takes the index of the
+ * merged one.
+ *
+ * @param num number of points
+ * @param dist function giving the linkage distance of two active clusters
+ * @param merge function updating the state for merging the first cluster
+ * into the second one, called before the first one is deactivated
+ * @param steps merges, in the order they were found
+ */
+template <class Dist, class Merge>
+static void nn_chain(int32_t num, Dist dist, Merge merge, merge_step* steps)
+{
+	SGVector<bool> active(num);
+	active.set_const(true);
+	SGVector<int32_t> chain(num);
+	int32_t chain_len=0;
+	int32_t first_active=0;
+
+	for (int32_t l=0; l<num-1; l++)
+	{
+		if (chain_len==0)
+		{
+			while (!active[first_active])
+				first_active++;
+			chain[chain_len++]=first_active;
+		}
+
+		int32_t a, b;
+		float64_t d;
+		while (true)
+		{
+			a=chain[chain_len-1];
+			int32_t prev=chain_len>1 ? chain[chain_len-2] : -1;
+
+			b=parallel_arg_min(num,
+				[&](int32_t j) { return active[j] && j!=a; },
+				[&](int32_t j) { return dist(a, j); }, d);
+
+			/* prefer the previous element of the chain on ties, so that
+			 * the chain cannot cycle */
+			if (prev!=-1 && dist(a, prev)<=d)
+			{
+				b=prev;
+				d=dist(a, prev);
+			}
+
+			if (b==prev)
+				break;
+
+			chain[chain_len++]=b;
+		}
+
+		chain_len-=2;
+		steps[l].idx1=a;
+		steps[l].idx2=b;
+		steps[l].dist=d;
+
+		merge(a, b);
+		active[a]=false;
+	}
+}
+
+/** index of the distance between i and j, i<j, in a condensed distance
+ * matrix of num points
+ */
+static inline int64_t condensed_index(int64_t i, int64_t j, int64_t num)
+{
+	return i*num-i*(i+1)/2+j-i-1;
+}
+
+/** complete or average linkage with the nearest-neighbor chain algorithm
+ * and Lance-Williams updates of the pairwise distances
+ */
+static void matrix_linkage(CDistance* distance, int32_t num, bool complete,
+	merge_step* steps)
+{
+	int64_t num_pairs=(int64_t)num*(num-1)/2;
+	SGVector<float64_t> dists(num_pairs);
+	SGVector<int32_t> sizes(num);
+	sizes.set_const(1);
+
+#pragma omp parallel for schedule(dynamic)
+	for (int32_t i=0; i<num; i++)
+	{
+		for (int32_t j=i+1; j<num; j++)
+			dists[condensed_index(i, j, num)]=distance->distance(i, j);
+	}
+
+	auto dist=[&](int32_t i, int32_t j)
+	{
+		return i<j ? dists[condensed_index(i, j, num)] :
+			dists[condensed_index(j, i, num)];
+	};
+
+	auto merge=[&](int32_t a, int32_t b)
+	{
+#pragma omp parallel for
+		for (int32_t j=0; j<num; j++)
+		{
+			if (j==a || j==b || sizes[j]==0)
+				continue;
+
+			int64_t idx=j<b ? condensed_index(j, b, num) :
+				condensed_index(b, j, num);
+			if (complete)
+				dists[idx]=CMath::max(dist(a, j), dist(b, j));
+			else
+				dists[idx]=(sizes[a]*dist(a, j)+sizes[b]*dist(b, j))/
+					(sizes[a]+sizes[b]);
+		}
+		sizes[b]+=sizes[a];
+		sizes[a]=0;
+	};
+
+	nn_chain(num, dist, merge, steps);
+}
+
+/** Ward linkage with the nearest-neighbor chain algorithm on the cluster
+ * centroids
+ */
+static void ward_linkage(CDotFeatures* features, int32_t num, merge_step* steps)
+{
+	int32_t dim=features->get_dim_feature_space();
+	SGMatrix<float64_t> centroids(dim, num);
+	centroids.zero();
+	SGVector<float64_t> sizes(num);
+	sizes.set_const(1.0);
+
+#pragma omp parallel for
+	for (int32_t i=0; i<num; i++)
+		features->add_to_dense_vec(1.0, i, centroids.get_column_vector(i), dim);
+
+	auto dist=[&](int32_t i, int32_t j)
+	{
+		float64_t sq_dist=0;
+		float64_t* ci=centroids.get_column_vector(i);
+		float64_t* cj=centroids.get_column_vector(j);
+		for (int32_t k=0; k<dim; k++)
+			sq_dist+=CMath::sq(ci[k]-cj[k]);
+
+		return std::sqrt(2*sizes[i]*sizes[j]/(sizes[i]+sizes[j])*sq_dist);
+	};
+
+	auto merge=[&](int32_t a, int32_t b)
+	{
+		float64_t* ca=centroids.get_column_vector(a);
+		float64_t* cb=centroids.get_column_vector(b);
+		float64_t size=sizes[a]+sizes[b];
+		for (int32_t k=0; k<dim; k++)
+			cb[k]=(sizes[a]*ca[k]+sizes[b]*cb[k])/size;
+		sizes[b]=size;
+	};
+
+	nn_chain(num, dist, merge, steps);
+}
+
+/** root of the union-find tree of i, with path halving */
+static int32_t find_root(int32_t* parents, int32_t i)
+{
+	while (parents[i]!=i)
+	{
+		parents[i]=parents[parents[i]];
+		i=parents[i];
+	}
+	return i;
+}
 #endif // DOXYGEN_SHOULD_SKIP_THIS
 
 CHierarchical::CHierarchical()
@@ -44,6 +298,7 @@ CHierarchical::CHierarchical(int32_t merges_, CDistance* d)
 void CHierarchical::init()
 {
 	merges = 3;
+	linkage = HL_SINGLE;
 	dimensions = 0;
 	assignment = NULL;
 	assignment_len = 0;
@@ -57,6 +312,7 @@ void CHierarchical::init()
 void CHierarchical::register_parameters()
 {
 	watch_param("merges", &merges);
+	watch_param("linkage", (machine_int_t*) &linkage);
 	watch_param("dimensions", &dimensions);
 	watch_param("assignment", &assignment, &assignment_len);
 	watch_param("table_size", &table_size);
@@ -89,8 +345,6 @@ bool CHierarchical::train_machine(CFeatures* data)
 	int32_t num=lhs->get_num_vectors();
 	ASSERT(num>0)
 
-	const int32_t num_pairs=num*(num-1)/2;
-
 	SG_FREE(merge_distance);
 	merge_distance=SG_MALLOC(float64_t, num);
 	merge_distance_len=num;
@@ -105,73 +359,73 @@ bool CHierarchical::train_machine(CFeatures* data)
 	pairs=SG_MALLOC(int32_t, 2*num);
 	SGVector<int32_t>::fill_vector(pairs, 2*num, -1);
 
-	pair* index=SG_MALLOC(pair, num_pairs);
-	float64_t* distances=SG_MALLOC(float64_t, num_pairs);
-
-	int32_t offs=0;
-	for (auto i : progress(range(0, num), *this->io))
+	/* the complete dendrogram, in the order the merges were found */
+	merge_step* steps=SG_MALLOC(merge_step, num-1);
+	switch (linkage)
 	{
-		for (int32_t j=i+1; j<num; j++)
+		case HL_SINGLE:
+			single_linkage(distance, num, steps);
+			break;
+		case HL_COMPLETE:
+		case HL_AVERAGE:
+			matrix_linkage(distance, num, linkage==HL_COMPLETE, steps);
+			break;
+		case HL_WARD:
 		{
-			distances[offs] = distance->distance(i, j);
-			index[offs].idx1 = i;
-			index[offs].idx2 = j;
-			offs++; // offs=i*(i+1)/2+j
+			EDistanceType type=distance->get_distance_type();
+			REQUIRE(type==D_EUCLIDEAN || type==D_SPARSEEUCLIDEAN,
+				"Ward linkage requires the Euclidean distance\n");
+			ward_linkage(lhs->as<CDotFeatures>(), num, steps);
+			break;
 		}
 	}
 
-	CMath::qsort_index<float64_t,pair>(distances, index, (num-1)*num/2);
-	//CMath::display_vector(distances, (num-1)*num/2, "dists");
-
-	auto pb = progress(range(0, num_pairs - 1), *this->io);
-	int32_t k=-1;
-	int32_t l=0;
-	for (; l<num && (num-l)>=merges && k<num_pairs-1; l++)
-	{
-		while (k<num_pairs-1)
+	/* all linkages are reducible, so sorting the merges by distance gives
+	 * the order in which they are done */
+	std::stable_sort(steps, steps+num-1,
+		[](const merge_step& s1, const merge_step& s2)
 		{
-			k++;
+			return s1.dist<s2.dist;
+		});
 
-			int32_t i=index[k].idx1;
-			int32_t j=index[k].idx2;
-			int32_t c1=assignment[i];
-			int32_t c2=assignment[j];
+	/* replay the merges, tracking clusters with a union-find forest whose
+	 * roots carry the cluster labels */
+	int32_t* parents=SG_MALLOC(int32_t, num);
+	SGVector<int32_t>::range_fill_vector(parents, num);
+	int32_t* labels=SG_MALLOC(int32_t, num);
+	SGVector<int32_t>::range_fill_vector(labels, num);
 
-			if (c1==c2)
-				continue;
+	auto pb = progress(range(0, num - 1), *this->io);
+	int32_t l=0;
+	for (; l<num-1 && (num-l)>=merges; l++)
+	{
+		pb.print_progress();
 
-			pb.print_progress();
+		int32_t r1=find_root(parents, steps[l].idx1);
+		int32_t r2=find_root(parents, steps[l].idx2);
+		int32_t c1=labels[r1];
+		int32_t c2=labels[r2];
 
-			if (c1<c2)
-			{
-				pairs[2*l]=c1;
-				pairs[2*l+1]=c2;
-			}
-			else
-			{
-				pairs[2*l]=c2;
-				pairs[2*l+1]=c1;
-			}
-			merge_distance[l]=distances[k];
+		pairs[2*l]=CMath::min(c1, c2);
+		pairs[2*l+1]=CMath::max(c1, c2);
+		merge_distance[l]=steps[l].dist;
 
-			int32_t c=num+l;
-			for (int32_t m=0; m<num; m++)
-			{
-				if (assignment[m] == c1 || assignment[m] == c2)
-					assignment[m] = c;
-			}
+		parents[r1]=r2;
+		labels[r2]=num+l;
 #ifdef DEBUG_HIERARCHICAL
-			SG_PRINT("l=%04i i=%04i j=%04i c1=%+04d c2=%+04d c=%+04d dist=%6.6f\n", l,i,j, c1,c2,c, merge_distance[l])
+		SG_PRINT("l=%04i c1=%+04d c2=%+04d c=%+04d dist=%6.6f\n", l, c1,c2, num+l, merge_distance[l])
 #endif
-			break;
-		}
 	}
 	pb.complete();
 
+	for (int32_t m=0; m<num; m++)
+		assignment[m]=labels[find_root(parents, m)];
+
 	table_size=l-1;
 	ASSERT(table_size>0)
-	SG_FREE(distances);
-	SG_FREE(index);
+	SG_FREE(labels);
+	SG_FREE(parents);
+	SG_FREE(steps);
 	SG_UNREF(lhs)
 
 	return true;
@@ -197,6 +451,16 @@ int32_t CHierarchical::get_merges()
 	return merges;
 }
 
+void CHierarchical::set_linkage(EHierarchicalLinkage l)
+{
+	linkage=l;
+}
+
+EHierarchicalLinkage CHierarchical::get_linkage() const
+{
+	return linkage;
+}
+
 SGVector<int32_t> CHierarchical::get_assignment()
 {
 	return SGVector<int32_t>(assignment,table_size, false);
@@ -19,19 +19,42 @@ namespace shogun
 {
 class CDistanceMachine;
 
-/** @brief Agglomerative hierarchical single linkage clustering.
+/** linkage criterion used by CHierarchical */
+enum EHierarchicalLinkage
+{
+	/** minimum distance between the elements of the clusters */
+	HL_SINGLE,
+	/** maximum distance between the elements of the clusters */
+	HL_COMPLETE,
+	/** mean distance between the elements of the clusters */
+	HL_AVERAGE,
+	/** increase of the within-cluster variance, Euclidean distance only */
+	HL_WARD
+};
+
+/** @brief Agglomerative hierarchical clustering.
  *
  * Starting with each object being assigned to its own cluster clusters are
  * iteratively merged.  Here the clusters are merged whose elements have
- * minimum distance, i.e.  the clusters A and B that obtain
+ * minimum distance, i.e. for single linkage the clusters A and B that obtain
  *
  * \f[
  * \min\{d({\bf x},{\bf x'}): {\bf x}\in {\cal A},{\bf x'}\in {\cal B}\}
  * \f]
  *
- * are merged.
+ * are merged. Complete, average and Ward linkage are available as well, see
+ * set_linkage().
  *
- * cf e.g. http://en.wikipedia.org/wiki/Data_clustering*/
+ * All linkages take \f$O(n^2)\f$ distance computations, done in parallel.
+ * Single linkage is computed from a minimum spanning tree (Prim's algorithm)
+ * and Ward linkage with the nearest-neighbor chain algorithm on the cluster
+ * centroids, both in \f$O(n)\f$ memory. Complete and average linkage use the
+ * nearest-neighbor chain algorithm on the matrix of pairwise distances, which
+ * needs \f$n(n-1)/2\f$ distances in memory.
+ *
+ * cf e.g. http://en.wikipedia.org/wiki/Data_clustering
+ * cf. Muellner, D. (2011). Modern hierarchical, agglomerative clustering
+ * algorithms. arXiv:1109.2378 */
 class CHierarchical : public CDistanceMachine
 {
 	public:
@@ -85,6 +108,18 @@ class CHierarchical : public CDistanceMachine
 		 */
 		int32_t get_merges();
 
+		/** set linkage criterion
+		 *
+		 * @param l new linkage, default is HL_SINGLE
+		 */
+		void set_linkage(EHierarchicalLinkage l);
+
+		/** get linkage criterion
+		 *
+		 * @return linkage
+		 */
+		EHierarchicalLinkage get_linkage() const;
+
 		/** get assignment
 		 *
 		 */
@@ -132,6 +167,9 @@ class CHierarchical : public CDistanceMachine
 		/// the number of merges in hierarchical clustering
 		int32_t merges;
 
+		/// linkage criterion
+		EHierarchicalLinkage linkage;
+
 		/// number of dimensions
 		int32_t dimensions;
 
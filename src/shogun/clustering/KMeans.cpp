@@ -23,20 +23,33 @@ namespace shogun
 
 CKMeans::CKMeans():CKMeansBase()
 {
+	init_km_params();
 }
 
 CKMeans::CKMeans(int32_t k_i, CDistance* d_i, bool use_kmpp_i):CKMeansBase(k_i, d_i, use_kmpp_i)
 {
+	init_km_params();
 }
 
 CKMeans::CKMeans(int32_t k_i, CDistance* d_i, SGMatrix<float64_t> centers_i):CKMeansBase(k_i, d_i, centers_i)
 {
+	init_km_params();
 }
 
 CKMeans::~CKMeans()
 {
 }
 
+void CKMeans::set_train_method(EKMeansMethod method)
+{
+	train_method=method;
+}
+
+EKMeansMethod CKMeans::get_train_method() const
+{
+	return train_method;
+}
+
 void CKMeans::Lloyd_KMeans(SGMatrix<float64_t> centers, int32_t num_centers)
 {
 	CDenseFeatures<float64_t>* lhs =
@@ -181,13 +194,277 @@ void CKMeans::Lloyd_KMeans(SGMatrix<float64_t> centers, int32_t num_centers)
 	SG_UNREF(lhs);
 }
 
+void CKMeans::Hamerly_KMeans(SGMatrix<float64_t> centers, int32_t num_centers)
+{
+	CDenseFeatures<float64_t>* lhs=
+		distance->get_lhs()->as<CDenseFeatures<float64_t>>();
+	SGMatrix<float64_t> data=lhs->get_feature_matrix();
+	SG_UNREF(lhs);
+
+	int32_t lhs_size=data.num_cols;
+	int32_t dim=data.num_rows;
+	Map<MatrixXd> map_data(data.matrix, dim, lhs_size);
+	Map<MatrixXd> map_centers(centers.matrix, dim, num_centers);
+
+	SGVector<int32_t> cluster_assignments=SGVector<int32_t>(lhs_size);
+	cluster_assignments.zero();
+
+	/* upper bound on the distance to the assigned center and lower bound on
+	 * the distance to every other center */
+	SGVector<float64_t> upper_bounds(lhs_size);
+	SGVector<float64_t> lower_bounds(lhs_size);
+
+	/* half the distance from each center to its closest other center */
+	SGVector<float64_t> half_min_dists(num_centers);
+	/* distance each center moved in the last update step */
+	SGVector<float64_t> moved(num_centers);
+	SGMatrix<float64_t> old_centers(dim, num_centers);
+	Map<MatrixXd> map_old_centers(old_centers.matrix, dim, num_centers);
+
+	int32_t changed=1;
+	int32_t iter;
+
+	for(iter=0; iter<max_iter; iter++)
+	{
+		if (iter==max_iter-1)
+			SG_SWARNING("KMeans clustering has reached maximum number of ( %d ) iterations without having converged. \
+				   	Terminating. \n", iter)
+
+		changed=0;
+
+#pragma omp parallel for
+		for (int32_t j=0; j<num_centers; j++)
+		{
+			float64_t min_dist=CMath::INFTY;
+			for (int32_t l=0; l<num_centers; l++)
+			{
+				if (l!=j)
+					min_dist=CMath::min(min_dist,
+						(map_centers.col(j)-map_centers.col(l)).norm());
+			}
+			half_min_dists[j]=0.5*min_dist;
+		}
+
+#pragma omp parallel for reduction(+:changed) schedule(static, 1024)
+		/* Assigment step : only points whose bounds do not rule out a closer
+		 * center are compared against all the centers */
+		for (int32_t i=0; i<lhs_size; i++)
+		{
+			const int32_t cluster_assignments_i=cluster_assignments[i];
+
+			/* in the first iteration there are no bounds yet */
+			if (iter>0)
+			{
+				float64_t bound=CMath::max(
+					half_min_dists[cluster_assignments_i], lower_bounds[i]);
+				if (upper_bounds[i]<=bound)
+					continue;
+
+				upper_bounds[i]=(map_data.col(i)-
+					map_centers.col(cluster_assignments_i)).norm();
+				if (upper_bounds[i]<=bound)
+					continue;
+			}
+
+			int32_t min_cluster=0;
+			float64_t min_dist=CMath::INFTY;
+			float64_t second_min_dist=CMath::INFTY;
+			for (int32_t j=0; j<num_centers; j++)
+			{
+				float64_t dist=(map_data.col(i)-map_centers.col(j)).norm();
+				if (dist<min_dist)
+				{
+					second_min_dist=min_dist;
+					min_dist=dist;
+					min_cluster=j;
+				}
+				else if (dist<second_min_dist)
+					second_min_dist=dist;
+			}
+
+			upper_bounds[i]=min_dist;
+			lower_bounds[i]=second_min_dist;
+
+			if (min_cluster!=cluster_assignments_i)
+			{
+				changed++;
+				cluster_assignments[i]=min_cluster;
+			}
+		}
+		if(changed==0)
+			break;
+
+		/* Update Step : Calculate new means and loosen the bounds by the
+		 * distances the centers moved */
+		map_old_centers=map_centers;
+		update_centers(data, cluster_assignments, centers);
+
+		int32_t max_moved=0;
+		int32_t second_max_moved=-1;
+		for (int32_t j=0; j<num_centers; j++)
+		{
+			moved[j]=(map_centers.col(j)-map_old_centers.col(j)).norm();
+			if (moved[j]>moved[max_moved])
+			{
+				second_max_moved=max_moved;
+				max_moved=j;
+			}
+			else if (j!=max_moved &&
+				(second_max_moved==-1 || moved[j]>moved[second_max_moved]))
+				second_max_moved=j;
+		}
+
+#pragma omp parallel for schedule(static, 1024)
+		for (int32_t i=0; i<lhs_size; i++)
+		{
+			const int32_t cluster_i=cluster_assignments[i];
+			upper_bounds[i]+=moved[cluster_i];
+			if (cluster_i==max_moved)
+			{
+				if (second_max_moved!=-1)
+					lower_bounds[i]-=moved[second_max_moved];
+			}
+			else
+				lower_bounds[i]-=moved[max_moved];
+		}
+
+		if (max_iter>=10 && iter%(max_iter/10) == 0)
+			SG_SINFO("Iteration[%d/%d]: Assignment of %i patterns changed.\n", iter, max_iter, changed)
+	}
+}
+
+void CKMeans::Blocked_KMeans(SGMatrix<float64_t> centers, int32_t num_centers)
+{
+	/* number of points whose distances are computed in one product */
+	const int32_t block_size=256;
+
+	CDenseFeatures<float64_t>* lhs=
+		distance->get_lhs()->as<CDenseFeatures<float64_t>>();
+	SGMatrix<float64_t> data=lhs->get_feature_matrix();
+	SG_UNREF(lhs);
+
+	int32_t lhs_size=data.num_cols;
+	int32_t dim=data.num_rows;
+	Map<MatrixXd> map_data(data.matrix, dim, lhs_size);
+	Map<MatrixXd> map_centers(centers.matrix, dim, num_centers);
+
+	SGVector<int32_t> cluster_assignments=SGVector<int32_t>(lhs_size);
+	cluster_assignments.zero();
+
+	VectorXd center_norms(num_centers);
+
+	int32_t changed=1;
+	int32_t iter;
+
+	for(iter=0; iter<max_iter; iter++)
+	{
+		if (iter==max_iter-1)
+			SG_SWARNING("KMeans clustering has reached maximum number of ( %d ) iterations without having converged. \
+				   	Terminating. \n", iter)
+
+		changed=0;
+		center_norms=map_centers.colwise().squaredNorm().transpose();
+
+#pragma omp parallel for reduction(+:changed) schedule(dynamic)
+		/* Assigment step : ||x||^2 is the same for all the centers, so the
+		 * closest center minimizes ||mu||^2-2x'mu */
+		for (int32_t b=0; b<lhs_size; b+=block_size)
+		{
+			int32_t num_points=CMath::min(block_size, lhs_size-b);
+			MatrixXd dists=-2.0*map_centers.transpose()*
+				map_data.middleCols(b, num_points);
+			dists.colwise()+=center_norms;
+
+			for (int32_t i=0; i<num_points; i++)
+			{
+				int32_t min_cluster;
+				dists.col(i).minCoeff(&min_cluster);
+
+				if (min_cluster!=cluster_assignments[b+i])
+				{
+					changed++;
+					cluster_assignments[b+i]=min_cluster;
+				}
+			}
+		}
+		if(changed==0)
+			break;
+
+		/* Update Step : Calculate new means */
+		update_centers(data, cluster_assignments, centers);
+
+		if (max_iter>=10 && iter%(max_iter/10) == 0)
+			SG_SINFO("Iteration[%d/%d]: Assignment of %i patterns changed.\n", iter, max_iter, changed)
+	}
+}
+
+void CKMeans::update_centers(SGMatrix<float64_t> data,
+	SGVector<int32_t> cluster_assignments, SGMatrix<float64_t> centers)
+{
+	int32_t dim=data.num_rows;
+	int32_t num_centers=centers.num_cols;
+	Map<MatrixXd> map_data(data.matrix, dim, data.num_cols);
+	Map<MatrixXd> map_centers(centers.matrix, dim, num_centers);
+
+	/* mus=zeros(dim, num_centers) ; */
+	map_centers.setZero();
+	VectorXd weights=VectorXd::Zero(num_centers);
+
+#pragma omp parallel
+	{
+		MatrixXd sums=MatrixXd::Zero(dim, num_centers);
+		VectorXd counts=VectorXd::Zero(num_centers);
+
+#pragma omp for nowait
+		for (int32_t i=0; i<data.num_cols; i++)
+		{
+			sums.col(cluster_assignments[i])+=map_data.col(i);
+			counts[cluster_assignments[i]]+=1;
+		}
+
+#pragma omp critical
+		{
+			map_centers+=sums;
+			weights+=counts;
+		}
+	}
+
+	for (int32_t i=0; i<num_centers; i++)
+	{
+		if (weights[i]!=0)
+			map_centers.col(i)*=1.0/weights[i];
+	}
+}
+
 bool CKMeans::train_machine(CFeatures* data)
 {
 	initialize_training(data);
-	Lloyd_KMeans(mus, k);
+
+	if (train_method==KMM_LLOYD)
+		Lloyd_KMeans(mus, k);
+	else
+	{
+		REQUIRE(distance->get_distance_type()==D_EUCLIDEAN,
+			"Training method %d requires the Euclidean distance\n", train_method);
+		REQUIRE(!fixed_centers,
+			"Training method %d cannot be used with fixed centers\n", train_method);
+
+		if (train_method==KMM_HAMERLY)
+			Hamerly_KMeans(mus, k);
+		else
+			Blocked_KMeans(mus, k);
+	}
+
 	compute_cluster_variances();
 	return true;
 }
 
+void CKMeans::init_km_params()
+{
+	train_method=KMM_LLOYD;
+	SG_ADD((machine_int_t*) &train_method, "train_method",
+		"Method used for the iterations", MS_AVAILABLE);
+}
+
 }
 
@@ -21,6 +21,17 @@ namespace shogun
 {
 class CKMeansBase;
 
+/** method used for the iterations of CKMeans */
+enum EKMeansMethod
+{
+	/** distances from every point to every center through CDistance */
+	KMM_LLOYD,
+	/** Hamerly's bounds to skip most of the distance computations */
+	KMM_HAMERLY,
+	/** assignments computed in blocks of points using matrix products */
+	KMM_BLOCKED
+};
+
 /** @brief KMeans clustering,  partitions the data into k (a-priori specified) clusters.
  *
  * It minimizes
@@ -35,6 +46,22 @@ class CKMeansBase;
  *
  * To use mini-batch based training was see CKMeansMiniBatch 
  *
+ * Besides the standard Lloyd iterations (KMM_LLOYD), two faster ways of
+ * computing the same iterations are available for the Euclidean distance, see
+ * set_train_method():
+ *
+ * KMM_HAMERLY keeps an upper bound on the distance from each point to its
+ * assigned center and a lower bound on the distance to its second closest
+ * center. The triangle inequality then allows skipping the distance
+ * computations for most of the points once the centers start settling. It
+ * only needs two bounds per point, unlike Elkan's method which needs k.
+ *
+ * KMM_BLOCKED computes all the distances of a block of points in a single
+ * matrix-matrix product, using
+ * \f$\|x-\mu\|^2 = \|x\|^2-2x^T\mu+\|\mu\|^2\f$, which pays off for large k.
+ *
+ * cf. Hamerly, G. (2010). Making k-means even faster. SDM.
+ *
  * cf. http://en.wikipedia.org/wiki/K-means_algorithm
  * cf. http://en.wikipedia.org/wiki/Lloyd's_algorithm
  *
@@ -67,6 +94,20 @@ class CKMeans : public CKMeansBase
 		/** @return object name */
 		virtual const char* get_name() const { return "KMeans"; }		
 
+		/** set the method used for the iterations. KMM_HAMERLY and
+		 * KMM_BLOCKED require a CEuclideanDistance and cannot be used with
+		 * fixed centers
+		 *
+		 * @param method training method, default is KMM_LLOYD
+		 */
+		void set_train_method(EKMeansMethod method);
+
+		/** get the method used for the iterations
+		 *
+		 * @return training method
+		 */
+		EKMeansMethod get_train_method() const;
+
 	private:
 
 		/** train k-means
@@ -82,6 +123,32 @@ class CKMeans : public CKMeansBase
 		/** Lloyd's KMeans training method
 		 */
 		void Lloyd_KMeans(SGMatrix<float64_t> centers, int32_t num_centers);
+
+		/** Lloyd's iterations accelerated with Hamerly's bounds
+		 */
+		void Hamerly_KMeans(SGMatrix<float64_t> centers, int32_t num_centers);
+
+		/** Lloyd's iterations with the assignment step computed blockwise
+		 * using matrix products
+		 */
+		void Blocked_KMeans(SGMatrix<float64_t> centers, int32_t num_centers);
+
+		/** sets each center to the mean of the points assigned to it, or
+		 * to zero if there are none
+		 *
+		 * @param data points, one per column
+		 * @param cluster_assignments index of the center of each point
+		 * @param centers cluster centers to be updated
+		 */
+		void update_centers(SGMatrix<float64_t> data,
+			SGVector<int32_t> cluster_assignments, SGMatrix<float64_t> centers);
+
+		void init_km_params();
+
+	protected:
+
+		/** Method used for the iterations */
+		EKMeansMethod train_method;
 };
 }
 #endif
@@ -9,6 +9,7 @@
 #include <shogun/distance/EuclideanDistance.h>
 #include <shogun/labels/Labels.h>
 #include <shogun/features/DenseFeatures.h>
+#include <shogun/features/SparseFeatures.h>
 #include <shogun/mathematics/Math.h>
 #include <shogun/base/Parallel.h>
 #include <shogun/mathematics/eigen3.h>
@@ -46,8 +47,8 @@ CKMeansBase::~CKMeansBase()
 
 void CKMeansBase::set_initial_centers(SGMatrix<float64_t> centers)
 {
-	CDenseFeatures<float64_t>* lhs=distance->get_lhs()->as<CDenseFeatures<float64_t>>();
-	dimensions=lhs->get_num_features();
+	CDotFeatures* lhs=distance->get_lhs()->as<CDotFeatures>();
+	dimensions=lhs->get_dim_feature_space();
 	REQUIRE(centers.num_cols == k,
 			"Expected %d initial cluster centers, got %d", k, centers.num_cols);
 	REQUIRE(centers.num_rows == dimensions,
@@ -59,8 +60,7 @@ void CKMeansBase::set_initial_centers(SGMatrix<float64_t> centers)
 void CKMeansBase::set_random_centers()
 {
 	mus.zero();
-	CDenseFeatures<float64_t>* lhs=
-		distance->get_lhs()->as<CDenseFeatures<float64_t>>();
+	CDotFeatures* lhs=distance->get_lhs()->as<CDotFeatures>();
 	int32_t lhs_size=lhs->get_num_vectors();
 
 	SGVector<int32_t> temp=SGVector<int32_t>(lhs_size);
@@ -70,12 +70,8 @@ void CKMeansBase::set_random_centers()
 	for (int32_t i=0; i<k; i++)
 	{
 		const int32_t cluster_center_i=temp[i];
-		SGVector<float64_t> vec=lhs->get_feature_vector(cluster_center_i);
-
-		for (int32_t j=0; j<dimensions; j++)
-			mus(j,i)=vec[j];
-
-		lhs->free_feature_vector(vec, cluster_center_i);
+		lhs->add_to_dense_vec(1.0, cluster_center_i, mus.get_column_vector(i),
+			dimensions);
 	}
 
 	SG_UNREF(lhs);
@@ -138,12 +134,11 @@ void CKMeansBase::initialize_training(CFeatures* data)
 	if (data)
 		distance->init(data, data);
 
-	CDenseFeatures<float64_t>* lhs=
-		distance->get_lhs()->as<CDenseFeatures<float64_t>>();
+	CDotFeatures* lhs=distance->get_lhs()->as<CDotFeatures>();
 
 	REQUIRE(lhs, "Lhs features of distance not provided");
 	int32_t lhs_size=lhs->get_num_vectors();
-	dimensions=lhs->get_num_features();
+	dimensions=lhs->get_dim_feature_space();
 	const int32_t centers_size=dimensions*k;
 
 	REQUIRE(lhs_size>0, "Lhs features should not be empty");
@@ -224,9 +219,15 @@ SGMatrix<float64_t> CKMeansBase::get_cluster_centers()
 	if (!R.vector)
 		return SGMatrix<float64_t>();
 
-	CDenseFeatures<float64_t>* lhs=
-		distance->get_lhs()->as<CDenseFeatures<float64_t>>();
-	SGMatrix<float64_t> centers=lhs->get_feature_matrix();
+	CFeatures* lhs=distance->get_lhs();
+	SGMatrix<float64_t> centers;
+	if (lhs->get_feature_class()==C_SPARSE)
+	{
+		centers=lhs->as<CSparseFeatures<float64_t>>()
+			->get_full_feature_matrix();
+	}
+	else
+		centers=lhs->as<CDenseFeatures<float64_t>>()->get_feature_matrix();
 	SG_UNREF(lhs);
 	return centers;
 }
@@ -248,9 +249,13 @@ bool CKMeansBase::get_fixed_centers()
 
 void CKMeansBase::store_model_features()
 {
-	/* set lhs of underlying distance to cluster centers */
-	CDenseFeatures<float64_t>* cluster_centers=new CDenseFeatures<float64_t>(
-			mus);
+	/* set lhs of underlying distance to cluster centers, in the same
+	 * representation as the training data */
+	CFeatures* cluster_centers;
+	if (distance->get_feature_class()==C_SPARSE)
+		cluster_centers=new CSparseFeatures<float64_t>(mus);
+	else
+		cluster_centers=new CDenseFeatures<float64_t>(mus);
 
 	/* store cluster centers in lhs of distance variable */
 	CFeatures* rhs=distance->get_rhs();
@@ -261,7 +266,7 @@ void CKMeansBase::store_model_features()
 SGMatrix<float64_t> CKMeansBase::kmeanspp()
 {
 	int32_t lhs_size;
-	CDenseFeatures<float64_t>* lhs=distance->get_lhs()->as<CDenseFeatures<float64_t>>();
+	CDotFeatures* lhs=distance->get_lhs()->as<CDotFeatures>();
 	lhs_size=lhs->get_num_vectors();
 
 	SGMatrix<float64_t> centers=SGMatrix<float64_t>(dimensions, k);
@@ -271,9 +276,7 @@ SGMatrix<float64_t> CKMeansBase::kmeanspp()
 
 	/* First center is chosen at random */
 	int32_t mu=CMath::random((int32_t) 0, lhs_size-1);
-	SGVector<float64_t> mu_first=lhs->get_feature_vector(mu);
-	for(int32_t j=0; j<dimensions; j++)
-		centers(j, 0)=mu_first[j];
+	lhs->add_to_dense_vec(1.0, mu, centers.get_column_vector(0), dimensions);
 
 	distance->precompute_lhs();
 	distance->precompute_rhs();
@@ -340,9 +343,8 @@ SGMatrix<float64_t> CKMeansBase::kmeanspp()
 			}
 		}
 
-		SGVector<float64_t> vec=lhs->get_feature_vector(best_center);
-		for(int32_t j=0; j<dimensions; j++)
-			centers(j, i)=vec[j];
+		lhs->add_to_dense_vec(1.0, best_center, centers.get_column_vector(i),
+			dimensions);
 		sum=best_sum;
 		min_dist=best_min_dist;
 	}
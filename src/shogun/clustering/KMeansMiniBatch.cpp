@@ -8,6 +8,7 @@
 #include <shogun/mathematics/Math.h>
 #include <shogun/distance/Distance.h>
 #include <shogun/features/DenseFeatures.h>
+#include <shogun/mathematics/linalg/LinalgNamespace.h>
 
 #ifdef _WIN32
 #undef far
@@ -74,54 +75,102 @@ void CKMeansMiniBatch::minibatch_KMeans()
 	REQUIRE(minib_iter>0,
 		"number of iterations not set to positive value. Current iterations %d \n", minib_iter);
 
-	CDenseFeatures<float64_t>* lhs=
-		distance->get_lhs()->as<CDenseFeatures<float64_t>>();
-	CDenseFeatures<float64_t>* rhs_mus=new CDenseFeatures<float64_t>(mus);
-	CFeatures* rhs_cache=distance->replace_rhs(rhs_mus);
+	CDotFeatures* lhs=distance->get_lhs()->as<CDotFeatures>();
 	int32_t XSize=lhs->get_num_vectors();
-	int32_t dims=lhs->get_num_features();
+	int32_t dims=lhs->get_dim_feature_space();
+
+	/* with the Euclidean distance the closest center minimizes
+	 * ||mu||^2-2x'mu, which only needs dot products and so works the same
+	 * for dense and sparse features. Other distances go through CDistance */
+	EDistanceType distance_type=distance->get_distance_type();
+	bool euclidean=(distance_type==D_EUCLIDEAN ||
+		distance_type==D_SPARSEEUCLIDEAN);
+	REQUIRE(euclidean || distance->get_feature_class()==C_DENSE,
+		"Distance %s requires dense features\n", distance->get_name());
+
+	CDenseFeatures<float64_t>* rhs_mus=NULL;
+	CFeatures* rhs_cache=NULL;
+	if (!euclidean)
+	{
+		rhs_mus=new CDenseFeatures<float64_t>(mus);
+		rhs_cache=distance->replace_rhs(rhs_mus);
+	}
 
 	SGVector<float64_t> v=SGVector<float64_t>(k);
 	v.zero();
+	SGVector<float64_t> center_norms=SGVector<float64_t>(k);
+	SGVector<int32_t> offsets=SGVector<int32_t>(k+1);
+	SGVector<int32_t> order=SGVector<int32_t>(batch_size);
 
 	for (int32_t i=0; i<minib_iter; i++)
 	{
 		SGVector<int32_t> M=mbchoose_rand(batch_size,XSize);
 		SGVector<int32_t> ncent=SGVector<int32_t>(batch_size);
-		for (int32_t j=0; j<batch_size; j++)
+
+		if (euclidean)
 		{
-			SGVector<float64_t> dists=SGVector<float64_t>(k);
 			for (int32_t p=0; p<k; p++)
-				dists[p]=distance->distance(M[j],p);
+			{
+				SGVector<float64_t> mu(mus.get_column_vector(p), dims, false);
+				center_norms[p]=linalg::dot(mu, mu);
+			}
+		}
 
+#pragma omp parallel for
+		for (int32_t j=0; j<batch_size; j++)
+		{
 			int32_t imin=0;
-			float64_t min=dists[0];
-			for (int32_t p=1; p<k; p++)
+			float64_t min=CMath::INFTY;
+			for (int32_t p=0; p<k; p++)
 			{
-				if (dists[p]<min)
+				float64_t dist;
+				if (euclidean)
+				{
+					dist=center_norms[p]-
+						2*lhs->dense_dot(M[j], mus.get_column_vector(p), dims);
+				}
+				else
+					dist=distance->distance(M[j],p);
+
+				if (dist<min)
 				{
 					imin=p;
-					min=dists[p];
+					min=dist;
 				}
 			}
 			ncent[j]=imin;
 		}
+
+		/* group the batch by center, keeping the batch order within each
+		 * center, so that the centers can be updated in parallel */
+		offsets.zero();
 		for (int32_t j=0; j<batch_size; j++)
+			offsets[ncent[j]+1]++;
+		for (int32_t p=0; p<k; p++)
+			offsets[p+1]+=offsets[p];
+		SGVector<int32_t> next=offsets.clone();
+		for (int32_t j=0; j<batch_size; j++)
+			order[next[ncent[j]]++]=M[j];
+
+#pragma omp parallel for schedule(dynamic)
+		for (int32_t p=0; p<k; p++)
 		{
-			int32_t near=ncent[j];
-			SGVector<float64_t> c_alive=rhs_mus->get_feature_vector(near);
-			SGVector<float64_t> x=lhs->get_feature_vector(M[j]);
-			v[near]+=1.0;
-			float64_t eta=1.0/v[near];
-			for (int32_t c=0; c<dims; c++)
+			float64_t* c_alive=mus.get_column_vector(p);
+			for (int32_t j=offsets[p]; j<offsets[p+1]; j++)
 			{
-				c_alive[c]=(1.0-eta)*c_alive[c]+eta*x[c];
+				v[p]+=1.0;
+				float64_t eta=1.0/v[p];
+				SGVector<float64_t>::scale_vector(1.0-eta, c_alive, dims);
+				lhs->add_to_dense_vec(eta, order[j], c_alive, dims);
 			}
 		}
 	}
 	SG_UNREF(lhs);
-	distance->replace_rhs(rhs_cache);
-	delete rhs_mus;
+	if (!euclidean)
+	{
+		distance->replace_rhs(rhs_cache);
+		delete rhs_mus;
+	}
 }
 
 SGVector<int32_t> CKMeansMiniBatch::mbchoose_rand(int32_t b, int32_t num)
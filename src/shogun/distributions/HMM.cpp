@@ -10,6 +10,7 @@
 #include <shogun/io/SGIO.h>
 #include <shogun/lib/config.h>
 #include <shogun/lib/Signal.h>
+#include <shogun/lib/SGMatrix.h>
 #include <shogun/base/Parallel.h>
 #include <shogun/features/StringFeatures.h>
 #include <shogun/features/Alphabet.h>
@@ -1275,13 +1276,156 @@ float64_t CHMM::best_path(int32_t dimension)
 	}
 }
 
+void CHMM::get_linear_model(SGVector<float64_t>& lin_a,
+	SGVector<float64_t>& lin_bt, SGVector<float64_t>& lin_p,
+	SGVector<float64_t>& lin_q) const
+{
+	lin_a=SGVector<float64_t>(N*N);
+	lin_bt=SGVector<float64_t>(M*N);
+	lin_p=SGVector<float64_t>(N);
+	lin_q=SGVector<float64_t>(N);
+
+	for (int32_t i=0; i<N*N; i++)
+		lin_a[i]=exp(transition_matrix_a[i]);
+
+	for (int32_t i=0; i<N; i++)
+	{
+		lin_p[i]=exp(get_p(i));
+		lin_q[i]=exp(get_q(i));
+
+		for (int32_t j=0; j<M; j++)
+			lin_bt[j*N+i]=exp(get_b(i, j));
+	}
+}
+
+float64_t CHMM::scaled_forward_backward(const uint16_t* obs, int32_t len,
+	const float64_t* lin_a, const float64_t* lin_bt, const float64_t* lin_p,
+	const float64_t* lin_q, float64_t* alpha, float64_t* beta,
+	float64_t* scale) const
+{
+	ASSERT(len>0)
+
+	//initialization	alpha_1(i)=p_i*b_i(O_1)
+	const float64_t* b=&lin_bt[obs[0]*N];
+	float64_t c=0;
+	for (int32_t i=0; i<N; i++)
+	{
+		alpha[i]=lin_p[i]*b[i];
+		c+=alpha[i];
+	}
+
+	if (c==0)
+		return -CMath::INFTY;
+
+	scale[0]=c;
+	for (int32_t i=0; i<N; i++)
+		alpha[i]/=c;
+	float64_t log_prob=log(c);
+
+	//induction		alpha_t+1(j) = (sum_i=1^N alpha_t(i)a_ij) b_j(O_t+1)
+	for (int32_t t=1; t<len; t++)
+	{
+		const float64_t* prev=&alpha[(t-1)*N];
+		float64_t* cur=&alpha[t*N];
+		b=&lin_bt[obs[t]*N];
+		c=0;
+
+		for (int32_t j=0; j<N; j++)
+		{
+			const float64_t* a_j=&lin_a[j*N];
+			float64_t sum=0;
+			for (int32_t i=0; i<N; i++)
+				sum+=prev[i]*a_j[i];
+
+			cur[j]=sum*b[j];
+			c+=cur[j];
+		}
+
+		if (c==0)
+			return -CMath::INFTY;
+
+		scale[t]=c;
+		for (int32_t j=0; j<N; j++)
+			cur[j]/=c;
+		log_prob+=log(c);
+	}
+
+	// termination
+	const float64_t* last=&alpha[(len-1)*N];
+	c=0;
+	for (int32_t i=0; i<N; i++)
+		c+=last[i]*lin_q[i];
+
+	if (c==0)
+		return -CMath::INFTY;
+
+	scale[len]=c;
+	log_prob+=log(c);
+
+	if (beta)
+	{
+		float64_t* cur=&beta[(len-1)*N];
+		for (int32_t i=0; i<N; i++)
+			cur[i]=lin_q[i]/c;
+
+		// beta_t(i) = sum_j a_ij b_j(O_t+1) beta_t+1(j), column-wise
+		for (int32_t t=len-2; t>=0; t--)
+		{
+			const float64_t* next=&beta[(t+1)*N];
+			cur=&beta[t*N];
+			b=&lin_bt[obs[t+1]*N];
+
+			for (int32_t i=0; i<N; i++)
+				cur[i]=0;
+
+			for (int32_t j=0; j<N; j++)
+			{
+				float64_t w=b[j]*next[j]/scale[t+1];
+				if (w==0)
+					continue;
+
+				const float64_t* a_j=&lin_a[j*N];
+				for (int32_t i=0; i<N; i++)
+					cur[i]+=a_j[i]*w;
+			}
+		}
+	}
+
+	return log_prob;
+}
+
 #ifndef USE_HMMPARALLEL
 float64_t CHMM::model_probability_comp()
 {
+	SGVector<float64_t> lin_a, lin_bt, lin_p, lin_q;
+	get_linear_model(lin_a, lin_bt, lin_p, lin_q);
+
+	int32_t num_dims=p_observations->get_num_vectors();
+	int32_t max_len=p_observations->get_max_vector_length();
+	SGVector<float64_t> dim_prob(num_dims);
+
+	#pragma omp parallel
+	{
+		SGVector<float64_t> alpha(max_len*N);
+		SGVector<float64_t> scale(max_len+1);
+
+		#pragma omp for schedule(dynamic)
+		for (int32_t dim=0; dim<num_dims; dim++)
+		{
+			int32_t len=0;
+			bool free_vec;
+			uint16_t* obs=p_observations->get_feature_vector(dim, len, free_vec);
+			dim_prob[dim]=scaled_forward_backward(obs, len, lin_a.vector,
+					lin_bt.vector, lin_p.vector, lin_q.vector, alpha.vector,
+					NULL, scale.vector);
+			p_observations->free_feature_vector(obs, dim, free_vec);
+		}
+	}
+
 	//for faster calculation cache model probability
 	mod_prob=0 ;
-	for (int32_t dim=0; dim<p_observations->get_num_vectors(); dim++) //sum in log space
-		mod_prob+=forward(p_observations->get_vector_length(dim), 0, dim);
+	for (int32_t dim=0; dim<num_dims; dim++) //sum in log space
+		mod_prob+=dim_prob[dim];
 
 	mod_prob_updated=true;
 	return mod_prob;
@@ -1526,9 +1670,7 @@ void CHMM::estimate_model_baum_welch(CHMM* hmm)
 //estimates new model lambda out of lambda_estimate using baum welch algorithm
 void CHMM::estimate_model_baum_welch(CHMM* estimate)
 {
-	int32_t i,j,t,dim;
-	float64_t a_sum, b_sum;	//numerator
-	float64_t dimmodprob=0;	//model probability for dim
+	int32_t i,j;
 	float64_t fullmodprob=0;	//for all dims
 
 	//clear actual model a,b,p,q are used as numerator
@@ -1556,47 +1698,118 @@ void CHMM::estimate_model_baum_welch(CHMM* estimate)
 	}
 	invalidate_model();
 
-	//change summation order to make use of alpha/beta caches
-	for (dim=0; dim<p_observations->get_num_vectors(); dim++)
-	{
-		dimmodprob=estimate->model_probability(dim);
-		fullmodprob+=dimmodprob ;
-
-		for (i=0; i<N; i++)
+	SGVector<float64_t> lin_a, lin_bt, lin_p, lin_q;
+	estimate->get_linear_model(lin_a, lin_bt, lin_p, lin_q);
+
+	int32_t num_dims=p_observations->get_num_vectors();
+	int32_t max_len=p_observations->get_max_vector_length();
+	int32_t num_blocks=CMath::max(1, CMath::min(parallel->get_num_threads(), num_dims));
+	SGVector<float64_t> dim_prob(num_dims);
+
+	// expected counts of p, q, a and b (in linear space, as they are
+	// posteriors) per block of sequences, merged in block order afterwards
+	const int32_t num_counts=2*N+N*N+N*M;
+	SGMatrix<float64_t> counts(num_counts, num_blocks);
+	counts.zero();
+
+	#pragma omp parallel for schedule(dynamic)
+	for (int32_t block=0; block<num_blocks; block++)
+	{
+		SGVector<float64_t> alpha(max_len*N);
+		SGVector<float64_t> beta(max_len*N);
+		SGVector<float64_t> scale(max_len+1);
+		float64_t* p_cnt=counts.get_column_vector(block);
+		float64_t* q_cnt=p_cnt+N;
+		float64_t* a_cnt=q_cnt+N;
+		float64_t* b_cnt=a_cnt+N*N;
+
+		int32_t dim_start=int64_t(num_dims)*block/num_blocks;
+		int32_t dim_stop=int64_t(num_dims)*(block+1)/num_blocks;
+		for (int32_t dim=dim_start; dim<dim_stop; dim++)
 		{
-			//estimate initial+end state distribution numerator
-			set_p(i, CMath::logarithmic_sum(get_p(i), estimate->get_p(i)+estimate->get_b(i,p_observations->get_feature(dim,0))+estimate->backward(0,i,dim) - dimmodprob));
-			set_q(i, CMath::logarithmic_sum(get_q(i), estimate->forward(p_observations->get_vector_length(dim)-1, i, dim)+estimate->get_q(i) - dimmodprob ));
-
-			int32_t num = trans_list_backward_cnt[i] ;
+			int32_t len=0;
+			bool free_vec;
+			uint16_t* obs=p_observations->get_feature_vector(dim, len, free_vec);
+			dim_prob[dim]=estimate->scaled_forward_backward(obs, len,
+					lin_a.vector, lin_bt.vector, lin_p.vector, lin_q.vector,
+					alpha.vector, beta.vector, scale.vector);
 
-			//estimate a
-			for (j=0; j<num; j++)
+			if (dim_prob[dim]>-CMath::INFTY)
 			{
-				int32_t jj = trans_list_backward[i][j] ;
-				a_sum=-CMath::INFTY;
+				//estimate initial+end state distribution numerator
+				const float64_t* last=&alpha[(len-1)*N];
+				for (int32_t k=0; k<N; k++)
+				{
+					p_cnt[k]+=alpha[k]*beta[k];
+					q_cnt[k]+=last[k]*lin_q[k]/scale[len];
+				}
 
-				for (t=0; t<p_observations->get_vector_length(dim)-1; t++)
+				for (int32_t t=0; t<len; t++)
 				{
-					a_sum= CMath::logarithmic_sum(a_sum, estimate->forward(t,i,dim)+
-							estimate->get_a(i,jj)+estimate->get_b(jj,p_observations->get_feature(dim,t+1))+estimate->backward(t+1,jj,dim));
+					const float64_t* alpha_t=&alpha[t*N];
+					const float64_t* beta_t=&beta[t*N];
+
+					//estimate b
+					float64_t* b_o=&b_cnt[obs[t]];
+					for (int32_t k=0; k<N; k++)
+						b_o[k*M]+=alpha_t[k]*beta_t[k];
+
+					if (t==len-1)
+						continue;
+
+					//estimate a
+					const float64_t* beta_next=&beta[(t+1)*N];
+					const float64_t* b_next=&lin_bt[obs[t+1]*N];
+					for (int32_t l=0; l<N; l++)
+					{
+						float64_t w=b_next[l]*beta_next[l]/scale[t+1];
+						if (w==0)
+							continue;
+
+						const float64_t* a_l=&lin_a[l*N];
+						float64_t* a_cnt_l=&a_cnt[l*N];
+						for (int32_t k=0; k<N; k++)
+							a_cnt_l[k]+=alpha_t[k]*a_l[k]*w;
+					}
 				}
-				set_a(i,jj, CMath::logarithmic_sum(get_a(i,jj), a_sum-dimmodprob));
 			}
+			p_observations->free_feature_vector(obs, dim, free_vec);
+		}
+	}
 
-			//estimate b
-			for (j=0; j<M; j++)
-			{
-				b_sum=-CMath::INFTY;
+	for (int32_t dim=0; dim<num_dims; dim++)
+		fullmodprob+=dim_prob[dim];
 
-				for (t=0; t<p_observations->get_vector_length(dim); t++)
-				{
-					if (p_observations->get_feature(dim,t)==j)
-						b_sum=CMath::logarithmic_sum(b_sum, estimate->forward(t,i,dim)+estimate->backward(t, i, dim));
-				}
+	for (int32_t block=1; block<num_blocks; block++)
+	{
+		for (int32_t k=0; k<num_counts; k++)
+			counts(k, 0)+=counts(k, block);
+	}
 
-				set_b(i,j, CMath::logarithmic_sum(get_b(i,j), b_sum-dimmodprob));
-			}
+	const float64_t* p_cnt=counts.get_column_vector(0);
+	const float64_t* q_cnt=p_cnt+N;
+	const float64_t* a_cnt=q_cnt+N;
+	const float64_t* b_cnt=a_cnt+N*N;
+
+	for (i=0; i<N; i++)
+	{
+		if (p_cnt[i]>0)
+			set_p(i, CMath::logarithmic_sum(get_p(i), log(p_cnt[i])));
+		if (q_cnt[i]>0)
+			set_q(i, CMath::logarithmic_sum(get_q(i), log(q_cnt[i])));
+
+		int32_t num = trans_list_backward_cnt[i] ;
+		for (j=0; j<num; j++)
+		{
+			int32_t jj = trans_list_backward[i][j] ;
+			if (a_cnt[i+jj*N]>0)
+				set_a(i,jj, CMath::logarithmic_sum(get_a(i,jj), log(a_cnt[i+jj*N])));
+		}
+
+		for (j=0; j<M; j++)
+		{
+			if (b_cnt[i*M+j]>0)
+				set_b(i,j, CMath::logarithmic_sum(get_b(i,j), log(b_cnt[i*M+j])));
 		}
 	}
 
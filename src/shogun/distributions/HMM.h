@@ -10,6 +10,7 @@
 
 #include <shogun/mathematics/Math.h>
 #include <shogun/lib/common.h>
+#include <shogun/lib/SGVector.h>
 #include <shogun/io/SGIO.h>
 #include <shogun/lib/config.h>
 #include <shogun/features/Features.h>
@@ -566,6 +567,45 @@ class CHMM : public CDistribution
 		/// by the model using forward algorithm.
 		float64_t model_probability_comp() ;
 
+		/** scaled forward-backward pass over one observation sequence
+		 *
+		 * Runs the recursions in matrix form on linear probabilities that
+		 * are renormalized in every step, so the inner loops are dense
+		 * products over the states. Unlike forward()/backward() no shared
+		 * caches are touched, i.e. it can be called concurrently.
+		 *
+		 * alpha[t*N+i] and beta[t*N+i] hold the scaled variables, such that
+		 * alpha*beta is the state posterior, and scale[t] the normalizers
+		 * (scale[len] the termination).
+		 *
+		 * @param obs observation sequence
+		 * @param len length of the sequence
+		 * @param lin_a transition probabilities, as transition_matrix_a
+		 * @param lin_bt observation probabilities, N per symbol
+		 * @param lin_p start state probabilities
+		 * @param lin_q end state probabilities
+		 * @param alpha forward table of len*N entries
+		 * @param beta backward table of len*N entries, NULL to skip
+		 * @param scale normalizers of len+1 entries
+		 * @return log likelihood of the sequence
+		 */
+		float64_t scaled_forward_backward(const uint16_t* obs, int32_t len,
+			const float64_t* lin_a, const float64_t* lin_bt,
+			const float64_t* lin_p, const float64_t* lin_q, float64_t* alpha,
+			float64_t* beta, float64_t* scale) const;
+
+		/** model parameters as linear probabilities for
+		 * scaled_forward_backward()
+		 *
+		 * @param lin_a transition probabilities (N*N)
+		 * @param lin_bt observation probabilities, transposed (M*N)
+		 * @param lin_p start state probabilities (N)
+		 * @param lin_q end state probabilities (N)
+		 */
+		void get_linear_model(SGVector<float64_t>& lin_a,
+			SGVector<float64_t>& lin_bt, SGVector<float64_t>& lin_p,
+			SGVector<float64_t>& lin_q) const;
+
 		/// inline proxy for model probability.
 		inline float64_t model_probability(int32_t dimension=-1)
 		{
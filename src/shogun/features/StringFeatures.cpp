@@ -100,12 +100,21 @@ template<class ST> CStringFeatures<ST>::CStringFeatures(const CStringFeatures &
 
 		for (int32_t i=0; i<num_vectors; i++)
 		{
-			features[i].string=SG_MALLOC(ST, orig.features[i].slen);
 			features[i].slen=orig.features[i].slen;
+			// packed symbols are shared, they are never modified in-place
+			if (orig.is_dna_packed())
+			{
+				features[i].string=NULL;
+				continue;
+			}
+			features[i].string=SG_MALLOC(ST, orig.features[i].slen);
 			sg_memcpy(features[i].string, orig.features[i].string, sizeof(ST)*orig.features[i].slen);
 		}
 	}
 
+	packed_dna=orig.packed_dna;
+	packed_offsets=orig.packed_offsets;
+
 	if (orig.symbol_mask_table)
 	{
 		symbol_mask_table=SG_MALLOC(ST, 256);
@@ -168,6 +177,8 @@ template<class ST> void CStringFeatures<ST>::cleanup()
 	SG_FREE(symbol_mask_table);
 	features=NULL;
 	symbol_mask_table=NULL;
+	packed_dna=SGVector<uint64_t>();
+	packed_offsets=SGVector<int64_t>();
 
 	/* start with a fresh alphabet, but instead of emptying the histogram
 	 * create a new object (to leave the alphabet object alone if it is used
@@ -261,6 +272,7 @@ template<class ST> void CStringFeatures<ST>::set_feature_vector(SGVector<ST> vec
 	if (vector.vlen<=0)
 		SG_ERROR("String has zero or negative length\n")
 
+	unpack_dna();
 	cleanup_feature_vector(num);
 	features[num].slen=vector.vlen;
 	features[num].string=SG_MALLOC(ST, vector.vlen);
@@ -287,7 +299,7 @@ template<class ST> ST* CStringFeatures<ST>::get_feature_vector(int32_t num, int3
 
 	int32_t real_num=m_subset_stack->subset_idx_conversion(num);
 
-	if (!preprocess_on_get)
+	if (!preprocess_on_get && !is_dna_packed())
 	{
 		dofree=false;
 		len=features[real_num].slen;
@@ -299,7 +311,7 @@ template<class ST> ST* CStringFeatures<ST>::get_feature_vector(int32_t num, int3
 		ST* feat=compute_feature_vector(num, len);
 		dofree=true;
 
-		if (get_num_preprocessors())
+		if (preprocess_on_get && get_num_preprocessors())
 		{
 			ST* tmp_feat_before=feat;
 
@@ -412,6 +424,9 @@ template<class ST> int32_t CStringFeatures<ST>::get_vector_length(int32_t vec_nu
 {
 	ASSERT(vec_num<get_num_vectors())
 
+	if (is_dna_packed() && !preprocess_on_get)
+		return features[m_subset_stack->subset_idx_conversion(vec_num)].slen;
+
 	int32_t len;
 	bool free_vec;
 	ST* vec=get_feature_vector(vec_num, len, free_vec);
@@ -951,6 +966,7 @@ template<class ST> bool CStringFeatures<ST>::append_features(CStringFeatures<ST>
 	if (m_subset_stack->has_subsets())
 		SG_ERROR("Cannot call set_features() with subset.\n")
 
+	sf->unpack_dna();
 	SGString<ST>* new_features=SG_MALLOC(SGString<ST>, sf->get_num_vectors());
 
 	index_t sf_num_str=sf->get_num_vectors();
@@ -974,6 +990,8 @@ template<class ST> bool CStringFeatures<ST>::append_features(SGString<ST>* p_fea
 	if (!features)
 		return set_features(p_features, p_num_vectors, p_max_string_length);
 
+	unpack_dna();
+
 	CAlphabet* alpha=new CAlphabet(alphabet->get_alphabet());
 
 	//compute histogram for char/byte
@@ -1032,6 +1050,8 @@ template<class ST> SGString<ST>* CStringFeatures<ST>::get_features(int32_t& num_
 	if (m_subset_stack->has_subsets())
 		SG_ERROR("get features() is not possible on subset")
 
+	unpack_dna();
+
 	num_str=num_vectors;
 	max_str_len=max_string_length;
 	return features;
@@ -1226,6 +1246,9 @@ template<class ST> bool CStringFeatures<ST>::apply_preprocessor(bool force_prepr
 {
 	SG_DEBUG("force: %d\n", force_preprocessing)
 
+	// preprocessors work in-place on the strings
+	unpack_dna();
+
 	for (int32_t i=0; i<get_num_preprocessors(); i++)
 	{
 		if ( (!is_preprocessed(i) || force_preprocessing) )
@@ -1253,6 +1276,7 @@ template<class ST> int32_t CStringFeatures<ST>::obtain_by_sliding_window(int32_t
 
 	ASSERT(step_size>0)
 	ASSERT(window_size>0)
+	unpack_dna();
 	ASSERT(num_vectors==1 || single_string)
 	ASSERT(max_string_length>=window_size ||
 			(single_string && length_of_single_string>=window_size));
@@ -1291,6 +1315,7 @@ template<class ST> int32_t CStringFeatures<ST>::obtain_by_position_list(int32_t
 
 	ASSERT(positions)
 	ASSERT(window_size>0)
+	unpack_dna();
 	ASSERT(num_vectors==1 || single_string)
 	ASSERT(max_string_length>=window_size ||
 			(single_string && length_of_single_string>=window_size));
@@ -1372,6 +1397,7 @@ template<class ST> void CStringFeatures<ST>::embed_features(int32_t p_order)
 
 	ASSERT(alphabet->get_num_symbols_in_histogram() > 0)
 
+	unpack_dna();
 	order=p_order;
 	original_num_symbols=alphabet->get_num_symbols();
 	int32_t max_val=alphabet->get_num_bits();
@@ -1502,6 +1528,7 @@ template<class ST> void CStringFeatures<ST>::set_feature_vector(int32_t num, ST*
 	ASSERT(features)
 	ASSERT(num<get_num_vectors())
 
+	unpack_dna();
 	int32_t real_num=m_subset_stack->subset_idx_conversion(num);
 
 
@@ -1670,8 +1697,13 @@ template<class ST> CFeatures* CStringFeatures<ST>::copy_subset(
 		/* copy string */
 		SGString<ST> current_string=features[real_idx];
 		SGString<ST> string_copy(current_string.slen);
-		sg_memcpy(string_copy.string, current_string.string,
-			current_string.slen*sizeof(ST));
+		if (is_dna_packed())
+			decode_packed_string(real_idx, string_copy.string);
+		else
+		{
+			sg_memcpy(string_copy.string, current_string.string,
+				current_string.slen*sizeof(ST));
+		}
 		list_copy.strings[i]=string_copy;
 	}
 
@@ -1707,10 +1739,143 @@ template<class ST> ST* CStringFeatures<ST>::compute_feature_vector(int32_t num,
 		return NULL;
 
 	ST* target=SG_MALLOC(ST, len);
-	sg_memcpy(target, features[real_num].string, len*sizeof(ST));
+	if (is_dna_packed())
+		decode_packed_string(real_num, target);
+	else
+		sg_memcpy(target, features[real_num].string, len*sizeof(ST));
 	return target;
 }
 
+template<class ST> bool CStringFeatures<ST>::pack_dna()
+{
+	if (is_dna_packed())
+		return true;
+
+	ASSERT(alphabet)
+	if (alphabet->get_alphabet()!=DNA && alphabet->get_alphabet()!=RNA)
+	{
+		SG_WARNING("Only strings of a DNA or RNA alphabet can be packed\n")
+		return false;
+	}
+
+	if (!features || single_string)
+		return false;
+
+	packed_offsets=SGVector<int64_t>(num_vectors+1);
+	packed_offsets[0]=0;
+	for (int32_t i=0; i<num_vectors; i++)
+		packed_offsets[i+1]=packed_offsets[i]+features[i].slen;
+
+	packed_dna=SGVector<uint64_t>(packed_offsets[num_vectors]/32+1);
+	packed_dna.zero();
+
+	for (int32_t i=0; i<num_vectors; i++)
+	{
+		int64_t offs=packed_offsets[i];
+		for (int32_t j=0; j<features[i].slen; j++, offs++)
+		{
+			uint64_t sym=alphabet->remap_to_bin((uint8_t) features[i].string[j]) & 3;
+			packed_dna[offs/32]|=sym << (62-2*(offs%32));
+		}
+
+		SG_FREE(features[i].string);
+		features[i].string=NULL;
+	}
+
+	return true;
+}
+
+template<class ST> void CStringFeatures<ST>::unpack_dna()
+{
+	if (!is_dna_packed())
+		return;
+
+	for (int32_t i=0; i<num_vectors; i++)
+	{
+		SG_FREE(features[i].string);
+		features[i].string=SG_MALLOC(ST, features[i].slen);
+		decode_packed_string(i, features[i].string);
+	}
+
+	packed_dna=SGVector<uint64_t>();
+	packed_offsets=SGVector<int64_t>();
+}
+
+template<class ST> void CStringFeatures<ST>::restore_packed_strings()
+{
+	REQUIRE(packed_offsets.vlen==num_vectors+1,
+		"Number of packed offsets (%d) does not match the number of strings (%d)\n",
+		packed_offsets.vlen, num_vectors)
+
+	for (int32_t i=0; i<num_vectors; i++)
+	{
+		SG_FREE(features[i].string);
+		features[i].string=NULL;
+		features[i].slen=packed_offsets[i+1]-packed_offsets[i];
+	}
+}
+
+template<class ST> CSGObject* CStringFeatures<ST>::clone()
+{
+	CStringFeatures<ST>* cloned=(CStringFeatures<ST>*) CSGObject::clone();
+
+	// the generic clone allocates a buffer for every packed string
+	if (cloned && cloned->is_dna_packed())
+		cloned->restore_packed_strings();
+
+	return cloned;
+}
+
+template<class ST> void CStringFeatures<ST>::load_serializable_post() throw (ShogunException)
+{
+	CFeatures::load_serializable_post();
+
+	// packed strings are saved without symbols, i.e. with zero length
+	if (is_dna_packed())
+		restore_packed_strings();
+}
+
+template<class ST> void CStringFeatures<ST>::decode_packed_string(int32_t real_num, ST* target) const
+{
+	const uint64_t* words=packed_dna.vector;
+	int64_t offs=packed_offsets[real_num];
+	int32_t len=features[real_num].slen;
+
+	for (int32_t j=0; j<len; j++, offs++)
+		target[j]=(ST) alphabet->remap_to_char((words[offs/32] >> (62-2*(offs%32))) & 3);
+}
+
+template<class ST> void CStringFeatures<ST>::get_packed_kmers(int32_t num, int32_t p_order, uint64_t* kmers) const
+{
+	REQUIRE(is_dna_packed(), "Strings are not packed\n")
+	REQUIRE(p_order>0 && p_order<=32, "Order must be within 1..32 (got %d)\n", p_order)
+	ASSERT(num<get_num_vectors())
+
+	int32_t real_num=m_subset_stack->subset_idx_conversion(num);
+	const uint64_t* words=packed_dna.vector;
+	int64_t offs=packed_offsets[real_num];
+	int32_t len=features[real_num].slen;
+	uint64_t mask=(p_order==32) ? ~((uint64_t) 0) : (((uint64_t) 1) << (2*p_order))-1;
+
+	uint64_t kmer=0;
+	int32_t j=0;
+	while (j<len)
+	{
+		// consume the symbols of one word, first symbol in the top bits
+		int32_t shift=(int32_t) (offs%32);
+		uint64_t w=words[offs/32] << (2*shift);
+		int32_t n=CMath::min(32-shift, len-j);
+
+		for (int32_t k=0; k<n; k++, j++)
+		{
+			kmer=((kmer << 2) | (w >> 62)) & mask;
+			w<<=2;
+			kmers[j]=kmer;
+		}
+		offs+=n;
+	}
+}
+
 template<class ST> void CStringFeatures<ST>::init()
 {
 	set_generic<ST>();
@@ -1759,6 +1924,11 @@ template<class ST> void CStringFeatures<ST>::init()
 
 	m_parameters->add_vector(&symbol_mask_table, &symbol_mask_table_len, "mask_table", "Symbol mask table - using in higher order mapping");
 	watch_param("mask_table", &symbol_mask_table, &symbol_mask_table_len);
+
+	SG_ADD(&packed_dna, "packed_dna", "2-bit packed DNA symbols.",
+		MS_NOT_AVAILABLE);
+	SG_ADD(&packed_offsets, "packed_offsets",
+		"Offsets of the strings in the packed DNA symbols.", MS_NOT_AVAILABLE);
 }
 
 /** get feature type the char feature can deal with
@@ -2011,6 +2181,7 @@ template<> void CStringFeatures<sg_type>::save(CFile* writer)		\
 {																			\
 	if (m_subset_stack->has_subsets())															\
 		SG_ERROR("save() is not possible on subset")						\
+	unpack_dna();															\
 	SG_SET_LOCALE_C;													\
 	ASSERT(writer)															\
 	writer->f_write(features, num_vectors);									\
@@ -2053,8 +2224,25 @@ bool CStringFeatures<ST>::obtain_from_char_features(CStringFeatures<CT>* sf, int
 	SG_DEBUG("%1.0llf symbols in StringFeatures<*> %d symbols in histogram\n", sf->get_num_symbols(),
 			alpha->get_num_symbols_in_histogram());
 
+	// packed DNA: k-mers are rolled directly over the 2-bit stream
+	bool from_packed=sf->is_dna_packed() && alpha->get_num_bits()==2 &&
+		gap==0 && !rev && p_order<=32;
+	uint64_t* kmers=from_packed ? SG_MALLOC(uint64_t, sf->get_max_vector_length()) : NULL;
+
 	for (int32_t i=0; i<num_vectors; i++)
 	{
+		if (from_packed)
+		{
+			int32_t len=sf->get_vector_length(i);
+			sf->get_packed_kmers(i, p_order, kmers);
+
+			features[i].slen=CMath::max(len-start, 0);
+			features[i].string=SG_MALLOC(ST, features[i].slen);
+			for (int32_t j=0; j<features[i].slen; j++)
+				features[i].string[j]=(ST) kmers[j+start];
+			continue;
+		}
+
 		int32_t len=-1;
 		bool vfree;
 		CT* c=sf->get_feature_vector(i, len, vfree);
@@ -2067,6 +2255,7 @@ bool CStringFeatures<ST>::obtain_from_char_features(CStringFeatures<CT>* sf, int
 		for (int32_t j=0; j<len; j++)
 			str[j]=(ST) alpha->remap_to_bin(c[j]);
 	}
+	SG_FREE(kmers);
 
 	original_num_symbols=alpha->get_num_symbols();
 	int32_t max_val=alpha->get_num_bits();
@@ -2086,7 +2275,7 @@ bool CStringFeatures<ST>::obtain_from_char_features(CStringFeatures<CT>* sf, int
 	}
 
 	SG_DEBUG("translate: start=%i order=%i gap=%i(size:%i)\n", start, p_order, gap, sizeof(ST))
-	for (int32_t line=0; line<num_vectors; line++)
+	for (int32_t line=0; line<num_vectors && !from_packed; line++)
 	{
 		int32_t len=0;
 		bool vfree;
@@ -564,6 +564,45 @@ template <class ST> class CStringFeatures : public CFeatures
 		 */
 		bool have_same_length(int32_t len=-1);
 
+		/** pack strings of a DNA or RNA alphabet into 2 bits per symbol
+		 *
+		 * All strings are stored contiguously in a single bit stream,
+		 * addressed by per string symbol offsets, which takes a quarter of
+		 * the memory of one byte per symbol. Vectors are decoded on access
+		 * (free_feature_vector has to be called as usual) and symbols
+		 * are decoded to upper case. Operations that work on the raw
+		 * strings unpack them first. obtain_from_char() extracts k-mers
+		 * directly from the packed stream.
+		 *
+		 * possible with subset
+		 *
+		 * @return if strings are packed
+		 */
+		bool pack_dna();
+
+		/** restore one symbol per element strings after pack_dna() */
+		void unpack_dna();
+
+		/** check whether strings are stored 2-bit packed
+		 *
+		 * @return if strings are packed
+		 */
+		inline bool is_dna_packed() const { return packed_offsets.vlen>0; }
+
+		/** compute all k-mers of a packed string
+		 *
+		 * kmers[i] is the k-mer ending at position i with its first symbol
+		 * in the most significant bits and positions before the string
+		 * start zero padded, as in CAlphabet::translate_from_single_order().
+		 *
+		 * possible with subset
+		 *
+		 * @param num index of the string
+		 * @param p_order k-mer length (at most 32)
+		 * @param kmers buffer of get_vector_length(num) k-mers to write to
+		 */
+		void get_packed_kmers(int32_t num, int32_t p_order, uint64_t* kmers) const;
+
 		/** embed string features in bit representation in-place
 		 *
 		 * not implemented for subset
@@ -649,6 +688,23 @@ template <class ST> class CStringFeatures : public CFeatures
 		/** post method when subset is changed */
 		virtual void subset_changed_post();
 
+		/** Creates a clone of the current object, packed strings are
+		 * cloned as packed strings.
+		 *
+		 * @return an identical copy of the given object
+		 */
+		virtual CSGObject* clone();
+
+		/** Can (optionally) be overridden to post-initialize some
+		 *  member variables which are not PARAMETER::ADD'ed.  Make
+		 *  sure that at first the overridden method
+		 *  BASE_CLASS::LOAD_SERIALIZABLE_POST is called.
+		 *
+		 *  @exception ShogunException Will be thrown if an error
+		 *                             occurres.
+		 */
+		virtual void load_serializable_post() throw (ShogunException);
+
 	protected:
 		/** compute feature vector for sample num
 		 * if target is set the vector is written to target
@@ -662,6 +718,19 @@ template <class ST> class CStringFeatures : public CFeatures
 		 */
 		virtual ST* compute_feature_vector(int32_t num, int32_t& len);
 
+		/** decode a packed string
+		 *
+		 * @param real_num index of the string (ignoring subsets)
+		 * @param target buffer of the string's length to decode into
+		 */
+		void decode_packed_string(int32_t real_num, ST* target) const;
+
+		/** drop the string buffers of packed strings and restore their
+		 * lengths from the packed offsets, for strings that were cloned
+		 * or loaded without their symbols
+		 */
+		void restore_packed_strings();
+
 	private:
 		void init();
 
@@ -704,6 +773,13 @@ template <class ST> class CStringFeatures : public CFeatures
 
 		/** feature cache */
 		CCache<ST>* feature_cache;
+
+		/** 2-bit packed symbols of all strings, 32 per word, first symbol
+		 * in the most significant bits */
+		SGVector<uint64_t> packed_dna;
+
+		/** symbol offset of each string in packed_dna (empty if unpacked) */
+		SGVector<int64_t> packed_offsets;
 };
 }
 #endif // _CSTRINGFEATURES__H__
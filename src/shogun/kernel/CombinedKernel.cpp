@@ -16,6 +16,7 @@
 #include <shogun/kernel/CustomKernel.h>
 #include <shogun/features/CombinedFeatures.h>
 #include <string.h>
+#include <vector>
 #include <shogun/mathematics/Math.h>
 #include <shogun/mathematics/eigen3.h>
 
@@ -177,6 +178,7 @@ bool CCombinedKernel::init_with_extracted_subsets(
 
 	init_normalizer();
 	initialized = true;
+	update_subkernel_cache();
 	return true;
 }
 
@@ -259,6 +261,7 @@ bool CCombinedKernel::init(CFeatures* l, CFeatures* r)
 void CCombinedKernel::remove_lhs()
 {
 	delete_optimization();
+	clear_subkernel_cache();
 
 	for (index_t k_idx=0; k_idx<get_num_kernels(); k_idx++)
 	{
@@ -276,6 +279,7 @@ void CCombinedKernel::remove_lhs()
 void CCombinedKernel::remove_rhs()
 {
 	delete_optimization();
+	clear_subkernel_cache();
 
 	for (index_t k_idx=0; k_idx<get_num_kernels(); k_idx++)
 	{
@@ -293,6 +297,7 @@ void CCombinedKernel::remove_rhs()
 void CCombinedKernel::remove_lhs_and_rhs()
 {
 	delete_optimization();
+	clear_subkernel_cache();
 
 	for (index_t k_idx=0; k_idx<get_num_kernels(); k_idx++)
 	{
@@ -319,6 +324,7 @@ void CCombinedKernel::cleanup()
 	}
 
 	delete_optimization();
+	clear_subkernel_cache();
 
 	CKernel::cleanup();
 
@@ -342,18 +348,85 @@ void CCombinedKernel::list_kernels()
 
 float64_t CCombinedKernel::compute(int32_t x, int32_t y)
 {
+	// called for every kernel entry, so the subkernels are borrowed from the
+	// array rather than referenced and released one by one
+	CSGObject** kernels=kernel_array->get_array();
+	const int32_t num_kernels=get_num_kernels();
+
 	float64_t result=0;
-	for (index_t k_idx=0; k_idx<get_num_kernels(); k_idx++)
+	for (index_t k_idx=0; k_idx<num_kernels; k_idx++)
 	{
-		CKernel* k = get_kernel(k_idx);
-		if (k->get_combined_kernel_weight()!=0)
-			result += k->get_combined_kernel_weight() * k->kernel(x,y);
-		SG_UNREF(k);
+		CKernel* k=(CKernel*) kernels[k_idx];
+		const float64_t weight=k->get_combined_kernel_weight();
+		if (weight!=0)
+			result += weight * compute_subkernel(k_idx, k, x, y);
 	}
 
 	return result;
 }
 
+void CCombinedKernel::set_subkernel_cache_size(int32_t size)
+{
+	REQUIRE(size>=0, "Subkernel cache size (%d) must not be negative\n", size)
+
+	subkernel_cache_size=size;
+	if (initialized)
+		update_subkernel_cache();
+	else
+		clear_subkernel_cache();
+}
+
+void CCombinedKernel::clear_subkernel_cache()
+{
+	subkernel_cache.clear();
+}
+
+void CCombinedKernel::update_subkernel_cache()
+{
+	clear_subkernel_cache();
+
+	if (subkernel_cache_size<=0 || num_lhs<=0 || num_rhs<=0)
+		return;
+
+	CSGObject** kernels=kernel_array->get_array();
+	const int32_t num_kernels=get_num_kernels();
+
+	// hand out the budget in list order before computing anything, so which
+	// subkernels end up cached does not depend on the thread schedule
+	int64_t budget=int64_t(subkernel_cache_size)*1024*1024;
+	const int64_t matrix_size=int64_t(num_lhs)*num_rhs*sizeof(float64_t);
+	std::vector<int32_t> cached;
+
+	for (index_t k_idx=0; k_idx<num_kernels && budget>=matrix_size; k_idx++)
+	{
+		CKernel* k=(CKernel*) kernels[k_idx];
+		if (k->get_kernel_type()==K_CUSTOM || !k->has_features())
+			continue;
+		if (append_subkernel_weights && k->get_num_subkernels()>1)
+			continue;
+
+		cached.push_back(k_idx);
+		budget-=matrix_size;
+	}
+
+	if (cached.empty())
+		return;
+
+	SG_DEBUG("caching %d of %d subkernel matrices of size %dx%d\n",
+		int32_t(cached.size()), num_kernels, num_lhs, num_rhs)
+
+	subkernel_cache.resize(num_kernels);
+
+	// the subkernels are independent, so compute their matrices in parallel
+	// (each one then runs single threaded inside the nested region)
+#pragma omp parallel for schedule(dynamic)
+	for (index_t i=0; i<index_t(cached.size()); i++)
+	{
+		CKernel* k=(CKernel*) kernels[cached[i]];
+		subkernel_cache[cached[i]]=k->get_kernel_matrix();
+	}
+}
+
 bool CCombinedKernel::init_optimization(
 	int32_t count, int32_t *IDX, float64_t *weights)
 {
@@ -506,11 +579,14 @@ float64_t CCombinedKernel::compute_optimized(int32_t idx)
 		return 0;
 	}
 
+	CSGObject** kernels=kernel_array->get_array();
+	const int32_t num_kernels=get_num_kernels();
+
 	float64_t result=0;
 
-	for (index_t k_idx=0; k_idx<get_num_kernels(); k_idx++)
+	for (index_t k_idx=0; k_idx<num_kernels; k_idx++)
 	{
-		CKernel* k = get_kernel(k_idx);
+		CKernel* k=(CKernel*) kernels[k_idx];
 		if (k->has_property(KP_LINADD) &&
 			k->get_is_initialized())
 		{
@@ -529,13 +605,11 @@ float64_t CCombinedKernel::compute_optimized(int32_t idx)
 			{ // compute the usual way for any non-optimized kernel
 				float64_t sub_result=0;
 				for (int32_t j=0; j<sv_count; j++)
-					sub_result += sv_weight[j] * k->kernel(sv_idx[j], idx);
+					sub_result += sv_weight[j] * compute_subkernel(k_idx, k, sv_idx[j], idx);
 
 				result += k->get_combined_kernel_weight()*sub_result;
 			}
 		}
-
-		SG_UNREF(k);
 	}
 
 	return result;
@@ -566,12 +640,17 @@ void CCombinedKernel::clear_normal()
 void CCombinedKernel::compute_by_subkernel(
 	int32_t idx, float64_t * subkernel_contrib)
 {
+	// called for every training vector in each MKL iteration, borrow the
+	// subkernels instead of referencing them
+	CSGObject** kernels=kernel_array->get_array();
+	const int32_t num_kernels=get_num_kernels();
+
 	if (append_subkernel_weights)
 	{
 		int32_t i=0 ;
-		for (index_t k_idx=0; k_idx<get_num_kernels(); k_idx++)
+		for (index_t k_idx=0; k_idx<num_kernels; k_idx++)
 		{
-			CKernel* k = get_kernel(k_idx);
+			CKernel* k=(CKernel*) kernels[k_idx];
 			int32_t num = -1 ;
 			k->get_subkernel_weights(num);
 			if (num>1)
@@ -579,20 +658,18 @@ void CCombinedKernel::compute_by_subkernel(
 			else
 				subkernel_contrib[i] += k->get_combined_kernel_weight() * k->compute_optimized(idx) ;
 
-			SG_UNREF(k);
 			i += num ;
 		}
 	}
 	else
 	{
 		int32_t i=0 ;
-		for (index_t k_idx=0; k_idx<get_num_kernels(); k_idx++)
+		for (index_t k_idx=0; k_idx<num_kernels; k_idx++)
 		{
-			CKernel* k = get_kernel(k_idx);
+			CKernel* k=(CKernel*) kernels[k_idx];
 			if (k->get_combined_kernel_weight()!=0)
 				subkernel_contrib[i] += k->get_combined_kernel_weight() * k->compute_optimized(idx) ;
 
-			SG_UNREF(k);
 			i++ ;
 		}
 	}
@@ -723,6 +800,7 @@ bool CCombinedKernel::precompute_subkernels()
 	SG_UNREF(kernel_array);
 	kernel_array=new_kernel_array;
 	SG_REF(kernel_array);
+	clear_subkernel_cache();
 
 	return true;
 }
@@ -766,6 +844,10 @@ void CCombinedKernel::init()
 	weight_update = false;
 	SG_ADD(&weight_update, "weight_update",
 	    "weight update", MS_NOT_AVAILABLE);
+
+	subkernel_cache_size=0;
+	SG_ADD(&subkernel_cache_size, "subkernel_cache_size",
+	    "Memory budget in MB for caching subkernel matrices.", MS_NOT_AVAILABLE);
 }
 
 void CCombinedKernel::enable_subkernel_weight_learning()
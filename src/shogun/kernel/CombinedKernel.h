@@ -19,6 +19,8 @@
 #include <shogun/features/Features.h>
 #include <shogun/features/CombinedFeatures.h>
 
+#include <vector>
+
 namespace shogun
 {
 class CFeatures;
@@ -154,6 +156,7 @@ class CCombinedKernel : public CKernel
 		{
 			ASSERT(k)
 			adjust_num_lhs_rhs_initialized(k);
+			clear_subkernel_cache();
 
 			if (!(k->has_property(KP_LINADD)))
 				unset_property(KP_LINADD);
@@ -174,17 +177,16 @@ class CCombinedKernel : public CKernel
 			if (!kernel_array || !kernel_array->get_num_elements())
 				return false;
 
-			bool all_linadd = true;
+			// queried once per vector during prediction, so borrow the
+			// subkernels instead of referencing each of them
+			CSGObject** kernels = kernel_array->get_array();
 			for (auto i : range(kernel_array->get_num_elements()))
 			{
-				auto cur = kernel_array->get_element(i);
-				all_linadd &= ((CKernel*)cur)->has_property(p);
-				SG_UNREF(cur);
-				if (!all_linadd)
-					break;
+				if (!((CKernel*)kernels[i])->has_property(p))
+					return false;
 			}
 
-			return all_linadd;
+			return true;
 		}
 
 		/** append kernel to the end of the array
@@ -196,6 +198,7 @@ class CCombinedKernel : public CKernel
 		{
 			ASSERT(k)
 			adjust_num_lhs_rhs_initialized(k);
+			clear_subkernel_cache();
 
 			if (!(k->has_property(KP_LINADD)))
 				unset_property(KP_LINADD);
@@ -218,6 +221,7 @@ class CCombinedKernel : public CKernel
 		inline bool delete_kernel(int32_t idx)
 		{
 			bool succesful_deletion = kernel_array->delete_element(idx);
+			clear_subkernel_cache();
 
 			if (get_num_kernels()==0)
 			{
@@ -250,12 +254,10 @@ class CCombinedKernel : public CKernel
 			{
 				int32_t num_subkernels = 0;
 
+				CSGObject** kernels = kernel_array->get_array();
 				for (index_t k_idx=0; k_idx<get_num_kernels(); k_idx++)
-				{
-					CKernel* k = get_kernel(k_idx);
-					num_subkernels += k->get_num_subkernels();
-					SG_UNREF(k);
-				}
+					num_subkernels += ((CKernel*)kernels[k_idx])->get_num_subkernels();
+
 				return num_subkernels;
 			}
 			else
@@ -386,6 +388,33 @@ class CCombinedKernel : public CKernel
 		/** precompute all sub-kernels */
 		bool precompute_subkernels();
 
+		/** set the memory budget for caching subkernel matrices
+		 *
+		 * If non-zero, init() computes the kernel matrices of as many
+		 * subkernels as fit into the budget (in parallel over subkernels) and
+		 * compute() looks their entries up instead of evaluating the
+		 * subkernels. This pays off when entries are requested repeatedly,
+		 * as during MKL training. Custom kernels and kernels with own
+		 * subkernel weights in append mode are never cached. The cache is
+		 * only rebuilt by init(), so re-init after changing parameters of a
+		 * subkernel.
+		 *
+		 * @param size budget in MB, 0 disables caching
+		 */
+		void set_subkernel_cache_size(int32_t size);
+
+		/** get the memory budget for caching subkernel matrices
+		 *
+		 * @return budget in MB
+		 */
+		inline int32_t get_subkernel_cache_size()
+		{
+			return subkernel_cache_size;
+		}
+
+		/** drop all cached subkernel matrices */
+		void clear_subkernel_cache();
+
 		/** Returns a  casted version of the given kernel. Throws an error
 		 * if parameter is not of class CombinedKernel. SG_REF's the returned
 		 * kernel
@@ -441,6 +470,28 @@ class CCombinedKernel : public CKernel
 		 */
 		virtual float64_t compute(int32_t x, int32_t y);
 
+		/** compute the kernel matrices of the subkernels that fit into the
+		 * subkernel cache budget */
+		void update_subkernel_cache();
+
+		/** evaluate subkernel k_idx, from the cache if available
+		 *
+		 * @param k_idx index of the subkernel
+		 * @param k the subkernel
+		 * @param x x
+		 * @param y y
+		 * @return kernel value of the subkernel
+		 */
+		inline float64_t compute_subkernel(
+			int32_t k_idx, CKernel* k, int32_t x, int32_t y)
+		{
+			if (k_idx<(int32_t) subkernel_cache.size() &&
+				subkernel_cache[k_idx].matrix)
+				return subkernel_cache[k_idx](x,y);
+
+			return k->kernel(x,y);
+		}
+
 		/** adjust the variables num_lhs, num_rhs and initialized
 		 * based on the kernel to be appended/inserted
 		 *
@@ -526,6 +577,11 @@ class CCombinedKernel : public CKernel
 		bool enable_subkernel_weight_opt;
 		/** update the weight for subkernels */
 		bool weight_update;
+
+		/** memory budget in MB for caching subkernel matrices */
+		int32_t subkernel_cache_size;
+		/** cached subkernel matrices, empty if a subkernel is not cached */
+		std::vector<SGMatrix<float64_t> > subkernel_cache;
 };
 }
 #endif /* _COMBINEDKERNEL_H__ */
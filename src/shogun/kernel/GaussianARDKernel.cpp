@@ -299,3 +299,69 @@ SGMatrix<float64_t> CGaussianARDKernel::get_parameter_gradient(
 		return SGMatrix<float64_t>();
 	}
 }
+
+SGVector<float64_t> CGaussianARDKernel::get_parameter_gradient_trace_product(
+		const TParameter* param, SGMatrix<float64_t> weights)
+{
+	REQUIRE(param, "Param not set\n");
+	REQUIRE(lhs , "Left features not set!\n");
+	REQUIRE(rhs, "Right features not set!\n");
+
+	if (strcmp(param->m_name, "log_weights") || m_ARD_type==KT_FULL)
+		return CExponentialARDKernel::get_parameter_gradient_trace_product(param, weights);
+
+	REQUIRE(weights.num_rows==num_lhs && weights.num_cols==num_rhs,
+		"Weights (%dx%d) must match the kernel matrix (%dx%d)\n",
+		weights.num_rows, weights.num_cols, num_lhs, num_rhs);
+
+	if (m_ARD_type==KT_SCALAR)
+	{
+		SGVector<float64_t> result(1);
+		float64_t sum=0.0;
+		for (index_t j=0; j<num_lhs; j++)
+		{
+			for (index_t k=0; k<num_rhs; k++)
+			{
+				float64_t dist=distance(j,k);
+				sum+=weights(j,k)*std::exp(-dist)*(-dist*2.0);
+			}
+		}
+		result[0]=sum;
+		return result;
+	}
+
+	// d(K_jk)/d(log_weights[d])=-K_jk*(a_d-b_d)^2*exp(2*log_weights[d]), so a
+	// single pass over the pairs accumulates all elements at once
+	const index_t dim=m_log_weights.vlen;
+	SGVector<float64_t> sq_weights(dim);
+	for (index_t d=0; d<dim; d++)
+		sq_weights[d]=std::exp(2.0*m_log_weights[d]);
+
+	SGVector<float64_t> result(dim);
+	result.zero();
+	SGVector<float64_t> diff(dim);
+	for (index_t j=0; j<num_lhs; j++)
+	{
+		SGVector<float64_t> avec=get_feature_vector(j, lhs);
+		REQUIRE(avec.vlen==dim, "Dimension of features (%d) must match the "
+			"number of weights (%d)\n", avec.vlen, dim);
+		for (index_t k=0; k<num_rhs; k++)
+		{
+			SGVector<float64_t> bvec=get_feature_vector(k, rhs);
+			float64_t dist=0.0;
+			for (index_t d=0; d<dim; d++)
+			{
+				diff[d]=CMath::sq(avec[d]-bvec[d]);
+				dist+=diff[d]*sq_weights[d];
+			}
+			float64_t coef=weights(j,k)*normalizer->normalize(std::exp(-0.5*dist), j, k);
+			for (index_t d=0; d<dim; d++)
+				result[d]+=coef*diff[d];
+		}
+	}
+
+	for (index_t d=0; d<dim; d++)
+		result[d]*=-sq_weights[d];
+
+	return result;
+}
@@ -142,6 +142,19 @@ public:
 	virtual SGVector<float64_t> get_parameter_gradient_diagonal(
 		const TParameter* param, index_t index=-1);
 
+	/** return the trace products of a weight matrix with the derivatives
+	 * wrt log_weights without computing the derivative matrices. For
+	 * scalar or vector weights this costs \f$O(n^2d)\f$ in total instead
+	 * of \f$O(n^2d)\f$ per weight, i.e. \f$O(n^2d^2)\f$ for all weights
+	 *
+	 * @param param the parameter
+	 * @param weights weight matrix of size num_lhs x num_rhs
+	 *
+	 * @return trace product for each element of the parameter
+	 */
+	virtual SGVector<float64_t> get_parameter_gradient_trace_product(
+		const TParameter* param, SGMatrix<float64_t> weights);
+
 protected:
 	/** helper function to compute quadratic terms in
 	 * (a-b)^2 (== a^2+b^2-2ab)
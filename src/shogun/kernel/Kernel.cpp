@@ -1307,6 +1307,35 @@ template <class T> void* CKernel::get_kernel_matrix_helper(void* p)
 	return NULL;
 }
 
+SGVector<float64_t> CKernel::get_parameter_gradient_trace_product(
+		const TParameter* param, SGMatrix<float64_t> weights)
+{
+	REQUIRE(param, "Param not set\n");
+	int64_t len=const_cast<TParameter *>(param)->m_datatype.get_num_elements();
+	SGVector<float64_t> result(len);
+
+	for (index_t i=0; i<result.vlen; i++)
+	{
+		SGMatrix<float64_t> dK;
+
+		if (result.vlen==1)
+			dK=get_parameter_gradient(param);
+		else
+			dK=get_parameter_gradient(param, i);
+
+		REQUIRE(dK.num_rows==weights.num_rows && dK.num_cols==weights.num_cols,
+			"Weights (%dx%d) must match the kernel matrix (%dx%d)\n",
+			weights.num_rows, weights.num_cols, dK.num_rows, dK.num_cols);
+
+		float64_t sum=0.0;
+		for (int64_t k=0; k<int64_t(dK.num_rows)*dK.num_cols; k++)
+			sum+=weights.matrix[k]*dK.matrix[k];
+		result[i]=sum;
+	}
+
+	return result;
+}
+
 template <class T>
 SGMatrix<T> CKernel::get_kernel_matrix()
 {
@@ -866,6 +866,24 @@ class CKernel : public CSGObject
 			return get_parameter_gradient(param,index).get_diagonal_vector();
 		}
 
+		/** return the trace products of a weight matrix with the derivatives
+		 * of the kernel matrix wrt all elements of a parameter, i.e.
+		 * \f$\sum_{jk}W_{jk}\frac{\partial K_{jk}}{\partial \theta_i}\f$
+		 * for each element \f$\theta_i\f$, as needed by gradient-based
+		 * model selection.
+		 *
+		 * The default implementation reduces get_parameter_gradient() for
+		 * each element, kernels may override it to avoid computing the
+		 * derivative matrices.
+		 *
+		 * @param param the parameter
+		 * @param weights weight matrix of size num_lhs x num_rhs
+		 *
+		 * @return trace product for each element of the parameter
+		 */
+		virtual SGVector<float64_t> get_parameter_gradient_trace_product(
+				const TParameter* param, SGMatrix<float64_t> weights);
+
 		/** Obtains a kernel from a generic SGObject with error checking. Note
 		 * that if passing NULL, result will be NULL
 		 * @param kernel Object to cast to CKernel, is *not* SG_REFed
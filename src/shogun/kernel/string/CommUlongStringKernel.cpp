@@ -9,10 +9,15 @@
 #include <shogun/features/StringFeatures.h>
 #include <shogun/io/SGIO.h>
 #include <shogun/kernel/string/CommUlongStringKernel.h>
+#include <shogun/kernel/string/SortedIntersection.h>
 #include <shogun/lib/common.h>
 
 #include <shogun/kernel/normalizer/SqrtDiagKernelNormalizer.h>
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 using namespace shogun;
 
 CCommUlongStringKernel::CCommUlongStringKernel(int32_t size, bool us)
@@ -83,62 +88,44 @@ float64_t CCommUlongStringKernel::compute(int32_t idx_a, int32_t idx_b)
 	uint64_t* avec=((CStringFeatures<uint64_t>*) lhs)->get_feature_vector(idx_a, alen, free_avec);
 	uint64_t* bvec=((CStringFeatures<uint64_t>*) rhs)->get_feature_vector(idx_b, blen, free_bvec);
 
-	float64_t result=0;
+	float64_t result=sorted_intersection(avec, alen, bvec, blen, use_sign);
 
-	int32_t left_idx=0;
-	int32_t right_idx=0;
+	((CStringFeatures<uint64_t>*) lhs)->free_feature_vector(avec, idx_a, free_avec);
+	((CStringFeatures<uint64_t>*) rhs)->free_feature_vector(bvec, idx_b, free_bvec);
 
-	if (use_sign)
-	{
-		while (left_idx < alen && right_idx < blen)
-		{
-			if (avec[left_idx]==bvec[right_idx])
-			{
-				uint64_t sym=avec[left_idx];
+	return result;
+}
 
-				while (left_idx< alen && avec[left_idx]==sym)
-					left_idx++;
+SGVector<float64_t> CCommUlongStringKernel::get_kernel_row(int32_t idx_a)
+{
+	REQUIRE(lhs, "lhs feature vector is not set!\n")
+	REQUIRE(rhs, "rhs feature vector is not set!\n")
 
-				while (right_idx< blen && bvec[right_idx]==sym)
-					right_idx++;
+	CStringFeatures<uint64_t>* l=(CStringFeatures<uint64_t>*) lhs;
+	CStringFeatures<uint64_t>* r=(CStringFeatures<uint64_t>*) rhs;
 
-				result++;
-			}
-			else if (avec[left_idx]<bvec[right_idx])
-				left_idx++;
-			else
-				right_idx++;
-		}
-	}
-	else
-	{
-		while (left_idx < alen && right_idx < blen)
-		{
-			if (avec[left_idx]==bvec[right_idx])
-			{
-				int32_t old_left_idx=left_idx;
-				int32_t old_right_idx=right_idx;
+	int32_t alen;
+	bool free_avec;
+	uint64_t* avec=l->get_feature_vector(idx_a, alen, free_avec);
 
-				uint64_t sym=avec[left_idx];
+	SGVector<float64_t> row(num_rhs);
 
-				while (left_idx< alen && avec[left_idx]==sym)
-					left_idx++;
+#pragma omp parallel for schedule(dynamic)
+	for (int32_t idx_b=0; idx_b<num_rhs; idx_b++)
+	{
+		int32_t blen;
+		bool free_bvec;
+		uint64_t* bvec=r->get_feature_vector(idx_b, blen, free_bvec);
 
-				while (right_idx< blen && bvec[right_idx]==sym)
-					right_idx++;
+		float64_t result=sorted_intersection(avec, alen, bvec, blen, use_sign);
+		row[idx_b]=normalizer->normalize(result, idx_a, idx_b);
 
-				result+=((float64_t) (left_idx-old_left_idx)) * ((float64_t) (right_idx-old_right_idx));
-			}
-			else if (avec[left_idx]<bvec[right_idx])
-				left_idx++;
-			else
-				right_idx++;
-		}
+		r->free_feature_vector(bvec, idx_b, free_bvec);
 	}
-	((CStringFeatures<uint64_t>*) lhs)->free_feature_vector(avec, idx_a, free_avec);
-	((CStringFeatures<uint64_t>*) rhs)->free_feature_vector(bvec, idx_b, free_bvec);
 
-	return result;
+	l->free_feature_vector(avec, idx_a, free_avec);
+
+	return row;
 }
 
 void CCommUlongStringKernel::add_to_normal(int32_t vec_idx, float64_t weight)
@@ -230,11 +217,60 @@ bool CCommUlongStringKernel::init_optimization(
 
 	SG_DEBUG("initializing CCommUlongStringKernel optimization\n")
 
+	// collect the (k-mer, weight) pairs of all support vectors and merge them
+	// with a single stable sort instead of rebuilding the dictionary once per
+	// support vector, which is quadratic in the number of support vectors.
+	// Stability keeps the order in which weights of a k-mer are summed
+	// identical to calling add_to_normal() for each support vector.
+	CStringFeatures<uint64_t>* l=(CStringFeatures<uint64_t>*) lhs;
+	std::vector<std::pair<uint64_t, float64_t> > entries;
+
 	for (auto i : progress(range(0, count), *this->io))
 	{
-		add_to_normal(IDX[i], weights[i]);
+		int32_t len=-1;
+		bool free_vec;
+		uint64_t* vec=l->get_feature_vector(IDX[i], len, free_vec);
+
+		int32_t j=0;
+		while (j<len)
+		{
+			int32_t run_end=sorted_gallop(vec, len, j+1, vec[j], true);
+			float64_t weight=use_sign ? weights[i] : weights[i]*(run_end-j);
+			entries.push_back(std::make_pair(vec[j],
+				normalizer->normalize_lhs(weight, IDX[i])));
+			j=run_end;
+		}
+
+		l->free_feature_vector(vec, IDX[i], free_vec);
 	}
 
+	std::stable_sort(entries.begin(), entries.end(),
+		[](const std::pair<uint64_t, float64_t>& a,
+			const std::pair<uint64_t, float64_t>& b)
+		{
+			return a.first<b.first;
+		});
+
+	int32_t num_entries=entries.size();
+	dictionary=SGVector<uint64_t>(num_entries);
+	dictionary_weights=SGVector<float64_t>(num_entries);
+
+	int32_t t=0;
+	for (int32_t j=0; j<num_entries; j++)
+	{
+		if (t>0 && dictionary[t-1]==entries[j].first)
+			dictionary_weights[t-1]+=entries[j].second;
+		else
+		{
+			dictionary[t]=entries[j].first;
+			dictionary_weights[t]=entries[j].second;
+			t++;
+		}
+	}
+
+	dictionary.resize_vector(t);
+	dictionary_weights.resize_vector(t);
+
 	SG_DEBUG("Done.         \n")
 
 	set_is_initialized(true);
@@ -248,13 +284,12 @@ bool CCommUlongStringKernel::delete_optimization()
 	return true;
 }
 
-// binary search for each feature. trick: as features are sorted save last found idx in old_idx and
-// only search in the remainder of the dictionary
+// as both the features and the dictionary are sorted, intersect them with a
+// galloping merge: each dictionary lookup resumes from the last hit and skips
+// ahead in logarithmic time, so large (sparse) dictionaries stay cheap
 float64_t CCommUlongStringKernel::compute_optimized(int32_t i)
 {
 	float64_t result = 0;
-	int32_t j, last_j=0;
-	int32_t old_idx = 0;
 
 	if (!get_is_initialized())
 	{
@@ -262,60 +297,34 @@ float64_t CCommUlongStringKernel::compute_optimized(int32_t i)
 		return 0 ;
 	}
 
-
-
 	int32_t alen = -1;
 	bool free_avec;
 	uint64_t* avec=((CStringFeatures<uint64_t>*) rhs)->
 		get_feature_vector(i, alen, free_avec);
 
-	if (avec && alen>0)
-	{
-		if (use_sign)
-		{
-			for (j=1; j<alen; j++)
-			{
-				if (avec[j]==avec[j-1])
-					continue;
-
-				int32_t idx = CMath::binary_search_max_lower_equal(&(dictionary[old_idx]), dictionary.vlen-old_idx, avec[j-1]);
+	const uint64_t* dict=dictionary.vector;
+	int32_t dlen=dictionary.vlen;
 
-				if (idx!=-1)
-				{
-					if (dictionary[idx+old_idx] == avec[j-1])
-						result += dictionary_weights[idx+old_idx];
-
-					old_idx+=idx;
-				}
-			}
+	int32_t left_idx=0;
+	int32_t dict_idx=0;
 
-			int32_t idx = CMath::binary_search(&(dictionary[old_idx]), dictionary.vlen-old_idx, avec[alen-1]);
-			if (idx!=-1)
-				result += dictionary_weights[idx+old_idx];
-		}
+	while (left_idx<alen && dict_idx<dlen)
+	{
+		if (avec[left_idx]<dict[dict_idx])
+			left_idx=sorted_gallop(avec, alen, left_idx+1, dict[dict_idx]);
+		else if (dict[dict_idx]<avec[left_idx])
+			dict_idx=sorted_gallop(dict, dlen, dict_idx+1, avec[left_idx]);
 		else
 		{
-			for (j=1; j<alen; j++)
-			{
-				if (avec[j]==avec[j-1])
-					continue;
-
-				int32_t idx = CMath::binary_search_max_lower_equal(&(dictionary[old_idx]), dictionary.vlen-old_idx, avec[j-1]);
-
-				if (idx!=-1)
-				{
-					if (dictionary[idx+old_idx] == avec[j-1])
-						result += dictionary_weights[idx+old_idx]*(j-last_j);
-
-					old_idx+=idx;
-				}
+			int32_t left_end=sorted_gallop(avec, alen, left_idx+1, avec[left_idx], true);
 
-				last_j = j;
-			}
+			if (use_sign)
+				result += dictionary_weights[dict_idx];
+			else
+				result += dictionary_weights[dict_idx]*(left_end-left_idx);
 
-			int32_t idx = CMath::binary_search(&(dictionary[old_idx]), dictionary.vlen-old_idx, avec[alen-1]);
-			if (idx!=-1)
-				result += dictionary_weights[idx+old_idx]*(alen-last_j);
+			left_idx=left_end;
+			dict_idx++;
 		}
 	}
 
@@ -91,6 +91,14 @@ class CCommUlongStringKernel: public CStringKernel<uint64_t>
 		 */
 		virtual const char* get_name() const { return "CommUlongStringKernel"; }
 
+		/** get row idx_a of the kernel matrix, computed in parallel over
+		 * the right hand side strings
+		 *
+		 * @param idx_a index of the lhs string
+		 * @return kernel values of string idx_a against all rhs strings
+		 */
+		virtual SGVector<float64_t> get_kernel_row(int32_t idx_a);
+
 		/** initialize optimization
 		 *
 		 * @param count count
@@ -12,6 +12,7 @@
 
 #include <shogun/features/StringFeatures.h>
 #include <shogun/kernel/string/CommWordStringKernel.h>
+#include <shogun/kernel/string/SortedIntersection.h>
 
 #include <shogun/kernel/normalizer/SqrtDiagKernelNormalizer.h>
 
@@ -167,59 +168,7 @@ float64_t CCommWordStringKernel::compute_helper(
 		}
 	}
 
-	float64_t result=0;
-
-	int32_t left_idx=0;
-	int32_t right_idx=0;
-
-	if (use_sign)
-	{
-		while (left_idx < alen && right_idx < blen)
-		{
-			if (avec[left_idx]==bvec[right_idx])
-			{
-				uint16_t sym=avec[left_idx];
-
-				while (left_idx< alen && avec[left_idx]==sym)
-					left_idx++;
-
-				while (right_idx< blen && bvec[right_idx]==sym)
-					right_idx++;
-
-				result++;
-			}
-			else if (avec[left_idx]<bvec[right_idx])
-				left_idx++;
-			else
-				right_idx++;
-		}
-	}
-	else
-	{
-		while (left_idx < alen && right_idx < blen)
-		{
-			if (avec[left_idx]==bvec[right_idx])
-			{
-				int32_t old_left_idx=left_idx;
-				int32_t old_right_idx=right_idx;
-
-				uint16_t sym=avec[left_idx];
-
-				while (left_idx< alen && avec[left_idx]==sym)
-					left_idx++;
-
-				while (right_idx< blen && bvec[right_idx]==sym)
-					right_idx++;
-
-				result+=((float64_t) (left_idx-old_left_idx))*
-					((float64_t) (right_idx-old_right_idx));
-			}
-			else if (avec[left_idx]<bvec[right_idx])
-				left_idx++;
-			else
-				right_idx++;
-		}
-	}
+	float64_t result=sorted_intersection(avec, alen, bvec, blen, use_sign);
 
 	if (do_sort)
 	{
@@ -233,6 +182,30 @@ float64_t CCommWordStringKernel::compute_helper(
 	return result;
 }
 
+SGVector<float64_t> CCommWordStringKernel::get_kernel_row(int32_t idx_a)
+{
+	REQUIRE(lhs, "lhs feature vector is not set!\n")
+	REQUIRE(rhs, "rhs feature vector is not set!\n")
+
+	CStringFeatures<uint16_t>* l = (CStringFeatures<uint16_t>*) lhs;
+	CStringFeatures<uint16_t>* r = (CStringFeatures<uint16_t>*) rhs;
+
+	// check once here, compute_helper() must not raise inside the parallel loop
+	REQUIRE(l->get_num_preprocessors()==l->get_num_preprocessed() &&
+			r->get_num_preprocessors()==r->get_num_preprocessed(),
+			"not all preprocessors have been applied to training (%d/%d)"
+			" or test (%d/%d) data\n", l->get_num_preprocessed(), l->get_num_preprocessors(),
+			r->get_num_preprocessed(), r->get_num_preprocessors());
+
+	SGVector<float64_t> row(num_rhs);
+
+#pragma omp parallel for schedule(dynamic)
+	for (int32_t idx_b=0; idx_b<num_rhs; idx_b++)
+		row[idx_b]=normalizer->normalize(compute(idx_a, idx_b), idx_a, idx_b);
+
+	return row;
+}
+
 void CCommWordStringKernel::add_to_normal(int32_t vec_idx, float64_t weight)
 {
 	int32_t len=-1;
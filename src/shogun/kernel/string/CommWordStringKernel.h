@@ -98,6 +98,14 @@ class CCommWordStringKernel : public CStringKernel<uint16_t>
 		 */
 		virtual const char* get_name() const { return "CommWordStringKernel"; }
 
+		/** get row idx_a of the kernel matrix, computed in parallel over
+		 * the right hand side strings
+		 *
+		 * @param idx_a index of the lhs string
+		 * @return kernel values of string idx_a against all rhs strings
+		 */
+		virtual SGVector<float64_t> get_kernel_row(int32_t idx_a);
+
 		/** initialize dictionary
 		 *
 		 * @param size size
@@ -115,6 +115,8 @@ void CLocalAlignmentStringKernel::cleanup()
 {
 	SG_FREE(scaled_blosum);
 	scaled_blosum=NULL;
+	SG_FREE(m_substitution);
+	m_substitution=NULL;
 
 	SG_FREE(isAA);
 	isAA=NULL;
@@ -136,16 +138,8 @@ void CLocalAlignmentStringKernel::init_logsum(){
 
 int32_t CLocalAlignmentStringKernel::LogSum(int32_t p1, int32_t p2)
 {
-	int32_t diff;
-	static int32_t firsttime=1;
-
-	if (firsttime)
-	{
-		init_logsum();
-		firsttime =0;
-	}
-
-	diff=p1-p2;
+	// the lookup table is filled in init()
+	int32_t diff=p1-p2;
 	if (diff>=LOGSUM_TBL)
 		return p1;
 	else if (diff<=-LOGSUM_TBL)
@@ -185,6 +179,12 @@ void CLocalAlignmentStringKernel::init_static_variables()
 	for (i=0 ; i<NAA*(NAA+1)/2; i++)
 		scaled_blosum[i]=(int32_t)floor(blosum[i]*SCALING*INTSCALE);
 
+	/* Full square copy of it, so that the inner loop can index a row directly */
+	m_substitution = SG_MALLOC(int32_t, NAA*NAA);
+	for (i=0; i<NAA; i++)
+		for (int32_t j=0; j<NAA; j++)
+			m_substitution[i*NAA+j]=scaled_blosum[BINDEX(i, j)];
+
 
 	/* Scale of gap penalties */
 	m_opening=(int32_t)floor(m_opening*SCALING*INTSCALE);
@@ -198,7 +198,8 @@ void CLocalAlignmentStringKernel::init_static_variables()
  */
 float64_t CLocalAlignmentStringKernel::LAkernelcompute(
 	int32_t* aaX, int32_t* aaY, /* the two amino-acid sequences (as sequences of indexes in [0..NAA-1] indicating the position of the amino-acid in the variable 'aaList') */
-	int32_t nX, int32_t nY /* the lengths of both sequences */)
+	int32_t nX, int32_t nY, /* the lengths of both sequences */
+	SGVector<int32_t>& buffer /* scratch space, grown if needed */)
 {
 	register int32_t
 	i,j,                /* loop indexes */
@@ -227,11 +228,13 @@ float64_t CLocalAlignmentStringKernel::LAkernelcompute(
 	/* Each array stores two successive columns of the (nX+1)x(nY+1) table used in dynamic programming */
 	cl=nY+1;           /* each column stores the positions in the aaY sequence, plus a position at zero */
 
-	logM=SG_CALLOC(int32_t, 2*cl);
-	logX=SG_CALLOC(int32_t, 2*cl);
-	logY=SG_CALLOC(int32_t, 2*cl);
-	logX2=SG_CALLOC(int32_t, 2*cl);
-	logY2=SG_CALLOC(int32_t, 2*cl);
+	if (buffer.vlen<10*cl)
+		buffer=SGVector<int32_t>(10*cl);
+	logM=buffer.vector;
+	logX=logM+2*cl;
+	logY=logX+2*cl;
+	logX2=logY+2*cl;
+	logY2=logX2+2*cl;
 
 	/************************************************/
 	/* First iteration : initialization of column 0 */
@@ -266,6 +269,9 @@ float64_t CLocalAlignmentStringKernel::LAkernelcompute(
 		logX2[curpos]=LOG0;
 		logY2[curpos]=LOG0;
 
+		/* Substitution scores of aaX[i-1] against all amino-acids */
+		const int32_t* sub=m_substitution+aaX[i-1]*NAA;
+
 		/* Secondary loop to vary the position in aaY : j=1..nY */
 		for (j=1; j<=nY; j++) {
 
@@ -303,7 +309,7 @@ float64_t CLocalAlignmentStringKernel::LAkernelcompute(
 
 			aux=LOGP(logX[frompos], logY[frompos]);
 			aux2=LOGP(0, logM[frompos]);
-			logM[curpos]=LOGP(aux, aux2)+scaled_blosum[BINDEX(aaX[i-1], aaY[j-1])];
+			logM[curpos]=LOGP(aux, aux2)+sub[aaY[j-1]];
 
 			/*
 			printf("i=%d , j=%d\nM=%.5f\nX=%.5f\nY=%.5f\nX2=%.5f\nY2=%.5f\n",i,j,logM[curpos],logX[curpos],logY[curpos],logX2[curpos],logY2[curpos]);
@@ -327,13 +333,6 @@ float64_t CLocalAlignmentStringKernel::LAkernelcompute(
 	aux2=LOGP(0, logM[curpos]);
 	/*  kernel_value = LOGP( aux , aux2 );*/
 
-	/* Memory release */
-	SG_FREE(logM);
-	SG_FREE(logX);
-	SG_FREE(logY);
-	SG_FREE(logX2);
-	SG_FREE(logY2);
-
 	/* Return the logarithm of the kernel */
 	return (float32_t)LOGP(aux,aux2)/INTSCALE;
 }
@@ -343,13 +342,22 @@ float64_t CLocalAlignmentStringKernel::LAkernelcompute(
 /********************/
 
 
+int32_t CLocalAlignmentStringKernel::convert_to_aa(const char* x, int32_t lx,
+	int32_t* aa)
+{
+	/* Extract the characters corresponding to aminoacids and keep their indexes */
+	int32_t j=0;
+	for (int32_t i=0; i<lx; i++)
+		if (isAA[toupper(x[i])])
+			aa[j++]=aaIndex[toupper(x[i])-'A'];
+	return j;
+}
+
 /* Return the log-probability of two sequences x and y under a pair HMM model */
 /* x and y are strings of aminoacid letters, e.g., "AABRS" */
 float64_t CLocalAlignmentStringKernel::compute(int32_t idx_x, int32_t idx_y)
 {
-	int32_t *aax, *aay;  /* to convert x and y into sequences of amino-acid indexes */
 	int32_t lx=0, ly=0;       /* lengths of x and y */
-	int32_t i, j;
 
 	bool free_x, free_y;
 	char* x=((CStringFeatures<char>*) lhs)->get_feature_vector(idx_x, lx, free_x);
@@ -359,36 +367,74 @@ float64_t CLocalAlignmentStringKernel::compute(int32_t idx_x, int32_t idx_y)
 	if ( (lx<1) || (ly<1) )
 		SG_ERROR("empty chain")
 
-	/* Create aax and aay */
+	/* Convert x and y into sequences of amino-acid indexes */
+	SGVector<int32_t> aax(lx);
+	SGVector<int32_t> aay(ly);
+	lx=convert_to_aa(x, lx, aax.vector);
+	ly=convert_to_aa(y, ly, aay.vector);
 
-	aax = SG_CALLOC(int32_t, lx);
-	aay = SG_CALLOC(int32_t, ly);
+	/* Compute the pair HMM score, get_kernel_matrix() calls this from
+	 * several threads, each keeps its own scratch space */
+	static thread_local SGVector<int32_t> buffer;
+	float64_t result=LAkernelcompute(aax.vector, aay.vector, lx, ly, buffer);
 
-	/* Extract the characters corresponding to aminoacids and keep their indexes */
+	((CStringFeatures<char>*)lhs)->free_feature_vector(x, idx_x, free_x);
+	((CStringFeatures<char>*)rhs)->free_feature_vector(y, idx_y, free_y);
 
-	j=0;
-	for (i=0; i<lx; i++)
-		if (isAA[toupper(x[i])])
-			aax[j++]=aaIndex[toupper(x[i])-'A'];
-	lx=j;
-	j=0;
-	for (i=0; i<ly; i++)
-		if (isAA[toupper(y[i])])
-			aay[j++]=aaIndex[toupper(y[i])-'A'];
-	ly=j;
+	return result;
+}
 
+SGVector<float64_t> CLocalAlignmentStringKernel::get_kernel_row(int32_t idx_x)
+{
+	REQUIRE(lhs, "lhs feature vector is not set!\n")
+	REQUIRE(rhs, "rhs feature vector is not set!\n")
 
-	/* Compute the pair HMM score */
-	float64_t result=LAkernelcompute(aax, aay, lx, ly);
+	int32_t lx=0;
+	bool free_x;
+	char* x=((CStringFeatures<char>*) lhs)->get_feature_vector(idx_x, lx, free_x);
+	ASSERT(x)
 
-	/* Release memory */
-	SG_FREE(aax);
-	SG_FREE(aay);
+	if (lx<1)
+		SG_ERROR("empty chain")
 
+	/* x is converted only once for the whole row */
+	SGVector<int32_t> aax(lx);
+	lx=convert_to_aa(x, lx, aax.vector);
 	((CStringFeatures<char>*)lhs)->free_feature_vector(x, idx_x, free_x);
-	((CStringFeatures<char>*)rhs)->free_feature_vector(y, idx_y, free_y);
 
-	return result;
+	/* errors cannot leave the parallel region, so check all rhs first */
+	for (int32_t idx_y=0; idx_y<num_rhs; idx_y++)
+	{
+		if (((CStringFeatures<char>*) rhs)->get_vector_length(idx_y)<1)
+			SG_ERROR("empty chain")
+	}
+
+	SGVector<float64_t> row(num_rhs);
+
+#pragma omp parallel
+	{
+		/* scratch space reused for all sequences handled by a thread */
+		SGVector<int32_t> aay;
+		SGVector<int32_t> buffer;
+
+#pragma omp for schedule(dynamic)
+		for (int32_t idx_y=0; idx_y<num_rhs; idx_y++)
+		{
+			int32_t ly=0;
+			bool free_y;
+			char* y=((CStringFeatures<char>*) rhs)->get_feature_vector(idx_y, ly, free_y);
+
+			if (aay.vlen<ly)
+				aay=SGVector<int32_t>(ly);
+			int32_t n=convert_to_aa(y, ly, aay.vector);
+			((CStringFeatures<char>*)rhs)->free_feature_vector(y, idx_y, free_y);
+
+			float64_t result=LAkernelcompute(aax.vector, aay.vector, lx, n, buffer);
+			row[idx_y]=normalizer->normalize(result, idx_x, idx_y);
+		}
+	}
+
+	return row;
 }
 
 void CLocalAlignmentStringKernel::init()
@@ -398,6 +444,7 @@ void CLocalAlignmentStringKernel::init()
 	initialized=false;
 	isAA=NULL;
 	aaIndex=NULL;
+	m_substitution=NULL;
 
 	m_opening=10;
 	m_extension=2;
@@ -74,6 +74,15 @@ class CLocalAlignmentStringKernel: public CStringKernel<char>
 			return "LocalAlignmentStringKernel";
 		}
 
+		/** computes the kernel between one lhs sequence and all rhs
+		 * sequences in parallel. The lhs sequence is converted once and
+		 * each thread reuses its dynamic programming buffers.
+		 *
+		 * @param idx_x index of the lhs sequence
+		 * @return normalized kernel values against all rhs sequences
+		 */
+		virtual SGVector<float64_t> get_kernel_row(int32_t idx_x);
+
 	protected:
 		/** compute kernel function for features a and b
 		 * idx_{a,b} denote the index of the feature vectors
@@ -112,10 +121,22 @@ class CLocalAlignmentStringKernel: public CStringKernel<char>
 		 * @param aaY aaY
 		 * @param nX nX
 		 * @param nY nY
+		 * @param buffer scratch space for the dynamic programming, grown if
+		 * needed
 		 * @return computed value
 		 */
 		float64_t LAkernelcompute(
-			int32_t* aaX, int32_t* aaY, int32_t nX, int32_t nY);
+			int32_t* aaX, int32_t* aaY, int32_t nX, int32_t nY,
+			SGVector<int32_t>& buffer);
+
+		/** converts a sequence into amino-acid indexes, skipping other chars
+		 *
+		 * @param x sequence
+		 * @param lx length of the sequence
+		 * @param aa output indexes, at least lx elements
+		 * @return number of amino-acids
+		 */
+		int32_t convert_to_aa(const char* x, int32_t lx, int32_t* aa);
 
 		/** Initialize all static variables. This function should be called once
 		 * before computing the first pair HMM score */
@@ -143,6 +164,8 @@ class CLocalAlignmentStringKernel: public CStringKernel<char>
 		static const int32_t blosum[];
 		/** scaled blosum */
 		int32_t* scaled_blosum;
+		/** scaled blosum as full NAA x NAA matrix */
+		int32_t* m_substitution;
 		/** List of amino acids */
 		static const char* aaList;
 };
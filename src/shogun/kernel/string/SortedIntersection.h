@@ -0,0 +1,105 @@
+/*
+ * This software is distributed under BSD 3-clause license (see LICENSE file).
+ */
+
+#ifndef _SORTEDINTERSECTION_H___
+#define _SORTEDINTERSECTION_H___
+
+#include <shogun/lib/config.h>
+#include <shogun/lib/common.h>
+
+#include <algorithm>
+
+namespace shogun
+{
+/** Exponential (galloping) search in a sorted array.
+ *
+ * Starting at position pos, returns the first position p>=pos with
+ * vec[p]>=key (or vec[p]>key if upper is true), len if there is none. The
+ * cost is logarithmic in the distance skipped, so long stretches of
+ * non-matching k-mers are passed over in a few comparisons while the
+ * common case of a neighbouring hit costs a single comparison.
+ *
+ * @param vec sorted array
+ * @param len length of vec
+ * @param pos start position
+ * @param key key to search for
+ * @param upper whether to skip entries equal to key as well
+ * @return position of the first entry not skipped
+ */
+template <class T>
+inline int32_t sorted_gallop(
+	const T* vec, int32_t len, int32_t pos, T key, bool upper=false)
+{
+	if (pos>=len || (upper ? vec[pos]>key : vec[pos]>=key))
+		return pos;
+
+	// vec[lo] is known to be skipped, grow the step until vec[lo+step] is not
+	int32_t lo=pos;
+	int32_t step=1;
+	while (lo+step<len && (upper ? vec[lo+step]<=key : vec[lo+step]<key))
+	{
+		lo+=step;
+		step<<=1;
+	}
+
+	const T* first=vec+lo+1;
+	const T* last=vec+std::min(lo+step, len);
+	if (upper)
+		return std::upper_bound(first, last, key)-vec;
+	return std::lower_bound(first, last, key)-vec;
+}
+
+/** Spectrum kernel of two sorted k-mer arrays, i.e. the dot product of their
+ * k-mer count vectors (or the number of shared k-mers if use_sign is set).
+ *
+ * Runs of equal k-mers and gaps between matches are both skipped with
+ * sorted_gallop() instead of one element at a time, which makes the merge
+ * sublinear when one of the arrays is much shorter than the other or when
+ * the arrays share few k-mers.
+ *
+ * @param avec sorted k-mers of a
+ * @param alen length of avec
+ * @param bvec sorted k-mers of b
+ * @param blen length of bvec
+ * @param use_sign whether to count shared k-mers only once
+ * @return kernel value
+ */
+template <class T>
+float64_t sorted_intersection(
+	const T* avec, int32_t alen, const T* bvec, int32_t blen, bool use_sign)
+{
+	float64_t result=0;
+
+	int32_t left_idx=0;
+	int32_t right_idx=0;
+
+	while (left_idx<alen && right_idx<blen)
+	{
+		if (avec[left_idx]<bvec[right_idx])
+			left_idx=sorted_gallop(avec, alen, left_idx+1, bvec[right_idx]);
+		else if (bvec[right_idx]<avec[left_idx])
+			right_idx=sorted_gallop(bvec, blen, right_idx+1, avec[left_idx]);
+		else
+		{
+			T sym=avec[left_idx];
+			int32_t left_end=sorted_gallop(avec, alen, left_idx+1, sym, true);
+			int32_t right_end=sorted_gallop(bvec, blen, right_idx+1, sym, true);
+
+			if (use_sign)
+				result++;
+			else
+			{
+				result+=((float64_t) (left_end-left_idx))*
+					((float64_t) (right_end-right_idx));
+			}
+
+			left_idx=left_end;
+			right_idx=right_end;
+		}
+	}
+
+	return result;
+}
+}
+#endif /* _SORTEDINTERSECTION_H___ */
@@ -7,6 +7,8 @@
 #include <shogun/kernel/string/SubsequenceStringKernel.h>
 #include <shogun/kernel/normalizer/SqrtDiagKernelNormalizer.h>
 #include <shogun/features/StringFeatures.h>
+#include <shogun/mathematics/Math.h>
+#include <algorithm>
 
 using namespace shogun;
 
@@ -67,66 +69,121 @@ float64_t CSubsequenceStringKernel::compute(int32_t idx_a, int32_t idx_b)
 	REQUIRE(avec, "Feature vector for lhs is NULL!\n");
 	REQUIRE(bvec, "Feature vector for rhs is NULL!\n");
 
-	// allocating memory for computing K' (Kp)
-	float64_t ***Kp=SG_MALLOC(float64_t**, m_maxlen+1);
-	for (index_t i=0; i<m_maxlen+1; ++i)
-	{
-		Kp[i]=SG_MALLOC(float64_t*, alen);
-		for (index_t j=0; j<alen; ++j)
-			Kp[i][j]=SG_CALLOC(float64_t, blen);
-	}
+	// dynamic programming buffer reused for all pairs a thread computes
+	static thread_local SGVector<float64_t> buffer;
+	float64_t K=compute_helper(avec, alen, bvec, blen, buffer);
+
+	// cleanup
+	dynamic_cast<CStringFeatures<char>*>(lhs)->free_feature_vector(avec, idx_a,
+			free_avec);
+	dynamic_cast<CStringFeatures<char>*>(rhs)->free_feature_vector(bvec, idx_b,
+			free_bvec);
+
+	return K;
+}
+
+float64_t CSubsequenceStringKernel::compute_helper(const char* avec,
+		int32_t alen, const char* bvec, int32_t blen,
+		SGVector<float64_t>& buffer)
+{
+	if (alen<1 || blen<1)
+		return 0.0;
+
+	// only two layers K'_{i} and K'_{i+1} are kept, plus one row of
+	// matching terms
+	const int64_t size=int64_t(alen)*blen;
+	if (buffer.vlen<2*size+blen)
+		buffer=SGVector<float64_t>(2*size+blen);
+
+	float64_t* Kp=buffer.vector;
+	float64_t* Kp_next=Kp+size;
+	float64_t* match=Kp_next+size;
 
 	// initialize for 0 subsequence length for both the strings
-	for (index_t j=0; j<alen; j++)
-		for (index_t k=0; k<blen; ++k)
-			Kp[0][j][k]=1.0;
+	std::fill(Kp, Kp+size, 1.0);
 
 	// computing of the K' (Kp) function using equations
 	// shown in Lodhi et. al. See the class documentation for
-	// definitions of Kp and Kpp
-	for (index_t i=0; i<m_maxlen; i++)
+	// definitions of Kp and Kpp. K'_{i} vanishes on the first i rows and
+	// columns, so each layer starts at row i.
+	const int32_t num_layers=CMath::min(m_maxlen, CMath::min(alen, blen));
+	float64_t K=0.0;
+	for (index_t i=0; i<num_layers; i++)
 	{
-		for (index_t j=0; j<alen-1; j++)
+		const bool last=(i==num_layers-1);
+		if (!last)
+			std::fill(Kp_next, Kp_next+size, 0.0);
+
+		for (index_t j=i; j<alen; j++)
 		{
+			const float64_t* Kp_row=Kp+j*int64_t(blen);
+			const char a=avec[j];
+
+			// matching terms of this row contribute to the kernel directly
+			float64_t sum=0.0;
+			for (index_t k=0; k<blen; k++)
+			{
+				match[k]=(a==bvec[k]) ? Kp_row[k] : 0.0;
+				sum+=match[k];
+			}
+			K+=m_lambda*m_lambda*sum;
+
+			if (last || j==alen-1)
+				continue;
+
+			const float64_t* Kp_next_prev=Kp_next+j*int64_t(blen);
+			float64_t* Kp_next_row=Kp_next+(j+1)*int64_t(blen);
 			float64_t Kpp=0.0;
 			for (index_t k=0; k<blen-1; k++)
 			{
-				Kpp=m_lambda*(Kpp+m_lambda*(avec[j]==bvec[k])
-						*Kp[i][j][k]);
-				Kp[i+1][j+1][k+1]=m_lambda*Kp[i+1][j][k+1]+Kpp;
+				Kpp=m_lambda*(Kpp+m_lambda*match[k]);
+				Kp_next_row[k+1]=m_lambda*Kp_next_prev[k+1]+Kpp;
 			}
 		}
+
+		std::swap(Kp, Kp_next);
 	}
 
-	// compute the kernel function
-	float64_t K=0.0;
-	for (index_t i=0; i<m_maxlen; i++)
+	return K;
+}
+
+SGVector<float64_t> CSubsequenceStringKernel::get_kernel_row(int32_t idx_a)
+{
+	REQUIRE(lhs, "lhs feature vector is not set!\n")
+	REQUIRE(rhs, "rhs feature vector is not set!\n")
+
+	int32_t alen;
+	bool free_avec;
+	char* avec=dynamic_cast<CStringFeatures<char>*>(lhs)
+		->get_feature_vector(idx_a, alen, free_avec);
+	REQUIRE(avec, "Feature vector for lhs is NULL!\n");
+
+	CStringFeatures<char>* rhs_str=dynamic_cast<CStringFeatures<char>*>(rhs);
+	SGVector<float64_t> row(num_rhs);
+
+#pragma omp parallel
 	{
-		for (index_t j=0; j<alen; j++)
+		// dynamic programming buffer reused for all strings of a thread
+		SGVector<float64_t> buffer;
+
+#pragma omp for schedule(dynamic)
+		for (int32_t idx_b=0; idx_b<num_rhs; idx_b++)
 		{
-			for (index_t k=0; k<blen; k++)
-			{
-				K+=m_lambda*m_lambda*(avec[j]==bvec[k])
-					*Kp[i][j][k];
-			}
+			int32_t blen;
+			bool free_bvec;
+			char* bvec=rhs_str->get_feature_vector(idx_b, blen, free_bvec);
+
+			float64_t K=compute_helper(avec, alen, bvec, blen, buffer);
+			row[idx_b]=normalizer->normalize(K, idx_a, idx_b);
+
+			rhs_str->free_feature_vector(bvec, idx_b, free_bvec);
 		}
 	}
 
-	// cleanup
 	dynamic_cast<CStringFeatures<char>*>(lhs)->free_feature_vector(avec, idx_a,
 			free_avec);
-	dynamic_cast<CStringFeatures<char>*>(rhs)->free_feature_vector(bvec, idx_b,
-			free_bvec);
-
-	for (index_t i=0; i<m_maxlen+1; ++i)
-	{
-		for (index_t j=0; j<alen; ++j)
-			SG_FREE(Kp[i][j]);
-		SG_FREE(Kp[i]);
-	}
-	SG_FREE(Kp);
 
-	return K;
+	return row;
 }
 
 void CSubsequenceStringKernel::register_params()
@@ -129,7 +129,29 @@ public:
 	 */
 	virtual float64_t compute(int32_t idx_a, int32_t idx_b);
 
+	/**
+	 * computes the kernel between one lhs string and all rhs strings in
+	 * parallel, each thread reusing its dynamic programming buffer
+	 *
+	 * @param idx_a index of the lhs string
+	 * @return normalized kernel values against all rhs strings
+	 */
+	virtual SGVector<float64_t> get_kernel_row(int32_t idx_a);
+
 protected:
+	/**
+	 * computes the unnormalized kernel between two strings
+	 *
+	 * @param avec first string
+	 * @param alen length of the first string
+	 * @param bvec second string
+	 * @param blen length of the second string
+	 * @param buffer scratch space, grown if needed
+	 * @return kernel value
+	 */
+	float64_t compute_helper(const char* avec, int32_t alen,
+		const char* bvec, int32_t blen, SGVector<float64_t>& buffer);
+
 	/** maximum length of common subsequences */
 	int32_t m_maxlen;
 
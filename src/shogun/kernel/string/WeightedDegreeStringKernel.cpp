@@ -213,7 +213,14 @@ bool CWeightedDegreeStringKernel::init_optimization(int32_t count, int32_t* IDX,
 
 	for (auto i : progress(range(count), *this->io))
 	{
-		if (tree_num<0)
+		if (uses_flat_tables())
+		{
+			if (tree_num<0)
+				add_example_to_table(IDX[i], alphas[i]);
+			else
+				add_example_to_table(IDX[i], alphas[i], tree_num, tree_num+1);
+		}
+		else if (tree_num<0)
 		{
 
 			if (max_mismatch==0)
@@ -244,6 +251,7 @@ bool CWeightedDegreeStringKernel::delete_optimization()
 	{
 		if (tries!=NULL)
 			tries->delete_trees(max_mismatch==0);
+		clear_kmer_table();
 		set_is_initialized(false);
 		return true;
 	}
@@ -251,6 +259,64 @@ bool CWeightedDegreeStringKernel::delete_optimization()
 	return false;
 }
 
+void CWeightedDegreeStringKernel::set_use_flat_tables(bool flat)
+{
+	if (flat!=use_flat_tables)
+		delete_optimization();
+
+	use_flat_tables=flat;
+}
+
+void CWeightedDegreeStringKernel::clear_kmer_table()
+{
+	kmer_codes=SGVector<uint64_t>();
+	kmer_positions=SGVector<int32_t>();
+	kmer_weights=SGVector<float64_t>();
+	kmer_table_used=0;
+}
+
+index_t CWeightedDegreeStringKernel::find_kmer_slot(
+	int32_t pos, uint64_t code) const
+{
+	uint64_t h=(code^((uint64_t) pos*0x9E3779B97F4A7C15ULL))*0xBF58476D1CE4E5B9ULL;
+	h^=h>>31;
+
+	const uint64_t* codes=kmer_codes.vector;
+	const int32_t* positions=kmer_positions.vector;
+	index_t mask=kmer_codes.vlen-1;
+	index_t slot=(index_t) (h & (uint64_t) mask);
+
+	// linear probing, the table is never more than half full
+	while (codes[slot]!=0 && (codes[slot]!=code || positions[slot]!=pos))
+		slot=(slot+1) & mask;
+
+	return slot;
+}
+
+void CWeightedDegreeStringKernel::grow_kmer_table()
+{
+	SGVector<uint64_t> old_codes=kmer_codes;
+	SGVector<int32_t> old_positions=kmer_positions;
+	SGVector<float64_t> old_weights=kmer_weights;
+
+	index_t capacity=CMath::max(2*old_codes.vlen, 1024);
+	kmer_codes=SGVector<uint64_t>(capacity);
+	kmer_codes.zero();
+	kmer_positions=SGVector<int32_t>(capacity);
+	kmer_weights=SGVector<float64_t>(capacity);
+
+	for (index_t i=0; i<old_codes.vlen; i++)
+	{
+		if (old_codes[i]==0)
+			continue;
+
+		index_t slot=find_kmer_slot(old_positions[i], old_codes[i]);
+		kmer_codes[slot]=old_codes[i];
+		kmer_positions[slot]=old_positions[i];
+		kmer_weights[slot]=old_weights[i];
+	}
+}
+
 
 float64_t CWeightedDegreeStringKernel::compute_with_mismatch(
 	char* avec, int32_t alen, char* bvec, int32_t blen)
@@ -555,6 +621,102 @@ void CWeightedDegreeStringKernel::compute_by_tree(
 	SG_FREE(vec);
 }
 
+void CWeightedDegreeStringKernel::add_example_to_table(
+	int32_t idx, float64_t alpha, int32_t start, int32_t end)
+{
+	ASSERT(alphabet)
+	ASSERT(alphabet->get_alphabet()==DNA || alphabet->get_alphabet()==RNA)
+	ASSERT(max_mismatch==0)
+	// k-mers are packed 2 bits per base behind a sentinel bit into 64 bits
+	REQUIRE(degree<=31, "Flat k-mer tables support degree<=31 (got %d)\n", degree)
+
+	if (alpha==0.0)
+		return;
+
+	int32_t len=0;
+	bool free_vec;
+	char* char_vec=((CStringFeatures<char>*) lhs)->get_feature_vector(idx, len, free_vec);
+	uint8_t* vec=SG_MALLOC(uint8_t, len);
+
+	for (int32_t i=0; i<len; i++)
+		vec[i]=alphabet->remap_to_bin(char_vec[i]);
+	((CStringFeatures<char>*) lhs)->free_feature_vector(char_vec, idx, free_vec);
+
+	float64_t alpha_n=normalizer->normalize_lhs(alpha, idx);
+	if (end<0 || end>len)
+		end=len;
+
+	for (int32_t i=start; i<end; i++)
+	{
+		float64_t* weights_column=(length!=0) ? &weights[i*degree] : weights;
+		uint64_t code=1;
+
+		for (int32_t j=0; (j<degree) && (i+j<len); j++)
+		{
+			code=(code<<2) | vec[i+j];
+
+			if (2*(kmer_table_used+1)>kmer_codes.vlen)
+				grow_kmer_table();
+
+			index_t slot=find_kmer_slot(i, code);
+			if (kmer_codes[slot]==0)
+			{
+				kmer_codes[slot]=code;
+				kmer_positions[slot]=i;
+				kmer_weights[slot]=0;
+				kmer_table_used++;
+			}
+			kmer_weights[slot]+=alpha_n*weights_column[j];
+		}
+	}
+
+	SG_FREE(vec);
+	tree_initialized=true;
+}
+
+float64_t CWeightedDegreeStringKernel::compute_by_table(int32_t idx)
+{
+	ASSERT(alphabet)
+	ASSERT(alphabet->get_alphabet()==DNA || alphabet->get_alphabet()==RNA)
+
+	int32_t len=0;
+	bool free_vec;
+	char* char_vec=((CStringFeatures<char>*) rhs)->get_feature_vector(idx, len, free_vec);
+	ASSERT(char_vec && len>0)
+
+	const uint64_t* codes=kmer_codes.vector;
+	const float64_t* kmer_w=kmer_weights.vector;
+	float64_t sum=0;
+
+	for (int32_t i=0; i<len && kmer_table_used>0; i++)
+	{
+		if ((position_weights!=NULL) && (position_weights[i]==0))
+			continue;
+
+		float64_t sumi=0;
+		uint64_t code=1;
+
+		for (int32_t j=0; (j<degree) && (i+j<len); j++)
+		{
+			code=(code<<2) | alphabet->remap_to_bin(char_vec[i+j]);
+			index_t slot=find_kmer_slot(i, code);
+
+			// no support vector shares this prefix, so no longer k-mer either
+			if (codes[slot]==0)
+				break;
+			sumi+=kmer_w[slot];
+		}
+
+		if (position_weights!=NULL)
+			sum+=position_weights[i]*sumi;
+		else
+			sum+=sumi;
+	}
+	((CStringFeatures<char>*) rhs)->free_feature_vector(char_vec, idx, free_vec);
+
+	return normalizer->normalize_rhs(sum, idx);
+}
+
 float64_t *CWeightedDegreeStringKernel::compute_abs_weights(int32_t &len)
 {
 	ASSERT(tries)
@@ -865,6 +1027,20 @@ void CWeightedDegreeStringKernel::compute_batch(
 	ASSERT(num_vec>0)
 	ASSERT(vec_idx)
 	ASSERT(result)
+
+	if (uses_flat_tables())
+	{
+		// one table holds all positions, examples are scored independently
+		init_optimization(num_suppvec, IDX, alphas, -1);
+
+		#pragma omp parallel for
+		for (int32_t i=0; i<num_vec; i++)
+			result[i]+=factor*compute_by_table(vec_idx[i]);
+
+		delete_optimization();
+		return;
+	}
+
 	create_empty_tries();
 
 	int32_t num_feat=((CStringFeatures<char>*) rhs)->get_max_vector_length();
@@ -1002,6 +1178,9 @@ void CWeightedDegreeStringKernel::init()
 	tree_initialized=false;
 	alphabet=NULL;
 
+	use_flat_tables=false;
+	kmer_table_used=0;
+
 	lhs=NULL;
 	rhs=NULL;
 
@@ -1031,4 +1210,6 @@ void CWeightedDegreeStringKernel::init()
 			MS_AVAILABLE);
 	SG_ADD((CSGObject**) &alphabet, "alphabet",
 			"Alphabet of Features.", MS_NOT_AVAILABLE);
+	SG_ADD(&use_flat_tables, "use_flat_tables",
+			"If flat k-mer tables are used instead of tries.", MS_NOT_AVAILABLE);
 }
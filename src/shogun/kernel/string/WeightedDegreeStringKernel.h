@@ -158,7 +158,11 @@ class CWeightedDegreeStringKernel: public CStringKernel<char>
 		virtual float64_t compute_optimized(int32_t idx)
 		{
 			if (get_is_initialized())
+			{
+				if (uses_flat_tables())
+					return compute_by_table(idx);
 				return compute_by_tree(idx);
+			}
 
 			SG_ERROR("CWeightedDegreeStringKernel optimization not initialized\n")
 			return 0;
@@ -196,7 +200,10 @@ class CWeightedDegreeStringKernel: public CStringKernel<char>
 				if (normalizer && normalizer->get_normalizer_type()==N_MULTITASK)
 					SG_ERROR("not implemented")
 
-				tries->delete_trees(max_mismatch==0);
+				if (uses_flat_tables())
+					clear_kmer_table();
+				else
+					tries->delete_trees(max_mismatch==0);
 				set_is_initialized(false);
 			}
 		}
@@ -212,7 +219,9 @@ class CWeightedDegreeStringKernel: public CStringKernel<char>
 			if (normalizer && normalizer->get_normalizer_type()==N_MULTITASK)
 				SG_ERROR("not implemented")
 
-			if (max_mismatch==0)
+			if (uses_flat_tables())
+				add_example_to_table(idx, weight);
+			else if (max_mismatch==0)
 				add_example_to_tree(idx, weight);
 			else
 				add_example_to_tree_mismatch(idx, weight);
@@ -250,6 +259,9 @@ class CWeightedDegreeStringKernel: public CStringKernel<char>
 				if (normalizer && normalizer->get_normalizer_type()==N_MULTITASK)
 					SG_ERROR("not implemented")
 
+				REQUIRE(!uses_flat_tables(), "Subkernel contributions are "
+						"only available with trie based optimization\n")
+
 				compute_by_tree(idx, subkernel_contrib);
 				return ;
 			}
@@ -563,6 +575,24 @@ class CWeightedDegreeStringKernel: public CStringKernel<char>
 		 */
 		inline bool get_use_block_computation() { return block_computation; }
 
+		/** set whether the linadd optimization uses a flat hashed k-mer
+		 * weight table instead of per-position tries
+		 *
+		 * The table maps (position, k-mer) to the summed weight of all added
+		 * examples and is scored in parallel by compute_batch. It is only
+		 * used for degree<=31 without mismatches; otherwise tries are used.
+		 * Changing the setting drops an initialized optimization.
+		 *
+		 * @param flat if flat tables shall be used
+		 */
+		void set_use_flat_tables(bool flat);
+
+		/** check if flat k-mer tables are used for linadd
+		 *
+		 * @return if flat tables are used
+		 */
+		inline bool get_use_flat_tables() const { return use_flat_tables; }
+
 		/** set MKL steps ize
 		 *
 		 * @param step new step size
@@ -642,6 +672,38 @@ class CWeightedDegreeStringKernel: public CStringKernel<char>
 		 */
 		float64_t compute_by_tree(int32_t idx);
 
+		/** @return whether the flat k-mer table replaces the tries */
+		inline bool uses_flat_tables() const
+		{
+			// k-mers are packed into 64 bit codes, longer ones need tries
+			return use_flat_tables && max_mismatch==0 && degree<=31;
+		}
+
+		/** add example to the flat k-mer table
+		 *
+		 * @param idx index
+		 * @param weight weight
+		 * @param start first position to add (all positions by default)
+		 * @param end one past the last position to add (-1 for all)
+		 */
+		void add_example_to_table(int32_t idx, float64_t weight,
+			int32_t start=0, int32_t end=-1);
+
+		/** compute by flat k-mer table, safe to call concurrently
+		 *
+		 * Like compute_by_tree, the table only holds the normalized alphas
+		 * times the degree weights, and position_weights[i] is applied
+		 * once to the sum over all k-mers starting at position i when
+		 * scoring, so both agree with compute().
+		 *
+		 * @param idx index
+		 * @return computed value
+		 */
+		float64_t compute_by_table(int32_t idx);
+
+		/** drop all entries of the flat k-mer table */
+		void clear_kmer_table();
+
 		/** compute kernel function for features a and b
 		 * idx_{a,b} denote the index of the feature vectors
 		 * in the corresponding feature object
@@ -704,6 +766,17 @@ class CWeightedDegreeStringKernel: public CStringKernel<char>
 		 * and registering parameters */
 		void init();
 
+		/** find the slot of a (position, k-mer) key in the flat table
+		 *
+		 * @param pos position of the k-mer
+		 * @param code 2-bit packed k-mer with a leading sentinel bit
+		 * @return slot holding the key or the empty slot it would take
+		 */
+		index_t find_kmer_slot(int32_t pos, uint64_t code) const;
+
+		/** double the capacity of the flat k-mer table and rehash */
+		void grow_kmer_table();
+
 	protected:
 		/** degree*length weights
 		 *length must match seq_length if != 0
@@ -754,6 +827,17 @@ class CWeightedDegreeStringKernel: public CStringKernel<char>
 
 		/** alphabet of features */
 		CAlphabet* alphabet;
+
+		/** if flat k-mer tables are used instead of tries */
+		bool use_flat_tables;
+		/** k-mer codes of the flat table, 0 marks an empty slot */
+		SGVector<uint64_t> kmer_codes;
+		/** k-mer start positions of the flat table */
+		SGVector<int32_t> kmer_positions;
+		/** summed (weighted) alphas of the flat table */
+		SGVector<float64_t> kmer_weights;
+		/** number of used slots of the flat table */
+		index_t kmer_table_used;
 };
 
 }
@@ -71,7 +71,8 @@ template<class T>
 SGString<T> SGString<T>::clone() const
 {
 	SGString<T> result(slen);
-	sg_memcpy(result.string, string, sizeof(T)*slen);
+	if (string)
+		sg_memcpy(result.string, string, sizeof(T)*slen);
 	return result;
 }
 
@@ -67,6 +67,8 @@ template <class S, class T> inline void clone(T*& dst, S* src, int32_t n)
 }
 #define INF HUGE_VAL
 #define TAU 1e-12
+// minimal number of entries for which gradient updates are parallelized
+#define MIN_PARALLEL_SIZE 16384
 
 class QMatrix;
 class SVC_QMC;
@@ -89,9 +91,19 @@ public:
 	int32_t get_data(const int32_t index, Qfloat **data, int32_t len);
 	void swap_index(int32_t i, int32_t j);	// future_option
 
+	// space column index takes up once [0,len) of it is requested, columns
+	// cached earlier may already be longer than len
+	int64_t get_column_space(const int32_t index, int32_t len) const
+	{
+		return CMath::max(head[index].len, len);
+	}
+
+	int64_t get_capacity() const { return capacity; }
+
 private:
 	int32_t l;
 	int64_t size;
+	int64_t capacity;
 	struct head_t
 	{
 		head_t *prev, *next;	// a circular list
@@ -111,6 +123,7 @@ Cache::Cache(int32_t l_, int64_t size_):l(l_),size(size_)
 	size /= sizeof(Qfloat);
 	size -= l * sizeof(head_t) / sizeof(Qfloat);
 	size = CMath::max(size, (int64_t) 2*l);	// cache must be large enough for two columns
+	capacity = size;
 	lru_head.next = lru_head.prev = &lru_head;
 }
 
@@ -212,6 +225,16 @@ public:
 	virtual void swap_index(int32_t i, int32_t j) const = 0;
 	virtual ~QMatrix() {}
 
+	// get [0,len) of the first m<=n of the given columns, missing entries
+	// of all of them are computed in one parallel region
+	// return m, the columns stay valid until the next get_Q/get_Q_batch
+	virtual int32_t get_Q_batch(
+		const int32_t* columns, int32_t n, int32_t len, const Qfloat** data) const
+	{
+		data[0] = get_Q(columns[0], len);
+		return 1;
+	}
+
 	float64_t max_train_time;
 };
 
@@ -248,11 +271,57 @@ public:
 		}
 	}
 
+	// look up columns in the cache and fill what is missing of all of
+	// them at once; batch_start[c] is where filling column c began
+	int32_t compute_Q_batch_parallel(
+		Cache* cache, const int32_t* columns, int32_t n, int32_t len,
+		const Qfloat** data, float64_t* lab) const
+	{
+		// all columns of the batch have to fit into the cache together,
+		// otherwise filling a later one evicts an earlier one
+		int64_t space = 0;
+		for(int32_t c=0;c<n;c++)
+		{
+			space += cache->get_column_space(columns[c], len);
+			if(c>0 && space>cache->get_capacity())
+			{
+				n = c;
+				break;
+			}
+		}
+
+		for(int32_t c=0;c<n;c++)
+		{
+			Qfloat* data_c;
+			batch_start[c] = cache->get_data(columns[c], &data_c, len);
+			data[c] = data_c;
+		}
+
+		#pragma omp parallel
+		for(int32_t c=0;c<n;c++)
+		{
+			const int32_t i = columns[c];
+			Qfloat* data_c = const_cast<Qfloat*>(data[c]);
+			#pragma omp for nowait
+			for(int32_t j=batch_start[c];j<len;j++)
+			{
+				if (lab)
+					data_c[j] = (Qfloat) lab[i]*lab[j]*this->kernel_function(i,j);
+				else
+					data_c[j] = (Qfloat) this->kernel_function(i,j);
+			}
+		}
+		return n;
+	}
+
 	inline float64_t kernel_function(int32_t i, int32_t j) const
 	{
 		return kernel->kernel(x[i]->index,x[j]->index);
 	}
 
+protected:
+	int32_t *batch_start;
+
 private:
 	CKernel* kernel;
 	const svm_node **x;
@@ -263,6 +332,7 @@ LibSVMKernel::LibSVMKernel(int32_t l, svm_node * const * x_, const svm_parameter
 {
 	clone(x,x_,l);
 	x_square = 0;
+	batch_start = SG_MALLOC(int32_t, l);
 	kernel=param.kernel;
 	max_train_time=param.max_train_time;
 }
@@ -271,6 +341,7 @@ LibSVMKernel::~LibSVMKernel()
 {
 	SG_FREE(x);
 	SG_FREE(x_square);
+	SG_FREE(batch_start);
 }
 
 // Generalized SMO+SVMlight algorithm
@@ -416,31 +487,60 @@ void Solver::reconstruct_gradient()
 	for(j=active_size;j<l;j++)
 		G[j] = G_bar[j] + p[j];
 
+	int32_t *free_set = SG_MALLOC(int32_t, active_size);
 	for(j=0;j<active_size;j++)
 		if(is_free(j))
-			nr_free++;
+			free_set[nr_free++] = j;
+
+	// columns are fetched in batches that fit into the kernel cache and
+	// their contributions are accumulated in parallel
+	const Qfloat **Q_batch = SG_MALLOC(const Qfloat*, CMath::max(l-active_size, nr_free));
 
 	if (nr_free*l > 2*active_size*(l-active_size))
 	{
+		int32_t *inactive_set = SG_MALLOC(int32_t, l-active_size);
 		for(i=active_size;i<l;i++)
+			inactive_set[i-active_size] = i;
+
+		for(i=active_size;i<l;)
 		{
-			const Qfloat *Q_i = Q->get_Q(i,active_size);
-			for(j=0;j<active_size;j++)
-				if(is_free(j))
-					G[i] += alpha[j] * Q_i[j];
+			int32_t nr_fetched = Q->get_Q_batch(
+				&inactive_set[i-active_size], l-i, active_size, Q_batch);
+
+			#pragma omp parallel for
+			for(int32_t c=0;c<nr_fetched;c++)
+			{
+				const Qfloat *Q_c = Q_batch[c];
+				float64_t sum = 0;
+				for(int32_t f=0;f<nr_free;f++)
+					sum += alpha[free_set[f]] * Q_c[free_set[f]];
+				G[i+c] += sum;
+			}
+			i += nr_fetched;
 		}
+		SG_FREE(inactive_set);
 	}
 	else
 	{
-		for(i=0;i<active_size;i++)
-			if(is_free(i))
+		for(int32_t f=0;f<nr_free;)
+		{
+			int32_t nr_fetched = Q->get_Q_batch(
+				&free_set[f], nr_free-f, l, Q_batch);
+
+			#pragma omp parallel for
+			for(j=active_size;j<l;j++)
 			{
-				const Qfloat *Q_i = Q->get_Q(i,l);
-				float64_t alpha_i = alpha[i];
-				for(j=active_size;j<l;j++)
-					G[j] += alpha_i * Q_i[j];
+				float64_t sum = 0;
+				for(int32_t c=0;c<nr_fetched;c++)
+					sum += alpha[free_set[f+c]] * Q_batch[c][j];
+				G[j] += sum;
 			}
+			f += nr_fetched;
+		}
 	}
+
+	SG_FREE(Q_batch);
+	SG_FREE(free_set);
 }
 
 void Solver::Solve(
@@ -479,7 +579,6 @@ void Solver::Solve(
 	// initialize gradient
 	CTime start_time;
 	{
-		auto pb = progress(range(l));
 		G = SG_MALLOC(float64_t, l);
 		G_bar = SG_MALLOC(float64_t, l);
 		int32_t i;
@@ -490,22 +589,43 @@ void Solver::Solve(
 		}
 		SG_SINFO("Computing gradient for initial set of non-zero alphas\n")
 		//CMath::display_vector(alpha, l, "alphas");
-		for (i = 0; i < l && !cancel_computation(); i++)
-		{
+		int32_t *nonzero_set = SG_MALLOC(int32_t, l);
+		const Qfloat **Q_batch = SG_MALLOC(const Qfloat*, l);
+		int32_t nr_nonzero = 0;
+		for(i=0;i<l;i++)
 			if(!is_lower_bound(i))
+				nonzero_set[nr_nonzero++] = i;
+
+		// columns are fetched in batches that fit into the kernel cache
+		auto pb = progress(range(nr_nonzero));
+		for (i = 0; i < nr_nonzero && !cancel_computation();)
+		{
+			int32_t nr_fetched = Q->get_Q_batch(
+				&nonzero_set[i], nr_nonzero-i, l, Q_batch);
+
+			#pragma omp parallel for
+			for(int32_t j=0;j<l;j++)
 			{
-				const Qfloat *Q_i = Q->get_Q(i,l);
-				float64_t alpha_i = alpha[i];
-				int32_t j;
-				for(j=0;j<l;j++)
-					G[j] += alpha_i*Q_i[j];
-				if(is_upper_bound(i))
-					for(j=0;j<l;j++)
-						G_bar[j] += get_C(i) * Q_i[j];
+				float64_t g = 0;
+				float64_t g_bar = 0;
+				for(int32_t c=0;c<nr_fetched;c++)
+				{
+					int32_t k = nonzero_set[i+c];
+					g += alpha[k]*Q_batch[c][j];
+					if(is_upper_bound(k))
+						g_bar += get_C(k) * Q_batch[c][j];
+				}
+				G[j] += g;
+				G_bar[j] += g_bar;
 			}
-			pb.print_progress();
+
+			i += nr_fetched;
+			for(int32_t c=0;c<nr_fetched;c++)
+				pb.print_progress();
 		}
 		pb.complete();
+		SG_FREE(Q_batch);
+		SG_FREE(nonzero_set);
 	}
 
 	// optimization step
@@ -549,8 +669,13 @@ void Solver::Solve(
 
 		// update alpha[i] and alpha[j], handle bounds carefully
 
-		const Qfloat *Q_i = Q->get_Q(i,active_size);
-		const Qfloat *Q_j = Q->get_Q(j,active_size);
+		// both columns of the working set are computed together
+		const Qfloat *Q_ij[2];
+		int32_t working_set[2] = {i, j};
+		if (Q->get_Q_batch(working_set, 2, active_size, Q_ij) < 2)
+			Q_ij[1] = Q->get_Q(j,active_size);
+		const Qfloat *Q_i = Q_ij[0];
+		const Qfloat *Q_j = Q_ij[1];
 
 		float64_t C_i = get_C(i);
 		float64_t C_j = get_C(j);
@@ -670,6 +795,7 @@ void Solver::Solve(
 		float64_t delta_alpha_i = alpha[i] - old_alpha_i;
 		float64_t delta_alpha_j = alpha[j] - old_alpha_j;
 
+		#pragma omp parallel for if (active_size >= MIN_PARALLEL_SIZE)
 		for(int32_t k=0;k<active_size;k++)
 		{
 			G[k] += Q_i[k]*delta_alpha_i + Q_j[k]*delta_alpha_j;
@@ -1305,17 +1431,31 @@ public:
 		{
 			compute_Q_parallel(data, NULL, i, start, len);
 
-			for(int32_t j=start;j<len;j++)
-			{
-				if (y[i]==y[j])
-					data[j] *= (factor*(nr_class-1));
-				else
-					data[j] *= (-factor);
-			}
+			scale_Q(i, data, start, len);
 		}
 		return data;
 	}
 
+	int32_t get_Q_batch(
+		const int32_t* columns, int32_t n, int32_t len, const Qfloat** data) const
+	{
+		n = compute_Q_batch_parallel(cache, columns, n, len, data, NULL);
+		for(int32_t c=0;c<n;c++)
+			scale_Q(columns[c], const_cast<Qfloat*>(data[c]), batch_start[c], len);
+		return n;
+	}
+
+	inline void scale_Q(int32_t i, Qfloat* data, int32_t start, int32_t len) const
+	{
+		for(int32_t j=start;j<len;j++)
+		{
+			if (y[i]==y[j])
+				data[j] *= (factor*(nr_class-1));
+			else
+				data[j] *= (-factor);
+		}
+	}
+
 	inline Qfloat get_orig_Qij(Qfloat Q, int32_t i, int32_t j)
 	{
 		if (y[i]==y[j])
@@ -1685,6 +1825,12 @@ public:
 		return data;
 	}
 
+	int32_t get_Q_batch(
+		const int32_t* columns, int32_t n, int32_t len, const Qfloat** data) const
+	{
+		return compute_Q_batch_parallel(cache, columns, n, len, data, y);
+	}
+
 	Qfloat *get_QD() const
 	{
 		return QD;
@@ -1733,6 +1879,12 @@ public:
 		return data;
 	}
 
+	int32_t get_Q_batch(
+		const int32_t* columns, int32_t n, int32_t len, const Qfloat** data) const
+	{
+		return compute_Q_batch_parallel(cache, columns, n, len, data, NULL);
+	}
+
 	Qfloat *get_QD() const
 	{
 		return QD;
@@ -2556,6 +2708,28 @@ void svm_destroy_param(svm_parameter* param)
 	SG_FREE(param->weight);
 }
 
+void svm_get_Q_columns(
+	const svm_problem *prob, const svm_parameter *param, int32_t warm_len,
+	const int32_t *columns, int32_t num_columns, int32_t len, float64_t *Q)
+{
+	ONE_CLASS_Q kernel_Q(*prob, *param);
+
+	for(int32_t i=0;i<prob->l && warm_len>0;i++)
+		kernel_Q.get_Q(i, warm_len);
+
+	const Qfloat **Q_batch = SG_MALLOC(const Qfloat*, num_columns);
+	for(int32_t c=0;c<num_columns;)
+	{
+		int32_t nr_fetched = kernel_Q.get_Q_batch(
+			&columns[c], num_columns-c, len, Q_batch);
+		for(int32_t b=0;b<nr_fetched;b++)
+			for(int32_t j=0;j<len;j++)
+				Q[int64_t(c+b)*len+j] = Q_batch[b][j];
+		c += nr_fetched;
+	}
+	SG_FREE(Q_batch);
+}
+
 const char *svm_check_parameter(
 	const svm_problem *prob, const svm_parameter *param)
 {
@@ -171,6 +171,24 @@ float64_t svm_predict(const struct svm_model *model, const struct svm_node *x);
 void svm_destroy_model(struct svm_model *model);
 
 const char *svm_check_parameter(const struct svm_problem *prob, const struct svm_parameter *param);
+
+/** Fetches columns of the one-class Q matrix, i.e. of the kernel matrix,
+ * through the kernel cache the way the solver does. First [0,warm_len) of
+ * all columns is requested one column at a time, then [0,len) of the given
+ * columns in batches. Only meant for testing the cache.
+ *
+ * @param prob problem, only l and x are used
+ * @param param parameters, only kernel and cache_size are used
+ * @param warm_len length requested for every column beforehand, 0 for none
+ * @param columns columns to fetch in batches
+ * @param num_columns number of columns
+ * @param len number of rows to fetch of every column
+ * @param Q len x num_columns output matrix
+ */
+void svm_get_Q_columns(
+	const struct svm_problem *prob, const struct svm_parameter *param,
+	int32_t warm_len, const int32_t *columns, int32_t num_columns,
+	int32_t len, float64_t *Q);
 }
 #endif /* _LIBSVM_H */
 
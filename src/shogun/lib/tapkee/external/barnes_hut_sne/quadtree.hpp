@@ -69,8 +69,6 @@ class QuadTree
 	static const int QT_NO_DIMS = 2;
 	static const int QT_NODE_CAPACITY = 1;
 
-	// A buffer we use when doing force computations
-	double buff[QT_NO_DIMS];
 
 	// Properties of this node in the tree
 	QuadTree* parent;
@@ -320,6 +318,7 @@ public:
 
 		// Compute distance between point and center-of-mass
 		double D = .0;
+		double buff[QT_NO_DIMS];
 		int ind = point_index * QT_NO_DIMS;
 		for(int d = 0; d < QT_NO_DIMS; d++) buff[d]  = data[ind + d];
 		for(int d = 0; d < QT_NO_DIMS; d++) buff[d] -= center_of_mass[d];
@@ -344,13 +343,15 @@ public:
 		}
 	}
 
-	// Computes edge forces
+	// Computes edge forces, in parallel over the rows of P
 	void computeEdgeForces(int* row_P, int* col_P, double* val_P, int N, double* pos_f)
 	{
 		// Loop over all edges in the graph
-		int ind1, ind2;
-		double D;
+#pragma omp parallel for schedule(dynamic,256)
 		for(int n = 0; n < N; n++) {
+			int ind1, ind2;
+			double D;
+			double buff[QT_NO_DIMS];
 			ind1 = n * QT_NO_DIMS;
 			for(int i = row_P[n]; i < row_P[n + 1]; i++) {
 
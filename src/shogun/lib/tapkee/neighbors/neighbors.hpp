@@ -154,16 +154,18 @@ Neighbors find_neighbors_vptree_impl(const RandomAccessIterator& begin, const Ra
 {
 	timed_context context("VP-Tree based neighbors search");
 
-	Neighbors neighbors;
-	neighbors.reserve(end-begin);
+	const IndexType n_vectors = end-begin;
+	Neighbors neighbors(n_vectors);
 
 	VantagePointTree<RandomAccessIterator,Callback> tree(begin,end,callback);
 
-	for (RandomAccessIterator i=begin; i!=end; ++i)
+	// searches only read the tree
+#pragma omp parallel for schedule(dynamic,64)
+	for (IndexType i=0; i<n_vectors; ++i)
 	{
-		LocalNeighbors local_neighbors = tree.search(i,k+1);
-		std::remove(local_neighbors.begin(),local_neighbors.end(),i-begin);
-		neighbors.push_back(local_neighbors);
+		LocalNeighbors local_neighbors = tree.search(begin+i,k+1);
+		std::remove(local_neighbors.begin(),local_neighbors.end(),i);
+		neighbors[i] = local_neighbors;
 	}
 
 	return neighbors;
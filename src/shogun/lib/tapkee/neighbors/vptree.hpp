@@ -68,7 +68,7 @@ public:
 
 	// Default constructor
 	VantagePointTree(RandomAccessIterator b, RandomAccessIterator e, DistanceCallback c) :
-		begin(b), items(), callback(c), tau(0.0), root(0)
+		begin(b), items(), callback(c), root(0)
 	{
 		items.reserve(e-b);
 		for (RandomAccessIterator i=b; i!=e; ++i)
@@ -82,7 +82,8 @@ public:
 		delete root;
 	}
 
-	// Function that uses the tree to find the k nearest neighbors of target
+	// Function that uses the tree to find the k nearest neighbors of target,
+	// can be called concurrently from several threads
 	std::vector<IndexType> search(const RandomAccessIterator& target, int k)
 	{
 		std::vector<IndexType> results;
@@ -90,10 +91,10 @@ public:
 		std::priority_queue<HeapItem> heap;
 
 		// Variable that tracks the distance to the farthest point in our results
-		tau = std::numeric_limits<double>::max();
+		double tau = std::numeric_limits<double>::max();
 
 		// Perform the searcg
-		search(root, target, k, heap);
+		search(root, target, k, heap, tau);
 
 		// Gather final results
 		results.reserve(k);
@@ -112,7 +113,6 @@ private:
 	RandomAccessIterator begin;
 	std::vector<RandomAccessIterator> items;
 	DistanceCallback callback;
-	double tau;
 
 	struct Node
 	{
@@ -177,7 +177,7 @@ private:
 		return node;
 	}
 
-	void search(Node* node, const RandomAccessIterator& target, int k, std::priority_queue<HeapItem>& heap)
+	void search(Node* node, const RandomAccessIterator& target, int k, std::priority_queue<HeapItem>& heap, double& tau)
 	{
 		if (node == NULL)
 			return;
@@ -203,18 +203,18 @@ private:
 		if (distance < node->threshold)
 		{
 			if ((distance - tau) <= node->threshold)
-				search(node->left, target, k, heap);
+				search(node->left, target, k, heap, tau);
 
 			if ((distance + tau) >= node->threshold)
-				search(node->right, target, k, heap);
+				search(node->right, target, k, heap, tau);
 		}
 		else
 		{
 			if ((distance + tau) >= node->threshold)
-				search(node->right, target, k, heap);
+				search(node->right, target, k, heap, tau);
 
 			if ((distance - tau) <= node->threshold)
-				search(node->left, target, k, heap);
+				search(node->left, target, k, heap, tau);
 		}
 	}
 };
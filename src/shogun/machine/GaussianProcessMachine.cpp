@@ -60,6 +60,12 @@ CGaussianProcessMachine::CGaussianProcessMachine(CInference* method)
 void CGaussianProcessMachine::init()
 {
 	m_method=NULL;
+	m_cache_hash=0;
+	m_cache_kernel=NULL;
+	m_cache_features=NULL;
+	m_cache_solved_factor=false;
+	m_cache_data=NULL;
+	m_cache_data_hash=0;
 
 	SG_ADD((CSGObject**) &m_method, "inference_method", "Inference method",
 	    MS_AVAILABLE);
@@ -67,55 +73,140 @@ void CGaussianProcessMachine::init()
 
 CGaussianProcessMachine::~CGaussianProcessMachine()
 {
+	free_prediction_cache();
 	SG_UNREF(m_method);
 }
 
-SGVector<float64_t> CGaussianProcessMachine::get_posterior_means(CFeatures* data)
+/** number of testing vectors handled by one thread at once */
+static const index_t prediction_block_size=256;
+
+void CGaussianProcessMachine::clear_prediction_cache()
 {
-	REQUIRE(m_method, "Inference method should not be NULL\n")
+	std::lock_guard<std::mutex> lock(m_cache_mutex);
+	free_prediction_cache();
+}
+
+void CGaussianProcessMachine::free_prediction_cache()
+{
+	SG_UNREF(m_cache_kernel);
+	SG_UNREF(m_cache_features);
+	SG_UNREF(m_cache_data);
+	m_cache_kernel=NULL;
+	m_cache_features=NULL;
+	m_cache_data=NULL;
+	m_cache_alpha=SGVector<float64_t>();
+	m_cache_factor=SGMatrix<float64_t>();
+	m_cache_ks=SGMatrix<float64_t>();
+	m_cache_data_hash=0;
+	m_cache_hash=0;
+	m_cache_solved_factor=false;
+}
 
-	CFeatures* feat;
+void CGaussianProcessMachine::update_prediction_cache(bool with_variance_factor)
+{
+	REQUIRE(m_method, "Inference method should not be NULL\n")
 
 	CSingleSparseInference* sparse_method=
 		dynamic_cast<CSingleSparseInference *>(m_method);
-	// use inducing features for sparse inference method
 	if (sparse_method)
-	{
 		sparse_method->optimize_inducing_features();
-		feat=sparse_method->get_inducing_features();
+
+	// updates the inference method if its parameters have changed, its
+	// parameter hash then identifies the posterior
+	SGVector<float64_t> alpha=m_method->get_alpha();
+	uint32_t hash=m_method->m_hash;
+
+	if (!m_cache_kernel || hash!=m_cache_hash)
+	{
+		free_prediction_cache();
+
+		// use inducing features for sparse inference method
+		if (sparse_method)
+			m_cache_features=sparse_method->get_inducing_features();
+		else
+			m_cache_features=m_method->get_features();
+
+		CKernel* training_kernel=m_method->get_kernel();
+		m_cache_kernel=training_kernel->clone()->as<CKernel>();
+		SG_UNREF(training_kernel);
+
+		m_cache_alpha=alpha;
+		m_cache_hash=hash;
 	}
-	else
-		feat=m_method->get_features();
 
-	// get kernel and compute kernel matrix: K(feat, data)*scale^2
-	CKernel* training_kernel=m_method->get_kernel();
-	CKernel* kernel = training_kernel->clone()->as<CKernel>();
-	SG_UNREF(training_kernel);
+	if (!with_variance_factor || m_cache_factor.num_rows)
+		return;
 
-	kernel->init(feat, data);
+	SGMatrix<float64_t> L=m_method->get_cholesky();
+	Map<MatrixXd> eigen_L(L.matrix, L.num_rows, L.num_cols);
 
-	// get kernel matrix and create eigen representation of it
-	SGMatrix<float64_t> k_trts=kernel->get_kernel_matrix();
-	Map<MatrixXd> eigen_Ks(k_trts.matrix, k_trts.num_rows, k_trts.num_cols);
+	if (eigen_L.isUpperTriangular() && !sparse_method &&
+		m_cache_alpha.vlen==L.num_rows)
+	{
+		// binary case: V=inv(L')*diag(sW)*Ks, so that the variances only
+		// need a matrix product instead of a triangular solve per call
+		SGVector<float64_t> sW=m_method->get_diagonal_vector();
+		Map<VectorXd> eigen_sW(sW.vector, sW.vlen);
+
+		m_cache_factor=SGMatrix<float64_t>(L.num_rows, L.num_cols);
+		Map<MatrixXd> eigen_factor(m_cache_factor.matrix,
+			m_cache_factor.num_rows, m_cache_factor.num_cols);
+		eigen_factor=eigen_L.triangularView<Upper>().adjoint().solve(
+			MatrixXd(eigen_sW.asDiagonal()));
+		m_cache_solved_factor=true;
+	}
+	else
+	{
+		m_cache_factor=L;
+		m_cache_solved_factor=false;
+	}
+}
+
+SGMatrix<float64_t> CGaussianProcessMachine::get_cross_kernel(CFeatures* data)
+{
+	// the hash is kept here, the parameter hash stored in data belongs to
+	// the caller
+	uint32_t data_hash=data->compute_parameter_hash();
+	if (m_cache_ks.num_rows && data==m_cache_data &&
+		data_hash==m_cache_data_hash)
+		return m_cache_ks;
 
-	// compute Ks=Ks*scale^2
+	// compute kernel matrix: K(feat, data)*scale^2
+	m_cache_kernel->init(m_cache_features, data);
+	m_cache_ks=m_cache_kernel->get_kernel_matrix();
+	Map<MatrixXd> eigen_Ks(m_cache_ks.matrix, m_cache_ks.num_rows,
+		m_cache_ks.num_cols);
 	eigen_Ks*=CMath::sq(m_method->get_scale());
 
-	// cleanup
-	SG_UNREF(feat);
-	SG_UNREF(kernel);
+	SG_REF(data);
+	SG_UNREF(m_cache_data);
+	m_cache_data=data;
+	m_cache_data_hash=data_hash;
 
-	// get alpha and create eigen representation of it
-	SGVector<float64_t> alpha=m_method->get_alpha();
-	Map<VectorXd> eigen_alpha(alpha.vector, alpha.vlen);
+	return m_cache_ks;
+}
+
+SGVector<float64_t> CGaussianProcessMachine::get_posterior_means(CFeatures* data)
+{
+	REQUIRE(m_method, "Inference method should not be NULL\n")
+
+	std::lock_guard<std::mutex> lock(m_cache_mutex);
+	SG_REF(data);
+	update_prediction_cache(false);
+
+	SGMatrix<float64_t> k_trts=get_cross_kernel(data);
+	Map<MatrixXd> eigen_Ks(k_trts.matrix, k_trts.num_rows, k_trts.num_cols);
+
+	Map<VectorXd> eigen_alpha(m_cache_alpha.vector, m_cache_alpha.vlen);
 
 	// get mean and create eigen representation of it
 	CMeanFunction* mean_function=m_method->get_mean();
 	SGVector<float64_t> mean=mean_function->get_mean_vector(data);
 	Map<VectorXd> eigen_mean(mean.vector, mean.vlen);
 	SG_UNREF(mean_function);
+	SG_UNREF(data);
 
-	const index_t C=alpha.vlen/k_trts.num_rows;
+	const index_t C=m_cache_alpha.vlen/k_trts.num_rows;
 	const index_t n=k_trts.num_rows;
 	const index_t m=k_trts.num_cols;
 
@@ -123,8 +214,16 @@ SGVector<float64_t> CGaussianProcessMachine::get_posterior_means(CFeatures* data
 	SGVector<float64_t> mu(C*m);
 	Map<MatrixXd> eigen_mu_matrix(mu.vector,C,m);
 
-	for(index_t bl=0; bl<C; bl++)
-		eigen_mu_matrix.block(bl,0,1,m)=(eigen_Ks.adjoint()*eigen_alpha.block(bl*n,0,n,1)+eigen_mean).transpose();
+	const index_t num_blocks=(m+prediction_block_size-1)/prediction_block_size;
+#pragma omp parallel for
+	for (index_t b=0; b<num_blocks; b++)
+	{
+		const index_t start=b*prediction_block_size;
+		const index_t len=CMath::min(prediction_block_size, m-start);
+		for(index_t bl=0; bl<C; bl++)
+			eigen_mu_matrix.block(bl,start,1,len)=(eigen_Ks.middleCols(start,len).adjoint()*
+				eigen_alpha.segment(bl*n,n)+eigen_mean.segment(start,len)).transpose();
+	}
 
 	return mu;
 }
@@ -134,119 +233,96 @@ SGVector<float64_t> CGaussianProcessMachine::get_posterior_variances(
 {
 	REQUIRE(m_method, "Inference method should not be NULL\n")
 
-	CFeatures* feat;
-
-	bool is_sparse=false;
-	CSingleSparseInference* sparse_method=
-		dynamic_cast<CSingleSparseInference *>(m_method);
-	// use inducing features for sparse inference method
-	if (sparse_method)
-	{
-		sparse_method->optimize_inducing_features();
-		feat=sparse_method->get_inducing_features();
-		is_sparse=true;
-	}
-	else
-		feat=m_method->get_features();
-
+	std::lock_guard<std::mutex> lock(m_cache_mutex);
 	SG_REF(data);
+	update_prediction_cache(true);
 
-	// get kernel and compute kernel matrix: K(data, data)*scale^2
-	CKernel* training_kernel=m_method->get_kernel();
-	CKernel* kernel = training_kernel->clone()->as<CKernel>();
-	SG_UNREF(training_kernel);
-	kernel->init(data, data);
-
-	// get kernel matrix and create eigen representation of it
-	SGVector<float64_t> k_tsts=kernel->get_kernel_diagonal();
+	// get kernel diagonal: K(data, data)*scale^2
+	m_cache_kernel->init(data, data);
+	SGVector<float64_t> k_tsts=m_cache_kernel->get_kernel_diagonal();
 	Map<VectorXd> eigen_Kss_diag(k_tsts.vector, k_tsts.vlen);
-
-	// compute Kss=Kss*scale^2
 	eigen_Kss_diag*=CMath::sq(m_method->get_scale());
 
-	// compute kernel matrix: K(feat, data)*scale^2
-	kernel->init(feat, data);
-
-	// get kernel matrix and create eigen representation of it
-	SGMatrix<float64_t> k_trts=kernel->get_kernel_matrix();
+	SGMatrix<float64_t> k_trts=get_cross_kernel(data);
 	Map<MatrixXd> eigen_Ks(k_trts.matrix, k_trts.num_rows, k_trts.num_cols);
-
-	// compute Ks=Ks*scale^2
-	eigen_Ks*=CMath::sq(m_method->get_scale());
-
-	// cleanup
-	SG_UNREF(kernel);
-	SG_UNREF(feat);
 	SG_UNREF(data);
 
-	// get shogun representation of cholesky and create eigen representation
-	SGMatrix<float64_t> L=m_method->get_cholesky();
-	Map<MatrixXd> eigen_L(L.matrix, L.num_rows, L.num_cols);
+	Map<MatrixXd> eigen_L(m_cache_factor.matrix, m_cache_factor.num_rows,
+		m_cache_factor.num_cols);
 
-	SGVector<float64_t> alpha=m_method->get_alpha();
 	const index_t n=k_trts.num_rows;
 	const index_t m=k_tsts.vlen;
-	const index_t C=alpha.vlen/n;
+	const index_t C=m_cache_alpha.vlen/n;
 	// result variance vector
 	SGVector<float64_t> s2(m*C*C);
 	Map<VectorXd> eigen_s2(s2.vector, s2.vlen);
 
-	if (eigen_L.isUpperTriangular() && !is_sparse)
+	const index_t num_blocks=(m+prediction_block_size-1)/prediction_block_size;
+
+	if (m_cache_solved_factor)
 	{
-		if (alpha.vlen==L.num_rows)
+		//binary case
+		// V=inv(L')*diag(sW)*Ks and compute V.^2
+#pragma omp parallel for
+		for (index_t b=0; b<num_blocks; b++)
 		{
-			//binary case
-			// get shogun of diagonal sigma vector and create eigen representation
-			SGVector<float64_t> sW=m_method->get_diagonal_vector();
-			Map<VectorXd> eigen_sW(sW.vector, sW.vlen);
-			// solve L' * V = sW * Ks and compute V.^2
-			MatrixXd eigen_V=eigen_L.triangularView<Upper>().adjoint().solve(
-				eigen_sW.asDiagonal()*eigen_Ks);
-			MatrixXd eigen_sV=eigen_V.cwiseProduct(eigen_V);
-
-			eigen_s2=eigen_Kss_diag-eigen_sV.colwise().sum().adjoint();
+			const index_t start=b*prediction_block_size;
+			const index_t len=CMath::min(prediction_block_size, m-start);
+			MatrixXd eigen_V=eigen_L.triangularView<Lower>()*
+				eigen_Ks.middleCols(start,len);
+			eigen_s2.segment(start,len)=eigen_Kss_diag.segment(start,len)-
+				eigen_V.colwise().squaredNorm().adjoint();
 		}
-		else
+	}
+	else if (eigen_L.isUpperTriangular() &&
+		!dynamic_cast<CSingleSparseInference *>(m_method))
+	{
+		if (m_method->supports_multiclass())
 		{
-			if (m_method->supports_multiclass())
+			//multiclass case
+			//see the reference code of the gist link, which is based on the algorithm 3.4 of the GPML textbook
+			Map<MatrixXd> &eigen_M=eigen_L;
+			eigen_s2.fill(0);
+
+			SGMatrix<float64_t> E=m_method->get_multiclass_E();
+			Map<MatrixXd> eigen_E(E.matrix, E.num_rows, E.num_cols);
+			ASSERT(E.num_cols==m_cache_alpha.vlen);
+			for(index_t bl_i=0; bl_i<C; bl_i++)
 			{
-				//multiclass case
-				//see the reference code of the gist link, which is based on the algorithm 3.4 of the GPML textbook
-				Map<MatrixXd> &eigen_M=eigen_L;
-				eigen_s2.fill(0);
-
-				SGMatrix<float64_t> E=m_method->get_multiclass_E();
-				Map<MatrixXd> eigen_E(E.matrix, E.num_rows, E.num_cols);
-				ASSERT(E.num_cols==alpha.vlen);
-				for(index_t bl_i=0; bl_i<C; bl_i++)
+				//n by m
+				MatrixXd bi=eigen_E.block(0,bl_i*n,n,n)*eigen_Ks;
+				MatrixXd c_cav=eigen_M.triangularView<Upper>().adjoint().solve(bi);
+				c_cav=eigen_M.triangularView<Upper>().solve(c_cav);
+
+				for(index_t bl_j=0; bl_j<C; bl_j++)
 				{
-					//n by m
-					MatrixXd bi=eigen_E.block(0,bl_i*n,n,n)*eigen_Ks;
-					MatrixXd c_cav=eigen_M.triangularView<Upper>().adjoint().solve(bi);
-					c_cav=eigen_M.triangularView<Upper>().solve(c_cav);
-
-					for(index_t bl_j=0; bl_j<C; bl_j++)
-					{
-						MatrixXd bj=eigen_E.block(0,bl_j*n,n,n)*eigen_Ks;
-						for (index_t idx_m=0; idx_m<m; idx_m++)
-							eigen_s2[bl_j+(bl_i+idx_m*C)*C]=(bj.block(0,idx_m,n,1).array()*c_cav.block(0,idx_m,n,1).array()).sum();
-					}
+					MatrixXd bj=eigen_E.block(0,bl_j*n,n,n)*eigen_Ks;
 					for (index_t idx_m=0; idx_m<m; idx_m++)
-						eigen_s2[bl_i+(bl_i+idx_m*C)*C]+=eigen_Kss_diag(idx_m)-(eigen_Ks.block(0,idx_m,n,1).array()*bi.block(0,idx_m,n,1).array()).sum();
+						eigen_s2[bl_j+(bl_i+idx_m*C)*C]=(bj.block(0,idx_m,n,1).array()*c_cav.block(0,idx_m,n,1).array()).sum();
 				}
-			}
-			else
-			{
-				SG_ERROR("Unsupported inference method!\n");
-				return s2;
+				for (index_t idx_m=0; idx_m<m; idx_m++)
+					eigen_s2[bl_i+(bl_i+idx_m*C)*C]+=eigen_Kss_diag(idx_m)-(eigen_Ks.block(0,idx_m,n,1).array()*bi.block(0,idx_m,n,1).array()).sum();
 			}
 		}
+		else
+		{
+			SG_ERROR("Unsupported inference method!\n");
+			return s2;
+		}
 	}
 	else
 	{
 		// M = Ks .* (L * Ks)
-		MatrixXd eigen_M=eigen_Ks.cwiseProduct(eigen_L*eigen_Ks);
-		eigen_s2=eigen_Kss_diag+eigen_M.colwise().sum().adjoint();
+#pragma omp parallel for
+		for (index_t b=0; b<num_blocks; b++)
+		{
+			const index_t start=b*prediction_block_size;
+			const index_t len=CMath::min(prediction_block_size, m-start);
+			MatrixXd eigen_M=eigen_Ks.middleCols(start,len).cwiseProduct(
+				eigen_L*eigen_Ks.middleCols(start,len));
+			eigen_s2.segment(start,len)=eigen_Kss_diag.segment(start,len)+
+				eigen_M.colwise().sum().adjoint();
+		}
 	}
 
 	return s2;
@@ -42,6 +42,8 @@
 #include <shogun/machine/Machine.h>
 #include <shogun/machine/gp/Inference.h>
 
+#include <mutex>
+
 
 namespace shogun
 {
@@ -116,6 +118,7 @@ public:
 		SG_REF(method);
 		SG_UNREF(m_method);
 		m_method=method;
+		clear_prediction_cache();
 	}
 
 	/** set training labels
@@ -135,12 +138,63 @@ public:
 	 */
 	virtual void store_model_features() { }
 
+	/** drops the cached prediction state, it is rebuilt on the next call of
+	 * get_posterior_means() or get_posterior_variances()
+	 */
+	void clear_prediction_cache();
+
 private:
 	void init();
 
+protected:
+	/** drops the cached prediction state, the caller has to hold
+	 * m_cache_mutex
+	 */
+	void free_prediction_cache();
+
+	/** makes sure the cached alpha, training (or inducing) features and
+	 * kernel belong to the current state of the inference method
+	 *
+	 * @param with_variance_factor whether the factor used for variances is
+	 * needed as well
+	 */
+	void update_prediction_cache(bool with_variance_factor);
+
+	/** returns the cross kernel matrix K(feat, data)*scale^2, which is
+	 * reused as long as the data and the inference method do not change
+	 *
+	 * @param data testing features
+	 * @return cross kernel matrix
+	 */
+	SGMatrix<float64_t> get_cross_kernel(CFeatures* data);
+
 protected:
 	/** inference method */
 	CInference* m_method;
+
+	/** hash of the inference method the cache was built for */
+	uint32_t m_cache_hash;
+	/** copy of the kernel of the inference method used for predictions */
+	CKernel* m_cache_kernel;
+	/** training or inducing features the predictions are based on */
+	CFeatures* m_cache_features;
+	/** alpha of the inference method */
+	SGVector<float64_t> m_cache_alpha;
+	/** factor used for variances, either the lower triangular
+	 * inv(L')*diag(sW) if m_cache_solved_factor is set, or the Cholesky
+	 * matrix otherwise
+	 */
+	SGMatrix<float64_t> m_cache_factor;
+	/** whether m_cache_factor is the solved triangular factor */
+	bool m_cache_solved_factor;
+	/** testing features of the cached cross kernel matrix */
+	CFeatures* m_cache_data;
+	/** parameter hash of m_cache_data when the cross kernel was computed */
+	uint32_t m_cache_data_hash;
+	/** cached cross kernel matrix K(feat, data)*scale^2 */
+	SGMatrix<float64_t> m_cache_ks;
+	/** serializes predictions, since they all use and update the cache */
+	std::mutex m_cache_mutex;
 };
 }
 #endif /* _GAUSSIANPROCESSMACHINE_H_ */
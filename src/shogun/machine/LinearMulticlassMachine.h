@@ -162,6 +162,52 @@ class CLinearMulticlassMachine : public CMulticlassMachine
 			m_features->remove_subset();
 		}
 
+		/** clone the base linear machine for one binary subproblem, with
+		 * a shallow subset copy of the features if a subset is given
+		 *
+		 * @param subset subset indices of the subproblem, may be empty
+		 * @return new machine, or NULL if features can't be shallow copied
+		 */
+		virtual CMachine* create_task_machine(SGVector<index_t> subset)
+		{
+			CDotFeatures* features=m_features;
+			if (subset.vlen)
+			{
+				if (m_features->get_feature_class()!=C_DENSE)
+					return NULL;
+
+				features=(CDotFeatures*)m_features->shallow_subset_copy();
+				features->add_subset(subset);
+			}
+			else
+				SG_REF(features);
+
+			/* detach data so that cloning only copies the model parameters */
+			CLinearMachine* machine=(CLinearMachine*)m_machine;
+			CLabels* labels=machine->get_labels();
+			CDotFeatures* machine_features=machine->get_features();
+			machine->set_labels(NULL);
+			machine->set_features(NULL);
+
+			CLinearMachine* task=(CLinearMachine*)machine->clone();
+
+			machine->set_labels(labels);
+			machine->set_features(machine_features);
+			SG_UNREF(labels);
+			SG_UNREF(machine_features);
+
+			task->set_features(features);
+			SG_UNREF(features);
+
+			return task;
+		}
+
+		/** linear submachines only read the shared features */
+		virtual bool supports_parallel_apply() const
+		{
+			return true;
+		}
+
 		/** Stores feature data of underlying model. Does nothing because
 		 * Linear machines store the normal vector of the separating hyperplane
 		 * and therefore the model anyway
@@ -298,6 +298,15 @@ class CMachine : public CStoppableSGObject
 		/** @return whether this machine supports locking */
 		virtual bool supports_locking() const { return false; }
 
+		/** whether training may draw from the global random number
+		 * generator. Copies of such a machine that are trained concurrently
+		 * interleave their draws, so callers training copies in parallel
+		 * fall back to serial training to keep seeded runs reproducible.
+		 *
+		 * @return true unless training is known to be deterministic
+		 */
+		virtual bool train_uses_global_random() const { return true; }
+
 		/** @return whether this machine is locked */
 		bool is_data_locked() const { return m_data_locked; }
 
@@ -6,6 +6,8 @@
  *          Evan Shelhamer, Shell Hu, Thoralf Klein, Viktor Gal
  */
 
+#include <shogun/base/Parallel.h>
+#include <shogun/base/init.h>
 #include <shogun/multiclass/MulticlassOneVsRestStrategy.h>
 #include <shogun/machine/LinearMachine.h>
 #include <shogun/machine/KernelMachine.h>
@@ -14,6 +16,8 @@
 #include <shogun/mathematics/Statistics.h>
 #include <shogun/labels/MultilabelLabels.h>
 
+#include <vector>
+
 using namespace shogun;
 
 CMulticlassMachine::CMulticlassMachine()
@@ -119,6 +123,8 @@ CMulticlassLabels* CMulticlassMachine::apply_multiclass(CFeatures* data)
 		SGVector<float64_t> As(num_machines);
 		SGVector<float64_t> Bs(num_machines);
 
+		bool parallel_apply=supports_parallel_apply();
+		#pragma omp parallel for if (parallel_apply)
 		for (int32_t i=0; i<num_machines; ++i)
 		{
 			outputs[i] = (CBinaryLabels*) get_submachine_outputs(i);
@@ -134,38 +140,44 @@ CMulticlassLabels* CMulticlassMachine::apply_multiclass(CFeatures* data)
 				outputs[i]->scores_to_probabilities(0,0);
 		}
 
-		SGVector<float64_t> output_for_i(num_machines);
-		SGVector<float64_t> r_output_for_i(num_machines);
-		if (heuris!=PROB_HEURIS_NONE)
-			r_output_for_i.resize_vector(num_classes);
-
-		for (int32_t i=0; i<num_vectors; i++)
+		// strategies only read their state when deciding, so each thread
+		// decides a block of vectors with its own buffers
+		#pragma omp parallel
 		{
-			for (int32_t j=0; j<num_machines; j++)
-				output_for_i[j] = outputs[j]->get_value(i);
+			SGVector<float64_t> output_for_i(num_machines);
+			SGVector<float64_t> r_output_for_i(num_machines);
+			if (heuris!=PROB_HEURIS_NONE)
+				r_output_for_i.resize_vector(num_classes);
 
-			if (heuris==PROB_HEURIS_NONE)
-			{
-				r_output_for_i = output_for_i;
-			}
-			else
+			#pragma omp for
+			for (int32_t i=0; i<num_vectors; i++)
 			{
-				if (heuris==OVA_SOFTMAX)
-					m_multiclass_strategy->rescale_outputs(output_for_i,As,Bs);
-				else
-					m_multiclass_strategy->rescale_outputs(output_for_i);
+				for (int32_t j=0; j<num_machines; j++)
+					output_for_i[j] = outputs[j]->get_value(i);
 
-				// only first num_classes are returned
-				for (int32_t r=0; r<num_classes; r++)
-					r_output_for_i[r] = output_for_i[r];
-
-				SG_DEBUG("%s::apply_multiclass(): sum(r_output_for_i) = %f\n",
-					get_name(), SGVector<float64_t>::sum(r_output_for_i.vector,num_classes));
+				if (heuris==PROB_HEURIS_NONE)
+				{
+					r_output_for_i = output_for_i;
+				}
+				else
+				{
+					if (heuris==OVA_SOFTMAX)
+						m_multiclass_strategy->rescale_outputs(output_for_i,As,Bs);
+					else
+						m_multiclass_strategy->rescale_outputs(output_for_i);
+
+					// only first num_classes are returned
+					for (int32_t r=0; r<num_classes; r++)
+						r_output_for_i[r] = output_for_i[r];
+
+					SG_DEBUG("%s::apply_multiclass(): sum(r_output_for_i) = %f\n",
+						get_name(), SGVector<float64_t>::sum(r_output_for_i.vector,num_classes));
+				}
+
+				// use rescaled outputs for label decision
+				result->set_label(i, m_multiclass_strategy->decide_label(r_output_for_i));
+				result->set_multiclass_confidences(i, r_output_for_i);
 			}
-
-			// use rescaled outputs for label decision
-			result->set_label(i, m_multiclass_strategy->decide_label(r_output_for_i));
-			result->set_multiclass_confidences(i, r_output_for_i);
 		}
 
 		for (int32_t i=0; i < num_machines; ++i)
@@ -247,26 +259,70 @@ bool CMulticlassMachine::train_machine(CFeatures* data)
 	SG_REF(train_labels);
 	m_machine->set_labels(train_labels);
 
+	/* Subproblems whose machine can be copied are collected in waves of
+	 * up to one per thread and trained concurrently. The others are trained
+	 * serially on the base machine, after flushing the pending wave so that
+	 * submachines are stored in the order the strategy generates them. */
+	int32_t num_threads=get_global_parallel()->get_num_threads();
+	std::vector<CMachine*> tasks;
+	auto train_tasks=[&]()
+	{
+		int32_t num_tasks=tasks.size();
+		#pragma omp parallel for
+		for (int32_t i=0; i<num_tasks; i++)
+			tasks[i]->train();
+
+		for (int32_t i=0; i<num_tasks; i++)
+		{
+			m_machines->push_back(get_machine_from_trained(tasks[i]));
+			SG_UNREF(tasks[i]);
+		}
+		tasks.clear();
+	};
+
 	m_multiclass_strategy->train_start(
 	    multiclass_labels(m_labels), train_labels);
 	while (m_multiclass_strategy->train_has_more())
 	{
 		SGVector<index_t> subset=m_multiclass_strategy->train_prepare_next();
 		if (subset.vlen)
-		{
 			train_labels->add_subset(subset);
-			add_machine_subset(subset);
+
+		CMachine* task=NULL;
+		if (num_threads>1 && !m_machine->train_uses_global_random())
+			task=create_task_machine(subset);
+
+		if (task)
+		{
+			/* the strategy overwrites train_labels for the next subproblem */
+			SGVector<float64_t> values=train_labels->get_labels();
+			if (!subset.vlen)
+				values=values.clone();
+
+			task->set_labels(new CBinaryLabels(values));
+			tasks.push_back(task);
 		}
+		else
+		{
+			train_tasks();
+
+			if (subset.vlen)
+				add_machine_subset(subset);
 
-		m_machine->train();
-		m_machines->push_back(get_machine_from_trained(m_machine));
+			m_machine->train();
+			m_machines->push_back(get_machine_from_trained(m_machine));
+
+			if (subset.vlen)
+				remove_machine_subset();
+		}
 
 		if (subset.vlen)
-		{
 			train_labels->remove_subset();
-			remove_machine_subset();
-		}
+
+		if ((int32_t)tasks.size()>=num_threads)
+			train_tasks();
 	}
+	train_tasks();
 
 	m_multiclass_strategy->train_stop();
 	SG_UNREF(train_labels);
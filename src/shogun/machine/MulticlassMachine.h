@@ -185,6 +185,34 @@ class CMulticlassMachine : public CBaseMulticlassMachine
 		/** deletes any subset set to the features of the machine */
 		virtual void remove_machine_subset() = 0;
 
+		/** create an independent copy of the base machine that trains one
+		 * binary subproblem concurrently with the others
+		 *
+		 * The returned machine must be bound to its own view of the training
+		 * features (restricted to the given subset, if any) and must not share
+		 * mutable state with the base machine. Labels are set by the caller.
+		 * Returning NULL makes the subproblem be trained serially on the base
+		 * machine, which is the default. Not called for base machines whose
+		 * training draws random numbers, see
+		 * CMachine::train_uses_global_random().
+		 *
+		 * @param subset subset indices of the subproblem, may be empty
+		 * @return new machine with one reference, or NULL
+		 */
+		virtual CMachine* create_task_machine(SGVector<index_t> subset)
+		{
+			return NULL;
+		}
+
+		/** whether the outputs of the submachines may be computed
+		 * concurrently, i.e. applying a submachine only reads the shared
+		 * features. Default is false.
+		 */
+		virtual bool supports_parallel_apply() const
+		{
+			return false;
+		}
+
 		/** whether the machine is acceptable in set_machine */
 		virtual bool is_acceptable_machine(CMachine *machine)
 		{
@@ -503,29 +503,21 @@ SGVector<float64_t> CEPInferenceMethod::get_derivative_wrt_likelihood_model(
 SGVector<float64_t> CEPInferenceMethod::get_derivative_wrt_kernel(
 		const TParameter* param)
 {
-	// create eigen representation of the matrix Q
-	Map<MatrixXd> eigen_F(m_F.matrix, m_F.num_rows, m_F.num_cols);
-
 	REQUIRE(param, "Param not set\n");
 	SGVector<float64_t> result;
 	int64_t len=const_cast<TParameter *>(param)->m_datatype.get_num_elements();
 	result=SGVector<float64_t>(len);
 
-	for (index_t i=0; i<result.vlen; i++)
-	{
-		SGMatrix<float64_t> dK;
-
-		if (result.vlen==1)
-			dK=m_kernel->get_parameter_gradient(param);
-		else
-			dK=m_kernel->get_parameter_gradient(param, i);
-
-		Map<MatrixXd> eigen_dK(dK.matrix, dK.num_rows, dK.num_cols);
+	// compute derivative wrt kernel parameter: dnlZ=-sum(F.*dK*scale^2)/2.0
+	// without forming dK for each element of the parameter
+	SGVector<float64_t> trace_products=
+		m_kernel->get_parameter_gradient_trace_product(param, m_F);
+	REQUIRE(trace_products.vlen==result.vlen, "Number of derivatives (%d) "
+		"must match the length of %s (%d)\n", trace_products.vlen,
+		param->m_name, result.vlen);
 
-		// compute derivative wrt kernel parameter: dnlZ=-sum(F.*dK*scale^2)/2.0
-		result[i]=-(eigen_F.cwiseProduct(eigen_dK)).sum();
-		result[i] *= std::exp(m_log_scale * 2.0) / 2.0;
-	}
+	for (index_t i=0; i<result.vlen; i++)
+		result[i]=-trace_products[i]*std::exp(m_log_scale * 2.0) / 2.0;
 
 	return result;
 }
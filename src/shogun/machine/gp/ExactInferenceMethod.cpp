@@ -340,29 +340,21 @@ SGVector<float64_t> CExactInferenceMethod::get_derivative_wrt_likelihood_model(
 SGVector<float64_t> CExactInferenceMethod::get_derivative_wrt_kernel(
 		const TParameter* param)
 {
-	// create eigen representation of the matrix Q
-	Map<MatrixXd> eigen_Q(m_Q.matrix, m_Q.num_rows, m_Q.num_cols);
-
 	REQUIRE(param, "Param not set\n");
 	SGVector<float64_t> result;
 	int64_t len=const_cast<TParameter *>(param)->m_datatype.get_num_elements();
 	result=SGVector<float64_t>(len);
 
-	for (index_t i=0; i<result.vlen; i++)
-	{
-		SGMatrix<float64_t> dK;
+	// compute derivative wrt kernel parameter: dnlZ=sum(Q.*dK*scale)/2.0
+	// without forming dK for each element of the parameter
+	SGVector<float64_t> trace_products=
+		m_kernel->get_parameter_gradient_trace_product(param, m_Q);
+	REQUIRE(trace_products.vlen==result.vlen, "Number of derivatives (%d) "
+		"must match the length of %s (%d)\n", trace_products.vlen,
+		param->m_name, result.vlen);
 
-		if (result.vlen==1)
-			dK=m_kernel->get_parameter_gradient(param);
-		else
-			dK=m_kernel->get_parameter_gradient(param, i);
-
-		Map<MatrixXd> eigen_dK(dK.matrix, dK.num_rows, dK.num_cols);
-
-		// compute derivative wrt kernel parameter: dnlZ=sum(Q.*dK*scale)/2.0
-		result[i]=(eigen_Q.cwiseProduct(eigen_dK)).sum();
-		result[i] *= std::exp(m_log_scale * 2.0) / 2.0;
-	}
+	for (index_t i=0; i<result.vlen; i++)
+		result[i]=trace_products[i]*std::exp(m_log_scale * 2.0) / 2.0;
 
 	return result;
 }
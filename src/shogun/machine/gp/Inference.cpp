@@ -37,6 +37,7 @@
 #include <shogun/distributions/classical/GaussianDistribution.h>
 #include <shogun/mathematics/Statistics.h>
 #include <shogun/mathematics/Math.h>
+#include <vector>
 
 using namespace shogun;
 
@@ -198,11 +199,14 @@ get_negative_log_marginal_likelihood_derivatives(CMap<TParameter*, CSGObject*>*
 
 	SG_REF(result);
 
-	#pragma omp parallel for
+	// each parameter writes its own slot, the map is filled afterwards
+	std::vector<SGVector<float64_t> > gradients(num_deriv);
+
+	#pragma omp parallel for schedule(dynamic)
 	for (index_t i=0; i<num_deriv; i++)
 	{
         CMapNode<TParameter*, CSGObject*>* node=params->get_node_ptr(i);
-        SGVector<float64_t> gradient;
+        SGVector<float64_t>& gradient=gradients[i];
 
 		if(node->data == this)
 		{
@@ -230,12 +234,11 @@ get_negative_log_marginal_likelihood_derivatives(CMap<TParameter*, CSGObject*>*
 					"likelihood wrt %s.%s", node->data->get_name(), node->key->m_name);
 		}
 
-		#pragma omp critical
-		{
-			result->add(node->key, gradient);
-		}
 	}
 
+	for (index_t i=0; i<num_deriv; i++)
+		result->add(params->get_node_ptr(i)->key, gradients[i]);
+
 	return result;
 }
 
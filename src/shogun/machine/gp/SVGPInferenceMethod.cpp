@@ -0,0 +1,745 @@
+/*
+ * This software is distributed under BSD 3-clause license (see LICENSE file).
+ *
+ * The reference paper is
+ * Hensman, James, Nicolo Fusi, and Neil D. Lawrence.
+ * "Gaussian processes for big data."
+ * Uncertainty in Artificial Intelligence. 2013.
+ */
+
+#include <shogun/machine/gp/SVGPInferenceMethod.h>
+#include <shogun/machine/gp/GaussianLikelihood.h>
+#include <shogun/mathematics/Math.h>
+#include <shogun/labels/RegressionLabels.h>
+#include <shogun/mathematics/eigen3.h>
+#include <shogun/optimization/FirstOrderStochasticCostFunction.h>
+#include <shogun/optimization/SGDMinimizer.h>
+#include <shogun/optimization/AdamUpdater.h>
+
+using namespace Eigen;
+
+namespace shogun
+{
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+/** Wrapped cost function used for the stochastic minimizer, each sample is
+ * a mini-batch of a random permutation of the training data
+ */
+class SVGPInferenceCostFunction: public FirstOrderStochasticCostFunction
+{
+public:
+	SVGPInferenceCostFunction():FirstOrderStochasticCostFunction() { init(); }
+	virtual ~SVGPInferenceCostFunction() { SG_UNREF(m_obj); }
+	virtual const char* get_name() const { return "SVGPInferenceCostFunction"; }
+	void set_target(CSVGPInferenceMethod *obj)
+	{
+		REQUIRE(obj,"Object not set\n");
+		if(obj!=m_obj)
+		{
+			SG_REF(obj);
+			SG_UNREF(m_obj);
+			m_obj=obj;
+		}
+	}
+	void unset_target(bool is_unref)
+	{
+		if(is_unref)
+		{
+			SG_UNREF(m_obj);
+		}
+		m_obj=NULL;
+	}
+	virtual void begin_sample()
+	{
+		REQUIRE(m_obj,"Object not set\n");
+		int32_t num_vectors=m_obj->m_features->get_num_vectors();
+		m_batch_size=CMath::min(m_obj->m_batch_size, num_vectors);
+		m_order=SGVector<index_t>(num_vectors);
+		m_order.range_fill();
+		CMath::permute(m_order);
+		m_batch_start=-m_batch_size;
+	}
+	virtual bool next_sample()
+	{
+		m_batch_start+=m_batch_size;
+		return m_batch_start<m_order.vlen;
+	}
+	virtual SGVector<float64_t> get_gradient()
+	{
+		REQUIRE(m_obj,"Object not set\n");
+		m_obj->unpack_variables();
+
+		// the last mini-batch is shifted back so that it is a full one
+		index_t start=CMath::min(m_batch_start, m_order.vlen-m_batch_size);
+		SGVector<index_t> batch(m_batch_size);
+		sg_memcpy(batch.vector, m_order.vector+start, sizeof(index_t)*m_batch_size);
+
+		m_obj->m_features->add_subset(batch);
+		m_obj->m_labels->add_subset(batch);
+		m_obj->m_batch_scale=(float64_t)m_order.vlen/m_batch_size;
+
+		SGVector<float64_t> gradient(m_obj->m_variables.vlen);
+		m_obj->get_gradient_wrt_variables(gradient);
+
+		m_obj->m_batch_scale=1.0;
+		m_obj->m_labels->remove_subset();
+		m_obj->m_features->remove_subset();
+		return gradient;
+	}
+	virtual float64_t get_cost()
+	{
+		REQUIRE(m_obj,"Object not set\n");
+		m_obj->unpack_variables();
+		return m_obj->compute_negative_elbo();
+	}
+	virtual SGVector<float64_t> obtain_variable_reference()
+	{
+		REQUIRE(m_obj,"Object not set\n");
+		return m_obj->m_variables;
+	}
+private:
+	CSVGPInferenceMethod *m_obj;
+	SGVector<index_t> m_order;
+	index_t m_batch_start;
+	index_t m_batch_size;
+	void init()
+	{
+		m_obj=NULL;
+		m_batch_start=0;
+		m_batch_size=0;
+		//The existing implementation in CSGObject::get_parameter_incremental_hash()
+		//can NOT deal with circular reference when parameter_hash_changed() is called
+		//SG_ADD((CSGObject **)&m_obj, "CSVGPInferenceMethod__m_obj",
+			//"m_obj in SVGPInferenceCostFunction", MS_NOT_AVAILABLE);
+	}
+};
+
+/** data of a float64 parameter, NULL if the parameter is of any other type */
+static float64_t* get_float64_parameter_data(const TParameter* param)
+{
+	const TSGDataType& type=param->m_datatype;
+	if (type.m_ptype!=PT_FLOAT64 || type.m_stype!=ST_NONE)
+		return NULL;
+	if (type.m_ctype==CT_SCALAR)
+		return (float64_t*) param->m_parameter;
+	return *(float64_t**) param->m_parameter;
+}
+#endif //DOXYGEN_SHOULD_SKIP_THIS
+
+CSVGPInferenceMethod::CSVGPInferenceMethod() : CSingleSparseInference()
+{
+	init();
+}
+
+CSVGPInferenceMethod::CSVGPInferenceMethod(CKernel* kern, CFeatures* feat,
+		CMeanFunction* m, CLabels* lab, CLikelihoodModel* mod, CFeatures* lat)
+		: CSingleSparseInference(kern, feat, m, lab, mod, lat)
+{
+	init();
+}
+
+void CSVGPInferenceMethod::init()
+{
+	m_batch_size=100;
+	m_batch_scale=1.0;
+	m_opt_hyperparameters=false;
+	m_sigma2=0.0;
+
+	SG_ADD(&m_q_mean, "q_mean", "mean of q(u)", MS_NOT_AVAILABLE);
+	SG_ADD(&m_q_chol, "q_chol", "Cholesky factor of the covariance of q(u)",
+		MS_NOT_AVAILABLE);
+	SG_ADD(&m_chol_kuu, "chol_kuu", "Cholesky factor of Kuu", MS_NOT_AVAILABLE);
+	SG_ADD(&m_batch_size, "batch_size", "size of the mini-batches",
+		MS_NOT_AVAILABLE);
+	SG_ADD(&m_batch_scale, "batch_scale", "n/batch_size of the current batch",
+		MS_NOT_AVAILABLE);
+	SG_ADD(&m_opt_hyperparameters, "opt_hyperparameters",
+		"whether to learn the hyperparameters on mini-batches", MS_NOT_AVAILABLE);
+	SG_ADD(&m_sigma2, "sigma2", "sigma2", MS_NOT_AVAILABLE);
+	SG_ADD(&m_Tmm, "Tmm", "Tmm", MS_NOT_AVAILABLE);
+	SG_ADD(&m_Tmn, "Tmn", "Tmn", MS_NOT_AVAILABLE);
+
+	SGDMinimizer* opt=new SGDMinimizer();
+	AdamUpdater* updater=new AdamUpdater();
+	updater->set_learning_rate(0.01);
+	opt->set_gradient_updater(updater);
+	opt->set_number_passes(50);
+	register_minimizer(opt);
+}
+
+CSVGPInferenceMethod::~CSVGPInferenceMethod()
+{
+}
+
+CSVGPInferenceMethod* CSVGPInferenceMethod::obtain_from_generic(
+		CInference* inference)
+{
+	if (inference==NULL)
+		return NULL;
+
+	if (inference->get_inference_type()!=INF_SVGP_REGRESSION)
+		SG_SERROR("Provided inference is not of type CSVGPInferenceMethod!\n")
+
+	SG_REF(inference);
+	return (CSVGPInferenceMethod*)inference;
+}
+
+void CSVGPInferenceMethod::check_members() const
+{
+	CSingleSparseInference::check_members();
+
+	REQUIRE(m_model->get_model_type()==LT_GAUSSIAN,
+			"SVGP inference method can only use Gaussian likelihood function\n")
+	REQUIRE(m_labels->get_label_type()==LT_REGRESSION, "Labels must be type "
+			"of CRegressionLabels\n")
+}
+
+void CSVGPInferenceMethod::register_minimizer(Minimizer* minimizer)
+{
+	REQUIRE(minimizer, "Minimizer must set\n");
+	FirstOrderStochasticMinimizer* opt=
+		dynamic_cast<FirstOrderStochasticMinimizer*>(minimizer);
+	REQUIRE(opt, "FirstOrderStochasticMinimizer is required\n");
+	CInference::register_minimizer(minimizer);
+}
+
+void CSVGPInferenceMethod::set_batch_size(int32_t batch_size)
+{
+	REQUIRE(batch_size>0, "Batch size (%d) must be positive\n", batch_size);
+	m_batch_size=batch_size;
+}
+
+void CSVGPInferenceMethod::enable_optimizing_hyperparameters(bool is_optimization)
+{
+	m_opt_hyperparameters=is_optimization;
+}
+
+void CSVGPInferenceMethod::optimize_inducing_features()
+{
+	// inducing features are already learned on mini-batches in update()
+	if (m_opt_hyperparameters)
+		return;
+
+	CSingleSparseInference::optimize_inducing_features();
+}
+
+SGVector<float64_t> CSVGPInferenceMethod::get_diagonal_vector()
+{
+	SG_NOTIMPLEMENTED
+	//the inference method does not need to use this
+	return SGVector<float64_t>();
+}
+
+void CSVGPInferenceMethod::compute_gradient()
+{
+	CInference::compute_gradient();
+
+	if (!m_gradient_update)
+	{
+		update_deriv();
+		m_gradient_update=true;
+		update_parameter_hash();
+	}
+}
+
+void CSVGPInferenceMethod::update()
+{
+	SG_DEBUG("entering\n");
+
+	CInference::update();
+	update_chol();
+	update_alpha();
+	m_gradient_update=false;
+	update_parameter_hash();
+
+	SG_DEBUG("leaving\n");
+}
+
+void CSVGPInferenceMethod::update_train_kernel()
+{
+	check_features();
+	convert_features();
+
+	CFeatures* inducing_features=get_inducing_features();
+	m_kernel->init(inducing_features, inducing_features);
+	m_kuu=m_kernel->get_kernel_matrix();
+	SG_UNREF(inducing_features);
+}
+
+void CSVGPInferenceMethod::update_chol()
+{
+	CGaussianLikelihood* lik=m_model->as<CGaussianLikelihood>();
+	m_sigma2=CMath::sq(lik->get_sigma());
+
+	Map<MatrixXd> eigen_kuu(m_kuu.matrix, m_kuu.num_rows, m_kuu.num_cols);
+
+	LLT<MatrixXd> Luu(
+	    eigen_kuu * std::exp(m_log_scale * 2.0) +
+	    std::exp(m_log_ind_noise) *
+	        MatrixXd::Identity(m_kuu.num_rows, m_kuu.num_cols));
+	m_chol_kuu=SGMatrix<float64_t>(m_kuu.num_rows, m_kuu.num_cols);
+	Map<MatrixXd> eigen_chol_kuu(m_chol_kuu.matrix, m_chol_kuu.num_rows,
+		m_chol_kuu.num_cols);
+	eigen_chol_kuu=Luu.matrixL();
+}
+
+void CSVGPInferenceMethod::update_alpha()
+{
+	// start from the prior q(u)=p(u) the first time
+	if (m_q_mean.vlen!=m_kuu.num_rows)
+	{
+		m_q_mean=SGVector<float64_t>(m_kuu.num_rows);
+		m_q_mean.zero();
+		m_q_chol=m_chol_kuu.clone();
+	}
+
+	optimization();
+
+	Map<MatrixXd> eigen_chol_kuu(m_chol_kuu.matrix, m_chol_kuu.num_rows,
+		m_chol_kuu.num_cols);
+	Map<MatrixXd> eigen_q_chol(m_q_chol.matrix, m_q_chol.num_rows,
+		m_q_chol.num_cols);
+	Map<VectorXd> eigen_q_mean(m_q_mean.vector, m_q_mean.vlen);
+
+	// alpha=Kuu\m, such that the predictive mean is Ksu*alpha+mean
+	m_alpha=SGVector<float64_t>(m_q_mean.vlen);
+	Map<VectorXd> eigen_alpha(m_alpha.vector, m_alpha.vlen);
+	eigen_alpha=eigen_chol_kuu.triangularView<Lower>().solve(eigen_q_mean);
+	eigen_chol_kuu.triangularView<Lower>().adjoint().solveInPlace(eigen_alpha);
+
+	// L=Kuu\S/Kuu-inv(Kuu), such that the predictive variance is
+	// Kss+diag(Ksu*L*Kus)
+	MatrixXd V=eigen_chol_kuu.triangularView<Lower>().solve(
+		MatrixXd::Identity(m_kuu.num_rows, m_kuu.num_cols));
+	MatrixXd eigen_inv_kuu=V.transpose()*V;
+	MatrixXd W=eigen_inv_kuu*eigen_q_chol.triangularView<Lower>();
+	m_L=SGMatrix<float64_t>(m_kuu.num_rows, m_kuu.num_cols);
+	Map<MatrixXd> eigen_L(m_L.matrix, m_L.num_rows, m_L.num_cols);
+	eigen_L=W*W.transpose()-eigen_inv_kuu;
+}
+
+void CSVGPInferenceMethod::update_deriv()
+{
+	m_batch_scale=1.0;
+	compute_batch_terms(true);
+}
+
+float64_t CSVGPInferenceMethod::compute_batch_terms(bool with_deriv)
+{
+	CFeatures* inducing_features=get_inducing_features();
+	m_kernel->init(m_features, m_features);
+	m_ktrtr_diag=m_kernel->get_kernel_diagonal();
+	m_kernel->init(inducing_features, m_features);
+	m_ktru=m_kernel->get_kernel_matrix();
+	SG_UNREF(inducing_features);
+
+	const float64_t scale2=std::exp(m_log_scale*2.0);
+	const index_t m=m_ktru.num_rows;
+	const index_t n=m_ktru.num_cols;
+
+	Map<MatrixXd> eigen_ktru(m_ktru.matrix, m_ktru.num_rows, m_ktru.num_cols);
+	Map<VectorXd> eigen_ktrtr_diag(m_ktrtr_diag.vector, m_ktrtr_diag.vlen);
+	Map<MatrixXd> eigen_chol_kuu(m_chol_kuu.matrix, m_chol_kuu.num_rows,
+		m_chol_kuu.num_cols);
+	Map<MatrixXd> eigen_q_chol(m_q_chol.matrix, m_q_chol.num_rows,
+		m_q_chol.num_cols);
+	Map<VectorXd> eigen_q_mean(m_q_mean.vector, m_q_mean.vlen);
+
+	SGVector<float64_t> y=((CRegressionLabels*) m_labels)->get_labels();
+	Map<VectorXd> eigen_y(y.vector, y.vlen);
+	SGVector<float64_t> mean=m_mean->get_mean_vector(m_features);
+	Map<VectorXd> eigen_mean(mean.vector, mean.vlen);
+
+	// V=Lk\Kmn and A=Kuu\Kmn
+	MatrixXd V=eigen_chol_kuu.triangularView<Lower>().solve(eigen_ktru*scale2);
+	MatrixXd A=eigen_chol_kuu.triangularView<Lower>().adjoint().solve(V);
+	// a=Kuu\m
+	VectorXd a=eigen_chol_kuu.triangularView<Lower>().solve(eigen_q_mean);
+	eigen_chol_kuu.triangularView<Lower>().adjoint().solveInPlace(a);
+	// W=Lq'*A
+	MatrixXd W=eigen_q_chol.triangularView<Lower>().adjoint()*A;
+
+	// q(f_i)=N(y_i-r_i, v_i)
+	m_residual=SGVector<float64_t>(n);
+	Map<VectorXd> eigen_r(m_residual.vector, m_residual.vlen);
+	eigen_r=eigen_y-eigen_mean-A.transpose()*eigen_q_mean;
+	m_variance=SGVector<float64_t>(n);
+	Map<VectorXd> eigen_v(m_variance.vector, m_variance.vlen);
+	eigen_v=eigen_ktrtr_diag*scale2-V.colwise().squaredNorm().transpose()+
+		W.colwise().squaredNorm().transpose();
+
+	float64_t nll=m_batch_scale*(0.5*n*std::log(2.0*CMath::PI*m_sigma2)+
+		0.5*(eigen_r.squaredNorm()+eigen_v.sum())/m_sigma2);
+
+	if (!with_deriv)
+		return nll;
+
+	const float64_t cb=m_batch_scale/m_sigma2;
+
+	MatrixXd Vi=eigen_chol_kuu.triangularView<Lower>().solve(
+		MatrixXd::Identity(m, m));
+	MatrixXd inv_kuu=Vi.transpose()*Vi;
+	MatrixXd Lq=eigen_q_chol.triangularView<Lower>();
+	MatrixXd S=Lq*Lq.transpose();
+	MatrixXd inv_kuu_S=inv_kuu*S;
+	VectorXd Ar=A*eigen_r;
+	MatrixXd AAt=A*A.transpose();
+
+	// derivative wrt the (scaled) Kuu
+	m_Tmm=SGMatrix<float64_t>(m, m);
+	Map<MatrixXd> eigen_Tmm(m_Tmm.matrix, m_Tmm.num_rows, m_Tmm.num_cols);
+	MatrixXd Tmm=cb*Ar*a.transpose()+0.5*cb*AAt-cb*inv_kuu_S*AAt+
+		0.5*(inv_kuu-inv_kuu_S*inv_kuu-a*a.transpose());
+	eigen_Tmm=0.5*(Tmm+Tmm.transpose());
+
+	// derivative wrt the (scaled) Kmn
+	m_Tmn=SGMatrix<float64_t>(m, n);
+	Map<MatrixXd> eigen_Tmn(m_Tmn.matrix, m_Tmn.num_rows, m_Tmn.num_cols);
+	eigen_Tmn=cb*(inv_kuu_S*A-A-a*eigen_r.transpose());
+
+	// derivatives wrt q(u)
+	m_dq_mean=SGVector<float64_t>(m);
+	Map<VectorXd> eigen_dq_mean(m_dq_mean.vector, m_dq_mean.vlen);
+	eigen_dq_mean=a-cb*Ar;
+
+	m_dq_chol=SGMatrix<float64_t>(m, m);
+	Map<MatrixXd> eigen_dq_chol(m_dq_chol.matrix, m_dq_chol.num_rows,
+		m_dq_chol.num_cols);
+	eigen_dq_chol=(cb*AAt+inv_kuu)*Lq;
+	eigen_dq_chol.triangularView<StrictlyUpper>().setZero();
+	eigen_dq_chol.diagonal()-=eigen_q_chol.diagonal().cwiseInverse();
+
+	return nll;
+}
+
+float64_t CSVGPInferenceMethod::get_kl_divergence() const
+{
+	Map<MatrixXd> eigen_chol_kuu(m_chol_kuu.matrix, m_chol_kuu.num_rows,
+		m_chol_kuu.num_cols);
+	Map<MatrixXd> eigen_q_chol(m_q_chol.matrix, m_q_chol.num_rows,
+		m_q_chol.num_cols);
+	Map<VectorXd> eigen_q_mean(m_q_mean.vector, m_q_mean.vlen);
+
+	//KL=0.5*(tr(Kuu\S)+m'*(Kuu\m)-M+log|Kuu|-log|S|)
+	MatrixXd B=eigen_chol_kuu.triangularView<Lower>().solve(
+		MatrixXd(eigen_q_chol.triangularView<Lower>()));
+	VectorXd b=eigen_chol_kuu.triangularView<Lower>().solve(eigen_q_mean);
+	float64_t log_det_kuu=2.0*eigen_chol_kuu.diagonal().array().log().sum();
+	float64_t log_det_S=2.0*eigen_q_chol.diagonal().array().abs().log().sum();
+
+	return 0.5*(B.squaredNorm()+b.squaredNorm()-m_q_mean.vlen+log_det_kuu-
+		log_det_S);
+}
+
+float64_t CSVGPInferenceMethod::compute_negative_elbo()
+{
+	// go through the training data in chunks to bound the memory
+	const index_t num_vectors=m_features->get_num_vectors();
+	float64_t nll=0.0;
+	m_batch_scale=1.0;
+	for (index_t start=0; start<num_vectors; start+=m_batch_size)
+	{
+		SGVector<index_t> chunk(CMath::min(m_batch_size, num_vectors-start));
+		chunk.range_fill(start);
+
+		m_features->add_subset(chunk);
+		m_labels->add_subset(chunk);
+		nll+=compute_batch_terms(false);
+		m_labels->remove_subset();
+		m_features->remove_subset();
+	}
+	// the kernel matrices only cover the last chunk now
+	m_gradient_update=false;
+
+	return nll+get_kl_divergence();
+}
+
+float64_t CSVGPInferenceMethod::get_negative_log_marginal_likelihood()
+{
+	if (parameter_hash_changed())
+		update();
+
+	return compute_negative_elbo();
+}
+
+float64_t CSVGPInferenceMethod::optimization()
+{
+	pack_variables();
+
+	SVGPInferenceCostFunction *cost_fun=new SVGPInferenceCostFunction();
+	cost_fun->set_target(this);
+	bool cleanup=false;
+	if(this->ref_count()>1)
+		cleanup=true;
+
+	FirstOrderStochasticMinimizer* opt=
+		dynamic_cast<FirstOrderStochasticMinimizer*>(m_minimizer);
+	REQUIRE(opt, "FirstOrderStochasticMinimizer is required\n")
+	opt->set_cost_function(cost_fun);
+
+	float64_t nelbo=opt->minimize();
+	opt->unset_cost_function(false);
+	cost_fun->unset_target(cleanup);
+	SG_UNREF(cost_fun);
+
+	unpack_variables();
+	return nelbo;
+}
+
+void CSVGPInferenceMethod::pack_variables()
+{
+	const index_t m=m_q_mean.vlen;
+	index_t len=m+m*(m+1)/2;
+
+	TParameter* sigma_param=NULL;
+	TParameter* ind_param=NULL;
+	if (m_opt_hyperparameters)
+	{
+		sigma_param=m_model->m_gradient_parameters->get_parameter("log_sigma");
+		len+=2;
+		for (index_t i=0; i<m_kernel->m_gradient_parameters->get_num_parameters(); i++)
+		{
+			TParameter* param=m_kernel->m_gradient_parameters->get_parameter(i);
+			if (get_float64_parameter_data(param))
+				len+=param->m_datatype.get_num_elements();
+		}
+		if (m_opt_inducing_features && m_fully_sparse)
+		{
+			ind_param=m_gradient_parameters->get_parameter("inducing_features");
+			len+=m_inducing_features.num_rows*m_inducing_features.num_cols;
+		}
+	}
+
+	m_variables=SGVector<float64_t>(len);
+	index_t idx=0;
+	for (index_t i=0; i<m; i++)
+		m_variables[idx++]=m_q_mean[i];
+	for (index_t j=0; j<m; j++)
+		for (index_t i=j; i<m; i++)
+			m_variables[idx++]=m_q_chol(i,j);
+
+	if (!m_opt_hyperparameters)
+		return;
+
+	m_variables[idx++]=*get_float64_parameter_data(sigma_param);
+	m_variables[idx++]=m_log_scale;
+	for (index_t i=0; i<m_kernel->m_gradient_parameters->get_num_parameters(); i++)
+	{
+		TParameter* param=m_kernel->m_gradient_parameters->get_parameter(i);
+		float64_t* data=get_float64_parameter_data(param);
+		if (!data)
+			continue;
+		for (index_t k=0; k<param->m_datatype.get_num_elements(); k++)
+			m_variables[idx++]=data[k];
+	}
+	if (ind_param)
+	{
+		for (index_t k=0; k<m_inducing_features.num_rows*m_inducing_features.num_cols; k++)
+			m_variables[idx++]=m_inducing_features.matrix[k];
+	}
+	ASSERT(idx==len)
+}
+
+void CSVGPInferenceMethod::unpack_variables()
+{
+	const index_t m=m_q_mean.vlen;
+	index_t idx=0;
+	for (index_t i=0; i<m; i++)
+		m_q_mean[i]=m_variables[idx++];
+	for (index_t j=0; j<m; j++)
+		for (index_t i=j; i<m; i++)
+			m_q_chol(i,j)=m_variables[idx++];
+
+	if (!m_opt_hyperparameters)
+		return;
+
+	TParameter* sigma_param=m_model->m_gradient_parameters->get_parameter("log_sigma");
+	*get_float64_parameter_data(sigma_param)=m_variables[idx++];
+	m_log_scale=m_variables[idx++];
+	for (index_t i=0; i<m_kernel->m_gradient_parameters->get_num_parameters(); i++)
+	{
+		TParameter* param=m_kernel->m_gradient_parameters->get_parameter(i);
+		float64_t* data=get_float64_parameter_data(param);
+		if (!data)
+			continue;
+		for (index_t k=0; k<param->m_datatype.get_num_elements(); k++)
+			data[k]=m_variables[idx++];
+	}
+	if (m_opt_inducing_features && m_fully_sparse)
+	{
+		for (index_t k=0; k<m_inducing_features.num_rows*m_inducing_features.num_cols; k++)
+			m_inducing_features.matrix[k]=m_variables[idx++];
+	}
+	ASSERT(idx==m_variables.vlen)
+
+	// Kuu depends on the hyperparameters
+	update_train_kernel();
+	update_chol();
+}
+
+void CSVGPInferenceMethod::get_gradient_wrt_variables(SGVector<float64_t> gradient)
+{
+	compute_batch_terms(true);
+
+	const index_t m=m_q_mean.vlen;
+	index_t idx=0;
+	for (index_t i=0; i<m; i++)
+		gradient[idx++]=m_dq_mean[i];
+	for (index_t j=0; j<m; j++)
+		for (index_t i=j; i<m; i++)
+			gradient[idx++]=m_dq_chol(i,j);
+
+	if (!m_opt_hyperparameters)
+		return;
+
+	TParameter* sigma_param=m_model->m_gradient_parameters->get_parameter("log_sigma");
+	gradient[idx++]=get_derivative_wrt_likelihood_model(sigma_param)[0];
+	TParameter* scale_param=m_gradient_parameters->get_parameter("log_scale");
+	gradient[idx++]=get_derivative_wrt_inference_method(scale_param)[0];
+	for (index_t i=0; i<m_kernel->m_gradient_parameters->get_num_parameters(); i++)
+	{
+		TParameter* param=m_kernel->m_gradient_parameters->get_parameter(i);
+		if (!get_float64_parameter_data(param))
+			continue;
+		SGVector<float64_t> deriv=get_derivative_wrt_kernel(param);
+		for (index_t k=0; k<deriv.vlen; k++)
+			gradient[idx++]=deriv[k];
+	}
+	if (m_opt_inducing_features && m_fully_sparse)
+	{
+		TParameter* ind_param=m_gradient_parameters->get_parameter("inducing_features");
+		SGVector<float64_t> deriv=get_derivative_wrt_inducing_features(ind_param);
+		for (index_t k=0; k<deriv.vlen; k++)
+			gradient[idx++]=deriv[k];
+	}
+	ASSERT(idx==gradient.vlen)
+}
+
+SGVector<float64_t> CSVGPInferenceMethod::get_posterior_mean()
+{
+	if (parameter_hash_changed())
+		update();
+
+	return m_q_mean.clone();
+}
+
+SGMatrix<float64_t> CSVGPInferenceMethod::get_posterior_covariance()
+{
+	if (parameter_hash_changed())
+		update();
+
+	Map<MatrixXd> eigen_q_chol(m_q_chol.matrix, m_q_chol.num_rows,
+		m_q_chol.num_cols);
+	SGMatrix<float64_t> result(m_q_chol.num_rows, m_q_chol.num_cols);
+	Map<MatrixXd> eigen_result(result.matrix, result.num_rows, result.num_cols);
+	MatrixXd Lq=eigen_q_chol.triangularView<Lower>();
+	eigen_result=Lq*Lq.transpose();
+	return result;
+}
+
+SGVector<float64_t> CSVGPInferenceMethod::get_derivative_wrt_likelihood_model(
+		const TParameter* param)
+{
+	REQUIRE(!strcmp(param->m_name, "log_sigma"), "Can't compute derivative of "
+			"the nagative log marginal likelihood wrt %s.%s parameter\n",
+			m_model->get_name(), param->m_name)
+
+	Map<VectorXd> eigen_r(m_residual.vector, m_residual.vlen);
+	Map<VectorXd> eigen_v(m_variance.vector, m_variance.vlen);
+
+	SGVector<float64_t> dlik(1);
+	dlik[0]=m_batch_scale*(m_residual.vlen-
+		(eigen_r.squaredNorm()+eigen_v.sum())/m_sigma2);
+	return dlik;
+}
+
+SGVector<float64_t> CSVGPInferenceMethod::get_derivative_wrt_inducing_features(
+	const TParameter* param)
+{
+	Map<MatrixXd> eigen_Tmm(m_Tmm.matrix, m_Tmm.num_rows, m_Tmm.num_cols);
+	Map<MatrixXd> eigen_Tmn(m_Tmn.matrix, m_Tmn.num_rows, m_Tmn.num_cols);
+	const float64_t scale2=std::exp(m_log_scale*2.0);
+
+	int32_t dim=m_inducing_features.num_rows;
+	int32_t num_samples=m_inducing_features.num_cols;
+	SGVector<float64_t>deriv_lat(dim*num_samples);
+	deriv_lat.zero();
+
+	m_lock->lock();
+	CFeatures *inducing_features=get_inducing_features();
+	//asymtric part (related to xu and x)
+	m_kernel->init(inducing_features, m_features);
+	for(int32_t lat_idx=0; lat_idx<eigen_Tmn.rows(); lat_idx++)
+	{
+		Map<VectorXd> deriv_lat_col_vec(deriv_lat.vector+lat_idx*dim,dim);
+		//p by n
+		SGMatrix<float64_t> deriv_mat=m_kernel->get_parameter_gradient(param, lat_idx);
+		Map<MatrixXd> eigen_deriv_mat(deriv_mat.matrix, deriv_mat.num_rows, deriv_mat.num_cols);
+		deriv_lat_col_vec+=eigen_deriv_mat*(scale2*eigen_Tmn.row(lat_idx).transpose());
+	}
+
+	//symtric part (related to xu and xu), both Kuu(i,j) and Kuu(j,i) depend on xu_i
+	m_kernel->init(inducing_features, inducing_features);
+	for(int32_t lat_lidx=0; lat_lidx<eigen_Tmm.cols(); lat_lidx++)
+	{
+		Map<VectorXd> deriv_lat_col_vec(deriv_lat.vector+lat_lidx*dim,dim);
+		//p by n
+		SGMatrix<float64_t> deriv_mat=m_kernel->get_parameter_gradient(param, lat_lidx);
+		Map<MatrixXd> eigen_deriv_mat(deriv_mat.matrix, deriv_mat.num_rows, deriv_mat.num_cols);
+		deriv_lat_col_vec+=eigen_deriv_mat*(2.0*scale2*eigen_Tmm.col(lat_lidx));
+	}
+	SG_UNREF(inducing_features);
+	m_lock->unlock();
+	return deriv_lat;
+}
+
+SGVector<float64_t> CSVGPInferenceMethod::get_derivative_wrt_inducing_noise(
+	const TParameter* param)
+{
+	REQUIRE(param, "Param not set\n");
+	REQUIRE(!strcmp(param->m_name, "log_inducing_noise"), "Can't compute derivative of "
+			"the nagative log marginal likelihood wrt %s.%s parameter\n",
+			get_name(), param->m_name)
+
+	Map<MatrixXd> eigen_Tmm(m_Tmm.matrix, m_Tmm.num_rows, m_Tmm.num_cols);
+	SGVector<float64_t> result(1);
+	result[0]=std::exp(m_log_ind_noise)*eigen_Tmm.trace();
+	return result;
+}
+
+float64_t CSVGPInferenceMethod::get_derivative_related_cov(SGVector<float64_t> ddiagKi,
+	SGMatrix<float64_t> dKuui, SGMatrix<float64_t> dKui)
+{
+	Map<VectorXd> eigen_ddiagKi(ddiagKi.vector, ddiagKi.vlen);
+	Map<MatrixXd> eigen_dKuui(dKuui.matrix, dKuui.num_rows, dKuui.num_cols);
+	Map<MatrixXd> eigen_dKui(dKui.matrix, dKui.num_rows, dKui.num_cols);
+
+	Map<MatrixXd> eigen_Tmm(m_Tmm.matrix, m_Tmm.num_rows, m_Tmm.num_cols);
+	Map<MatrixXd> eigen_Tmn(m_Tmn.matrix, m_Tmn.num_rows, m_Tmn.num_cols);
+
+	return eigen_dKuui.cwiseProduct(eigen_Tmm).sum()+
+		eigen_dKui.cwiseProduct(eigen_Tmn).sum()+
+		0.5*m_batch_scale/m_sigma2*eigen_ddiagKi.sum();
+}
+
+SGVector<float64_t> CSVGPInferenceMethod::get_derivative_wrt_mean(
+	const TParameter* param)
+{
+	REQUIRE(param, "Param not set\n");
+	SGVector<float64_t> result;
+	int64_t len=const_cast<TParameter *>(param)->m_datatype.get_num_elements();
+	result=SGVector<float64_t>(len);
+
+	Map<VectorXd> eigen_r(m_residual.vector, m_residual.vlen);
+
+	for (index_t i=0; i<result.vlen; i++)
+	{
+		SGVector<float64_t> dmu=m_mean->get_parameter_derivative(m_features, param, i);
+		Map<VectorXd> eigen_dmu(dmu.vector, dmu.vlen);
+
+		result[i]=-m_batch_scale/m_sigma2*eigen_dmu.dot(eigen_r);
+	}
+	return result;
+}
+
+}
@@ -0,0 +1,315 @@
+/*
+ * This software is distributed under BSD 3-clause license (see LICENSE file).
+ *
+ * The reference paper is
+ * Hensman, James, Nicolo Fusi, and Neil D. Lawrence.
+ * "Gaussian processes for big data."
+ * Uncertainty in Artificial Intelligence. 2013.
+ */
+
+#ifndef CSVGPINFERENCEMETHOD_H
+#define CSVGPINFERENCEMETHOD_H
+
+#include <shogun/lib/config.h>
+#include <shogun/machine/gp/SingleSparseInference.h>
+
+namespace shogun
+{
+/** @brief The stochastic variational inference method for sparse Gaussian
+ * process regression (SVGP).
+ *
+ * The posterior over the inducing variables \f$u\f$ is approximated by an
+ * explicit Gaussian \f$q(u)=\mathcal{N}(m,LL^T)\f$ and the evidence lower
+ * bound
+ *
+ * \f[
+ * \sum_{i=1}^n E_{q(f_i)}[\log p(y_i|f_i)] - KL(q(u)||p(u))
+ * \f]
+ *
+ * is maximized. Since the bound is a sum over training points, it is
+ * optimized with a FirstOrderStochasticMinimizer on mini-batches whose
+ * contribution is rescaled by n/batch_size, so that one step costs
+ * \f$O(bm^2+m^3)\f$ instead of \f$O(nm^2)\f$. By default only \f$q(u)\f$ is
+ * learned this way, see enable_optimizing_hyperparameters() to learn the
+ * likelihood noise, the kernel scale and parameters and (for kernels that
+ * support it) the inducing features on mini-batches as well.
+ *
+ * The negative log marginal likelihood reported by this method is the
+ * negative evidence lower bound, evaluated over the full training data in
+ * chunks of batch_size points. Predictions only depend on \f$q(u)\f$ and
+ * cost \f$O(m^2)\f$ per test point.
+ *
+ * NOTE: The Gaussian Likelihood Function must be used for this inference
+ * method.
+ */
+class CSVGPInferenceMethod: public CSingleSparseInference
+{
+friend class SVGPInferenceCostFunction;
+public:
+	/** default constructor */
+	CSVGPInferenceMethod();
+
+	/** constructor
+	 *
+	 * @param kernel covariance function
+	 * @param features features to use in inference
+	 * @param mean mean function
+	 * @param labels labels of the features
+	 * @param model likelihood model to use
+	 * @param inducing_features features to use
+	 */
+	CSVGPInferenceMethod(CKernel* kernel, CFeatures* features,
+			CMeanFunction* mean, CLabels* labels, CLikelihoodModel* model,
+			CFeatures* inducing_features);
+
+	virtual ~CSVGPInferenceMethod();
+
+	/** returns the name of the inference method
+	 *
+	 * @return name SVGPInferenceMethod
+	 */
+	virtual const char* get_name() const { return "SVGPInferenceMethod"; }
+
+	/** return what type of inference we are
+	 *
+	 * @return inference type SVGP_REGRESSION
+	 */
+	virtual EInferenceType get_inference_type() const { return INF_SVGP_REGRESSION; }
+
+	/** helper method used to specialize a base class instance
+	 *
+	 * @param inference inference method
+	 * @return casted CSVGPInferenceMethod object
+	 */
+	static CSVGPInferenceMethod* obtain_from_generic(CInference* inference);
+
+	/** get negative log marginal likelihood
+	 *
+	 * @return the negative evidence lower bound
+	 *
+	 * \f[
+	 * -\sum_{i=1}^n E_{q(f_i)}[\log p(y_i|f_i)] + KL(q(u)||p(u))
+	 * \f]
+	 *
+	 * which is an upper bound of \f$-log(p(y|X, \theta))\f$.
+	 */
+	virtual float64_t get_negative_log_marginal_likelihood();
+
+	/** get diagonal vector
+	 *
+	 * @return diagonal of matrix used to calculate posterior covariance matrix
+	 */
+	virtual SGVector<float64_t> get_diagonal_vector();
+
+	/**
+	 * @return whether combination of sparse inference method and given likelihood
+	 * function supports regression
+	 */
+	virtual bool supports_regression() const
+	{
+		check_members();
+		return m_model->supports_regression();
+	}
+
+	/** returns the mean vector \f$m\f$ of the variational distribution
+	 * \f$q(u)=\mathcal{N}(m,S)\f$ of the inducing variables
+	 *
+	 * @return mean vector
+	 */
+	virtual SGVector<float64_t> get_posterior_mean();
+
+	/** returns the covariance matrix \f$S\f$ of the variational distribution
+	 * \f$q(u)=\mathcal{N}(m,S)\f$ of the inducing variables
+	 *
+	 * @return covariance matrix
+	 */
+	virtual SGMatrix<float64_t> get_posterior_covariance();
+
+	/** update all matrices, this runs the stochastic optimization */
+	virtual void update();
+
+	/** set the minimizer used to fit the variational distribution
+	 *
+	 * @param minimizer a FirstOrderStochasticMinimizer
+	 */
+	virtual void register_minimizer(Minimizer* minimizer);
+
+	/** set the number of training points per mini-batch
+	 *
+	 * @param batch_size positive batch size
+	 */
+	virtual void set_batch_size(int32_t batch_size);
+
+	/** get the number of training points per mini-batch
+	 *
+	 * @return batch size
+	 */
+	virtual int32_t get_batch_size() const { return m_batch_size; }
+
+	/** whether to learn the likelihood noise, the scale, the kernel
+	 * parameters and (if enabled by enable_optimizing_inducing_features())
+	 * the inducing features together with \f$q(u)\f$ on mini-batches
+	 *
+	 * Only parameters of the kernel itself are considered, parameters of
+	 * nested kernels are left untouched.
+	 *
+	 * @param is_optimization whether to learn the hyperparameters
+	 */
+	virtual void enable_optimizing_hyperparameters(bool is_optimization);
+
+	/** the inducing features are learned together with q(u) if
+	 * enable_optimizing_hyperparameters() is set, otherwise they are
+	 * optimized as in the other sparse inference methods
+	 */
+	virtual void optimize_inducing_features();
+
+protected:
+	/** check if members of object are valid for inference */
+	virtual void check_members() const;
+
+	/** only computes the kernel matrix of the inducing features, kernel
+	 * values involving training features are computed per mini-batch
+	 */
+	virtual void update_train_kernel();
+
+	/** update alpha vector and the matrix used for predictions from q(u) */
+	virtual void update_alpha();
+
+	/** update the Cholesky factor of the inducing kernel matrix */
+	virtual void update_chol();
+
+	/** update matrices which are required to compute the derivatives on the
+	 * current training features (a mini-batch during the optimization)
+	 */
+	virtual void update_deriv();
+
+	/** returns derivative of negative log marginal likelihood wrt parameter of
+	 * likelihood model
+	 *
+	 * @param param parameter of given likelihood model
+	 *
+	 * @return derivative of negative log marginal likelihood
+	 */
+	virtual SGVector<float64_t> get_derivative_wrt_likelihood_model(
+			const TParameter* param);
+
+	/** returns derivative of negative log marginal likelihood wrt inducing features (input)
+	 * Note that the kernel must support to compute the derivatives wrt inducing features
+	 *
+	 * @param param parameter of given kernel
+	 * @return derivative of negative log marginal likelihood
+	 */
+	virtual SGVector<float64_t> get_derivative_wrt_inducing_features(
+		const TParameter* param);
+
+	/** returns derivative of negative log marginal likelihood wrt inducing noise
+	 *
+	 * @param param parameter of given inference class
+	 *
+	 * @return derivative of negative log marginal likelihood
+	 */
+	virtual SGVector<float64_t> get_derivative_wrt_inducing_noise(
+		const TParameter* param);
+
+	/** returns derivative of negative log marginal likelihood wrt mean
+	 * function's parameter
+	 *
+	 * @param param parameter of given mean function
+	 *
+	 * @return derivative of negative log marginal likelihood
+	 */
+	virtual SGVector<float64_t> get_derivative_wrt_mean(
+			const TParameter* param);
+
+	/** compute variables which are required to compute negative log marginal
+	 * likelihood full derivatives wrt cov-like hyperparameter \f$\theta\f$
+	 *
+	 * @param ddiagKi \f$\textbf{diag}(\frac{\partial {\Sigma_{n}}}{\partial {\theta}})\f$
+	 * @param dKuui \f$\frac{\partial {\Sigma_{m}}}{\partial {\theta}}\f$
+	 * @param dKui \f$\frac{\partial {\Sigma_{m,n}}}{\partial {\theta}}\f$
+	 *
+	 * @return derivative of negative log marginal likelihood
+	 */
+	virtual float64_t get_derivative_related_cov(SGVector<float64_t> ddiagKi,
+		SGMatrix<float64_t> dKuui, SGMatrix<float64_t> dKui);
+
+	/** update gradients */
+	virtual void compute_gradient();
+
+	/** computes the kernel matrices involving the current training features
+	 * and the expected negative log likelihood of their labels
+	 *
+	 * @param with_deriv whether to also compute the matrices needed for
+	 * derivatives
+	 * @return expected negative log likelihood, scaled by m_batch_scale
+	 */
+	virtual float64_t compute_batch_terms(bool with_deriv);
+
+	/** KL divergence between q(u) and the prior p(u)
+	 *
+	 * @return KL(q(u)||p(u))
+	 */
+	virtual float64_t get_kl_divergence() const;
+
+	/** negative evidence lower bound over the full training data, computed in
+	 * chunks of batch_size points
+	 *
+	 * @return negative evidence lower bound
+	 */
+	virtual float64_t compute_negative_elbo();
+
+	/** run the stochastic optimization of the negative evidence lower bound
+	 *
+	 * @return the negative evidence lower bound after the optimization
+	 */
+	virtual float64_t optimization();
+
+	/** pack q(u) and, if enabled, the hyperparameters into m_variables */
+	virtual void pack_variables();
+
+	/** write m_variables back into q(u) and the hyperparameters */
+	virtual void unpack_variables();
+
+	/** gradient of the negative evidence lower bound on the current
+	 * training features wrt m_variables
+	 *
+	 * @param gradient output vector, same length as m_variables
+	 */
+	virtual void get_gradient_wrt_variables(SGVector<float64_t> gradient);
+
+protected:
+	/** mean of q(u) */
+	SGVector<float64_t> m_q_mean;
+	/** lower triangular Cholesky factor of the covariance of q(u) */
+	SGMatrix<float64_t> m_q_chol;
+	/** lower triangular Cholesky factor of the (scaled) inducing kernel matrix */
+	SGMatrix<float64_t> m_chol_kuu;
+	/** number of training points per mini-batch */
+	int32_t m_batch_size;
+	/** n/batch_size for the batch currently in use, 1 for the full data */
+	float64_t m_batch_scale;
+	/** whether to learn the hyperparameters on mini-batches */
+	bool m_opt_hyperparameters;
+	/** square of sigma from Gaussian likelihood */
+	float64_t m_sigma2;
+	/** labels minus the predicted mean on the current batch */
+	SGVector<float64_t> m_residual;
+	/** predictive variances of q on the current batch */
+	SGVector<float64_t> m_variance;
+	/** coefficient matrix of the derivative wrt (scaled) Kuu */
+	SGMatrix<float64_t> m_Tmm;
+	/** coefficient matrix of the derivative wrt (scaled) Kmn */
+	SGMatrix<float64_t> m_Tmn;
+	/** derivative wrt mean of q(u) */
+	SGVector<float64_t> m_dq_mean;
+	/** derivative wrt Cholesky factor of the covariance of q(u) */
+	SGMatrix<float64_t> m_dq_chol;
+	/** packed variables handed to the minimizer */
+	SGVector<float64_t> m_variables;
+
+private:
+	/** init */
+	void init();
+};
+}
+#endif /* CSVGPINFERENCEMETHOD_H */
@@ -307,6 +307,23 @@ namespace shogun
 		    BACKEND_GENERIC_EIGEN_SOLVER_SYMMETRIC, SGMatrix)
 #undef BACKEND_GENERIC_EIGEN_SOLVER_SYMMETRIC
 
+/**
+ * Wrapper method of randomized top-k eigensolver of symmetric matrices.
+ *
+ * @see linalg::eigen_solver_symmetric_randomized
+ */
+#define BACKEND_GENERIC_EIGEN_SOLVER_SYMMETRIC_RANDOMIZED(Type, Container)     \
+	virtual void eigen_solver_symmetric_randomized(                            \
+	    const Container<Type>& A, SGVector<Type>& eigenvalues,                 \
+	    SGMatrix<Type>& eigenvectors, index_t k, index_t num_iterations,       \
+	    index_t oversampling) const                                            \
+	{                                                                          \
+		SG_SNOTIMPLEMENTED;                                                    \
+	}
+		DEFINE_FOR_NON_INTEGER_PTYPE(
+		    BACKEND_GENERIC_EIGEN_SOLVER_SYMMETRIC_RANDOMIZED, SGMatrix)
+#undef BACKEND_GENERIC_EIGEN_SOLVER_SYMMETRIC_RANDOMIZED
+
 /**
  * Wrapper method of in-place vector elementwise product.
  *
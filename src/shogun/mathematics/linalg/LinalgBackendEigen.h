@@ -157,6 +157,17 @@ namespace shogun
 		    BACKEND_GENERIC_EIGEN_SOLVER_SYMMETRIC, SGMatrix)
 #undef BACKEND_GENERIC_EIGEN_SOLVER_SYMMETRIC
 
+/** Implementation of @see LinalgBackendBase::eigen_solver_symmetric_randomized
+ */
+#define BACKEND_GENERIC_EIGEN_SOLVER_SYMMETRIC_RANDOMIZED(Type, Container)     \
+	virtual void eigen_solver_symmetric_randomized(                            \
+	    const Container<Type>& A, SGVector<Type>& eigenvalues,                 \
+	    SGMatrix<Type>& eigenvectors, index_t k, index_t num_iterations,       \
+	    index_t oversampling) const;
+		DEFINE_FOR_NON_INTEGER_REAL_PTYPE(
+		    BACKEND_GENERIC_EIGEN_SOLVER_SYMMETRIC_RANDOMIZED, SGMatrix)
+#undef BACKEND_GENERIC_EIGEN_SOLVER_SYMMETRIC_RANDOMIZED
+
 /** Implementation of @see LinalgBackendBase::element_prod */
 #define BACKEND_GENERIC_IN_PLACE_VECTOR_ELEMENT_PROD(Type, Container)          \
 	virtual void element_prod(                                                 \
@@ -504,6 +515,14 @@ namespace shogun
 		    const SGMatrix<T>& A, SGVector<T>& eigenvalues,
 		    SGMatrix<T>& eigenvectors, index_t k) const;
 
+		/** Eigen3 randomized subspace iteration top-k eigensolver for
+		 * symmetric matrices */
+		template <typename T>
+		void eigen_solver_symmetric_randomized_impl(
+		    const SGMatrix<T>& A, SGVector<T>& eigenvalues,
+		    SGMatrix<T>& eigenvectors, index_t k, index_t num_iterations,
+		    index_t oversampling) const;
+
 		/** Eigen3 matrix in-place elementwise product method */
 		template <typename T>
 		void element_prod_impl(
@@ -803,6 +803,71 @@ namespace shogun
 			    A, eigenvalues, eigenvectors, k);
 		}
 
+		/**
+		 * Approximate the top-k eigenvalues and eigenvectors of a symmetric
+		 * positive semi-definite matrix by randomized subspace iteration.
+		 *
+		 * Halko, N., Martinsson, P. G., & Tropp, J. A. (2011).
+		 * Finding structure with randomness: Probabilistic algorithms for
+		 * constructing approximate matrix decompositions.
+		 * SIAM Review, 53(2), 217-288.
+		 *
+		 * Only n x (k + oversampling) blocks are allocated besides A, which
+		 * makes this much cheaper than @see eigen_solver_symmetric when k
+		 * is small compared to the size of A. The random test matrix is
+		 * drawn from the global random generator.
+		 *
+		 * User should pass an appropriately pre-allocated memory vector
+		 * to store the eigenvalues and an appropriately pre-allocated memory
+		 * matrix to store the eigenvectors.
+		 *
+		 * @param A The matrix whose eigenvalues and eigenvectors are to be
+		 * computed
+		 * @param eigenvalues Eigenvalues result vector in ascending order
+		 * @param eigenvectors Eigenvectors result matrix
+		 * @param k number of top eigenvalues to be computed
+		 * @param num_iterations number of power iterations [default = 4]
+		 * @param oversampling number of extra random directions
+		 * [default = 10]
+		 */
+		template <typename T>
+		void eigen_solver_symmetric_randomized(
+		    const SGMatrix<T>& A, SGVector<T>& eigenvalues,
+		    SGMatrix<T>& eigenvectors, index_t k, index_t num_iterations = 4,
+		    index_t oversampling = 10)
+		{
+			REQUIRE(
+			    A.num_rows == A.num_cols, "Matrix A (%d x% d) is not square!\n",
+			    A.num_rows, A.num_cols);
+			REQUIRE(
+			    k > 0 && k <= A.num_rows,
+			    "Invalid value of k (%d), it must be in the range 1-%d.", k,
+			    A.num_rows)
+			REQUIRE(
+			    num_iterations >= 0 && oversampling >= 0,
+			    "Number of iterations (%d) and oversampling (%d) must be "
+			    "non-negative.\n",
+			    num_iterations, oversampling);
+
+			REQUIRE(
+			    A.num_rows == eigenvectors.num_rows,
+			    "Number of rows of A (%d) doesn't match eigenvectors' matrix "
+			    "(%d).\n",
+			    A.num_rows, eigenvectors.num_rows);
+			REQUIRE(
+			    k == eigenvectors.num_cols, "Number of requested eigenvectors "
+			                                "(%d) doesn't match the number "
+			                                "of result matrix columns (%d).\n",
+			    k, eigenvectors.num_cols);
+			REQUIRE(
+			    k == eigenvalues.vlen, "Length of result vector doesn't "
+			                           "match the number of requested "
+			                           "eigenvalues");
+
+			infer_backend(A)->eigen_solver_symmetric_randomized(
+			    A, eigenvalues, eigenvectors, k, num_iterations, oversampling);
+		}
+
 		/** Performs the operation C = A .* B where ".*" denotes elementwise
 		 * multiplication
 		 * on matrix blocks.
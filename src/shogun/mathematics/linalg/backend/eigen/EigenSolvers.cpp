@@ -30,6 +30,7 @@
  * Authors: 2016 Pan Deng, Soumyajit De, Heiko Strathmann, Viktor Gal
  */
 
+#include <shogun/mathematics/Math.h>
 #include <shogun/mathematics/lapack.h>
 #include <shogun/mathematics/linalg/LinalgBackendEigen.h>
 #include <shogun/mathematics/linalg/LinalgMacros.h>
@@ -56,9 +57,23 @@ DEFINE_FOR_NON_INTEGER_PTYPE(BACKEND_GENERIC_EIGEN_SOLVER, SGMatrix)
 DEFINE_FOR_NON_INTEGER_PTYPE(BACKEND_GENERIC_EIGEN_SOLVER_SYMMETRIC, SGMatrix)
 #undef BACKEND_GENERIC_EIGEN_SOLVER_SYMMETRIC
 
+#define BACKEND_GENERIC_EIGEN_SOLVER_SYMMETRIC_RANDOMIZED(Type, Container)     \
+	void LinalgBackendEigen::eigen_solver_symmetric_randomized(                \
+	    const Container<Type>& A, SGVector<Type>& eigenvalues,                 \
+	    SGMatrix<Type>& eigenvectors, index_t k, index_t num_iterations,       \
+	    index_t oversampling) const                                            \
+	{                                                                          \
+		eigen_solver_symmetric_randomized_impl(                                \
+		    A, eigenvalues, eigenvectors, k, num_iterations, oversampling);    \
+	}
+DEFINE_FOR_NON_INTEGER_REAL_PTYPE(
+    BACKEND_GENERIC_EIGEN_SOLVER_SYMMETRIC_RANDOMIZED, SGMatrix)
+#undef BACKEND_GENERIC_EIGEN_SOLVER_SYMMETRIC_RANDOMIZED
+
 #undef DEFINE_FOR_ALL_PTYPE
 #undef DEFINE_FOR_REAL_PTYPE
 #undef DEFINE_FOR_NON_INTEGER_PTYPE
+#undef DEFINE_FOR_NON_INTEGER_REAL_PTYPE
 #undef DEFINE_FOR_NUMERIC_PTYPE
 
 template <typename T>
@@ -134,6 +149,51 @@ void LinalgBackendEigen::eigen_solver_symmetric_impl(
 	eigenvectors_eig = solver.eigenvectors().rightCols(k).template cast<T>();
 }
 
+template <typename T>
+void LinalgBackendEigen::eigen_solver_symmetric_randomized_impl(
+    const SGMatrix<T>& A, SGVector<T>& eigenvalues, SGMatrix<T>& eigenvectors,
+    index_t k, index_t num_iterations, index_t oversampling) const
+{
+	typedef typename SGMatrix<T>::EigenMatrixXt MatrixXt;
+
+	typename SGMatrix<T>::EigenMatrixXtMap A_eig = A;
+	typename SGMatrix<T>::EigenMatrixXtMap eigenvectors_eig = eigenvectors;
+	typename SGVector<T>::EigenVectorXtMap eigenvalues_eig = eigenvalues;
+
+	const index_t n = A.num_rows;
+	const index_t l = CMath::min(n, k + oversampling);
+
+	// Gaussian test matrix spanning the initial subspace
+	MatrixXt Q(n, l);
+	for (index_t i = 0; i < n * l; ++i)
+		Q.data()[i] = (T)CMath::randn_double();
+
+	/*
+	 * subspace iteration: the basis is re-orthonormalized after every
+	 * product with A so that the small eigenvalues are not lost to
+	 * round-off, and only n x l blocks are ever stored
+	 */
+	MatrixXt Y(n, l);
+	for (index_t i = 0; i <= num_iterations; ++i)
+	{
+		Y.noalias() = A_eig * Q;
+		Eigen::HouseholderQR<MatrixXt> qr(Y);
+		Q = qr.householderQ() * MatrixXt::Identity(n, l);
+	}
+
+	// Rayleigh-Ritz projection onto the captured subspace
+	Y.noalias() = A_eig * Q;
+	MatrixXt B = Q.transpose() * Y;
+
+	Eigen::SelfAdjointEigenSolver<MatrixXt> solver(B);
+	REQUIRE(
+	    solver.info() != Eigen::NoConvergence,
+	    "Iterative procedure did not converge!\n");
+
+	eigenvalues_eig = solver.eigenvalues().tail(k);
+	eigenvectors_eig.noalias() = Q * solver.eigenvectors().rightCols(k);
+}
+
 #ifdef HAVE_LAPACK
 template <>
 void LinalgBackendEigen::eigen_solver_symmetric_impl<float64_t>(
@@ -123,6 +123,8 @@ bool CAutoencoder::train(CFeatures* data)
 		result = train_gradient_descent(inputs, inputs);
 	else if (m_optimization_method==NNOM_LBFGS)
 		result = train_lbfgs(inputs, inputs);
+	else if (m_optimization_method==NNOM_STOCHASTIC_MINIMIZER)
+		result = train_stochastic_minimizer(inputs, inputs);
 
 	for (int32_t i=0; i<m_num_layers; i++)
 		get_layer(i)->is_training = false;
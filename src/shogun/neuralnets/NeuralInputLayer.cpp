@@ -57,6 +57,13 @@ CNeuralInputLayer::CNeuralInputLayer(int32_t width, int32_t height,
 }
 
 void CNeuralInputLayer::compute_activations(SGMatrix< float64_t > inputs)
+{
+	draw_gaussian_noise();
+	compute_activations(inputs, get_gaussian_noise());
+}
+
+void CNeuralInputLayer::compute_activations(SGMatrix<float64_t> inputs,
+		SGMatrix<float64_t> noise)
 {
 	if (m_start_index == 0)
 	{
@@ -69,11 +76,47 @@ void CNeuralInputLayer::compute_activations(SGMatrix< float64_t > inputs)
 			for (int32_t j=0; j<m_batch_size; j++)
 				m_activations(i,j) = inputs(m_start_index+i, j);
 	}
-	if (gaussian_noise > 0)
+	if (noise.matrix)
 	{
 		int32_t len = m_num_neurons*m_batch_size;
 		for (int32_t k=0; k<len; k++)
-			m_activations[k] += CMath::normal_random(0.0, gaussian_noise);
+			m_activations[k] += noise[k];
+	}
+}
+
+void CNeuralInputLayer::draw_gaussian_noise()
+{
+	if (gaussian_noise <= 0)
+		return;
+
+	if (m_noise.num_rows!=m_num_neurons || m_noise.num_cols!=m_batch_size)
+		m_noise = SGMatrix<float64_t>(m_num_neurons, m_batch_size);
+
+	int32_t len = m_num_neurons*m_batch_size;
+	for (int32_t k=0; k<len; k++)
+		m_noise[k] = CMath::normal_random(0.0, gaussian_noise);
+}
+
+SGMatrix<float64_t> CNeuralInputLayer::get_gaussian_noise()
+{
+	if (gaussian_noise <= 0)
+		return SGMatrix<float64_t>();
+
+	return m_noise;
+}
+
+void CNeuralInputLayer::compute_inference_activations(
+		SGVector<float64_t> parameters, SGMatrix<float64_t> inputs,
+		const SGMatrix<float64_t>* layer_activations,
+		SGMatrix<float64_t> activations)
+{
+	float64_t scale = 1.0-dropout_prop;
+	for (int32_t j=0; j<activations.num_cols; j++)
+	{
+		float64_t* src = inputs.get_column_vector(j)+m_start_index;
+		float64_t* dst = activations.get_column_vector(j);
+		for (int32_t i=0; i<m_num_neurons; i++)
+			dst[i] = scale*src[i];
 	}
 }
 
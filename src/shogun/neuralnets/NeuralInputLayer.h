@@ -87,6 +87,45 @@ public:
 	 */
 	virtual void compute_activations(SGMatrix<float64_t> inputs);
 
+	/** Like compute_activations(), but adds the given noise instead of
+	 * drawing new gaussian noise. Used by layer copies that work on a slice of
+	 * a batch whose noise was drawn by draw_gaussian_noise()
+	 *
+	 * @param inputs Input features matrix, size num_features*num_cases
+	 * @param noise noise to add, matrix of size num_neurons*num_cases, or an
+	 * empty matrix for no noise
+	 */
+	virtual void compute_activations(SGMatrix<float64_t> inputs,
+			SGMatrix<float64_t> noise);
+
+	/** If gaussian_noise is nonzero, draws the noise for the whole batch,
+	 * in the order compute_activations() adds it, and keeps it in the layer
+	 */
+	virtual void draw_gaussian_noise();
+
+	/** Gets the noise drawn by the last call to draw_gaussian_noise()
+	 *
+	 * @return matrix of size num_neurons*batch_size, or an empty matrix if
+	 * gaussian_noise is zero
+	 */
+	virtual SGMatrix<float64_t> get_gaussian_noise();
+
+	virtual bool supports_inference() { return true; }
+
+	/** Copies the layer's section of the inputs into activations, scaled by
+	 * (1-dropout_prop). Gaussian noise is not added.
+	 *
+	 * @param parameters unused
+	 * @param inputs inputs to the network, matrix of size
+	 * num_inputs*batch_size
+	 * @param layer_activations unused
+	 * @param activations matrix of size num_neurons*batch_size
+	 */
+	virtual void compute_inference_activations(SGVector<float64_t> parameters,
+			SGMatrix<float64_t> inputs,
+			const SGMatrix<float64_t>* layer_activations,
+			SGMatrix<float64_t> activations);
+
 	/** Gets the index of the first feature that the layer connects to,
 	 * i.e the activations of the layer are copied from
 	 * input_features[start_index:start_index+num_neurons]
@@ -116,6 +155,9 @@ protected:
 	 * input_features[start_index:start_index+num_neurons]
 	 */
 	int32_t m_start_index;
+
+	/** Noise drawn by draw_gaussian_noise(), size num_neurons*batch_size */
+	SGMatrix<float64_t> m_noise;
 };
 }
 #endif
@@ -91,23 +91,39 @@ void CNeuralLayer::dropout_activations()
 {
 	if (dropout_prop==0.0) return;
 
+	draw_dropout_mask();
+	dropout_activations(m_dropout_mask);
+}
+
+void CNeuralLayer::dropout_activations(SGMatrix<bool> mask)
+{
+	if (dropout_prop==0.0) return;
+
+	int32_t len = m_num_neurons*m_batch_size;
 	if (is_training)
 	{
-		int32_t len = m_num_neurons*m_batch_size;
+		if (mask.matrix!=m_dropout_mask.matrix)
+			sg_memcpy(m_dropout_mask.matrix, mask.matrix, len*sizeof(bool));
+
 		for (int32_t i=0; i<len; i++)
-		{
-			m_dropout_mask[i] = CMath::random(0.0,1.0) >= dropout_prop;
 			m_activations[i] *= m_dropout_mask[i];
-		}
 	}
 	else
 	{
-		int32_t len = m_num_neurons*m_batch_size;
 		for (int32_t i=0; i<len; i++)
 			m_activations[i] *= (1.0-dropout_prop);
 	}
 }
 
+void CNeuralLayer::draw_dropout_mask()
+{
+	if (dropout_prop==0.0 || !is_training) return;
+
+	int32_t len = m_num_neurons*m_batch_size;
+	for (int32_t i=0; i<len; i++)
+		m_dropout_mask[i] = CMath::random(0.0,1.0) >= dropout_prop;
+}
+
 void CNeuralLayer::init()
 {
 	m_num_neurons = 0;
@@ -119,6 +135,7 @@ void CNeuralLayer::init()
 	contraction_coefficient = 0.0;
 	is_training = false;
 	autoencoder_position = NLAP_NONE;
+	single_precision = false;
 
 	SG_ADD(&m_num_neurons, "num_neurons",
 	       "Number of Neurons", MS_NOT_AVAILABLE);
@@ -149,4 +166,6 @@ void CNeuralLayer::init()
 
 	SG_ADD((machine_int_t*)&autoencoder_position, "autoencoder_position",
 	       "Autoencoder Position", MS_NOT_AVAILABLE);
+	SG_ADD(&single_precision, "single_precision",
+	       "Single precision computations", MS_NOT_AVAILABLE);
 }
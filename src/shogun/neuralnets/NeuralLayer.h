@@ -164,6 +164,36 @@ public:
 	virtual void compute_activations(SGVector<float64_t> parameters,
 			CDynamicObjectArray* layers) { }
 
+	/** Returns true if the layer implements
+	 * compute_inference_activations()
+	 */
+	virtual bool supports_inference() { return false; }
+
+	/** Computes the activations of the layer for inference. Unlike
+	 * compute_activations(), this neither reads nor modifies any of the
+	 * layer's buffers, so it can be called from several threads at once on a
+	 * trained network. Dropout is accounted for by scaling the activations by
+	 * (1-dropout_prop).
+	 *
+	 * @param parameters Vector of size get_num_parameters(), contains the
+	 * parameters of the layer
+	 *
+	 * @param inputs inputs to the network, matrix of size
+	 * num_inputs*batch_size. Only used by input layers
+	 *
+	 * @param layer_activations activations of every layer in the network,
+	 * indexed in the same order as the network's layers array. The
+	 * activations of the layers that connect into this layer must already be
+	 * computed
+	 *
+	 * @param activations matrix of size num_neurons*batch_size, to be filled
+	 * with the layer's activations
+	 */
+	virtual void compute_inference_activations(SGVector<float64_t> parameters,
+			SGMatrix<float64_t> inputs,
+			const SGMatrix<float64_t>* layer_activations,
+			SGMatrix<float64_t> activations) { }
+
 	/** Computes the gradients that are relevent to this layer:
 	 *- The gradients of the error with respect to the layer's parameters
 	 * -The gradients of the error with respect to the layer's inputs
@@ -226,6 +256,29 @@ public:
 	 */
 	virtual void dropout_activations();
 
+	/** Applies dropout like dropout_activations(), but during training
+	 * multiplies the given mask into the activations instead of drawing a new
+	 * one. The mask is copied into m_dropout_mask for backpropagation. Used by
+	 * layer copies that work on a slice of a batch whose mask was drawn by
+	 * draw_dropout_mask()
+	 *
+	 * @param mask matrix of size num_neurons*batch_size
+	 */
+	virtual void dropout_activations(SGMatrix<bool> mask);
+
+	/** If is_training is true and dropout_prop is nonzero, fills
+	 * m_dropout_mask with random values without applying it, drawing them in
+	 * the same order as dropout_activations()
+	 */
+	virtual void draw_dropout_mask();
+
+	/** Gets the layer's dropout mask
+	 *
+	 * @return the layer's dropout mask, matrix of size
+	 * num_neurons*batch_size
+	 */
+	virtual SGMatrix<bool> get_dropout_mask() { return m_dropout_mask; }
+
 	/** Computes
 	 * \f[ \frac{\lambda}{N} \sum_{k=0}^{N-1} \left \| J(x_k) \right \|^2_F \f]
 	 * where \f$ \left \| J(x_k)) \right \|^2_F \f$ is the Frobenius norm of
@@ -342,6 +395,14 @@ public:
 	 */
 	ENLAutoencoderPosition autoencoder_position;
 
+	/** If true, the layer computes the matrix products of forward and
+	 * backpropagation during training in single precision (float32), trading
+	 * accuracy for speed. The inference forward pass always computes in
+	 * double precision. Layers that do not support this ignore it.
+	 * Default value is false
+	 */
+	bool single_precision;
+
 protected:
 	/** Number of neurons in this layer */
 	int32_t m_num_neurons;
@@ -59,4 +59,19 @@ void CNeuralLeakyRectifiedLinearLayer::compute_activations(
 	{
 		m_activations[i] = CMath::max<float64_t>(m_alpha*m_activations[i], m_activations[i]);
 	}
-}
\ No newline at end of file
+}
+
+void CNeuralLeakyRectifiedLinearLayer::compute_inference_epilogue(
+	const float64_t* biases, SGMatrix<float64_t> activations)
+{
+	float64_t scale = 1.0-dropout_prop;
+	for (int32_t j=0; j<activations.num_cols; j++)
+	{
+		float64_t* a = activations.get_column_vector(j);
+		for (int32_t i=0; i<m_num_neurons; i++)
+		{
+			float64_t z = a[i]+biases[i];
+			a[i] = scale*CMath::max<float64_t>(m_alpha*z, z);
+		}
+	}
+}
@@ -86,6 +86,20 @@ public:
 	virtual void compute_activations(SGVector<float64_t> parameters,
 		CDynamicObjectArray* layers);
 
+	/** Adds the biases, applies the leaky rectified linear function and scales by
+	 * (1-dropout_prop) in a single pass
+	 *
+	 * @param biases array of size num_neurons
+	 * @param activations matrix of size num_neurons*batch_size
+	 */
+	virtual void compute_inference_epilogue(const float64_t* biases,
+			SGMatrix<float64_t> activations);
+
+	/** Returns true, compute_inference_epilogue() implements the leaky rectified linear
+	 * activations of compute_activations()
+	 */
+	virtual bool supports_inference() { return true; }
+
 	virtual const char* get_name() const { return "NeuralLeakyRectifiedLinearLayer"; }
 
 protected:
@@ -37,6 +37,8 @@
 
 #include <shogun/mathematics/eigen3.h>
 
+#include <typeinfo>
+
 using namespace shogun;
 
 CNeuralLinearLayer::CNeuralLinearLayer() : CNeuralLayer()
@@ -78,6 +80,7 @@ void CNeuralLinearLayer::compute_activations(SGVector<float64_t> parameters,
 	float64_t* biases = parameters.vector;
 
 	typedef Eigen::Map<Eigen::MatrixXd> EMappedMatrix;
+	typedef Eigen::Map<Eigen::MatrixXf> EMappedMatrix32;
 	typedef Eigen::Map<Eigen::VectorXd> EMappedVector;
 
 	EMappedMatrix  A(m_activations.matrix, m_num_neurons, m_batch_size);
@@ -94,15 +97,80 @@ void CNeuralLinearLayer::compute_activations(SGVector<float64_t> parameters,
 		float64_t* weights = parameters.vector + weights_index_offset;
 		weights_index_offset += m_num_neurons*layer->get_num_neurons();
 
-		EMappedMatrix W(weights, m_num_neurons, layer->get_num_neurons());
+		int32_t num_inputs = layer->get_num_neurons();
+		EMappedMatrix W(weights, m_num_neurons, num_inputs);
 		EMappedMatrix X(layer->get_activations().matrix,
-				layer->get_num_neurons(), m_batch_size);
+				num_inputs, m_batch_size);
 
-		A += W*X;
+		if (single_precision)
+		{
+			EMappedMatrix32 W32(get_buffer32(m_weights32,
+				(int64_t)m_num_neurons*num_inputs), m_num_neurons, num_inputs);
+			EMappedMatrix32 X32(get_buffer32(m_inputs32,
+				(int64_t)num_inputs*m_batch_size), num_inputs, m_batch_size);
+			EMappedMatrix32 P32(get_buffer32(m_products32,
+				(int64_t)m_num_neurons*m_batch_size), m_num_neurons, m_batch_size);
+
+			W32 = W.cast<float32_t>();
+			X32 = X.cast<float32_t>();
+			P32.noalias() = W32*X32;
+			A += P32.cast<float64_t>();
+		}
+		else
+			A += W*X;
 		SG_UNREF(layer);
 	}
 }
 
+bool CNeuralLinearLayer::supports_inference()
+{
+	return typeid(*this)==typeid(CNeuralLinearLayer);
+}
+
+void CNeuralLinearLayer::compute_inference_activations(
+		SGVector<float64_t> parameters, SGMatrix<float64_t> inputs,
+		const SGMatrix<float64_t>* layer_activations,
+		SGMatrix<float64_t> activations)
+{
+	typedef Eigen::Map<Eigen::MatrixXd> EMappedMatrix;
+
+	int32_t batch_size = activations.num_cols;
+	EMappedMatrix A(activations.matrix, m_num_neurons, batch_size);
+
+	if (m_input_indices.vlen==0)
+		A.setZero();
+
+	int32_t weights_index_offset = m_num_neurons;
+	for (int32_t l=0; l<m_input_indices.vlen; l++)
+	{
+		float64_t* weights = parameters.vector + weights_index_offset;
+		weights_index_offset += m_num_neurons*m_input_sizes[l];
+
+		EMappedMatrix W(weights, m_num_neurons, m_input_sizes[l]);
+		EMappedMatrix X(layer_activations[m_input_indices[l]].matrix,
+				m_input_sizes[l], batch_size);
+
+		if (l==0)
+			A.noalias() = W*X;
+		else
+			A.noalias() += W*X;
+	}
+
+	compute_inference_epilogue(parameters.vector, activations);
+}
+
+void CNeuralLinearLayer::compute_inference_epilogue(const float64_t* biases,
+		SGMatrix<float64_t> activations)
+{
+	float64_t scale = 1.0-dropout_prop;
+	for (int32_t j=0; j<activations.num_cols; j++)
+	{
+		float64_t* a = activations.get_column_vector(j);
+		for (int32_t i=0; i<m_num_neurons; i++)
+			a[i] = scale*(a[i]+biases[i]);
+	}
+}
+
 void CNeuralLinearLayer::compute_gradients(
 		SGVector<float64_t> parameters,
 		SGMatrix<float64_t> targets,
@@ -129,6 +197,15 @@ void CNeuralLinearLayer::compute_gradients(
 			m_local_gradients[i] *= m_dropout_mask[i];
 	}
 
+	typedef Eigen::Map<Eigen::MatrixXf> EMappedMatrix32;
+	EMappedMatrix32 LG32(NULL, m_num_neurons, m_batch_size);
+	if (single_precision)
+	{
+		new (&LG32) EMappedMatrix32(get_buffer32(m_local_gradients32,
+			(int64_t)m_num_neurons*m_batch_size), m_num_neurons, m_batch_size);
+		LG32 = LG.cast<float32_t>();
+	}
+
 	int32_t weights_index_offset = m_num_neurons;
 	for (int32_t l=0; l<m_input_indices.vlen; l++)
 	{
@@ -149,12 +226,38 @@ void CNeuralLinearLayer::compute_gradients(
 		EMappedMatrix  IG(layer->get_activation_gradients().matrix,
 				layer->get_num_neurons(), m_batch_size);
 
-		// compute weight gradients
-		WG = LG*X.transpose();
+		if (single_precision)
+		{
+			int32_t num_inputs = layer->get_num_neurons();
+			EMappedMatrix32 X32(get_buffer32(m_inputs32,
+				(int64_t)num_inputs*m_batch_size), num_inputs, m_batch_size);
+			EMappedMatrix32 P32(get_buffer32(m_products32,
+				(int64_t)m_num_neurons*num_inputs), m_num_neurons, num_inputs);
+
+			// compute weight gradients
+			X32 = X.cast<float32_t>();
+			P32.noalias() = LG32*X32.transpose();
+			WG = P32.cast<float64_t>();
+
+			// compute input gradients, reusing the buffer of the inputs
+			if (!layer->is_input())
+			{
+				EMappedMatrix32 W32(get_buffer32(m_weights32,
+					(int64_t)m_num_neurons*num_inputs), m_num_neurons, num_inputs);
+				W32 = W.cast<float32_t>();
+				X32.noalias() = W32.transpose()*LG32;
+				IG += X32.cast<float64_t>();
+			}
+		}
+		else
+		{
+			// compute weight gradients
+			WG = LG*X.transpose();
 
-		// compute input gradients
-		if (!layer->is_input())
-			IG += W.transpose()*LG;
+			// compute input gradients
+			if (!layer->is_input())
+				IG += W.transpose()*LG;
+		}
 		SG_UNREF(layer);
 	}
 
@@ -164,6 +267,15 @@ void CNeuralLinearLayer::compute_gradients(
 	}
 }
 
+float32_t* CNeuralLinearLayer::get_buffer32(SGVector<float32_t>& buffer,
+		int64_t length)
+{
+	if (buffer.vlen<length)
+		buffer = SGVector<float32_t>(length);
+
+	return buffer.vector;
+}
+
 void CNeuralLinearLayer::compute_local_gradients(SGMatrix<float64_t> targets)
 {
 	if (targets.num_rows != 0)
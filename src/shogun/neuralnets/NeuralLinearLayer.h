@@ -116,6 +116,42 @@ public:
 	virtual void compute_activations(SGVector<float64_t> parameters,
 			CDynamicObjectArray* layers);
 
+	/** Returns true for this class only. Derived layers have to opt in by
+	 * overriding this, as their compute_activations() may do more than
+	 * compute_inference_epilogue() accounts for
+	 */
+	virtual bool supports_inference();
+
+	/** Computes the activations of the layer for inference: the products of
+	 * the weights with the input activations, followed by
+	 * compute_inference_epilogue(). Does not use the layer's buffers, so it
+	 * can be called from several threads at once
+	 *
+	 * @param parameters Vector of size get_num_parameters(), contains the
+	 * parameters of the layer
+	 * @param inputs unused
+	 * @param layer_activations activations of every layer in the network
+	 * @param activations matrix of size num_neurons*batch_size, to be filled
+	 * with the layer's activations
+	 */
+	virtual void compute_inference_activations(SGVector<float64_t> parameters,
+			SGMatrix<float64_t> inputs,
+			const SGMatrix<float64_t>* layer_activations,
+			SGMatrix<float64_t> activations);
+
+	/** Adds the biases to the given pre-activations, applies the activation
+	 * function and scales the result by (1-dropout_prop), all in a single
+	 * pass over the matrix.
+	 *
+	 * Should be overriden by layers with different activation functions
+	 *
+	 * @param biases array of size num_neurons
+	 * @param activations matrix of size num_neurons*batch_size, holds the
+	 * products of the weights and the inputs on entry
+	 */
+	virtual void compute_inference_epilogue(const float64_t* biases,
+			SGMatrix<float64_t> activations);
+
 	/** Computes the gradients that are relevent to this layer:
 	 *- The gradients of the error with respect to the layer's parameters
 	 * -The gradients of the error with respect to the layer's inputs
@@ -211,6 +247,28 @@ public:
 	virtual void compute_local_gradients(SGMatrix<float64_t> targets);
 
 	virtual const char* get_name() const { return "NeuralLinearLayer"; }
+
+protected:
+	/** Returns the storage of a single precision buffer, growing it if it
+	 * holds less than length elements
+	 *
+	 * @param buffer buffer to use
+	 * @param length number of elements needed
+	 */
+	static float32_t* get_buffer32(SGVector<float32_t>& buffer, int64_t length);
+
+protected:
+	/** Single precision buffers used when single_precision is set, kept
+	 * between calls: the weights of one input layer, its activations (and
+	 * later its activation gradients), and the products of the two
+	 */
+	SGVector<float32_t> m_weights32;
+	/** see m_weights32 */
+	SGVector<float32_t> m_inputs32;
+	/** see m_weights32 */
+	SGVector<float32_t> m_products32;
+	/** Single precision copy of the local gradients */
+	SGVector<float32_t> m_local_gradients32;
 };
 
 }
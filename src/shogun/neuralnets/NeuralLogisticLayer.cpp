@@ -57,6 +57,18 @@ void CNeuralLogisticLayer::compute_activations(SGVector<float64_t> parameters,
 		m_activations[i] = 1.0 / (1.0 + std::exp(-1.0 * m_activations[i]));
 }
 
+void CNeuralLogisticLayer::compute_inference_epilogue(const float64_t* biases,
+		SGMatrix<float64_t> activations)
+{
+	float64_t scale = 1.0-dropout_prop;
+	for (int32_t j=0; j<activations.num_cols; j++)
+	{
+		float64_t* a = activations.get_column_vector(j);
+		for (int32_t i=0; i<m_num_neurons; i++)
+			a[i] = scale / (1.0 + std::exp(-1.0 * (a[i]+biases[i])));
+	}
+}
+
 float64_t CNeuralLogisticLayer::compute_contraction_term(
 	SGVector< float64_t > parameters)
 {
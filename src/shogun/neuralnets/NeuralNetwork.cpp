@@ -34,12 +34,112 @@
 #include <shogun/neuralnets/NeuralNetwork.h>
 #include <shogun/mathematics/Math.h>
 #include <shogun/optimization/lbfgs/lbfgs.h>
+#include <shogun/optimization/FirstOrderStochasticMinimizer.h>
+#include <shogun/optimization/FirstOrderStochasticCostFunction.h>
 #include <shogun/features/DenseFeatures.h>
 #include <shogun/lib/DynamicObjectArray.h>
+#include <shogun/lib/Lock.h>
 #include <shogun/neuralnets/NeuralLayer.h>
+#include <shogun/neuralnets/NeuralInputLayer.h>
 
 using namespace shogun;
 
+/** minimum number of training cases in each of the slices that a batch is split
+ * into when computing gradients in parallel
+ */
+static const int32_t NN_MIN_SLICE_SIZE = 32;
+
+namespace shogun
+{
+/** @brief Cost function used to train a CNeuralNetwork with a
+ * FirstOrderStochasticMinimizer, each sample is a mini-batch of the training
+ * set
+ */
+class NeuralNetworkCostFunction: public FirstOrderStochasticCostFunction
+{
+public:
+	NeuralNetworkCostFunction(): FirstOrderStochasticCostFunction()
+	{
+		m_network = NULL;
+		m_batch_size = 0;
+		m_batch_start = 0;
+		m_num_batches = 0;
+		m_pass_error = 0.0;
+	}
+
+	virtual ~NeuralNetworkCostFunction() {}
+
+	/** sets the network to train and its training data */
+	void set_target(CNeuralNetwork* network, SGMatrix<float64_t> inputs,
+		SGMatrix<float64_t> targets, int32_t batch_size)
+	{
+		m_network = network;
+		m_inputs = inputs;
+		m_targets = targets;
+		m_batch_size = batch_size;
+		m_gradients = SGVector<float64_t>(network->get_num_parameters());
+	}
+
+	virtual void begin_sample()
+	{
+		m_batch_start = -m_batch_size;
+		m_num_batches = 0;
+		m_pass_error = 0.0;
+	}
+
+	virtual bool next_sample()
+	{
+		m_batch_start += m_batch_size;
+		return m_batch_start < m_inputs.num_cols;
+	}
+
+	virtual SGVector<float64_t> get_gradient()
+	{
+		// the last mini-batch is shifted back so that it is a full one
+		int32_t j = CMath::min(m_batch_start, m_inputs.num_cols-m_batch_size);
+
+		SGMatrix<float64_t> inputs_batch(
+			m_inputs.matrix+(int64_t)j*m_inputs.num_rows,
+			m_inputs.num_rows, m_batch_size, false);
+		SGMatrix<float64_t> targets_batch(
+			m_targets.matrix+(int64_t)j*m_targets.num_rows,
+			m_targets.num_rows, m_batch_size, false);
+
+		m_pass_error += m_network->compute_gradients(inputs_batch,
+			targets_batch, m_gradients);
+		m_num_batches++;
+
+		return m_gradients;
+	}
+
+	/** returns the mean error of the mini-batches seen in the current pass */
+	virtual float64_t get_cost()
+	{
+		return m_num_batches>0 ? m_pass_error/m_num_batches : 0.0;
+	}
+
+	virtual SGVector<float64_t> obtain_variable_reference()
+	{
+		return m_network->m_params;
+	}
+
+	virtual const char* get_name() const
+	{
+		return "NeuralNetworkCostFunction";
+	}
+
+private:
+	CNeuralNetwork* m_network;
+	SGMatrix<float64_t> m_inputs;
+	SGMatrix<float64_t> m_targets;
+	SGVector<float64_t> m_gradients;
+	int32_t m_batch_size;
+	int32_t m_batch_start;
+	int32_t m_num_batches;
+	float64_t m_pass_error;
+};
+}
+
 CNeuralNetwork::CNeuralNetwork()
 : CMachine()
 {
@@ -69,9 +169,33 @@ void CNeuralNetwork::set_layers(CDynamicObjectArray* layers)
 	{
 		if (get_layer(i)->is_input())
 			m_num_inputs += get_layer(i)->get_num_neurons();
+
+		get_layer(i)->single_precision = m_single_precision;
 	}
 }
 
+void CNeuralNetwork::set_minimizer(FirstOrderStochasticMinimizer* minimizer)
+{
+	REQUIRE(minimizer, "Minimizer must be set\n");
+	SG_REF(minimizer);
+	SG_UNREF(m_minimizer);
+	m_minimizer = minimizer;
+	m_optimization_method = NNOM_STOCHASTIC_MINIMIZER;
+}
+
+FirstOrderStochasticMinimizer* CNeuralNetwork::get_minimizer()
+{
+	SG_REF(m_minimizer);
+	return m_minimizer;
+}
+
+void CNeuralNetwork::set_single_precision(bool single_precision)
+{
+	m_single_precision = single_precision;
+	for (int32_t i=0; i<m_num_layers; i++)
+		get_layer(i)->single_precision = m_single_precision;
+}
+
 void CNeuralNetwork::connect(int32_t i, int32_t j)
 {
 	REQUIRE("i<j", "i(%i) must be less that j(%i)\n", i, j);
@@ -152,15 +276,20 @@ void CNeuralNetwork::initialize_neural_network(float64_t sigma)
 
 CNeuralNetwork::~CNeuralNetwork()
 {
+	release_layer_replicas();
+	delete m_inference_lock;
+	SG_UNREF(m_minimizer);
 	SG_UNREF(m_layers);
 }
 
 CBinaryLabels* CNeuralNetwork::apply_binary(CFeatures* data)
 {
-	SGMatrix<float64_t> output_activations = forward_propagate(data);
-	CBinaryLabels* labels = new CBinaryLabels(m_batch_size);
+	SGMatrix<float64_t> output_activations =
+		forward_propagate_inference(features_to_matrix(data));
+	int32_t num_cases = output_activations.num_cols;
+	CBinaryLabels* labels = new CBinaryLabels(num_cases);
 
-	for (int32_t i=0; i<m_batch_size; i++)
+	for (int32_t i=0; i<num_cases; i++)
 	{
 		if (get_num_outputs()==1)
 		{
@@ -186,10 +315,11 @@ CBinaryLabels* CNeuralNetwork::apply_binary(CFeatures* data)
 
 CRegressionLabels* CNeuralNetwork::apply_regression(CFeatures* data)
 {
-	SGMatrix<float64_t> output_activations = forward_propagate(data);
-	SGVector<float64_t> labels_vec(m_batch_size);
+	SGMatrix<float64_t> output_activations =
+		forward_propagate_inference(features_to_matrix(data));
+	SGVector<float64_t> labels_vec(output_activations.num_cols);
 
-	for (int32_t i=0; i<m_batch_size; i++)
+	for (int32_t i=0; i<labels_vec.vlen; i++)
 			labels_vec[i] = output_activations[i];
 
 	return new CRegressionLabels(labels_vec);
@@ -198,10 +328,12 @@ CRegressionLabels* CNeuralNetwork::apply_regression(CFeatures* data)
 
 CMulticlassLabels* CNeuralNetwork::apply_multiclass(CFeatures* data)
 {
-	SGMatrix<float64_t> output_activations = forward_propagate(data);
-	SGVector<float64_t> labels_vec(m_batch_size);
+	SGMatrix<float64_t> output_activations =
+		forward_propagate_inference(features_to_matrix(data));
+	int32_t num_cases = output_activations.num_cols;
+	SGVector<float64_t> labels_vec(num_cases);
 
-	for (int32_t i=0; i<m_batch_size; i++)
+	for (int32_t i=0; i<num_cases; i++)
 	{
 		labels_vec[i] = CMath::arg_max(
 			output_activations.matrix+i*get_num_outputs(), 1, get_num_outputs());
@@ -210,7 +342,7 @@ CMulticlassLabels* CNeuralNetwork::apply_multiclass(CFeatures* data)
 	CMulticlassLabels* labels = new CMulticlassLabels(labels_vec);
 
 	labels->allocate_confidences_for(get_num_outputs());
-	for (int32_t i=0; i<m_batch_size; i++)
+	for (int32_t i=0; i<num_cases; i++)
 	{
 		labels->set_multiclass_confidences(i, SGVector<float64_t>(
 			output_activations.matrix, get_num_outputs(), i*get_num_outputs()));
@@ -222,7 +354,8 @@ CMulticlassLabels* CNeuralNetwork::apply_multiclass(CFeatures* data)
 CDenseFeatures< float64_t >* CNeuralNetwork::transform(
 	CDenseFeatures< float64_t >* data)
 {
-	SGMatrix<float64_t> output_activations = forward_propagate(data);
+	SGMatrix<float64_t> output_activations =
+		forward_propagate_inference(features_to_matrix(data));
 	return new CDenseFeatures<float64_t>(output_activations);
 }
 
@@ -250,6 +383,8 @@ bool CNeuralNetwork::train_machine(CFeatures* data)
 		result = train_gradient_descent(inputs, targets);
 	else if (m_optimization_method==NNOM_LBFGS)
 		result = train_lbfgs(inputs, targets);
+	else if (m_optimization_method==NNOM_STOCHASTIC_MINIMIZER)
+		result = train_stochastic_minimizer(inputs, targets);
 
 	for (int32_t i=0; i<m_num_layers; i++)
 		get_layer(i)->is_training = false;
@@ -270,6 +405,8 @@ bool CNeuralNetwork::train_gradient_descent(SGMatrix<float64_t> inputs,
 	if (m_gd_mini_batch_size==0) m_gd_mini_batch_size = training_set_size;
 	set_batch_size(m_gd_mini_batch_size);
 
+	init_layer_replicas();
+
 	int32_t n_param = get_num_parameters();
 	SGVector<float64_t> gradients(n_param);
 
@@ -351,6 +488,7 @@ bool CNeuralNetwork::train_gradient_descent(SGMatrix<float64_t> inputs,
 		}
 	}
 
+	release_layer_replicas();
 	return true;
 }
 
@@ -370,6 +508,8 @@ bool CNeuralNetwork::train_lbfgs(SGMatrix<float64_t> inputs,
 	m_lbfgs_temp_inputs = &inputs;
 	m_lbfgs_temp_targets = &targets;
 
+	init_layer_replicas();
+
 	int32_t result = lbfgs(m_total_num_parameters,
 			m_params,
 			NULL,
@@ -381,6 +521,8 @@ bool CNeuralNetwork::train_lbfgs(SGMatrix<float64_t> inputs,
 	m_lbfgs_temp_inputs = NULL;
 	m_lbfgs_temp_targets = NULL;
 
+	release_layer_replicas();
+
 	if (result==LBFGS_SUCCESS || 1)
 	{
 		SG_INFO("L-BFGS Optimization Converged\n");
@@ -396,6 +538,38 @@ bool CNeuralNetwork::train_lbfgs(SGMatrix<float64_t> inputs,
 	return true;
 }
 
+bool CNeuralNetwork::train_stochastic_minimizer(SGMatrix<float64_t> inputs,
+		SGMatrix<float64_t> targets)
+{
+	REQUIRE(m_minimizer, "A minimizer must be set using set_minimizer()\n");
+
+	int32_t training_set_size = inputs.num_cols;
+	int32_t batch_size = m_gd_mini_batch_size;
+	if (batch_size==0 || batch_size>training_set_size)
+		batch_size = training_set_size;
+	set_batch_size(batch_size);
+
+	if (m_max_num_epochs!=0)
+		m_minimizer->set_number_passes(m_max_num_epochs);
+
+	init_layer_replicas();
+
+	NeuralNetworkCostFunction* cost_fun = new NeuralNetworkCostFunction();
+	SG_REF(cost_fun);
+	cost_fun->set_target(this, inputs, targets, batch_size);
+
+	m_minimizer->set_cost_function(cost_fun);
+	float64_t error = m_minimizer->minimize();
+	m_minimizer->unset_cost_function();
+	SG_UNREF(cost_fun);
+
+	release_layer_replicas();
+
+	SG_INFO("%s Optimization finished: Error = %f\n",
+		m_minimizer->get_name(), error);
+	return true;
+}
+
 float64_t CNeuralNetwork::lbfgs_evaluate(void* userdata,
 		const float64_t* W,
 		float64_t* grad,
@@ -464,25 +638,112 @@ SGMatrix<float64_t> CNeuralNetwork::forward_propagate(
 	return get_layer(j)->get_activations();
 }
 
-float64_t CNeuralNetwork::compute_gradients(SGMatrix<float64_t> inputs,
-		SGMatrix<float64_t> targets, SGVector<float64_t> gradients)
+SGMatrix<float64_t> CNeuralNetwork::forward_propagate_inference(
+	SGMatrix<float64_t> inputs)
 {
-	forward_propagate(inputs);
+	bool supported = true;
+	for (int32_t i=0; i<m_num_layers; i++)
+		supported &= get_layer(i)->supports_inference();
 
+	if (!supported)
+	{
+		m_inference_lock->lock();
+		set_batch_size(inputs.num_cols);
+		SGMatrix<float64_t> outputs = forward_propagate(inputs).clone();
+		m_inference_lock->unlock();
+		return outputs;
+	}
+
+	// offsets of the layers' activations in the buffer, in cases
+	SGVector<int64_t> buffer_offsets(m_num_layers);
+	int64_t buffer_size = 0;
 	for (int32_t i=0; i<m_num_layers; i++)
 	{
-		if (!get_layer(i)->is_input())
-			get_layer(i)->get_activation_gradients().zero();
+		buffer_offsets[i] = buffer_size;
+		buffer_size += (int64_t)get_layer(i)->get_num_neurons()*
+			m_max_inference_batch_size;
 	}
 
-	for (int32_t i=m_num_layers-1; i>=0; i--)
+	SGVector<float64_t> buffer;
+	m_inference_lock->lock();
+	if (!m_inference_buffers.empty())
 	{
-		if (i==m_num_layers-1)
-			get_layer(i)->compute_gradients(get_section(m_params,i), targets,
-				m_layers, get_section(gradients,i));
-		else
-			get_layer(i)->compute_gradients(get_section(m_params,i),
-				SGMatrix<float64_t>(), m_layers, get_section(gradients,i));
+		buffer = m_inference_buffers.back();
+		m_inference_buffers.pop_back();
+	}
+	m_inference_lock->unlock();
+
+	if (buffer.vlen!=buffer_size)
+		buffer = SGVector<float64_t>(buffer_size);
+
+	int32_t num_cases = inputs.num_cols;
+	int32_t num_outputs = get_num_outputs();
+	SGMatrix<float64_t> outputs(num_outputs, num_cases);
+	std::vector<SGMatrix<float64_t> > activations(m_num_layers);
+
+	for (int32_t j=0; j<num_cases; j+=m_max_inference_batch_size)
+	{
+		int32_t batch_size =
+			CMath::min(m_max_inference_batch_size, num_cases-j);
+
+		SGMatrix<float64_t> inputs_batch(
+			inputs.matrix+(int64_t)j*inputs.num_rows,
+			inputs.num_rows, batch_size, false);
+
+		for (int32_t i=0; i<m_num_layers; i++)
+		{
+			CNeuralLayer* layer = get_layer(i);
+
+			// the last layer writes straight into the outputs
+			if (i==m_num_layers-1)
+				activations[i] = SGMatrix<float64_t>(
+					outputs.matrix+(int64_t)j*num_outputs,
+					num_outputs, batch_size, false);
+			else
+				activations[i] = SGMatrix<float64_t>(
+					buffer.vector+buffer_offsets[i], layer->get_num_neurons(),
+					batch_size, false);
+
+			layer->compute_inference_activations(get_section(m_params, i),
+				inputs_batch, activations.data(), activations[i]);
+		}
+	}
+
+	m_inference_lock->lock();
+	m_inference_buffers.push_back(buffer);
+	m_inference_lock->unlock();
+
+	return outputs;
+}
+
+float64_t CNeuralNetwork::compute_gradients(SGMatrix<float64_t> inputs,
+		SGMatrix<float64_t> targets, SGVector<float64_t> gradients)
+{
+	bool parallel_batch = m_layer_replicas!=NULL &&
+		inputs.num_cols==m_batch_size;
+
+	float64_t error = 0;
+	if (parallel_batch)
+		error = compute_gradients_parallel(inputs, targets, gradients);
+	else
+	{
+		forward_propagate(inputs);
+
+		for (int32_t i=0; i<m_num_layers; i++)
+		{
+			if (!get_layer(i)->is_input())
+				get_layer(i)->get_activation_gradients().zero();
+		}
+
+		for (int32_t i=m_num_layers-1; i>=0; i--)
+		{
+			if (i==m_num_layers-1)
+				get_layer(i)->compute_gradients(get_section(m_params,i), targets,
+					m_layers, get_section(gradients,i));
+			else
+				get_layer(i)->compute_gradients(get_section(m_params,i),
+					SGMatrix<float64_t>(), m_layers, get_section(gradients,i));
+		}
 	}
 
 	// L2 regularization
@@ -516,12 +777,172 @@ float64_t CNeuralNetwork::compute_gradients(SGMatrix<float64_t> inputs,
 		}
 	}
 
+	if (parallel_batch)
+		return error + compute_regularization_error();
+
 	return compute_error(targets);
 }
 
+float64_t CNeuralNetwork::compute_gradients_parallel(
+		SGMatrix<float64_t> inputs, SGMatrix<float64_t> targets,
+		SGVector<float64_t> gradients)
+{
+	int32_t num_replicas = m_layer_replicas->get_num_elements();
+	SGVector<float64_t> errors(num_replicas);
+
+	// draw the input noise and dropout masks of the whole batch serially, in
+	// the order forward_propagate() draws them, so that the replicas don't
+	// contend for the random number generator and seeded training does not
+	// depend on the number of threads
+	for (int32_t i=0; i<m_num_layers; i++)
+	{
+		CNeuralLayer* layer = get_layer(i);
+		if (layer->is_input())
+			((CNeuralInputLayer*)layer)->draw_gaussian_noise();
+		layer->draw_dropout_mask();
+	}
+
+	#pragma omp parallel for num_threads(num_replicas)
+	for (int32_t r=0; r<num_replicas; r++)
+	{
+		int32_t start = (int64_t)r*m_batch_size/num_replicas;
+		int32_t end = (int64_t)(r+1)*m_batch_size/num_replicas;
+
+		SGMatrix<float64_t> inputs_slice(
+			inputs.matrix+(int64_t)start*inputs.num_rows,
+			inputs.num_rows, end-start, false);
+		SGMatrix<float64_t> targets_slice(
+			targets.matrix+(int64_t)start*targets.num_rows,
+			targets.num_rows, end-start, false);
+		SGVector<float64_t> slice_gradients(
+			m_replica_gradients.matrix+(int64_t)r*m_total_num_parameters,
+			m_total_num_parameters, false);
+
+		CDynamicObjectArray* layers =
+			(CDynamicObjectArray*)m_layer_replicas->element(r);
+
+		for (int32_t i=0; i<m_num_layers; i++)
+		{
+			CNeuralLayer* layer = (CNeuralLayer*)layers->element(i);
+
+			if (layer->is_input())
+			{
+				SGMatrix<float64_t> noise =
+					((CNeuralInputLayer*)get_layer(i))->get_gaussian_noise();
+				if (noise.matrix)
+					noise = SGMatrix<float64_t>(
+						noise.matrix+(int64_t)start*noise.num_rows,
+						noise.num_rows, end-start, false);
+
+				((CNeuralInputLayer*)layer)->compute_activations(
+					inputs_slice, noise);
+			}
+			else
+				layer->compute_activations(get_section(m_params, i), layers);
+
+			SGMatrix<bool> mask = get_layer(i)->get_dropout_mask();
+			layer->dropout_activations(SGMatrix<bool>(
+				mask.matrix+(int64_t)start*mask.num_rows,
+				mask.num_rows, end-start, false));
+
+			if (!layer->is_input())
+				layer->get_activation_gradients().zero();
+			SG_UNREF(layer);
+		}
+
+		for (int32_t i=m_num_layers-1; i>=0; i--)
+		{
+			CNeuralLayer* layer = (CNeuralLayer*)layers->element(i);
+
+			if (i==m_num_layers-1)
+				layer->compute_gradients(get_section(m_params,i), targets_slice,
+					layers, get_section(slice_gradients,i));
+			else
+				layer->compute_gradients(get_section(m_params,i),
+					SGMatrix<float64_t>(), layers, get_section(slice_gradients,i));
+
+			if (i==m_num_layers-1)
+				errors[r] = layer->compute_error(targets_slice);
+			SG_UNREF(layer);
+		}
+
+		SG_UNREF(layers);
+	}
+
+	// every slice computes the mean over its own training cases, so weighting
+	// them by their relative sizes gives the mean over the whole batch
+	gradients.zero();
+	float64_t error = 0;
+	for (int32_t r=0; r<num_replicas; r++)
+	{
+		int32_t start = (int64_t)r*m_batch_size/num_replicas;
+		int32_t end = (int64_t)(r+1)*m_batch_size/num_replicas;
+		float64_t weight = (float64_t)(end-start)/m_batch_size;
+
+		float64_t* slice_gradients =
+			m_replica_gradients.matrix+(int64_t)r*m_total_num_parameters;
+		for (int32_t k=0; k<m_total_num_parameters; k++)
+			gradients[k] += weight*slice_gradients[k];
+
+		error += weight*errors[r];
+	}
+
+	return error;
+}
+
+void CNeuralNetwork::init_layer_replicas()
+{
+	release_layer_replicas();
+
+	int32_t num_replicas = CMath::min(parallel->get_num_threads(),
+		m_batch_size/NN_MIN_SLICE_SIZE);
+	if (num_replicas<2)
+		return;
+
+	for (int32_t i=0; i<m_num_layers; i++)
+	{
+		if (get_layer(i)->contraction_coefficient!=0.0)
+			return;
+	}
+
+	m_layer_replicas = new CDynamicObjectArray(num_replicas);
+	SG_REF(m_layer_replicas);
+
+	for (int32_t r=0; r<num_replicas; r++)
+	{
+		int32_t start = (int64_t)r*m_batch_size/num_replicas;
+		int32_t end = (int64_t)(r+1)*m_batch_size/num_replicas;
+
+		CDynamicObjectArray* layers = new CDynamicObjectArray(m_num_layers);
+		for (int32_t i=0; i<m_num_layers; i++)
+		{
+			CNeuralLayer* layer = (CNeuralLayer*)get_layer(i)->clone();
+			layer->set_batch_size(end-start);
+			layers->append_element(layer);
+			SG_UNREF(layer);
+		}
+		m_layer_replicas->append_element(layers);
+	}
+
+	m_replica_gradients =
+		SGMatrix<float64_t>(m_total_num_parameters, num_replicas);
+}
+
+void CNeuralNetwork::release_layer_replicas()
+{
+	SG_UNREF(m_layer_replicas);
+	m_replica_gradients = SGMatrix<float64_t>();
+}
+
 float64_t CNeuralNetwork::compute_error(SGMatrix<float64_t> targets)
 {
-	float64_t error = get_layer(m_num_layers-1)->compute_error(targets);
+	return get_layer(m_num_layers-1)->compute_error(targets) +
+		compute_regularization_error();
+}
+
+float64_t CNeuralNetwork::compute_regularization_error()
+{
+	float64_t error = 0;
 
 	// L2 regularization
 	if (m_l2_coefficient != 0.0)
@@ -773,6 +1194,11 @@ void CNeuralNetwork::init()
 	m_lbfgs_temp_inputs = NULL;
 	m_lbfgs_temp_targets = NULL;
 	m_is_training = false;
+	m_single_precision = false;
+	m_layer_replicas = NULL;
+	m_minimizer = NULL;
+	m_max_inference_batch_size = 256;
+	m_inference_lock = new CLock();
 
 	SG_ADD((machine_int_t*)&m_optimization_method, "optimization_method",
 	       "Optimization Method", MS_NOT_AVAILABLE);
@@ -819,4 +1245,10 @@ void CNeuralNetwork::init()
 		MS_NOT_AVAILABLE);
 	SG_ADD(&m_is_training, "is_training",
 		"is_training", MS_NOT_AVAILABLE);
+	SG_ADD(&m_single_precision, "single_precision",
+		"Single precision computations", MS_NOT_AVAILABLE);
+	SG_ADD((CSGObject**)&m_minimizer, "minimizer",
+		"Minimizer used with NNOM_STOCHASTIC_MINIMIZER", MS_NOT_AVAILABLE);
+	SG_ADD(&m_max_inference_batch_size, "max_inference_batch_size",
+		"Maximum inference batch size", MS_NOT_AVAILABLE);
 }
@@ -39,17 +39,22 @@
 #include <shogun/lib/SGVector.h>
 #include <shogun/lib/SGMatrix.h>
 
+#include <vector>
+
 namespace shogun
 {
 template<class T> class CDenseFeatures;
 class CDynamicObjectArray;
+class CLock;
 class CNeuralLayer;
+class FirstOrderStochasticMinimizer;
 
 /** optimization method for neural networks */
 enum ENNOptimizationMethod
 {
 	NNOM_GRADIENT_DESCENT=0,
-	NNOM_LBFGS=1
+	NNOM_LBFGS=1,
+	NNOM_STOCHASTIC_MINIMIZER=2
 };
 
 /** @brief A generic multi-layer neural network
@@ -87,9 +92,11 @@ enum ENNOptimizationMethod
  * 	- CRegressionLabels
  *
  * The neural network can be trained using
- * [L-BFGS](http://en.wikipedia.org/wiki/Limited-memory_BFGS) (default) or
+ * [L-BFGS](http://en.wikipedia.org/wiki/Limited-memory_BFGS) (default),
  * [mini-batch gradient descent]
- * (http://en.wikipedia.org/wiki/Stochastic_gradient_descent).
+ * (http://en.wikipedia.org/wiki/Stochastic_gradient_descent), or any
+ * FirstOrderStochasticMinimizer (see set_minimizer()), which allows using
+ * descend updaters such as AdamUpdater or RmsPropUpdater.
  *
  * NOTE: LBFGS does not work properly when using dropout/max-norm regularization
  * due to their stochastic nature. Use gradient descent instead.
@@ -97,6 +104,20 @@ enum ENNOptimizationMethod
  * During training, the error at each iteration is logged as MSG_INFO. (to turn
  * on info messages call sg_io->set_loglevel(MSG_INFO)).
  *
+ * Applying the network uses an inference-only forward pass which does not
+ * touch the layers' training buffers, so apply() and transform() can be called
+ * concurrently from several threads on a trained network. Inputs are processed
+ * in chunks of at most get_max_inference_batch_size() cases, using activation
+ * buffers that are allocated once and reused across calls. Networks containing
+ * layers that do not support this pass (see CNeuralLayer::supports_inference())
+ * fall back to the regular forward propagation, one call at a time.
+ *
+ * When more than one thread is available (see Parallel), the training batch
+ * is split into slices which are backpropagated in parallel through per-thread
+ * copies of the layers, and the resulting gradients are averaged. Dropout
+ * masks and input noise are drawn for the whole batch before the slices are
+ * processed, so seeded training does not depend on the number of threads.
+ *
  * The network stores the parameters of all the  layers in a single array. This
  * makes it easy to train a network of any combination of arbitrary layer types
  * using any optimization method (gradient descent, L-BFGS, ..)
@@ -110,6 +131,7 @@ enum ENNOptimizationMethod
 class CNeuralNetwork : public CMachine
 {
 friend class CDeepBeliefNetwork;
+friend class NeuralNetworkCostFunction;
 
 public:
 	/** default constuctor */
@@ -245,6 +267,22 @@ public:
 	{
 		return m_optimization_method;
 	}
+
+	/** Sets the minimizer used to train the network and sets the
+	 * optimization method to NNOM_STOCHASTIC_MINIMIZER.
+	 *
+	 * Each sample the minimizer draws is one mini-batch of the training set
+	 * (see set_gd_mini_batch_size()), and the descend updater of the
+	 * minimizer updates the network's parameters in place. If
+	 * max_num_epochs is non-zero, it overrides the number of passes of the
+	 * minimizer.
+	 *
+	 * @param minimizer a stochastic minimizer with a descend updater set
+	 */
+	void set_minimizer(FirstOrderStochasticMinimizer* minimizer);
+
+	/** Returns the minimizer used with NNOM_STOCHASTIC_MINIMIZER */
+	FirstOrderStochasticMinimizer* get_minimizer();
 	/** Sets L2 Regularization coeff
 	 * default value is 0.0
 	 * @param l2_coefficient l2_coefficient
@@ -456,6 +494,43 @@ public:
 		return m_gd_error_damping_coeff;
 	}
 
+	/** Sets the maximum number of cases forward propagated at once by the
+	 * inference pass used in apply() and transform(). Larger inputs are split
+	 * into chunks of this size. The activation buffers of the pass are sized
+	 * accordingly.
+	 * default value is 256
+	 * @param max_inference_batch_size maximum inference batch size
+	 */
+	void set_max_inference_batch_size(int32_t max_inference_batch_size)
+	{
+		REQUIRE(max_inference_batch_size>0, "Maximum inference batch size "
+			"(%d) must be positive\n", max_inference_batch_size);
+		m_max_inference_batch_size = max_inference_batch_size;
+	}
+
+	/** Returns the maximum inference batch size */
+	int32_t get_max_inference_batch_size() const
+	{
+		return m_max_inference_batch_size;
+	}
+
+	/** Sets whether the layers compute their matrix products in single
+	 * precision (float32). The parameters are still stored and updated in
+	 * double precision, only the products of the forward and backward passes
+	 * during training are affected; apply() and transform() compute in double
+	 * precision. Supported by CNeuralLinearLayer and the layers derived
+	 * from it, other layers ignore it.
+	 * default value is false
+	 * @param single_precision whether to compute in single precision
+	 */
+	void set_single_precision(bool single_precision);
+
+	/** Returns whether the layers compute in single precision */
+	bool get_single_precision() const
+	{
+		return m_single_precision;
+	}
+
 protected:
 	/** trains the network */
 	virtual bool train_machine(CFeatures* data=NULL);
@@ -468,6 +543,10 @@ protected:
 	virtual bool train_lbfgs(SGMatrix<float64_t> inputs,
 			SGMatrix<float64_t> targets);
 
+	/** trains the network using the minimizer set by set_minimizer() */
+	virtual bool train_stochastic_minimizer(SGMatrix<float64_t> inputs,
+			SGMatrix<float64_t> targets);
+
 	/** Applies forward propagation, computes the activations of each layer up
 	 * to layer j
 	 *
@@ -491,6 +570,18 @@ protected:
 	 */
 	virtual SGMatrix<float64_t> forward_propagate(SGMatrix<float64_t> inputs, int32_t j=-1);
 
+	/** Applies the inference-only forward propagation through all the
+	 * layers. Does not modify the state of the network or its layers, so it
+	 * is safe to call from several threads at once.
+	 *
+	 * @param inputs inputs to the network, a matrix of size
+	 * m_num_inputs*num_cases
+	 *
+	 * @return activations of the last layer, a newly allocated matrix of size
+	 * get_num_outputs()*num_cases
+	 */
+	SGMatrix<float64_t> forward_propagate_inference(SGMatrix<float64_t> inputs);
+
 	/** Sets the batch size (the number of train/test cases) the network is
 	 * expected to deal with.
 	 * Allocates memory for the activations, local gradients, input gradients
@@ -537,6 +628,9 @@ protected:
 	 */
 	virtual float64_t compute_error(SGMatrix<float64_t> targets);
 
+	/** Computes the L1 and L2 regularization terms of the error */
+	float64_t compute_regularization_error();
+
 	virtual bool is_label_valid(CLabels *lab) const;
 
 	/** returns a pointer to layer i in the network */
@@ -580,6 +674,33 @@ private:
 	template<class T>
 	SGVector<T> get_section(SGVector<T> v, int32_t i);
 
+	/** Creates one copy of the layers per thread, used to compute the
+	 * gradients for slices of the current batch in parallel. Must be called
+	 * after set_batch_size(). No copies are made if only one thread is
+	 * available, if the batch is too small to be split or if any layer uses a
+	 * contraction term, in which case the gradients are computed serially.
+	 */
+	void init_layer_replicas();
+
+	/** Frees the layer copies created by init_layer_replicas() */
+	void release_layer_replicas();
+
+	/** Computes the gradients of the error (excluding regularization) by
+	 * splitting the batch into one slice per layer copy, backpropagating the
+	 * slices in parallel and averaging their gradients.
+	 *
+	 * @param inputs inputs to the network, a matrix of size
+	 * m_num_inputs*m_batch_size
+	 *
+	 * @param targets desired values for the output layer's activations
+	 *
+	 * @param gradients array to be filled with gradient values.
+	 *
+	 * @return error between the targets and the activations of the last layer
+	 */
+	float64_t compute_gradients_parallel(SGMatrix<float64_t> inputs,
+			SGMatrix<float64_t> targets, SGVector<float64_t> gradients);
+
 protected:
 	/** number of neurons in the input layer */
 	int32_t m_num_inputs;
@@ -710,12 +831,46 @@ protected:
 	 */
 	float64_t m_gd_error_damping_coeff;
 
+	/** Whether the layers compute their matrix products in single precision
+	 * default value is false
+	 */
+	bool m_single_precision;
+
+	/** minimizer used with NNOM_STOCHASTIC_MINIMIZER, default is NULL */
+	FirstOrderStochasticMinimizer* m_minimizer;
+
+	/** maximum number of cases forward propagated at once during inference
+	 * default value is 256
+	 */
+	int32_t m_max_inference_batch_size;
+
 private:
 	/** temperary pointers to the training data, used to pass the data to L-BFGS
 	 * routines
 	 */
 	const SGMatrix<float64_t>* m_lbfgs_temp_inputs;
 	const SGMatrix<float64_t>* m_lbfgs_temp_targets;
+
+	/** copies of m_layers, one per thread, used to compute the gradients of
+	 * batch slices in parallel during training. NULL if not in use
+	 */
+	CDynamicObjectArray* m_layer_replicas;
+
+	/** gradients computed by each of the layer copies, matrix of size
+	 * m_total_num_parameters*num_copies
+	 */
+	SGMatrix<float64_t> m_replica_gradients;
+
+	/** activation buffers of the inference pass that are not in use by any
+	 * thread. Each holds the activations of all the layers for
+	 * m_max_inference_batch_size cases
+	 */
+	std::vector<SGVector<float64_t> > m_inference_buffers;
+
+	/** guards m_inference_buffers, and the layers' own buffers when falling
+	 * back to the regular forward propagation during inference
+	 */
+	CLock* m_inference_lock;
 };
 
 }
@@ -59,6 +59,18 @@ void CNeuralRectifiedLinearLayer::compute_activations(
 	}
 }
 
+void CNeuralRectifiedLinearLayer::compute_inference_epilogue(const float64_t* biases,
+		SGMatrix<float64_t> activations)
+{
+	float64_t scale = 1.0-dropout_prop;
+	for (int32_t j=0; j<activations.num_cols; j++)
+	{
+		float64_t* a = activations.get_column_vector(j);
+		for (int32_t i=0; i<m_num_neurons; i++)
+			a[i] = scale*CMath::max<float64_t>(0, a[i]+biases[i]);
+	}
+}
+
 float64_t CNeuralRectifiedLinearLayer::compute_contraction_term(
 	SGVector< float64_t > parameters)
 {
@@ -73,6 +73,35 @@ void CNeuralSoftmaxLayer::compute_activations(SGVector<float64_t> parameters,
 	}
 }
 
+void CNeuralSoftmaxLayer::compute_inference_epilogue(const float64_t* biases,
+		SGMatrix<float64_t> activations)
+{
+	// to avoid exponentiating large numbers, the maximum activation of each
+	// case is subtracted from its activations
+	float64_t scale = 1.0-dropout_prop;
+	for (int32_t j=0; j<activations.num_cols; j++)
+	{
+		float64_t* a = activations.get_column_vector(j);
+
+		float64_t max = a[0]+biases[0];
+		for (int32_t i=0; i<m_num_neurons; i++)
+		{
+			a[i] += biases[i];
+			max = CMath::max(max, a[i]);
+		}
+
+		float64_t sum = 0;
+		for (int32_t i=0; i<m_num_neurons; i++)
+		{
+			a[i] = std::exp(a[i]-max);
+			sum += a[i];
+		}
+
+		for (int32_t i=0; i<m_num_neurons; i++)
+			a[i] *= scale/sum;
+	}
+}
+
 void CNeuralSoftmaxLayer::compute_local_gradients(SGMatrix<float64_t> targets)
 {
 	if (targets.num_rows == 0)
@@ -38,6 +38,8 @@
 #include <string.h>
 #include <stdarg.h>
 
+#include <shogun/base/Parallel.h>
+#include <shogun/base/init.h>
 #include <shogun/mathematics/Math.h>
 #include <shogun/mathematics/linalg/LinalgNamespace.h>
 #include <shogun/optimization/liblinear/shogun_liblinear.h>
@@ -47,6 +49,56 @@
 
 using namespace shogun;
 
+/* minimum number of rows a thread accumulates in transposed products */
+#define MIN_ROWS_PER_THREAD 1024
+
+/* computes res = sum_k v[k]*x_{rows[k]} (plus the bias term) over num rows,
+ * taking row k itself if rows is NULL. The rows are split into one chunk per
+ * thread, each scattered into a private copy of res, and the copies are
+ * summed afterwards. */
+static void transposed_product(const liblinear_problem* prob, const double* v,
+		const int* rows, int32_t num, double* res)
+{
+	int32_t n=prob->n;
+	if (prob->use_bias)
+		n--;
+
+	int32_t num_chunks=CMath::min(get_global_parallel()->get_num_threads(),
+			num/MIN_ROWS_PER_THREAD);
+	num_chunks=CMath::max(num_chunks, 1);
+
+	SGMatrix<float64_t> partial;
+	if (num_chunks>1)
+		partial=SGMatrix<float64_t>(prob->n, num_chunks-1);
+
+	#pragma omp parallel for if (num_chunks>1)
+	for (int32_t c=0; c<num_chunks; c++)
+	{
+		double* acc=c ? partial.get_column_vector(c-1) : res;
+		memset(acc, 0, sizeof(double)*prob->n);
+
+		int32_t start=int64_t(num)*c/num_chunks;
+		int32_t stop=int64_t(num)*(c+1)/num_chunks;
+		for (int32_t k=start; k<stop; k++)
+		{
+			prob->x->add_to_dense_vec(v[k], rows ? rows[k] : k, acc, n);
+
+			if (prob->use_bias)
+				acc[n]+=v[k];
+		}
+	}
+
+	if (num_chunks>1)
+	{
+		#pragma omp parallel for
+		for (int32_t j=0; j<prob->n; j++)
+		{
+			for (int32_t c=0; c<num_chunks-1; c++)
+				res[j]+=partial(j, c);
+		}
+	}
+}
+
 l2r_lr_fun::l2r_lr_fun(const liblinear_problem *p, float64_t* Cs)
 {
 	int l=p->l;
@@ -74,6 +126,7 @@ double l2r_lr_fun::fun(double *w)
 	int32_t n=m_prob->n;
 
 	Xv(w, z);
+	#pragma omp parallel for reduction(+:f)
 	for(i=0;i<l;i++)
 	{
 		double yz = y[i]*z[i];
@@ -95,6 +148,7 @@ void l2r_lr_fun::grad(double *w, double *g)
 	int l=m_prob->l;
 	int w_size=get_nr_variable();
 
+	#pragma omp parallel for
 	for(i=0;i<l;i++)
 	{
 		z[i] = 1/(1 + exp(-y[i]*z[i]));
@@ -120,6 +174,7 @@ void l2r_lr_fun::Hv(double *s, double *Hs)
 	double *wa = SG_MALLOC(double, l);
 
 	Xv(s, wa);
+	#pragma omp parallel for
 	for(i=0;i<l;i++)
 		wa[i] = C[i]*D[i]*wa[i];
 
@@ -146,21 +201,7 @@ void l2r_lr_fun::Xv(double *v, double *res_Xv)
 
 void l2r_lr_fun::XTv(double *v, double *res_XTv)
 {
-	int l=m_prob->l;
-	int32_t n=m_prob->n;
-
-	memset(res_XTv, 0, sizeof(double)*m_prob->n);
-
-	if (m_prob->use_bias)
-		n--;
-
-	for (int32_t i=0;i<l;i++)
-	{
-		m_prob->x->add_to_dense_vec(v[i], i, res_XTv, n);
-
-		if (m_prob->use_bias)
-			res_XTv[n]+=v[i];
-	}
+	transposed_product(m_prob, v, NULL, m_prob->l, res_XTv);
 }
 
 l2r_l2_svc_fun::l2r_l2_svc_fun(const liblinear_problem *p, double* Cs)
@@ -192,6 +233,7 @@ double l2r_l2_svc_fun::fun(double *w)
 	int w_size=get_nr_variable();
 
 	Xv(w, z);
+	#pragma omp parallel for reduction(+:f)
 	for(i=0;i<l;i++)
 	{
 		z[i] = y[i]*z[i];
@@ -239,6 +281,7 @@ void l2r_l2_svc_fun::Hv(double *s, double *Hs)
 	double *wa = SG_MALLOC(double, l);
 
 	subXv(s, wa);
+	#pragma omp parallel for
 	for(i=0;i<sizeI;i++)
 		wa[i] = C[I[i]]*wa[i];
 
@@ -287,19 +330,7 @@ void l2r_l2_svc_fun::subXv(double *v, double *res_Xv)
 
 void l2r_l2_svc_fun::subXTv(double *v, double *XTv)
 {
-	int32_t n=m_prob->n;
-
-	if (m_prob->use_bias)
-		n--;
-
-	memset(XTv, 0, sizeof(float64_t)*m_prob->n);
-	for (int32_t i=0;i<sizeI;i++)
-	{
-		m_prob->x->add_to_dense_vec(v[i], I[i], XTv, n);
-
-		if (m_prob->use_bias)
-			XTv[n]+=v[i];
-	}
+	transposed_product(m_prob, v, I, sizeI, XTv);
 }
 
 l2r_l2_svr_fun::l2r_l2_svr_fun(const liblinear_problem *prob, double *Cs, double p):
@@ -322,6 +353,7 @@ double l2r_l2_svr_fun::fun(double *w)
 	for(i=0;i<w_size;i++)
 		f += w[i]*w[i];
 	f /= 2;
+	#pragma omp parallel for private(d) reduction(+:f)
 	for(i=0;i<l;i++)
 	{
 		d = z[i] - y[i];
@@ -12,14 +12,18 @@
 #include <string.h>
 #include <stdlib.h>
 
+#include <algorithm>
+
 #include <shogun/features/Features.h>
 #include <shogun/io/SGIO.h>
 #include <shogun/kernel/Kernel.h>
 #include <shogun/lib/common.h>
+#include <shogun/mathematics/eigen3.h>
 #include <shogun/mathematics/linalg/LinalgNamespace.h>
 #include <shogun/preprocessor/DimensionReductionPreprocessor.h>
 
 using namespace shogun;
+using namespace Eigen;
 
 CKernelPCA::CKernelPCA() : CDimensionReductionPreprocessor()
 {
@@ -38,11 +42,40 @@ void CKernelPCA::init()
 	m_init_features = NULL;
 	m_transformation_matrix = SGMatrix<float64_t>();
 	m_bias_vector = SGVector<float64_t>();
+	m_method = KPCA_EXACT;
+	m_num_landmarks = 100;
 
 	SG_ADD(&m_transformation_matrix, "transformation_matrix",
 		"matrix used to transform data", MS_NOT_AVAILABLE);
 	SG_ADD(&m_bias_vector, "bias_vector",
 		"bias vector used to transform data", MS_NOT_AVAILABLE);
+	SG_ADD((machine_int_t*) &m_method, "method",
+		"method used to compute the components", MS_NOT_AVAILABLE);
+	SG_ADD(&m_num_landmarks, "num_landmarks",
+		"number of landmarks of the Nystroem method", MS_NOT_AVAILABLE);
+}
+
+void CKernelPCA::set_method(EKernelPCAMethod method)
+{
+	m_method = method;
+}
+
+EKernelPCAMethod CKernelPCA::get_method() const
+{
+	return m_method;
+}
+
+void CKernelPCA::set_num_landmarks(int32_t num_landmarks)
+{
+	REQUIRE(
+	    num_landmarks > 0, "Number of landmarks (%d) must be positive.\n",
+	    num_landmarks);
+	m_num_landmarks = num_landmarks;
+}
+
+int32_t CKernelPCA::get_num_landmarks() const
+{
+	return m_num_landmarks;
 }
 
 void CKernelPCA::cleanup()
@@ -66,59 +99,148 @@ bool CKernelPCA::init(CFeatures* features)
 {
 	if (!m_initialized && m_kernel)
 	{
-		SG_REF(features);
-		m_init_features = features;
-
-		m_kernel->init(features,features);
-		SGMatrix<float64_t> kernel_matrix = m_kernel->get_kernel_matrix();
-		m_kernel->cleanup();
-		int32_t n = kernel_matrix.num_cols;
-		int32_t m = kernel_matrix.num_rows;
-		ASSERT(n==m)
-		if (m_target_dim > n)
-		{
-			SG_SWARNING(
-			    "Target dimension (%d) is not a valid value, it must be"
-			    "less or equal than the number of vectors."
-			    "Setting it to maximum allowed size (%d).",
-			    m_target_dim, n);
-			m_target_dim = n;
-		}
+		if (m_method == KPCA_NYSTROEM)
+			init_nystroem(features);
+		else
+			init_exact(features);
 
-		SGVector<float64_t> bias_tmp = linalg::rowwise_sum(kernel_matrix);
-		linalg::scale(bias_tmp, bias_tmp, -1.0 / n);
-		float64_t s = linalg::sum(bias_tmp) / n;
-		linalg::add_scalar(bias_tmp, -s);
+		m_initialized=true;
+		SG_INFO("Done\n")
+		return true;
+	}
+	return false;
+}
+
+void CKernelPCA::init_exact(CFeatures* features)
+{
+	SG_REF(features);
+	m_init_features = features;
 
-		linalg::center_matrix(kernel_matrix);
+	m_kernel->init(features,features);
+	SGMatrix<float64_t> kernel_matrix = m_kernel->get_kernel_matrix();
+	m_kernel->cleanup();
+	int32_t n = kernel_matrix.num_cols;
+	int32_t m = kernel_matrix.num_rows;
+	ASSERT(n==m)
+	if (m_target_dim > n)
+	{
+		SG_SWARNING(
+		    "Target dimension (%d) is not a valid value, it must be"
+		    "less or equal than the number of vectors."
+		    "Setting it to maximum allowed size (%d).",
+		    m_target_dim, n);
+		m_target_dim = n;
+	}
 
-		SGVector<float64_t> eigenvalues(m_target_dim);
-		SGMatrix<float64_t> eigenvectors(kernel_matrix.num_rows, m_target_dim);
+	SGVector<float64_t> bias_tmp = linalg::rowwise_sum(kernel_matrix);
+	linalg::scale(bias_tmp, bias_tmp, -1.0 / n);
+	float64_t s = linalg::sum(bias_tmp) / n;
+	linalg::add_scalar(bias_tmp, -s);
+
+	linalg::center_matrix(kernel_matrix);
+
+	SGVector<float64_t> eigenvalues(m_target_dim);
+	SGMatrix<float64_t> eigenvectors(kernel_matrix.num_rows, m_target_dim);
+	// the randomized solver avoids the full eigendecomposition, the kernel
+	// matrix above is needed either way
+	if (m_method == KPCA_RANDOMIZED)
+		linalg::eigen_solver_symmetric_randomized(
+		    kernel_matrix, eigenvalues, eigenvectors, m_target_dim);
+	else
 		linalg::eigen_solver_symmetric(
 		    kernel_matrix, eigenvalues, eigenvectors, m_target_dim);
 
-		m_transformation_matrix =
-		    SGMatrix<float64_t>(kernel_matrix.num_rows, m_target_dim);
-		// eigenvalues are in increasing order
-		for (int32_t i = 0; i < m_target_dim; i++)
-		{
-			//normalize and trap divide by zero and negative eigenvalues
-			auto idx = m_target_dim - i - 1;
-			auto vec = eigenvectors.get_column(idx);
-			linalg::scale(
-			    vec, vec, 1.0 / std::sqrt(CMath::max(1e-16, eigenvalues[idx])));
-			m_transformation_matrix.set_column(i, vec);
-		}
+	m_transformation_matrix =
+	    SGMatrix<float64_t>(kernel_matrix.num_rows, m_target_dim);
+	// eigenvalues are in increasing order
+	for (int32_t i = 0; i < m_target_dim; i++)
+	{
+		//normalize and trap divide by zero and negative eigenvalues
+		auto idx = m_target_dim - i - 1;
+		auto vec = eigenvectors.get_column(idx);
+		linalg::scale(
+		    vec, vec, 1.0 / std::sqrt(CMath::max(1e-16, eigenvalues[idx])));
+		m_transformation_matrix.set_column(i, vec);
+	}
 
-		m_bias_vector = SGVector<float64_t>(m_target_dim);
-		linalg::matrix_prod(
-		    m_transformation_matrix, bias_tmp, m_bias_vector, true);
+	m_bias_vector = SGVector<float64_t>(m_target_dim);
+	linalg::matrix_prod(
+	    m_transformation_matrix, bias_tmp, m_bias_vector, true);
+}
 
-		m_initialized=true;
-		SG_INFO("Done\n")
-		return true;
+void CKernelPCA::init_nystroem(CFeatures* features)
+{
+	int32_t n = features->get_num_vectors();
+	int32_t m = m_num_landmarks;
+	if (m > n)
+	{
+		SG_SWARNING(
+		    "Number of landmarks (%d) exceeds the number of vectors, "
+		    "using all %d vectors as landmarks.\n",
+		    m, n);
+		m = n;
 	}
-	return false;
+
+	SGVector<index_t> permutation(n);
+	permutation.range_fill();
+	CMath::permute(permutation);
+	SGVector<index_t> landmarks(m);
+	std::copy(permutation.vector, permutation.vector + m, landmarks.vector);
+	std::sort(landmarks.vector, landmarks.vector + m);
+
+	m_init_features = features->copy_subset(landmarks);
+	SG_REF(m_init_features);
+
+	m_kernel->init(m_init_features, m_init_features);
+	SGMatrix<float64_t> kernel_mm = m_kernel->get_kernel_matrix();
+	m_kernel->init(features, m_init_features);
+	SGMatrix<float64_t> kernel_nm = m_kernel->get_kernel_matrix();
+	m_kernel->cleanup();
+
+	Map<MatrixXd> Kmm(kernel_mm.matrix, m, m);
+	Map<MatrixXd> Knm(kernel_nm.matrix, n, m);
+
+	// K_mm^-1/2 restricted to the numerically non-null directions
+	SelfAdjointEigenSolver<MatrixXd> landmark_solver(Kmm);
+	const VectorXd& s = landmark_solver.eigenvalues();
+	float64_t threshold = 1e-12 * CMath::max(s[m - 1], 0.0);
+	int32_t r = 0;
+	while (r < m && s[m - r - 1] > threshold)
+		r++;
+	REQUIRE(r > 0, "Kernel matrix of the landmarks is numerically zero.\n");
+
+	if (m_target_dim > r)
+	{
+		SG_SWARNING(
+		    "Target dimension (%d) is not a valid value, it must be"
+		    "less or equal than the rank of the landmarks' kernel matrix."
+		    "Setting it to maximum allowed size (%d).",
+		    m_target_dim, r);
+		m_target_dim = r;
+	}
+
+	MatrixXd W = landmark_solver.eigenvectors().rightCols(r) *
+	             s.tail(r).cwiseSqrt().cwiseInverse().asDiagonal();
+
+	// linear PCA of the centered Nystroem feature map
+	MatrixXd phi = Knm * W;
+	VectorXd mean = phi.colwise().mean().transpose();
+	phi.rowwise() -= mean.transpose();
+	MatrixXd cov = MatrixXd::Zero(r, r);
+	cov.selfadjointView<Lower>().rankUpdate(phi.transpose());
+
+	SelfAdjointEigenSolver<MatrixXd> solver(cov);
+	// eigenvalues are in increasing order
+	MatrixXd V =
+	    solver.eigenvectors().rightCols(m_target_dim).rowwise().reverse();
+
+	m_transformation_matrix = SGMatrix<float64_t>(m, m_target_dim);
+	Map<MatrixXd> T(m_transformation_matrix.matrix, m, m_target_dim);
+	T = W * V;
+
+	m_bias_vector = SGVector<float64_t>(m_target_dim);
+	Map<VectorXd> b(m_bias_vector.vector, m_target_dim);
+	b = -V.transpose() * mean;
 }
 
 SGMatrix<float64_t> CKernelPCA::apply_to_feature_matrix(CFeatures* features)
@@ -129,8 +251,13 @@ SGMatrix<float64_t> CKernelPCA::apply_to_feature_matrix(CFeatures* features)
 	m_kernel->init(features, m_init_features);
 	auto kernel_matrix = m_kernel->get_kernel_matrix();
 
-	auto rows_sum = linalg::rowwise_sum(kernel_matrix);
-	linalg::add_vector(kernel_matrix, rows_sum, kernel_matrix, 1.0, -1.0 / n);
+	// the Nystroem feature map is centered by the bias alone
+	if (m_method != KPCA_NYSTROEM)
+	{
+		auto rows_sum = linalg::rowwise_sum(kernel_matrix);
+		linalg::add_vector(
+		    kernel_matrix, rows_sum, kernel_matrix, 1.0, -1.0 / n);
+	}
 
 	SGMatrix<float64_t> new_feature_matrix =
 	    linalg::matrix_prod(m_transformation_matrix, kernel_matrix, true, true);
@@ -20,6 +20,20 @@ namespace shogun
 class CFeatures;
 class CKernel;
 
+/** method used to compute the kernel principal components */
+enum EKernelPCAMethod
+{
+	/** full eigendecomposition of the centered kernel matrix */
+	KPCA_EXACT,
+	/** randomized subspace iteration on the centered kernel matrix, this
+	 * only saves eigensolver time, the full num_vectors x num_vectors
+	 * kernel matrix is still computed and stored */
+	KPCA_RANDOMIZED,
+	/** Nystroem approximation from a random subset of landmarks, never
+	 * stores more than a num_vectors x num_landmarks kernel matrix */
+	KPCA_NYSTROEM
+};
+
 /** @brief Preprocessor KernelPCA performs kernel principal component analysis
  *
  * Schoelkopf, B., Smola, A. J., & Mueller, K. R. (1999).
@@ -27,6 +41,15 @@ class CKernel;
  * Advances in kernel methods support vector learning, 1327(3), 327-352. MIT Press.
  * Retrieved from http://citeseerx.ist.psu.edu/viewdoc/summary?doi=10.1.1.32.8744
  *
+ * For large data sets the Nystroem mode (see ::EKernelPCAMethod) saves
+ * memory as well as time, the randomized mode only speeds up the
+ * eigendecomposition of the full kernel matrix. The Nystroem mode maps the
+ * data onto \f$K_{mm}^{-1/2}k_m(x)\f$ for m randomly chosen landmarks and
+ * runs a linear PCA on this m dimensional representation:
+ *
+ * Williams, C. K. I., & Seeger, M. (2001).
+ * Using the Nystroem method to speed up kernel machines.
+ * Advances in Neural Information Processing Systems 13, 682-688.
  */
 class CKernelPCA: public CDimensionReductionPreprocessor
 {
@@ -77,6 +100,23 @@ public:
 			return m_bias_vector;
 		}
 
+		/** set method used to compute the components, has to be called
+		 * before init
+		 * @param method method
+		 */
+		void set_method(EKernelPCAMethod method);
+
+		/** @return method used to compute the components */
+		EKernelPCAMethod get_method() const;
+
+		/** set number of landmarks used by the Nystroem method
+		 * @param num_landmarks number of landmarks
+		 */
+		void set_num_landmarks(int32_t num_landmarks);
+
+		/** @return number of landmarks used by the Nystroem method */
+		int32_t get_num_landmarks() const;
+
 		/** @return object name */
 		virtual const char* get_name() const { return "KernelPCA"; }
 
@@ -88,6 +128,12 @@ public:
 		/** default init */
 		void init();
 
+		/** computes the components from the full kernel matrix */
+		void init_exact(CFeatures* features);
+
+		/** computes the components from a Nystroem approximation */
+		void init_nystroem(CFeatures* features);
+
 	protected:
 
 		/** features used by init. needed for apply */
@@ -102,6 +148,12 @@ public:
 		/** true when already initialized */
 		bool m_initialized;
 
+		/** method used to compute the components */
+		EKernelPCAMethod m_method;
+
+		/** number of landmarks used by the Nystroem method */
+		int32_t m_num_landmarks;
+
 };
 }
 #endif
@@ -9,13 +9,108 @@
 #include <shogun/preprocessor/PCA.h>
 #include <shogun/mathematics/Math.h>
 #include <shogun/preprocessor/DensePreprocessor.h>
+#include <shogun/base/Parallel.h>
+#include <shogun/base/init.h>
 #include <shogun/features/Features.h>
+#include <shogun/features/streaming/StreamingDenseFeatures.h>
 #include <shogun/io/SGIO.h>
 #include <shogun/mathematics/eigen3.h>
 
+#include <limits>
+#include <vector>
+
 using namespace shogun;
 using namespace Eigen;
 
+namespace
+{
+/** number of vectors, mean and factor B of the scatter matrix
+ * \f$(X-\mu)(X-\mu)^T\approx BB^T\f$ of a set of vectors
+ */
+struct ScatterSummary
+{
+	ScatterSummary() : num_vectors(0)
+	{
+	}
+
+	index_t num_vectors;
+	VectorXd mean;
+	MatrixXd factor;
+};
+}
+
+/** computes B with at most rank columns, ordered by decreasing norm, such
+ * that BB^T is the best rank-limited approximation of MM^T. The smaller of
+ * MM^T and M^TM is decomposed, as done by AUTO for EVD and SVD.
+ */
+static MatrixXd low_rank_factor(const MatrixXd& M, index_t rank)
+{
+	if (M.rows() <= M.cols())
+	{
+		MatrixXd scatter = MatrixXd::Zero(M.rows(), M.rows());
+		scatter.selfadjointView<Lower>().rankUpdate(M);
+		SelfAdjointEigenSolver<MatrixXd> solver(scatter);
+
+		index_t r = CMath::min(rank, (index_t)M.rows());
+		VectorXd s =
+		    solver.eigenvalues().tail(r).reverse().cwiseMax(0.0).cwiseSqrt();
+		return solver.eigenvectors().rightCols(r).rowwise().reverse() *
+		       s.asDiagonal();
+	}
+
+	MatrixXd gram = MatrixXd::Zero(M.cols(), M.cols());
+	gram.selfadjointView<Lower>().rankUpdate(M.transpose());
+	SelfAdjointEigenSolver<MatrixXd> solver(gram);
+
+	index_t r = CMath::min(rank, (index_t)M.cols());
+	return M * solver.eigenvectors().rightCols(r).rowwise().reverse();
+}
+
+static ScatterSummary
+summarize_block(const SGMatrix<float64_t>& block, index_t rank)
+{
+	Map<MatrixXd> X(block.matrix, block.num_rows, block.num_cols);
+
+	ScatterSummary summary;
+	summary.num_vectors = block.num_cols;
+	summary.mean = X.rowwise().mean();
+	summary.factor = low_rank_factor(X.colwise() - summary.mean, rank);
+	return summary;
+}
+
+/** merges b into a, the scatter of the union is the sum of both scatters
+ * plus the scatter of the two means weighted by \f$n_an_b/(n_a+n_b)\f$
+ */
+static void
+merge_summaries(ScatterSummary& a, const ScatterSummary& b, index_t rank)
+{
+	if (b.num_vectors == 0)
+		return;
+
+	if (a.num_vectors == 0)
+	{
+		a = b;
+		return;
+	}
+
+	REQUIRE(
+	    a.mean.size() == b.mean.size(),
+	    "Dimension of vectors (%d) does not match dimension of previous "
+	    "vectors (%d)\n",
+	    b.mean.size(), a.mean.size());
+
+	index_t n = a.num_vectors + b.num_vectors;
+	VectorXd delta = b.mean - a.mean;
+
+	MatrixXd M(a.factor.rows(), a.factor.cols() + b.factor.cols() + 1);
+	M << a.factor, b.factor,
+	    delta * std::sqrt((float64_t)a.num_vectors * b.num_vectors / n);
+
+	a.factor = low_rank_factor(M, rank);
+	a.mean += delta * ((float64_t)b.num_vectors / n);
+	a.num_vectors = n;
+}
+
 CPCA::CPCA(bool do_whitening, EPCAMode mode, float64_t thresh, EPCAMethod method, EPCAMemoryMode mem_mode)
 : CDimensionReductionPreprocessor()
 {
@@ -49,6 +144,7 @@ void CPCA::init()
 	m_mem_mode = MEM_REALLOCATE;
 	m_method = AUTO;
 	m_eigenvalue_zero_tolerance=1e-15;
+	m_block_size = 1024;
 
 	SG_ADD(&m_transformation_matrix, "transformation_matrix",
 	    "Transformation matrix (Eigenvectors of covariance matrix).",
@@ -68,6 +164,8 @@ void CPCA::init()
 		"Method used for PCA calculation", MS_NOT_AVAILABLE);
 	SG_ADD(&m_eigenvalue_zero_tolerance, "eigenvalue_zero_tolerance", "zero tolerance"
 	" for determining zero eigenvalues during whitening to avoid numerical issues", MS_NOT_AVAILABLE);
+	SG_ADD(&m_block_size, "block_size",
+		"Number of vectors per block of the incremental method.", MS_NOT_AVAILABLE);
 }
 
 CPCA::~CPCA()
@@ -78,6 +176,13 @@ bool CPCA::init(CFeatures* features)
 {
 	if (!m_initialized)
 	{
+		if (m_method == INCREMENTAL)
+		{
+			init_incremental(features);
+			m_initialized = true;
+			return true;
+		}
+
 		REQUIRE(features->get_feature_class()==C_DENSE, "PCA only works with dense features")
 		REQUIRE(features->get_feature_type()==F_DREAL, "PCA only works with real features")
 
@@ -279,6 +384,173 @@ void CPCA::init_with_svd(const SGMatrix<float64_t> &feature_matrix, int32_t max_
 	}
 }
 
+void CPCA::init_incremental(CFeatures* features)
+{
+	bool streaming = features->get_feature_class()==C_STREAMING_DENSE;
+	REQUIRE(streaming || features->get_feature_class()==C_DENSE,
+		"Incremental PCA only works with dense or streaming dense features")
+	REQUIRE(features->get_feature_type()==F_DREAL, "PCA only works with real features")
+	REQUIRE(m_mode!=FIXED_NUMBER || m_target_dim>0,
+		"target dimension (%d) should be positive", m_target_dim)
+
+	CStreamingDenseFeatures<float64_t>* stream = NULL;
+	SGMatrix<float64_t> feature_matrix;
+	if (streaming)
+	{
+		stream = features->as<CStreamingDenseFeatures<float64_t>>();
+		stream->start_parser();
+	}
+	else
+	{
+		feature_matrix =
+		    features->as<CDenseFeatures<float64_t>>()->get_feature_matrix();
+	}
+
+	// only the target dimension is needed in FIXED_NUMBER mode, the other
+	// modes keep the full rank to select the dimension at the end
+	index_t rank = (m_mode == FIXED_NUMBER)
+	                   ? m_target_dim
+	                   : std::numeric_limits<index_t>::max();
+	int32_t num_threads = get_global_parallel()->get_num_threads();
+
+	ScatterSummary total;
+	index_t offset = 0;
+	bool exhausted = false;
+	while (!exhausted)
+	{
+		// one block per thread, streams can only be read sequentially
+		std::vector<SGMatrix<float64_t>> blocks;
+		while (!exhausted && (int32_t)blocks.size() < num_threads)
+		{
+			SGMatrix<float64_t> block;
+			if (streaming)
+			{
+				CFeatures* streamed = stream->get_streamed_features(m_block_size);
+				SG_REF(streamed);
+				block = streamed->as<CDenseFeatures<float64_t>>()
+				            ->get_feature_matrix();
+				SG_UNREF(streamed);
+				exhausted = block.num_cols < m_block_size;
+			}
+			else
+			{
+				index_t num_block_vectors =
+				    CMath::min(m_block_size, feature_matrix.num_cols - offset);
+				block = SGMatrix<float64_t>(
+				    feature_matrix.matrix + (int64_t)offset * feature_matrix.num_rows,
+				    feature_matrix.num_rows, num_block_vectors, false);
+				offset += num_block_vectors;
+				exhausted = offset == feature_matrix.num_cols;
+			}
+
+			if (block.num_cols > 0)
+				blocks.push_back(block);
+		}
+
+		std::vector<ScatterSummary> summaries(blocks.size());
+		#pragma omp parallel for
+		for (index_t i = 0; i < (index_t)blocks.size(); i++)
+			summaries[i] = summarize_block(blocks[i], rank);
+
+		// pairwise tree reduction of the block summaries
+		for (index_t stride = 1; stride < (index_t)summaries.size(); stride *= 2)
+		{
+			index_t num_merges = summaries.size() - stride;
+			#pragma omp parallel for
+			for (index_t i = 0; i < num_merges; i += 2 * stride)
+				merge_summaries(summaries[i], summaries[i + stride], rank);
+		}
+
+		if (!summaries.empty())
+			merge_summaries(total, summaries[0], rank);
+	}
+
+	if (streaming)
+		stream->end_parser();
+
+	int32_t num_vectors = total.num_vectors;
+	int32_t num_features = total.mean.size();
+	SG_INFO(
+	    "num_examples: %d num_features: %d\n", num_vectors, num_features)
+	REQUIRE(num_vectors>1, "PCA needs at least two vectors")
+
+	int32_t max_dim_allowed = CMath::min(num_vectors, num_features);
+	num_dim=0;
+
+	REQUIRE(m_target_dim<=max_dim_allowed,
+		 "target dimension should be less or equal to than minimum of N and D")
+
+	m_mean_vector = SGVector<float64_t>(num_features);
+	Map<VectorXd> data_mean(m_mean_vector.vector, num_features);
+	data_mean = total.mean;
+
+	// factor columns are ordered by decreasing norm
+	int32_t num_eigenvalues = total.factor.cols();
+	m_eigenvalues_vector = SGVector<float64_t>(num_eigenvalues);
+	Map<VectorXd> eigenValues(m_eigenvalues_vector.vector, num_eigenvalues);
+	eigenValues =
+	    total.factor.colwise().squaredNorm().transpose() / (num_vectors - 1);
+
+	// target dimension
+	switch (m_mode)
+	{
+		case FIXED_NUMBER:
+			num_dim = CMath::min(m_target_dim, num_eigenvalues);
+			break;
+
+		case VARIANCE_EXPLAINED:
+		{
+			float64_t eig_sum = eigenValues.sum();
+			float64_t com_sum = 0;
+			for (int32_t i = 0; i < num_eigenvalues; i++) {
+				num_dim++;
+				com_sum += m_eigenvalues_vector.vector[i];
+				if (com_sum / eig_sum >= m_thresh)
+					break;
+			}
+		} break;
+
+		case THRESHOLD:
+			for (int32_t i = 0; i < num_eigenvalues; i++) {
+				if (m_eigenvalues_vector.vector[i] > m_thresh)
+					num_dim++;
+				else
+					break;
+			}
+			break;
+	};
+	SG_INFO("Reducing from %i to %i features...\n", num_features, num_dim)
+
+	// normalized factor columns form eigenvectors
+	m_transformation_matrix = SGMatrix<float64_t>(num_features, num_dim);
+	Map<MatrixXd> transformMatrix(m_transformation_matrix.matrix, num_features, num_dim);
+	num_old_dim = num_features;
+
+	for (int32_t i = 0; i < num_dim; i++)
+	{
+		float64_t norm = std::sqrt(eigenValues[i] * (num_vectors - 1));
+		if (m_whitening &&
+		    CMath::fequals_abs<float64_t>(0.0, eigenValues[i], m_eigenvalue_zero_tolerance))
+		{
+			SG_WARNING("Covariance matrix has almost zero Eigenvalue (ie "
+				"Eigenvalue within a tolerance of %E around 0) at "
+				"dimension %d. Consider reducing its dimension.",
+				m_eigenvalue_zero_tolerance, i + 1)
+
+			transformMatrix.col(i) = MatrixXd::Zero(num_features, 1);
+			continue;
+		}
+
+		if (norm > 0)
+			transformMatrix.col(i) = total.factor.col(i) / norm;
+		else
+			transformMatrix.col(i) = MatrixXd::Zero(num_features, 1);
+
+		if (m_whitening)
+			transformMatrix.col(i) /= norm;
+	}
+}
+
 void CPCA::cleanup()
 {
 	m_transformation_matrix=SGMatrix<float64_t>();
@@ -393,3 +665,14 @@ float64_t CPCA::get_eigenvalue_zero_tolerance() const
 {
 	return m_eigenvalue_zero_tolerance;
 }
+
+void CPCA::set_block_size(int32_t block_size)
+{
+	REQUIRE(block_size>0, "block size (%d) should be positive", block_size)
+	m_block_size = block_size;
+}
+
+int32_t CPCA::get_block_size() const
+{
+	return m_block_size;
+}
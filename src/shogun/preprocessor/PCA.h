@@ -29,7 +29,11 @@ enum EPCAMethod
 	/** Eigenvalue decomposition of covariance matrix.
 	 * Time complexity ~10d^3 (d-dimensions n-number of vectors)
 	 */
-	EVD = 30
+	EVD = 30,
+	/** Incremental PCA over blocks of vectors, works with streaming
+	 * features. Memory ~d(r+b) per thread (r-rank kept b-block size)
+	 */
+	INCREMENTAL = 40
 };
 
 /** mode of pca */
@@ -86,6 +90,17 @@ enum EPCAMemoryMode
  * <em>AUTO</em> : This mode automagically chooses one of the above modes for the user
  * based on whether N > D (chooses EVD) or N < D (chooses SVD).
  *
+ * <em>INCREMENTAL</em> : The data is consumed in blocks of set_block_size
+ * vectors, either from CDenseFeatures or from CStreamingDenseFeatures, so it
+ * never has to be held in memory at once. Every block is summarised by its
+ * mean and a rank-r factor \f$B\f$ of its scatter matrix,
+ * \f$(X-\mu)(X-\mu)^T\approx BB^T\f$, and summaries are merged pairwise
+ * (Ross, D. A. et al. (2008). Incremental Learning for Robust Visual
+ * Tracking. IJCV 77, 125-141). Blocks are summarised and merged in parallel.
+ * In FIXED_NUMBER mode r is the target dimension, which makes the result an
+ * approximation unless the data has rank r around its mean; in the other
+ * modes r is D and the result is exact.
+ *
  * This class provides 3 modes to determine the value of T :
  *
  * <em>FIXED_NUMBER</em> : T is supplied by user directly using set_target_dims method
@@ -187,6 +202,16 @@ class CPCA: public CDimensionReductionPreprocessor
 		 */
 		float64_t get_eigenvalue_zero_tolerance() const;
 
+		/** set number of vectors per block of the INCREMENTAL method
+		 * @param block_size block size
+		 */
+		void set_block_size(int32_t block_size);
+
+		/** get number of vectors per block of the INCREMENTAL method
+		 * @return block size
+		 */
+		int32_t get_block_size() const;
+
 	protected:
 
 		void init();
@@ -220,12 +245,16 @@ class CPCA: public CDimensionReductionPreprocessor
 		 * whitening to tackle numerical issues
 		 */
 		float64_t m_eigenvalue_zero_tolerance;
+		/** number of vectors per block of the INCREMENTAL method */
+		int32_t m_block_size;
 
 	private:
 		/** Computes the transformation matrix using an eigenvalue decomposition. */
 		void init_with_evd(const SGMatrix<float64_t>& feature_matrix, int32_t max_dim_allowed);
 		/** Computes the transformation matrix using svd */
 		void init_with_svd(const SGMatrix<float64_t>& feature_matrix, int32_t max_dim_allowed);
+		/** Computes mean and transformation matrix block by block */
+		void init_incremental(CFeatures* features);
 };
 }
 #endif // PCA_H_
@@ -31,6 +31,7 @@
 
 #include <vector>
 #include <memory>
+#include <future>
 #include <type_traits>
 #include <shogun/kernel/Kernel.h>
 #include <shogun/kernel/CustomKernel.h>
@@ -63,7 +64,10 @@ struct CStreamingMMD::Self
 
 	void merge_samples(NextSamples&, std::vector<CFeatures*>&) const;
 	void compute_kernel(ComputationManager&, std::vector<CFeatures*>&, CKernel*) const;
+	void compute_statistic_all_kernels(ComputationManager&, const KernelManager&,
+		std::vector<CFeatures*>&, std::vector<std::vector<float32_t> >&) const;
 	void compute_jobs(ComputationManager&) const;
+	std::future<NextSamples> prefetch(DataManager&, bool) const;
 
 	std::pair<float64_t, float64_t> compute_statistic_variance();
 	std::pair<SGVector<float64_t>, SGMatrix<float64_t>> compute_statistic_and_Q(const KernelManager&);
@@ -166,6 +170,64 @@ void CStreamingMMD::Self::compute_kernel(ComputationManager& cm, std::vector<CFe
 	}
 }
 
+void CStreamingMMD::Self::compute_statistic_all_kernels(ComputationManager& cm,
+	const KernelManager& kernel_mgr, std::vector<CFeatures*>& blocks,
+	std::vector<std::vector<float32_t> >& mmds) const
+{
+	const int64_t num_kernels=kernel_mgr.num_kernels();
+	const int64_t num_blocks=blocks.size();
+	for (auto k=0; k<num_kernels; ++k)
+	{
+		REQUIRE(kernel_mgr.kernel_at(k)->get_kernel_type()!=K_CUSTOM,
+			"Underlying kernel cannot be custom!\n");
+		mmds[k].resize(num_blocks);
+	}
+
+	// the fused pass below is CPU only, on the GPU the kernels are computed
+	// one after another and the statistic job is run by the computation manager
+	if (use_gpu)
+	{
+		for (auto k=0; k<num_kernels; ++k)
+		{
+			compute_kernel(cm, blocks, kernel_mgr.kernel_at(k));
+			compute_jobs(cm);
+			mmds[k]=cm.result(0);
+		}
+		return;
+	}
+
+	// every (block, kernel) pair is a task, so that all kernels are
+	// evaluated while a block is still hot in cache
+#pragma omp parallel for schedule(dynamic)
+	for (int64_t t=0; t<num_blocks*num_kernels; ++t)
+	{
+		const auto i=t/num_kernels;
+		const auto k=t%num_kernels;
+		try
+		{
+			auto kernel_clone=std::unique_ptr<CKernel>(static_cast<CKernel*>(kernel_mgr.kernel_at(k)->clone()));
+			kernel_clone->init(blocks[i], blocks[i]);
+			mmds[k][i]=statistic_job(kernel_clone->get_kernel_matrix<float32_t>());
+			kernel_clone->remove_lhs_and_rhs();
+		}
+		catch (const ShogunException& e)
+		{
+			SG_SERROR("%s, Try using less number of blocks per burst!\n", e.what());
+		}
+	}
+}
+
+std::future<NextSamples> CStreamingMMD::Self::prefetch(DataManager& data_mgr, bool concurrent) const
+{
+	// the current burst has already been merged into independent copies, so
+	// the next one can be fetched while it is being processed. Streaming
+	// generators draw from the global random generator, hence fetching is
+	// deferred until the current burst is done whenever the computation
+	// itself draws random numbers, so that results stay reproducible.
+	auto policy=concurrent ? std::launch::async : std::launch::deferred;
+	return std::async(policy, [&data_mgr]() { return data_mgr.next(); });
+}
+
 void CStreamingMMD::Self::compute_jobs(ComputationManager& cm) const
 {
 	if (use_gpu)
@@ -201,6 +263,7 @@ std::pair<float64_t, float64_t> CStreamingMMD::Self::compute_statistic_variance(
 		while (!next_burst.empty())
 		{
 			merge_samples(next_burst, blocks);
+			auto fetched_burst=prefetch(data_mgr, variance_estimation_method==VEM_DIRECT);
 			compute_kernel(cm, blocks, kernel);
 			blocks.resize(0);
 			compute_jobs(cm);
@@ -234,7 +297,7 @@ std::pair<float64_t, float64_t> CStreamingMMD::Self::compute_statistic_variance(
 					variance_term_counter++;
 				}
 			}
-			next_burst=data_mgr.next();
+			next_burst=fetched_burst.get();
 		}
 		cm.done();
 	}
@@ -271,7 +334,7 @@ std::pair<SGVector<float64_t>, SGMatrix<float64_t> > CStreamingMMD::Self::comput
 
 	DataManager& data_mgr=owner.get_data_mgr();
 	ComputationManager cm;
-	create_computation_jobs();
+	create_statistic_job();
 	cm.enqueue_job(statistic_job);
 
 	data_mgr.start();
@@ -285,13 +348,11 @@ std::pair<SGVector<float64_t>, SGMatrix<float64_t> > CStreamingMMD::Self::comput
 				"The number of blocks per burst (%d this burst) has to be even!\n",
 				num_blocks);
 		merge_samples(next_burst, blocks);
+		auto fetched_burst=prefetch(data_mgr, true);
 		std::for_each(blocks.begin(), blocks.end(), [](CFeatures* ptr) { SG_REF(ptr); });
+		compute_statistic_all_kernels(cm, kernel_selection_mgr, blocks, mmds);
 		for (auto k=0; k<num_kernels; ++k)
 		{
-			CKernel* kernel=kernel_selection_mgr.kernel_at(k);
-			compute_kernel(cm, blocks, kernel);
-			compute_jobs(cm);
-			mmds[k]=cm.result(0);
 			for (auto i=0; i<num_blocks; ++i)
 			{
 				auto delta=mmds[k][i]-statistic[k];
@@ -312,7 +373,7 @@ std::pair<SGVector<float64_t>, SGMatrix<float64_t> > CStreamingMMD::Self::comput
 				Q(j, i)=Q(i, j);
 			}
 		}
-		next_burst=data_mgr.next();
+		next_burst=fetched_burst.get();
 	}
 	mmds.clear();
 
@@ -352,6 +413,7 @@ SGVector<float64_t> CStreamingMMD::Self::sample_null()
 	while (!next_burst.empty())
 	{
 		merge_samples(next_burst, blocks);
+		auto fetched_burst=prefetch(data_mgr, false);
 		compute_kernel(cm, blocks, kernel);
 		blocks.resize(0);
 
@@ -366,7 +428,7 @@ SGVector<float64_t> CStreamingMMD::Self::sample_null()
 				term_counters[j]++;
 			}
 		}
-		next_burst=data_mgr.next();
+		next_burst=fetched_burst.get();
 	}
 
 	data_mgr.end();
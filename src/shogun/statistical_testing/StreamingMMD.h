@@ -97,11 +97,11 @@ protected:
 	virtual const float64_t normalize_variance(float64_t variance) const=0;
 	bool use_gpu() const;
 	std::shared_ptr<CKernelSelectionStrategy> get_strategy();
+	std::pair<SGVector<float64_t>, SGMatrix<float64_t> > compute_statistic_and_Q(const internal::KernelManager&);
 private:
 	struct Self;
 	std::unique_ptr<Self> self;
 	virtual std::pair<float64_t, float64_t> compute_statistic_variance();
-	std::pair<SGVector<float64_t>, SGMatrix<float64_t> > compute_statistic_and_Q(const internal::KernelManager&);
 };
 
 }
@@ -34,6 +34,9 @@
 
 #include <algorithm>
 #include <numeric>
+#include <vector>
+#include <shogun/base/Parallel.h>
+#include <shogun/base/init.h>
 #include <shogun/lib/SGVector.h>
 #include <shogun/lib/SGMatrix.h>
 #include <shogun/mathematics/Math.h>
@@ -50,7 +53,7 @@ namespace mmd
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 struct PermutationMMD : ComputeMMD
 {
-	PermutationMMD() : m_save_inds(false)
+	PermutationMMD() : m_save_inds(false), m_group_size(8)
 	{
 	}
 
@@ -61,29 +64,71 @@ struct PermutationMMD : ComputeMMD
 		ASSERT(m_num_null_samples>0);
 		precompute_permutation_inds();
 
-		const index_t size=m_n_x+m_n_y;
 		SGVector<float32_t> null_samples(m_num_null_samples);
-#pragma omp parallel for
-		for (auto n=0; n<m_num_null_samples; ++n)
+		compute_null_samples(kernel, null_samples.vector);
+		return null_samples;
+	}
+
+	/**
+	 * Computes the statistic under all precomputed permutations. The
+	 * permutations are processed in groups, each of which is handled by one
+	 * thread in a single sweep over the lower triangle of the Gram matrix, so
+	 * that every kernel value is read (or computed) once per group instead
+	 * of once per permutation.
+	 *
+	 * @param kernel returns the kernel value for (i, j) with i>=j; calls
+	 * are made column by column
+	 * @param null_samples array of m_num_null_samples elements to write to
+	 */
+	template <class Kernel>
+	void compute_null_samples(const Kernel& kernel, float32_t* null_samples) const
+	{
+		const index_t size=m_n_x+m_n_y;
+
+		// use smaller groups rather than leaving threads idle
+		const index_t num_threads=get_global_parallel()->get_num_threads();
+		const index_t group_size=std::max(index_t(1),
+			std::min(m_group_size, m_num_null_samples/num_threads));
+		const index_t num_groups=(m_num_null_samples+group_size-1)/group_size;
+
+#pragma omp parallel for schedule(dynamic)
+		for (auto g=0; g<num_groups; ++g)
 		{
-			terms_t terms;
+			const index_t first=g*group_size;
+			const index_t count=std::min(group_size, m_num_null_samples-first);
+
+			// inverted indices of the group, interleaved per sample
+			SGMatrix<index_t> inds(count, size);
+			for (auto i=0; i<size; ++i)
+			{
+				for (auto n=0; n<count; ++n)
+					inds(n, i)=m_inverted_permuted_inds(i, first+n);
+			}
+
+			std::vector<terms_t> terms(count);
 			for (auto j=0; j<size; ++j)
 			{
-				auto inverted_col=m_inverted_permuted_inds(j, n);
+				const index_t* inverted_col=inds.get_column_vector(j);
 				for (auto i=j; i<size; ++i)
 				{
-					auto inverted_row=m_inverted_permuted_inds(i, n);
-
-					if (inverted_row>=inverted_col)
-						add_term_lower(terms, kernel(i, j), inverted_row, inverted_col);
-					else
-						add_term_lower(terms, kernel(i, j), inverted_col, inverted_row);
+					const index_t* inverted_row=inds.get_column_vector(i);
+					const auto value=kernel(i, j);
+					for (auto n=0; n<count; ++n)
+					{
+						if (inverted_row[n]>=inverted_col[n])
+							add_term_lower(terms[n], value, inverted_row[n], inverted_col[n]);
+						else
+							add_term_lower(terms[n], value, inverted_col[n], inverted_row[n]);
+					}
 				}
 			}
-			null_samples[n]=compute(terms);
-			SG_SDEBUG("null_samples[%d] = %f!\n", n, null_samples[n]);
+
+			for (auto n=0; n<count; ++n)
+			{
+				null_samples[first+n]=compute(terms[n]);
+				SG_SDEBUG("null_samples[%d] = %f!\n", first+n, null_samples[first+n]);
+			}
 		}
-		return null_samples;
 	}
 
 	SGMatrix<float32_t> operator()(const KernelManager& kernel_mgr)
@@ -108,27 +153,7 @@ struct PermutationMMD : ComputeMMD
 				}
 			}
 
-#pragma omp parallel for
-			for (auto n=0; n<m_num_null_samples; ++n)
-			{
-				terms_t null_terms;
-				for (auto i=0; i<size; ++i)
-				{
-					auto inverted_row=m_inverted_permuted_inds(i, n);
-					auto index_base=i*size-i*(i+1)/2;
-					for (auto j=i; j<size; ++j)
-					{
-						auto index=index_base+j;
-						auto inverted_col=m_inverted_permuted_inds(j, n);
-
-						if (inverted_row<=inverted_col)
-							add_term_upper(null_terms, km[index], inverted_row, inverted_col);
-						else
-							add_term_upper(null_terms, km[index], inverted_col, inverted_row);
-					}
-				}
-				null_samples(n, k)=compute(null_terms);
-			}
+			compute_null_samples(packed_kernel(km, size), null_samples.get_column_vector(k));
 		}
 		return null_samples;
 	}
@@ -168,27 +193,7 @@ struct PermutationMMD : ComputeMMD
 			float32_t statistic=compute(terms);
 			SG_SDEBUG("Kernel(%d): statistic=%f\n", k, statistic);
 
-#pragma omp parallel for
-			for (auto n=0; n<m_num_null_samples; ++n)
-			{
-				terms_t null_terms;
-				for (auto i=0; i<size; ++i)
-				{
-					auto inverted_row=m_inverted_permuted_inds(i, n);
-					auto index_base=i*size-i*(i+1)/2;
-					for (auto j=i; j<size; ++j)
-					{
-						auto index=index_base+j;
-						auto inverted_col=m_inverted_permuted_inds(j, n);
-
-						if (inverted_row<=inverted_col)
-							add_term_upper(null_terms, km[index], inverted_row, inverted_col);
-						else
-							add_term_upper(null_terms, km[index], inverted_col, inverted_row);
-					}
-				}
-				null_samples[n]=compute(null_terms);
-			}
+			compute_null_samples(packed_kernel(km, size), null_samples.vector);
 			result[k]=compute_p_value(null_samples, statistic);
 			SG_SDEBUG("Kernel(%d): p_value=%f\n", k, result[k]);
 		}
@@ -196,6 +201,23 @@ struct PermutationMMD : ComputeMMD
 		return result;
 	}
 
+	/** row-major packed upper triangle of a Gram matrix, accessed as (i, j)
+	 * with i>=j */
+	struct packed_kernel
+	{
+		packed_kernel(const SGVector<float32_t>& km, index_t size) : m_km(km), m_size(size)
+		{
+		}
+
+		inline float32_t operator()(index_t i, index_t j) const
+		{
+			return m_km[j*m_size-j*(j+1)/2+i];
+		}
+
+		const SGVector<float32_t>& m_km;
+		const index_t m_size;
+	};
+
 	inline void precompute_permutation_inds()
 	{
 		ASSERT(m_num_null_samples>0);
@@ -236,6 +258,8 @@ struct PermutationMMD : ComputeMMD
 
 	index_t m_num_null_samples;
 	bool m_save_inds;
+	/** number of permutations evaluated in one sweep over the Gram matrix */
+	index_t m_group_size;
 	SGVector<index_t> m_permuted_inds;
 	SGMatrix<index_t> m_inverted_permuted_inds;
 	SGMatrix<index_t> m_all_inds;
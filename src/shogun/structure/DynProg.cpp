@@ -21,6 +21,10 @@
 #include <ctype.h>
 #include <limits.h>
 
+#ifdef HAVE_OPENMP
+#include <omp.h>
+#endif
+
 using namespace shogun;
 
 //#define USE_TMP_ARRAYCLASS
@@ -94,7 +98,9 @@ CDynProg::CDynProg(int32_t num_svms /*= 8 */)
 	  m_num_raw_data(0),
 
 	  m_long_transitions(true),
-	  m_long_transition_threshold(1000)
+	  m_long_transition_threshold(1000),
+	  m_pruning_beam(CMath::INFTY),
+	  m_tabulate_penalties(true)
 {
 	trans_list_forward = NULL ;
 	trans_list_forward_cnt = NULL ;
@@ -989,6 +995,13 @@ void CDynProg::compute_nbest_paths(int32_t max_num_signals, bool use_orf,
 		//for (int32_t i=0;i<m_N*m_seq_len*max_num_signals;i++)
       //   SG_PRINT("(%i)%0.2f ",i,seq_array[i])
 
+		// the views below unref their elements when destroyed, balance that
+		// so that the PLiFs owned by m_plif_matrices stay alive
+		for (int32_t i=0; i<m_N*m_N; i++)
+			SG_REF(Plif_matrix[i]) ;
+		for (int32_t i=0; i<m_N*max_num_signals; i++)
+			SG_REF(Plif_state_signals[i]) ;
+
 		CDynamicObjectArray PEN((CSGObject**) Plif_matrix, m_N, m_N, false, false) ; // 2d, CPlifBase*
 
 		CDynamicObjectArray PEN_state_signals((CSGObject**) Plif_state_signals, m_N, max_num_signals, false, false) ; // 2d,  CPlifBase*
@@ -1134,12 +1147,6 @@ void CDynProg::compute_nbest_paths(int32_t max_num_signals, bool use_orf,
 		long_transition_content_end_position.set_const(0) ;
 #endif
 
-		svm_value = SG_MALLOC(float64_t , m_num_lin_feat_plifs_cum[m_num_raw_data]+m_num_intron_plifs);
-		{ // initialize svm_svalue
-			for (int32_t s=0; s<m_num_lin_feat_plifs_cum[m_num_raw_data]+m_num_intron_plifs; s++)
-				svm_value[s]=0 ;
-		}
-
 		CDynamicArray<int32_t> look_back(m_N,m_N) ; // 2d
 		//CDynamicArray<int32_t> look_back_orig(m_N,m_N) ;
 
@@ -1240,6 +1247,47 @@ void CDynProg::compute_nbest_paths(int32_t max_num_signals, bool use_orf,
 			    }
 		    SG_DEBUG("Using %i long transitions\n", num_long_transitions)
 	    }
+
+	    /* tabulate the penalties of transitions that do not depend on SVM
+	     * values for all segment lengths up to their look-back, so that the
+	     * recursion neither calls the (virtual, possibly nested) PLiF lookup
+	     * nor computes content SVM values for them */
+	    SGVector<int64_t> pen_table_offset(m_N * m_N);
+	    pen_table_offset.set_const(-1);
+	    SGVector<float64_t> pen_table;
+	    {
+		    const int64_t max_pen_table_len = 1 << 22;
+		    int64_t pen_table_len = 0;
+		    for (int32_t j = 0; j < m_N; j++)
+			    for (int32_t i = 0; i < trans_list_forward_cnt[j]; i++)
+			    {
+				    T_STATES ii = trans_list_forward[j][i];
+				    CPlifBase* penij = (CPlifBase*)PEN.element(j, ii);
+				    int32_t len = look_back.element(j, ii);
+				    if (!m_tabulate_penalties || penij == NULL ||
+				        penij->uses_svm_values() || len < 0 ||
+				        pen_table_len + len + 1 > max_pen_table_len)
+					    continue;
+				    pen_table_offset[j * m_N + ii] = pen_table_len;
+				    pen_table_len += len + 1;
+			    }
+
+		    if (pen_table_len > 0)
+		    {
+			    pen_table = SGVector<float64_t>(pen_table_len);
+			    for (int32_t j = 0; j < m_N; j++)
+				    for (int32_t ii = 0; ii < m_N; ii++)
+				    {
+					    int64_t offset = pen_table_offset[j * m_N + ii];
+					    if (offset < 0)
+						    continue;
+					    CPlifBase* penij = (CPlifBase*)PEN.element(j, ii);
+					    for (int32_t l = 0; l <= look_back.element(j, ii); l++)
+						    pen_table[offset + l] = penij->lookup_penalty(l, NULL);
+				    }
+		    }
+		    SG_DEBUG("Tabulated %" PRId64 " penalty values\n", pen_table_len)
+	    }
 	    // SG_PRINT("max_look_back: %i \n", max_look_back)
 
 	    // SG_PRINT("use_svm=%i, genestr_len: \n", use_svm,
@@ -1290,10 +1338,21 @@ void CDynProg::compute_nbest_paths(int32_t max_num_signals, bool use_orf,
 	    CDynamicArray<int16_t> ktable_end(nbest);
 	    // ktable_end.set_const(0) ;
 
-	    float64_t* fixedtempvv = SG_MALLOC(float64_t, look_back_buflen);
-	    memset(fixedtempvv, 0, look_back_buflen * sizeof(float64_t));
-	    int32_t* fixedtempii = SG_MALLOC(int32_t, look_back_buflen);
-	    memset(fixedtempii, 0, look_back_buflen * sizeof(int32_t));
+	    /* target states of one position are processed in parallel, each
+	     * thread uses its own slice of the scratch buffers */
+#ifdef HAVE_OPENMP
+	    const int32_t num_threads = parallel->get_num_threads();
+#else
+	    const int32_t num_threads = 1;
+#endif
+	    const int32_t svm_value_len =
+	        m_num_lin_feat_plifs_cum[m_num_raw_data] + m_num_intron_plifs;
+	    float64_t* svm_value_buf =
+	        SG_CALLOC(float64_t, int64_t(svm_value_len) * num_threads);
+	    float64_t* fixedtempvv_buf =
+	        SG_CALLOC(float64_t, int64_t(look_back_buflen) * num_threads);
+	    int32_t* fixedtempii_buf =
+	        SG_CALLOC(int32_t, int64_t(look_back_buflen) * num_threads);
 
 	    CDynamicArray<float64_t> oldtempvv(look_back_buflen);
 
@@ -1412,13 +1471,41 @@ void CDynProg::compute_nbest_paths(int32_t max_num_signals, bool use_orf,
 			}
 		}
 
+		/* with pruning, prune_floor[ts] is the lowest predecessor score
+		 * (best score at ts minus the beam) a segment starting at ts
+		 * needs to be considered */
+		const bool use_pruning = CMath::is_finite(m_pruning_beam);
+		SGVector<float64_t> prune_floor;
+		if (use_pruning)
+		{
+			prune_floor = SGVector<float64_t>(m_seq_len);
+			float64_t best = -CMath::INFTY;
+			for (int32_t i=0; i<m_N; i++)
+				best = CMath::max(best, delta.element(delta_array, 0, i, 0, m_seq_len, m_N));
+			prune_floor[0] = best-m_pruning_beam;
+		}
+
 		SG_DEBUG("START_RECURSION \n\n")
 
 		// recursion
 		for (int32_t t=1; t<m_seq_len; t++)
 		{
-			for (T_STATES j=0; j<m_N; j++)
+			// delta at t only depends on positions before t, hence all
+			// target states can be computed independently
+#ifndef DYNPROG_TIMING
+#pragma omp parallel for schedule(dynamic) num_threads(num_threads)
+#endif
+			for (int32_t j=0; j<m_N; j++)
 			{
+#ifdef HAVE_OPENMP
+				const int32_t thread_num = omp_get_thread_num();
+#else
+				const int32_t thread_num = 0;
+#endif
+				float64_t* svm_value = svm_value_buf + int64_t(svm_value_len)*thread_num;
+				float64_t* fixedtempvv = fixedtempvv_buf + int64_t(look_back_buflen)*thread_num;
+				int32_t* fixedtempii = fixedtempii_buf + int64_t(look_back_buflen)*thread_num;
+
 				if (seq.element(j,t)<=-1e20)
 				{ // if we cannot observe the symbol here, then we can omit the rest
 					for (int16_t k=0; k<nbest; k++)
@@ -1460,6 +1547,9 @@ void CDynProg::compute_nbest_paths(int32_t max_num_signals, bool use_orf,
 						  } */
 
 						int32_t look_back_ = look_back.element(j, ii) ;
+						const float64_t* pen_table_ = NULL ;
+						if (pen_table_offset[j*m_N+ii]>=0)
+							pen_table_ = pen_table.vector+pen_table_offset[j*m_N+ii] ;
 
 						int32_t orf_from = m_orf_info.element(ii,0) ;
 						int32_t orf_to   = m_orf_info.element(j,1) ;
@@ -1503,6 +1593,8 @@ void CDynProg::compute_nbest_paths(int32_t max_num_signals, bool use_orf,
 
 							if (ok)
 							{
+								if (use_pruning && delta.element(delta_array, ts, ii, 0, m_seq_len, m_N)<prune_floor[ts])
+									continue ;
 
 								float64_t segment_loss = 0.0 ;
 								if (with_loss)
@@ -1515,12 +1607,13 @@ void CDynProg::compute_nbest_paths(int32_t max_num_signals, bool use_orf,
 								// BEST_PATH_TRANS
 								////////////////////////////////////////////////////////
 
-								int32_t frame = orf_from;//m_orf_info.element(ii,0);
-								lookup_content_svm_values(ts, t, m_pos[ts], m_pos[t], svm_value, frame);
-
 								float64_t pen_val = 0.0 ;
-								if (penalty)
+								if (pen_table_)
+									pen_val = pen_table_[m_pos[t]-m_pos[ts]] ;
+								else if (penalty)
 								{
+									int32_t frame = orf_from;//m_orf_info.element(ii,0);
+									lookup_content_svm_values(ts, t, m_pos[ts], m_pos[t], svm_value, frame);
 #ifdef DYNPROG_TIMING_DETAIL
 									MyTime.start() ;
 #endif
@@ -1712,15 +1805,15 @@ void CDynProg::compute_nbest_paths(int32_t max_num_signals, bool use_orf,
 									// but the current implementation is not valid since the
 									// long transition is discarded without loocking if there
 									// is a second best long transition in between
-									long_transition_content_scores.set_element(-CMath::INFTY, ii, j) ;
-									long_transition_content_start_position.set_element(0, ii, j) ;
+									long_transition_content_scores.element(ii, j) = -CMath::INFTY ;
+									long_transition_content_start_position.element(ii, j) = 0 ;
 									if (with_loss)
-										long_transition_content_scores_loss.set_element(0.0, ii, j) ;
+										long_transition_content_scores_loss.element(ii, j) = 0.0 ;
 #ifdef DYNPROG_DEBUG
-									long_transition_content_scores_pen.set_element(0.0, ii, j) ;
-									long_transition_content_scores_elem.set_element(0.0, ii, j) ;
-									long_transition_content_scores_prev.set_element(0.0, ii, j) ;
-									long_transition_content_end_position.set_element(0, ii, j) ;
+									long_transition_content_scores_pen.element(ii, j) = 0.0 ;
+									long_transition_content_scores_elem.element(ii, j) = 0.0 ;
+									long_transition_content_scores_prev.element(ii, j) = 0.0 ;
+									long_transition_content_end_position.element(ii, j) = 0 ;
 #endif
 								}
 								if (with_loss)
@@ -1728,35 +1821,35 @@ void CDynProg::compute_nbest_paths(int32_t max_num_signals, bool use_orf,
 									float64_t old_loss = long_transition_content_scores_loss.get_element(ii, j) ;
 									float64_t new_loss = m_seg_loss_obj->get_segment_loss(long_transition_content_start_position.get_element(ii,j), end_5p_part, elem_id[i]);
 									float64_t score = long_transition_content_scores.get_element(ii, j) - old_loss + new_loss ;
-									long_transition_content_scores.set_element(score, ii, j) ;
-									long_transition_content_scores_loss.set_element(new_loss, ii, j) ;
+									long_transition_content_scores.element(ii, j) = score ;
+									long_transition_content_scores_loss.element(ii, j) = new_loss ;
 #ifdef DYNPROG_DEBUG
-									long_transition_content_end_position.set_element(end_5p_part, ii, j) ;
+									long_transition_content_end_position.element(ii, j) = end_5p_part ;
 #endif
 
 								}
 								if (-long_transition_content_scores.get_element(ii, j) > mval_trans )
 								{
 									/* then the old long transition is either too far away or worse than the current one */
-									long_transition_content_scores.set_element(-mval_trans, ii, j) ;
-									long_transition_content_start_position.set_element(start_5p_part, ii, j) ;
+									long_transition_content_scores.element(ii, j) = -mval_trans ;
+									long_transition_content_start_position.element(ii, j) = start_5p_part ;
 									if (with_loss)
-										long_transition_content_scores_loss.set_element(segment_loss_part1, ii, j) ;
+										long_transition_content_scores_loss.element(ii, j) = segment_loss_part1 ;
 #ifdef DYNPROG_DEBUG
-									long_transition_content_scores_pen.set_element(pen_val*0.5, ii, j) ;
-									long_transition_content_scores_elem.set_element(elem_val[i], ii, j) ;
-									long_transition_content_scores_prev.set_element(delta.element(delta_array, start_5p_part, ii, 0, m_seq_len, m_N), ii, j) ;
+									long_transition_content_scores_pen.element(ii, j) = pen_val*0.5 ;
+									long_transition_content_scores_elem.element(ii, j) = elem_val[i] ;
+									long_transition_content_scores_prev.element(ii, j) = delta.element(delta_array, start_5p_part, ii, 0, m_seq_len, m_N) ;
 									/*ASSERT(fabs(long_transition_content_scores.get_element(ii, j)-(long_transition_content_scores_pen.get_element(ii, j) +
 									  long_transition_content_scores_elem.get_element(ii, j) +
 									  long_transition_content_scores_prev.get_element(ii, j)))<1e-6) ;*/
-									long_transition_content_end_position.set_element(end_5p_part, ii, j) ;
+									long_transition_content_end_position.element(ii, j) = end_5p_part ;
 #endif
 								}
 								//
 								// this sets the position where the search for better 5'parts is started the next time
 								// whithout this the prediction takes ages
 								//
-								long_transition_content_start.set_element(start_5p_part, ii, j) ;
+								long_transition_content_start.element(ii, j) = start_5p_part ;
 							}
 
 							// consider the 3' part at the end of the long segment:
@@ -1901,7 +1994,19 @@ void CDynProg::compute_nbest_paths(int32_t max_num_signals, bool use_orf,
 					}
 				}
 			}
+
+			if (use_pruning)
+			{
+				float64_t best = -CMath::INFTY;
+				for (int32_t i=0; i<m_N; i++)
+					best = CMath::max(best, delta.element(delta_array, t, i, 0, m_seq_len, m_N));
+				prune_floor[t] = best-m_pruning_beam;
+			}
 		}
+		SG_FREE(svm_value_buf);
+		SG_FREE(fixedtempvv_buf);
+		SG_FREE(fixedtempii_buf);
+
 		{ //termination
 			int32_t list_len = 0 ;
 			for (int16_t diff=0; diff<nbest; diff++)
@@ -1975,8 +2080,6 @@ void CDynProg::compute_nbest_paths(int32_t max_num_signals, bool use_orf,
 		SG_PRINT("Timing:  orf=%1.2f s \n Segment_init=%1.2f s Segment_pos=%1.2f s  Segment_extend=%1.2f s Segment_clean=%1.2f s\nsvm_init=%1.2f s  svm_pos=%1.2f  svm_clean=%1.2f\n  content_svm_values_time=%1.2f  content_plifs_time=%1.2f\ninner_loop_max_time=%1.2f inner_loop=%1.2f long_transition_time=%1.2f\n total=%1.2f\n", orf_time, segment_init_time, segment_pos_time, segment_extend_time, segment_clean_time, svm_init_time, svm_pos_time, svm_clean_time, content_svm_values_time, content_plifs_time, inner_loop_max_time, inner_loop_time, long_transition_time, MyTime2.time_diff_sec())
 #endif
 
-		SG_FREE(fixedtempvv);
-		SG_FREE(fixedtempii);
 	}
 
 
@@ -2008,6 +2111,13 @@ void CDynProg::best_path_trans_deriv(
 
 	bool use_svm = false ;
 
+	// the views below unref their elements when destroyed, balance that
+	// so that the PLiFs owned by m_plif_matrices stay alive
+	for (int32_t i=0; i<m_N*m_N; i++)
+		SG_REF(Plif_matrix[i]) ;
+	for (int32_t i=0; i<m_N*max_num_signals; i++)
+		SG_REF(Plif_state_signals[i]) ;
+
 	CDynamicObjectArray PEN((CSGObject**) Plif_matrix, m_N, m_N, false, false) ; // 2d, CPlifBase*
 
 	CDynamicObjectArray PEN_state_signals((CSGObject**) Plif_state_signals, m_N, max_num_signals, false, false) ; // 2d, CPlifBase*
@@ -2460,6 +2570,12 @@ void CDynProg::lookup_content_svm_values(const int32_t from_state, const int32_t
 	content_svm_values_time += MyTime.time_diff_sec() ;
 #endif
 }
+void CDynProg::set_pruning_beam(float64_t beam)
+{
+	REQUIRE(beam>=0, "Pruning beam (%f) must be non-negative\n", beam)
+	m_pruning_beam = beam;
+}
+
 void CDynProg::set_intron_list(CIntronList* intron_list, int32_t num_plifs)
 {
 	m_intron_list = intron_list;
@@ -478,6 +478,48 @@ public:
 		//m_long_transition_max = max_len;
 	}
 
+	/** set the beam used to prune segment starts in compute_nbest_paths
+	 *
+	 * A segment starting at position ts is only extended if the score
+	 * of its predecessor state is at most beam below the best score at
+	 * ts. The default (CMath::INFTY) disables pruning and yields the
+	 * exact Viterbi solution.
+	 *
+	 * @param beam non-negative beam width
+	 */
+	void set_pruning_beam(float64_t beam);
+
+	/** get the pruning beam
+	 *
+	 * @return beam width
+	 */
+	float64_t get_pruning_beam() const
+	{
+		return m_pruning_beam;
+	}
+
+	/** set whether compute_nbest_paths tabulates the penalties of
+	 * transitions whose PLiF does not depend on SVM values
+	 *
+	 * Tabulation does not change the result, disabling it is only
+	 * useful to save memory or to check the tables.
+	 *
+	 * @param tabulate whether to tabulate penalties (default true)
+	 */
+	void set_tabulate_penalties(bool tabulate)
+	{
+		m_tabulate_penalties = tabulate;
+	}
+
+	/** get whether penalties are tabulated
+	 *
+	 * @return whether penalties are tabulated
+	 */
+	bool get_tabulate_penalties() const
+	{
+		return m_tabulate_penalties;
+	}
+
 protected:
 
 	/* helper functions */
@@ -749,6 +791,10 @@ protected:
 	/** threshold for transitions that are computed
 	 *  the traditional way*/
 	int32_t m_long_transition_threshold  ;
+	/** beam for pruning segment starts in the recursion */
+	float64_t m_pruning_beam;
+	/** whether to tabulate penalties in compute_nbest_paths */
+	bool m_tabulate_penalties;
 	/** maximal length of a long transition
 	 *  Note: is ignored in the current implementation
 	 *        => arbitrarily long transitions can be decoded
@@ -12,22 +12,22 @@ CPlifMatrix::CPlifMatrix() : m_PEN(NULL), m_num_plifs(0), m_num_limits(0),
 
 CPlifMatrix::~CPlifMatrix()
 {
-	for (int32_t i=0; i<m_num_plifs; i++)
-		delete m_PEN[i];
-	SG_FREE(m_PEN);
-
+	// entries of the PLiF matrix may be PLiFs of m_PEN, all are referenced
 	for (int32_t i=0; i<m_num_states*m_num_states; i++)
-		delete m_plif_matrix[i];
-
+		SG_UNREF(m_plif_matrix[i]);
 	SG_FREE(m_plif_matrix);
 
+	for (int32_t i=0; i<m_num_plifs; i++)
+		SG_UNREF(m_PEN[i]);
+	SG_FREE(m_PEN);
+
 	SG_FREE(m_state_signals);
 }
 
 void CPlifMatrix::create_plifs(int32_t num_plifs, int32_t num_limits)
 {
 	for (int32_t i=0; i<m_num_plifs; i++)
-		delete m_PEN[i];
+		SG_UNREF(m_PEN[i]);
 	SG_FREE(m_PEN);
 	m_PEN=NULL;
 
@@ -35,7 +35,10 @@ void CPlifMatrix::create_plifs(int32_t num_plifs, int32_t num_limits)
 	m_num_limits=num_limits;
 	m_PEN = SG_MALLOC(CPlif*, num_plifs);
 	for (int32_t i=0; i<num_plifs; i++)
+	{
 		m_PEN[i]=new CPlif(num_limits) ;
+		SG_REF(m_PEN[i]);
+	}
 }
 
 void CPlifMatrix::set_plif_ids(SGVector<int32_t> plif_ids)
@@ -184,7 +187,7 @@ bool CPlifMatrix::compute_plif_matrix(SGNDArray<float64_t> penalties_array)
 	int32_t num_plifs = get_num_plifs();
 
 	for (int32_t i=0; i<m_num_states*m_num_states; i++)
-		delete  m_plif_matrix[i];
+		SG_UNREF(m_plif_matrix[i]);
 	SG_FREE(m_plif_matrix);
 
 	m_num_states = num_states;
@@ -230,10 +233,14 @@ bool CPlifMatrix::compute_plif_matrix(SGNDArray<float64_t> penalties_array)
 			{
 				SG_UNREF(plif_array);
 				ASSERT(plif!=NULL)
+				SG_REF(plif);
 				m_plif_matrix[i+j*num_states] = plif ;
 			}
 			else
+			{
+				SG_REF(plif_array);
 				m_plif_matrix[i+j*num_states] = plif_array ;
+			}
 
 		}
 	}
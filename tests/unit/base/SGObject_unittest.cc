@@ -417,6 +417,8 @@ TEST(SGObject,update_parameter_hash)
 	uint32_t hash2=inf->m_hash;
 
 	EXPECT_TRUE(hash1==hash2);
+	EXPECT_EQ(inf->compute_parameter_hash(), hash2);
+	EXPECT_EQ(inf->m_hash, hash2);
 
 	SG_UNREF(inf);
 }
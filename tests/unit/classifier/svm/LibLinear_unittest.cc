@@ -4,6 +4,8 @@
  * Authors: pl8787, Elfarouk Yasser
  */
 
+#include <shogun/base/Parallel.h>
+#include <shogun/base/init.h>
 #include <shogun/classifier/svm/LibLinear.h>
 #include <shogun/features/DataGenerator.h>
 #include <shogun/features/DenseFeatures.h>
@@ -442,3 +444,42 @@ TEST_F(LibLinear, simple_set_train_L2R_LR_DUAL_BIAS)
 	// bias, not l1
 	train_with_solver_simple(liblinear_solver_type, true, false, t_w);
 }
+
+TEST_F(LibLinear, parallel_dual_matches_serial)
+{
+	generate_data_l2();
+
+	int32_t old_num_threads = get_global_parallel()->get_num_threads();
+	get_global_parallel()->set_num_threads(4);
+
+	for (auto solver : {L2R_L2LOSS_SVC_DUAL, L2R_L1LOSS_SVC_DUAL})
+	{
+		auto serial = new CLibLinear(solver);
+		auto parallel = new CLibLinear(solver);
+		SG_REF(serial);
+		SG_REF(parallel);
+
+		for (auto ll : {serial, parallel})
+		{
+			ll->set_bias_enabled(true);
+			ll->set_epsilon(1e-8);
+			ll->set_features(train_feats);
+			ll->set_labels(ground_truth);
+		}
+		parallel->set_parallel_dual(true);
+
+		serial->train();
+		parallel->train();
+
+		SGVector<float64_t> w_serial = serial->get_w();
+		SGVector<float64_t> w_parallel = parallel->get_w();
+		for (auto i : range(w_serial.vlen))
+			EXPECT_NEAR(w_serial[i], w_parallel[i], 1e-4);
+		EXPECT_NEAR(serial->get_bias(), parallel->get_bias(), 1e-4);
+
+		SG_UNREF(serial);
+		SG_UNREF(parallel);
+	}
+
+	get_global_parallel()->set_num_threads(old_num_threads);
+}
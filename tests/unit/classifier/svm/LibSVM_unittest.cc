@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+
+#include <shogun/classifier/svm/LibSVM.h>
+#include <shogun/features/DenseFeatures.h>
+#include <shogun/kernel/GaussianKernel.h>
+#include <shogun/labels/BinaryLabels.h>
+#include <shogun/lib/external/shogun_libsvm.h>
+#include <shogun/mathematics/Math.h>
+
+using namespace shogun;
+
+namespace
+{
+const int32_t num_vectors=200;
+const float64_t C=1.0;
+
+/* two overlapping gaussian clouds, so that there are free and bounded
+ * support vectors */
+void generate_data(SGMatrix<float64_t>& data, SGVector<float64_t>& lab)
+{
+	CMath::init_random(17);
+	data=SGMatrix<float64_t>(2, num_vectors);
+	lab=SGVector<float64_t>(num_vectors);
+	for (index_t i=0; i<num_vectors; i++)
+	{
+		lab[i]=i<num_vectors/2 ? -1 : 1;
+		data(0, i)=CMath::randn_double()+lab[i];
+		data(1, i)=CMath::randn_double()-lab[i];
+	}
+}
+
+/* train on the same data with the given number of threads and kernel cache
+ * size in MB, 0 leaves room for only two columns in the cache, so that
+ * columns are batched in pairs and evicted all the time */
+CLibSVM* train(
+	LIBSVM_SOLVER_TYPE solver_type, int32_t num_threads, int32_t cache_size)
+{
+	SGMatrix<float64_t> data;
+	SGVector<float64_t> lab;
+	generate_data(data, lab);
+
+	CDenseFeatures<float64_t>* features=new CDenseFeatures<float64_t>(data);
+	CGaussianKernel* kernel=new CGaussianKernel(features, features, 2.0);
+	kernel->set_cache_size(cache_size);
+
+	CLibSVM* svm=new CLibSVM(C, kernel, new CBinaryLabels(lab), solver_type);
+	SG_REF(svm);
+	int32_t old_num_threads=svm->parallel->get_num_threads();
+	svm->parallel->set_num_threads(num_threads);
+	svm->set_epsilon(1e-5);
+	svm->train();
+	svm->parallel->set_num_threads(old_num_threads);
+
+	return svm;
+}
+
+SGVector<float64_t> training_outputs(CLibSVM* svm)
+{
+	CBinaryLabels* outputs=svm->apply_binary();
+	SGVector<float64_t> values=outputs->get_values().clone();
+	SG_UNREF(outputs);
+	return values;
+}
+}
+
+TEST(LibSVM, batched_Q_columns_match_kernel)
+{
+	CLibSVM* svm=train(LIBSVM_C_SVC, 4, 0);
+	CKernel* kernel=svm->get_kernel();
+
+	SGMatrix<float64_t> data;
+	SGVector<float64_t> lab;
+	generate_data(data, lab);
+
+	// the gradient the solver stops on is built from batched Q columns, so
+	// recompute the outputs pair by pair and check that the free support
+	// vectors lie on the margin
+	int32_t num_free=0;
+	for (int32_t s=0; s<svm->get_num_support_vectors(); s++)
+	{
+		float64_t alpha=svm->get_alpha(s);
+		if (CMath::abs(alpha)<1e-8 || CMath::abs(alpha)>C-1e-8)
+			continue;
+
+		int32_t i=svm->get_support_vector(s);
+		float64_t f=svm->get_bias();
+		for (int32_t t=0; t<svm->get_num_support_vectors(); t++)
+			f+=svm->get_alpha(t)*kernel->kernel(svm->get_support_vector(t), i);
+
+		EXPECT_NEAR(lab[i]*f, 1.0, 1e-3);
+		num_free++;
+	}
+	EXPECT_GT(num_free, 0);
+
+	SG_UNREF(kernel);
+	SG_UNREF(svm);
+}
+
+TEST(LibSVM, parallel_matches_single_thread)
+{
+	const LIBSVM_SOLVER_TYPE solver_types[]={LIBSVM_C_SVC, LIBSVM_NU_SVC};
+	for (auto solver_type : solver_types)
+	{
+		CLibSVM* reference=train(solver_type, 1, 10);
+		SGVector<float64_t> ref_outputs=training_outputs(reference);
+
+		// same batches, only the number of threads differs
+		CLibSVM* svm=train(solver_type, 4, 10);
+		EXPECT_EQ(svm->get_bias(), reference->get_bias());
+		ASSERT_EQ(
+			svm->get_num_support_vectors(),
+			reference->get_num_support_vectors());
+		for (int32_t s=0; s<svm->get_num_support_vectors(); s++)
+		{
+			EXPECT_EQ(
+				svm->get_support_vector(s), reference->get_support_vector(s));
+			EXPECT_EQ(svm->get_alpha(s), reference->get_alpha(s));
+		}
+		SG_UNREF(svm);
+
+		// batches of at most two columns only change the rounding
+		const int32_t num_threads[]={1, 4};
+		for (auto threads : num_threads)
+		{
+			svm=train(solver_type, threads, 0);
+			SGVector<float64_t> outputs=training_outputs(svm);
+			for (index_t i=0; i<num_vectors; i++)
+				EXPECT_NEAR(outputs[i], ref_outputs[i], 1e-3);
+			SG_UNREF(svm);
+		}
+
+		SG_UNREF(reference);
+	}
+}
+
+TEST(LibSVM, batched_Q_columns_after_longer_columns)
+{
+	SGMatrix<float64_t> data;
+	SGVector<float64_t> lab;
+	generate_data(data, lab);
+
+	CDenseFeatures<float64_t>* features=new CDenseFeatures<float64_t>(data);
+	CGaussianKernel* kernel=new CGaussianKernel(features, features, 2.0);
+	SG_REF(kernel);
+
+	svm_problem problem;
+	problem.l=num_vectors;
+	problem.x=SG_MALLOC(svm_node*, num_vectors);
+	svm_node* nodes=SG_MALLOC(svm_node, num_vectors);
+	for (int32_t i=0; i<num_vectors; i++)
+	{
+		nodes[i].index=i;
+		problem.x[i]=&nodes[i];
+	}
+
+	svm_parameter param;
+	param.kernel=kernel;
+	param.max_train_time=0;
+	// room for two full columns only
+	param.cache_size=0;
+
+	// as in the inactive branch of reconstruct_gradient(): the last two
+	// columns are cached in full length from the initial gradient, the
+	// batch then asks for them and more columns of the active length
+	const int32_t len=num_vectors/4;
+	const int32_t num_columns=num_vectors/2;
+	SGVector<int32_t> columns(num_columns);
+	columns[0]=num_vectors-1;
+	columns[1]=num_vectors-2;
+	for (int32_t c=2; c<num_columns; c++)
+		columns[c]=c-2;
+
+	SGMatrix<float64_t> Q(len, num_columns);
+	svm_get_Q_columns(
+		&problem, &param, num_vectors, columns.vector, num_columns, len,
+		Q.matrix);
+
+	for (int32_t c=0; c<num_columns; c++)
+	{
+		for (int32_t j=0; j<len; j++)
+			EXPECT_NEAR(Q(j, c), kernel->kernel(columns[c], j), 1e-6);
+	}
+
+	SG_FREE(nodes);
+	SG_FREE(problem.x);
+	SG_UNREF(kernel);
+}
@@ -0,0 +1,88 @@
+/*
+ * This software is distributed under BSD 3-clause license (see LICENSE file).
+ */
+
+#include <shogun/clustering/GMM.h>
+#include <shogun/features/DenseFeatures.h>
+#include <shogun/mathematics/Math.h>
+#include <shogun/mathematics/eigen3.h>
+#include <gtest/gtest.h>
+
+using namespace shogun;
+using namespace Eigen;
+
+/* log likelihood of the data under the mixture, computed directly from the
+ * covariance matrices */
+static float64_t log_likelihood(CGMM* gmm, SGMatrix<float64_t> data)
+{
+	int32_t num_dim=data.num_rows;
+	float64_t result=0;
+	for (int32_t i=0; i<data.num_cols; i++)
+	{
+		Map<VectorXd> x(data.get_column_vector(i), num_dim);
+		float64_t px=0;
+		for (int32_t j=0; j<gmm->get_num_components(); j++)
+		{
+			CGaussian* component=gmm->get_comp()[j];
+			SGVector<float64_t> mean=component->get_mean();
+			SGVector<float64_t> d=component->get_d();
+
+			MatrixXd cov;
+			if (component->get_cov_type()==FULL)
+			{
+				SGMatrix<float64_t> u=component->get_u();
+				Map<MatrixXd> U(u.matrix, num_dim, num_dim);
+				Map<VectorXd> D(d.vector, num_dim);
+				cov=U*D.asDiagonal()*U.transpose();
+			}
+			else
+				cov=Map<VectorXd>(d.vector, num_dim).asDiagonal();
+
+			VectorXd diff=x-Map<VectorXd>(mean.vector, num_dim);
+			float64_t maha=diff.dot(cov.ldlt().solve(diff));
+			px+=gmm->get_coef()[j]*std::exp(-0.5*maha)/
+				std::sqrt(std::pow(2*M_PI, num_dim)*cov.determinant());
+		}
+		result+=std::log(px);
+	}
+	return result;
+}
+
+static void check_em(ECovType cov_type)
+{
+	CMath::init_random(3);
+
+	int32_t num_vectors=600;
+	SGMatrix<float64_t> data(2, num_vectors);
+	for (int32_t i=0; i<num_vectors; i++)
+	{
+		float64_t offset=(i%2==0) ? -4.0 : 4.0;
+		float64_t a=CMath::randn_double();
+		float64_t b=CMath::randn_double();
+		data(0,i)=offset+a;
+		data(1,i)=offset+0.5*a+0.7*b;
+	}
+
+	CDenseFeatures<float64_t>* features=new CDenseFeatures<float64_t>(data);
+	CGMM* gmm=new CGMM(2, cov_type);
+	gmm->train(features);
+	float64_t result=gmm->train_em(1e-9, 1000, 1e-9);
+
+	EXPECT_NEAR(log_likelihood(gmm, data), result, 1e-6);
+
+	SGVector<float64_t> coef=gmm->get_coef();
+	EXPECT_NEAR(0.5, coef[0], 1e-6);
+	EXPECT_NEAR(0.5, coef[1], 1e-6);
+
+	SG_UNREF(gmm);
+}
+
+TEST(GMM, train_em_full)
+{
+	check_em(FULL);
+}
+
+TEST(GMM, train_em_diag)
+{
+	check_em(DIAG);
+}
@@ -0,0 +1,68 @@
+/*
+ * This software is distributed under BSD 3-clause license (see LICENSE file).
+ */
+
+#include <shogun/features/DenseFeatures.h>
+#include <shogun/clustering/Hierarchical.h>
+#include <shogun/distance/EuclideanDistance.h>
+#include <gtest/gtest.h>
+
+using namespace shogun;
+
+/* points on a line at 0, 1, 3, 7 and 15, so that every linkage merges
+ * {0,1}, then 3, then 7, at different distances */
+static void check_linkage(EHierarchicalLinkage linkage,
+	float64_t d1, float64_t d2, float64_t d3)
+{
+	SGMatrix<float64_t> points(1, 5);
+	points[0]=0;
+	points[1]=1;
+	points[2]=3;
+	points[3]=7;
+	points[4]=15;
+
+	CDenseFeatures<float64_t>* features=new CDenseFeatures<float64_t>(points);
+	SG_REF(features);
+	CEuclideanDistance* distance=new CEuclideanDistance(features, features);
+	CHierarchical* clustering=new CHierarchical(3, distance);
+	clustering->set_linkage(linkage);
+	EXPECT_EQ(linkage, clustering->get_linkage());
+	clustering->train(features);
+
+	SGMatrix<int32_t> pairs=clustering->get_cluster_pairs();
+	SGVector<float64_t> dists=clustering->get_merge_distances();
+
+	EXPECT_EQ(0, pairs(0,0));
+	EXPECT_EQ(1, pairs(1,0));
+	EXPECT_EQ(2, pairs(0,1));
+	EXPECT_EQ(5, pairs(1,1));
+	EXPECT_EQ(3, pairs(0,2));
+	EXPECT_EQ(6, pairs(1,2));
+
+	EXPECT_NEAR(d1, dists[0], 1E-12);
+	EXPECT_NEAR(d2, dists[1], 1E-12);
+	EXPECT_NEAR(d3, dists[2], 1E-12);
+
+	SG_UNREF(clustering);
+	SG_UNREF(features);
+}
+
+TEST(Hierarchical, single_linkage)
+{
+	check_linkage(HL_SINGLE, 1, 2, 4);
+}
+
+TEST(Hierarchical, complete_linkage)
+{
+	check_linkage(HL_COMPLETE, 1, 3, 7);
+}
+
+TEST(Hierarchical, average_linkage)
+{
+	check_linkage(HL_AVERAGE, 1, 2.5, 17.0/3);
+}
+
+TEST(Hierarchical, ward_linkage)
+{
+	check_linkage(HL_WARD, 1, std::sqrt(4.0/3)*2.5, std::sqrt(1.5)*17.0/3);
+}
@@ -7,9 +7,11 @@
 
 #include <shogun/labels/MulticlassLabels.h>
 #include <shogun/features/DenseFeatures.h>
+#include <shogun/features/SparseFeatures.h>
 #include <shogun/clustering/KMeans.h>
 #include <shogun/clustering/KMeansMiniBatch.h>
 #include <shogun/distance/EuclideanDistance.h>
+#include <shogun/distance/SparseEuclideanDistance.h>
 #include <gtest/gtest.h>
 
 using namespace shogun;
@@ -280,3 +282,127 @@ TEST(KMeans, random_centers_assign)
 	SG_UNREF(learnt_centers);
 }
 
+
+TEST(KMeans, train_methods)
+{
+	/* Hamerly's bounds and blocked assignments should reproduce the Lloyd
+	 * iterations on random data */
+	CMath::init_random(17);
+	int32_t dim=3;
+	int32_t num_points=1000;
+	int32_t num_clusters=8;
+
+	SGMatrix<float64_t> data(dim, num_points);
+	for (int32_t i=0; i<num_points; i++)
+	{
+		float64_t offset=5.0*(i%num_clusters);
+		for (int32_t j=0; j<dim; j++)
+			data(j,i)=offset+CMath::normal_random(0.0, 2.0);
+	}
+
+	SGMatrix<float64_t> initial_centers(dim, num_clusters);
+	for (int32_t i=0; i<num_clusters; i++)
+		for (int32_t j=0; j<dim; j++)
+			initial_centers(j,i)=data(j,i);
+
+	CDenseFeatures<float64_t>* features=new CDenseFeatures<float64_t>(data);
+	SG_REF(features);
+
+	SGMatrix<float64_t> centers[3];
+	SGVector<float64_t> labels[3];
+	EKMeansMethod methods[3]={KMM_LLOYD, KMM_HAMERLY, KMM_BLOCKED};
+
+	for (int32_t m=0; m<3; m++)
+	{
+		CEuclideanDistance* distance=new CEuclideanDistance(features, features);
+		CKMeans* clustering=new CKMeans(num_clusters, distance,
+			initial_centers.clone());
+		clustering->set_train_method(methods[m]);
+		EXPECT_EQ(methods[m], clustering->get_train_method());
+
+		clustering->train(features);
+		CMulticlassLabels* result=
+			clustering->apply(features)->as<CMulticlassLabels>();
+		labels[m]=result->get_labels();
+		SG_UNREF(result);
+
+		CDenseFeatures<float64_t>* learnt_centers=
+			distance->get_lhs()->as<CDenseFeatures<float64_t>>();
+		centers[m]=learnt_centers->get_feature_matrix();
+		SG_UNREF(learnt_centers);
+		SG_UNREF(clustering);
+	}
+
+	for (int32_t m=1; m<3; m++)
+	{
+		for (int32_t i=0; i<num_points; i++)
+			EXPECT_EQ(labels[0][i], labels[m][i]);
+
+		for (int32_t i=0; i<dim*num_clusters; i++)
+			EXPECT_NEAR(centers[0][i], centers[m][i], 1E-10);
+	}
+
+	SG_UNREF(features);
+}
+
+TEST(KMeans, minibatch_sparse_features)
+{
+	/* mini-batch training on sparse features should give the same centers
+	 * as on the equivalent dense features */
+	int32_t dim=20;
+	int32_t num_points=200;
+	int32_t num_clusters=4;
+
+	CMath::init_random(5);
+	SGMatrix<float64_t> data(dim, num_points);
+	data.zero();
+	for (int32_t i=0; i<num_points; i++)
+	{
+		int32_t cluster=i%num_clusters;
+		for (int32_t j=0; j<3; j++)
+			data(cluster*5+j,i)=CMath::random(1.0, 2.0);
+	}
+
+	SGMatrix<float64_t> initial_centers(dim, num_clusters);
+	for (int32_t i=0; i<num_clusters; i++)
+		for (int32_t j=0; j<dim; j++)
+			initial_centers(j,i)=data(j,i);
+
+	CDenseFeatures<float64_t>* dense=new CDenseFeatures<float64_t>(data);
+	CSparseFeatures<float64_t>* sparse=new CSparseFeatures<float64_t>(data);
+	SG_REF(dense);
+	SG_REF(sparse);
+
+	CMath::init_random(7);
+	CKMeansMiniBatch* dense_clustering=new CKMeansMiniBatch(num_clusters,
+		new CEuclideanDistance(dense, dense), initial_centers.clone());
+	dense_clustering->set_mb_params(16, 50);
+	dense_clustering->train(dense);
+	SGMatrix<float64_t> dense_centers=dense_clustering->get_cluster_centers();
+
+	CMath::init_random(7);
+	CKMeansMiniBatch* sparse_clustering=new CKMeansMiniBatch(num_clusters,
+		new CSparseEuclideanDistance(sparse, sparse), initial_centers.clone());
+	sparse_clustering->set_mb_params(16, 50);
+	sparse_clustering->train(sparse);
+	SGMatrix<float64_t> sparse_centers=sparse_clustering->get_cluster_centers();
+
+	ASSERT_EQ(dim, sparse_centers.num_rows);
+	ASSERT_EQ(num_clusters, sparse_centers.num_cols);
+	for (int32_t i=0; i<dim*num_clusters; i++)
+		EXPECT_NEAR(dense_centers[i], sparse_centers[i], 1E-10);
+
+	CMulticlassLabels* dense_result=
+		dense_clustering->apply(dense)->as<CMulticlassLabels>();
+	CMulticlassLabels* sparse_result=
+		sparse_clustering->apply(sparse)->as<CMulticlassLabels>();
+	for (int32_t i=0; i<num_points; i++)
+		EXPECT_EQ(dense_result->get_label(i), sparse_result->get_label(i));
+
+	SG_UNREF(dense_result);
+	SG_UNREF(sparse_result);
+	SG_UNREF(dense_clustering);
+	SG_UNREF(sparse_clustering);
+	SG_UNREF(dense);
+	SG_UNREF(sparse);
+}
@@ -0,0 +1,78 @@
+#include <shogun/distributions/HMM.h>
+#include <shogun/features/StringFeatures.h>
+#include <shogun/lib/SGStringList.h>
+#include <gtest/gtest.h>
+
+using namespace shogun;
+
+static CStringFeatures<uint16_t>* generate_observations(int32_t num_vec)
+{
+	const char acgt[]="ACGT";
+	SGStringList<char> list(num_vec, 60);
+	for (int32_t i=0; i<num_vec; i++)
+	{
+		int32_t len=CMath::random(20, 60);
+		list.strings[i]=SGString<char>(len);
+		for (int32_t j=0; j<len; j++)
+			list.strings[i].string[j]=acgt[CMath::random(0, 3)];
+	}
+
+	CStringFeatures<char>* chars=new CStringFeatures<char>(list, DNA);
+	CStringFeatures<uint16_t>* obs=new CStringFeatures<uint16_t>(DNA);
+	obs->obtain_from_char(chars, 0, 1, 0, false);
+	SG_UNREF(chars);
+
+	return obs;
+}
+
+TEST(HMM, model_probability_matches_forward)
+{
+	CMath::init_random(17);
+	CStringFeatures<uint16_t>* obs=generate_observations(25);
+	CHMM* hmm=new CHMM(obs, 5, 4, 1e-10);
+	SG_REF(hmm);
+	hmm->init_model_random();
+
+	float64_t expected=0;
+	for (int32_t dim=0; dim<obs->get_num_vectors(); dim++)
+		expected+=hmm->get_log_likelihood_example(dim);
+
+	EXPECT_NEAR(hmm->model_probability_comp(), expected, 1e-8*CMath::abs(expected));
+
+	SG_UNREF(hmm);
+}
+
+#ifndef USE_HMMPARALLEL_STRUCTURES
+TEST(HMM, baum_welch_matches_reference)
+{
+	CMath::init_random(17);
+	CStringFeatures<uint16_t>* obs=generate_observations(25);
+	CHMM* hmm=new CHMM(obs, 5, 4, 1e-10);
+	SG_REF(hmm);
+	hmm->init_model_random();
+
+	CHMM* estimate=new CHMM(hmm);
+	CHMM* reference=new CHMM(hmm);
+	SG_REF(estimate);
+	SG_REF(reference);
+
+	estimate->estimate_model_baum_welch(hmm);
+	float64_t full_prob=hmm->model_probability();
+	reference->estimate_model_baum_welch_old(hmm);
+
+	EXPECT_NEAR(full_prob, hmm->model_probability(), 1e-8*CMath::abs(full_prob));
+	for (int32_t i=0; i<5; i++)
+	{
+		EXPECT_NEAR(estimate->get_p(i), reference->get_p(i), 1e-8);
+		EXPECT_NEAR(estimate->get_q(i), reference->get_q(i), 1e-8);
+		for (int32_t j=0; j<5; j++)
+			EXPECT_NEAR(estimate->get_a(i, j), reference->get_a(i, j), 1e-8);
+		for (int32_t j=0; j<4; j++)
+			EXPECT_NEAR(estimate->get_b(i, j), reference->get_b(i, j), 1e-8);
+	}
+
+	SG_UNREF(estimate);
+	SG_UNREF(reference);
+	SG_UNREF(hmm);
+}
+#endif
@@ -6,6 +6,7 @@
  */
 
 #include <shogun/lib/memory.h>
+#include <shogun/io/SerializableAsciiFile.h>
 #include <shogun/features/StringFeatures.h>
 #include <shogun/lib/SGStringList.h>
 #include <gtest/gtest.h>
@@ -133,3 +134,126 @@ TEST(StringFeaturesTest,clone)
 	SG_UNREF(f);
 	SG_UNREF(f_clone);
 }
+
+TEST(StringFeaturesTest,pack_dna)
+{
+	const char acgt[]="ACGT";
+	SGStringList<char> strings(10, 75);
+	for (index_t i=0; i<strings.num_strings; ++i)
+	{
+		index_t len=CMath::random(40, 75);
+		SGString<char> current(len);
+		for (index_t j=0; j<len; ++j)
+			current.string[j]=acgt[CMath::random(0, 3)];
+		strings.strings[i]=current;
+	}
+
+	SGStringList<char> strings_copy(strings.num_strings, strings.max_string_length);
+	for (index_t i=0; i<strings.num_strings; ++i)
+		strings_copy.strings[i]=strings.strings[i].clone();
+
+	CStringFeatures<char>* f=new CStringFeatures<char>(strings, DNA);
+	CStringFeatures<char>* packed=new CStringFeatures<char>(strings_copy, DNA);
+	EXPECT_TRUE(packed->pack_dna());
+	EXPECT_TRUE(packed->is_dna_packed());
+
+	for (index_t i=0; i<f->get_num_vectors(); ++i)
+	{
+		SGVector<char> a=f->get_feature_vector(i);
+		SGVector<char> b=packed->get_feature_vector(i);
+		ASSERT_EQ(a.vlen, b.vlen);
+		EXPECT_EQ(packed->get_vector_length(i), a.vlen);
+		for (index_t j=0; j<a.vlen; ++j)
+			EXPECT_EQ(a[j], b[j]);
+	}
+
+	for (int32_t order=1; order<=12; order+=11)
+	{
+		CStringFeatures<uint64_t>* kmers=new CStringFeatures<uint64_t>(DNA);
+		CStringFeatures<uint64_t>* packed_kmers=new CStringFeatures<uint64_t>(DNA);
+		kmers->obtain_from_char(f, order-1, order, 0, false);
+		packed_kmers->obtain_from_char(packed, order-1, order, 0, false);
+
+		for (index_t i=0; i<kmers->get_num_vectors(); ++i)
+		{
+			SGVector<uint64_t> a=kmers->get_feature_vector(i);
+			SGVector<uint64_t> b=packed_kmers->get_feature_vector(i);
+			ASSERT_EQ(a.vlen, b.vlen);
+			for (index_t j=0; j<a.vlen; ++j)
+				EXPECT_EQ(a[j], b[j]);
+		}
+
+		SG_UNREF(kmers);
+		SG_UNREF(packed_kmers);
+	}
+
+	packed->unpack_dna();
+	EXPECT_FALSE(packed->is_dna_packed());
+	for (index_t i=0; i<f->get_num_vectors(); ++i)
+	{
+		SGVector<char> a=f->get_feature_vector(i);
+		SGVector<char> b=packed->get_feature_vector(i);
+		ASSERT_EQ(a.vlen, b.vlen);
+		for (index_t j=0; j<a.vlen; ++j)
+			EXPECT_EQ(a[j], b[j]);
+	}
+
+	SG_UNREF(f);
+	SG_UNREF(packed);
+}
+
+TEST(StringFeaturesTest,pack_dna_clone_serialize)
+{
+	const char acgt[]="ACGT";
+	SGStringList<char> strings(10, 75);
+	for (index_t i=0; i<strings.num_strings; ++i)
+	{
+		index_t len=CMath::random(40, 75);
+		SGString<char> current(len);
+		for (index_t j=0; j<len; ++j)
+			current.string[j]=acgt[CMath::random(0, 3)];
+		strings.strings[i]=current;
+	}
+
+	SGStringList<char> strings_copy(strings.num_strings, strings.max_string_length);
+	for (index_t i=0; i<strings.num_strings; ++i)
+		strings_copy.strings[i]=strings.strings[i].clone();
+
+	CStringFeatures<char>* f=new CStringFeatures<char>(strings, DNA);
+	CStringFeatures<char>* packed=new CStringFeatures<char>(strings_copy, DNA);
+	ASSERT_TRUE(packed->pack_dna());
+
+	CStringFeatures<char>* packed_clone=(CStringFeatures<char>*) packed->clone();
+	EXPECT_TRUE(packed_clone->is_dna_packed());
+	EXPECT_TRUE(packed_clone->equals(packed));
+
+	CSerializableAsciiFile* outfile=new CSerializableAsciiFile("packedStringFeatures.txt", 'w');
+	packed->save_serializable(outfile);
+	SG_UNREF(outfile);
+
+	CStringFeatures<char>* packed_loaded=new CStringFeatures<char>();
+	CSerializableAsciiFile* infile=new CSerializableAsciiFile("packedStringFeatures.txt", 'r');
+	packed_loaded->load_serializable(infile);
+	SG_UNREF(infile);
+	EXPECT_TRUE(packed_loaded->is_dna_packed());
+	EXPECT_TRUE(packed_loaded->equals(packed));
+
+	for (index_t i=0; i<f->get_num_vectors(); ++i)
+	{
+		SGVector<char> a=f->get_feature_vector(i);
+		SGVector<char> b=packed_clone->get_feature_vector(i);
+		SGVector<char> c=packed_loaded->get_feature_vector(i);
+		ASSERT_EQ(a.vlen, b.vlen);
+		ASSERT_EQ(a.vlen, c.vlen);
+		for (index_t j=0; j<a.vlen; ++j)
+		{
+			EXPECT_EQ(a[j], b[j]);
+			EXPECT_EQ(a[j], c[j]);
+		}
+	}
+
+	SG_UNREF(f);
+	SG_UNREF(packed);
+	SG_UNREF(packed_clone);
+	SG_UNREF(packed_loaded);
+}
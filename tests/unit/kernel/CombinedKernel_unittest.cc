@@ -236,6 +236,56 @@ TEST(CombinedKernelTest,serialization)
 	SG_UNREF(combined);
 }
 
+TEST(CombinedKernelTest,subkernel_cache)
+{
+	const index_t dim=2;
+	const index_t num_vec=20;
+
+	SGMatrix<float64_t> data(dim, num_vec);
+	for (index_t i=0; i<dim*num_vec; i++)
+		data.matrix[i]=CMath::randn_double();
+
+	CDenseFeatures<float64_t>* feats=new CDenseFeatures<float64_t>(data);
+
+	CCombinedKernel* combined=new CCombinedKernel();
+	combined->append_kernel(new CGaussianKernel(10, 0.5));
+	combined->append_kernel(new CGaussianKernel(10, 2));
+	combined->append_kernel(new CGaussianKernel(10, 8));
+
+	SGVector<float64_t> weights(3);
+	weights[0]=0.2;
+	weights[1]=0.3;
+	weights[2]=0.5;
+	combined->set_subkernel_weights(weights);
+
+	combined->init(feats, feats);
+	SGMatrix<float64_t> expected=combined->get_kernel_matrix();
+
+	combined->set_subkernel_cache_size(1);
+	EXPECT_EQ(combined->get_subkernel_cache_size(), 1);
+	SGMatrix<float64_t> cached=combined->get_kernel_matrix();
+
+	for (index_t i=0; i<num_vec*num_vec; i++)
+		EXPECT_NEAR(cached.matrix[i], expected.matrix[i], 1E-15);
+
+	// changing the combination weights must not invalidate the cache
+	weights[0]=1.0;
+	weights[1]=0.0;
+	weights[2]=0.0;
+	combined->set_subkernel_weights(weights);
+
+	CKernel* k0=combined->get_kernel(0);
+	SGMatrix<float64_t> k0_matrix=k0->get_kernel_matrix();
+	SG_UNREF(k0);
+
+	cached=combined->get_kernel_matrix();
+	for (index_t i=0; i<num_vec*num_vec; i++)
+		EXPECT_NEAR(cached.matrix[i], k0_matrix.matrix[i], 1E-15);
+
+	combined->set_subkernel_cache_size(0);
+	SG_UNREF(combined);
+}
+
 TEST(CombinedKernelTest,combination)
 {
 	CList* kernel_list = 0;
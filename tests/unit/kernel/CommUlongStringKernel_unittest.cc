@@ -66,3 +66,71 @@ TEST(CommUlongStringKernel, kernel_matrix)
 	SG_UNREF(alphabet);
 	SG_UNREF(h_feats);
 }
+
+TEST(CommUlongStringKernel, compute_optimized_and_kernel_row)
+{
+	const index_t num_strings=12;
+	const index_t min_len=20;
+	const index_t max_len=60;
+	const char* acgt="ACGT";
+
+	SGStringList<char> list(num_strings, max_len);
+	for (index_t i=0; i<num_strings; i++)
+	{
+		index_t cur_len=CMath::random(min_len, max_len);
+		SGString<char> str(cur_len);
+		for (index_t l=0; l<cur_len; l++)
+			str.string[l]=acgt[CMath::random(0, 3)];
+		list.strings[i]=str;
+	}
+
+	CStringFeatures<char>* s_feats=new CStringFeatures<char>(list, DNA);
+	CAlphabet* alphabet=s_feats->get_alphabet();
+	CStringFeatures<uint64_t>* l_feats=new CStringFeatures<uint64_t>(alphabet);
+	l_feats->obtain_from_char(s_feats, 2, 3, 0, false);
+	CSortUlongString* preproc=new CSortUlongString();
+	preproc->init(l_feats);
+	l_feats->add_preprocessor(preproc);
+	l_feats->apply_preprocessor();
+	SG_REF(l_feats);
+
+	for (index_t s=0; s<2; s++)
+	{
+		bool use_sign=s==1;
+		CCommUlongStringKernel* kernel=new CCommUlongStringKernel(l_feats, l_feats, use_sign);
+		SGMatrix<float64_t> kernel_matrix=kernel->get_kernel_matrix();
+
+		for (index_t i=0; i<num_strings; i++)
+		{
+			SGVector<float64_t> row=kernel->get_kernel_row(i);
+			ASSERT_EQ(row.vlen, num_strings);
+			for (index_t j=0; j<num_strings; j++)
+				EXPECT_NEAR(row[j], kernel_matrix(i,j), 1E-12);
+		}
+
+		SGVector<int32_t> idx(5);
+		SGVector<float64_t> weights(5);
+		for (index_t i=0; i<idx.vlen; i++)
+		{
+			idx[i]=2*i+1;
+			weights[i]=CMath::random(-1.0, 1.0);
+		}
+
+		kernel->init_optimization(idx.vlen, idx.vector, weights.vector);
+		for (index_t j=0; j<num_strings; j++)
+		{
+			float64_t expected=0;
+			for (index_t i=0; i<idx.vlen; i++)
+				expected+=weights[i]*kernel_matrix(idx[i], j);
+
+			EXPECT_NEAR(kernel->compute_optimized(j), expected, 1E-10);
+		}
+		kernel->delete_optimization();
+
+		SG_UNREF(kernel);
+	}
+
+	SG_UNREF(l_feats);
+	SG_UNREF(alphabet);
+	SG_UNREF(s_feats);
+}
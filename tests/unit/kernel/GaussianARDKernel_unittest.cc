@@ -729,3 +729,66 @@ TEST(GaussianARDKernel,get_parameter_gradient_diagonal)
 	SG_UNREF(features_train)
 	SG_UNREF(latent_features_train)
 }
+
+TEST(GaussianARDKernel,get_parameter_gradient_trace_product)
+{
+	index_t n=6;
+	index_t dim=3;
+	index_t m=4;
+	float64_t rel_tolerance=1e-8;
+	float64_t abs_tolerance;
+
+	SGMatrix<float64_t> feat_train(dim, n);
+	SGMatrix<float64_t> lat_feat_train(dim, m);
+	for (index_t i=0; i<dim*n; i++)
+		feat_train[i]=std::sin(0.7*i)*3.0;
+	for (index_t i=0; i<dim*m; i++)
+		lat_feat_train[i]=std::cos(1.3*i)*2.0;
+
+	SGMatrix<float64_t> W(n, m);
+	for (index_t i=0; i<n*m; i++)
+		W[i]=0.1*i-1.0;
+
+	CDenseFeatures<float64_t>* features_train=new CDenseFeatures<float64_t>(feat_train);
+	CDenseFeatures<float64_t>* latent_features_train=new CDenseFeatures<float64_t>(lat_feat_train);
+	SG_REF(features_train)
+	SG_REF(latent_features_train)
+
+	SGVector<float64_t> ard_weights(dim);
+	ard_weights[0]=1.0/6.0;
+	ard_weights[1]=1.0/3.0;
+	ard_weights[2]=0.5;
+
+	for (index_t type=0; type<2; type++)
+	{
+		CGaussianARDKernel* kernel=new CGaussianARDKernel(10);
+		if (type==0)
+			kernel->set_scalar_weights(0.4);
+		else
+			kernel->set_vector_weights(ard_weights);
+		kernel->init(features_train, latent_features_train);
+
+		TParameter* param=kernel->m_gradient_parameters->get_parameter("log_weights");
+		SGVector<float64_t> fused=kernel->get_parameter_gradient_trace_product(
+			param, W);
+		EXPECT_EQ(fused.vlen, type==0 ? 1 : dim);
+
+		// reference: reduce the full derivative matrices
+		for (index_t i=0; i<fused.vlen; i++)
+		{
+			SGMatrix<float64_t> dK=fused.vlen==1 ?
+				kernel->get_parameter_gradient(param) :
+				kernel->get_parameter_gradient(param, i);
+			float64_t expected=0.0;
+			for (index_t k=0; k<n*m; k++)
+				expected+=W[k]*dK[k];
+			abs_tolerance=CMath::get_abs_tolerance(expected, rel_tolerance);
+			EXPECT_NEAR(fused[i], expected, abs_tolerance);
+		}
+
+		SG_UNREF(kernel);
+	}
+
+	SG_UNREF(features_train)
+	SG_UNREF(latent_features_train)
+}
@@ -0,0 +1,94 @@
+/*
+ * This software is distributed under BSD 3-clause license (see LICENSE file).
+ */
+
+#include <shogun/lib/common.h>
+#include <shogun/mathematics/Math.h>
+#include <shogun/lib/SGString.h>
+#include <shogun/lib/SGStringList.h>
+#include <shogun/features/StringFeatures.h>
+#include <shogun/kernel/string/LocalAlignmentStringKernel.h>
+#include <shogun/kernel/normalizer/IdentityKernelNormalizer.h>
+#include <gtest/gtest.h>
+#include <string.h>
+
+using namespace shogun;
+
+namespace
+{
+CStringFeatures<char>* create_features(const char** seqs, index_t num_seqs)
+{
+	index_t max_len=0;
+	for (index_t i=0; i<num_seqs; i++)
+		max_len=CMath::max(max_len, (index_t)strlen(seqs[i]));
+
+	SGStringList<char> list(num_seqs, max_len);
+	for (index_t i=0; i<num_seqs; i++)
+	{
+		index_t len=strlen(seqs[i]);
+		SGString<char> str(len);
+		for (index_t l=0; l<len; l++)
+			str.string[l]=seqs[i][l];
+		list.strings[i]=str;
+	}
+
+	return new CStringFeatures<char>(list, PROTEIN);
+}
+}
+
+TEST(LocalAlignmentStringKernel, kernel_matrix)
+{
+	const index_t num_seqs=4;
+	const char* seqs[]={"ACDEFGHIKLMNPQRSTVWY", "MKTAYIAKQRQISFVKSHFSRQ",
+		"GGHHACDWWKLT", "WYVLLPQACDEK"};
+	CStringFeatures<char>* feats=create_features(seqs, num_seqs);
+
+	CLocalAlignmentStringKernel* kernel=
+		new CLocalAlignmentStringKernel(feats, feats);
+	SG_REF(kernel);
+	SGMatrix<float64_t> kernel_matrix=kernel->get_kernel_matrix();
+
+	// values computed with the implementation before the buffers were reused
+	const float64_t expected[num_seqs][num_seqs]={
+		{1, 0.7645715651467051, 0.68140018268227842, 0.70157126641396939},
+		{0.76461814276261419, 1, 0.67335252660603184, 0.72848112484509753},
+		{0.68122922002040276, 0.67312800092193514, 1, 0.67352583412504141},
+		{0.70139276469238154, 0.72836391147022306, 0.67359753920692422, 1}};
+
+	for (index_t i=0; i<num_seqs; i++)
+	{
+		for (index_t j=0; j<num_seqs; j++)
+			EXPECT_NEAR(kernel_matrix(i, j), expected[i][j], 1E-10);
+	}
+
+	for (index_t i=0; i<num_seqs; i++)
+	{
+		SGVector<float64_t> row=kernel->get_kernel_row(i);
+		ASSERT_EQ(row.vlen, num_seqs);
+		for (index_t j=0; j<num_seqs; j++)
+			EXPECT_EQ(row[j], kernel_matrix(i, j));
+	}
+
+	SG_UNREF(kernel);
+}
+
+TEST(LocalAlignmentStringKernel, get_kernel_row_empty_chain)
+{
+	const char* seqs[]={"ACDEFGHIK", "MKTAYIAKQR"};
+	CStringFeatures<char>* lhs=create_features(seqs, 2);
+	SGStringList<char> list(2, 5);
+	list.strings[0]=SGString<char>(5);
+	for (index_t l=0; l<5; l++)
+		list.strings[0].string[l]='A';
+	list.strings[1]=SGString<char>(0);
+	CStringFeatures<char>* rhs=new CStringFeatures<char>(list, PROTEIN);
+
+	CLocalAlignmentStringKernel* kernel=new CLocalAlignmentStringKernel();
+	SG_REF(kernel);
+	kernel->set_normalizer(new CIdentityKernelNormalizer());
+	kernel->init(lhs, rhs);
+
+	EXPECT_THROW(kernel->get_kernel_row(0), ShogunException);
+
+	SG_UNREF(kernel);
+}
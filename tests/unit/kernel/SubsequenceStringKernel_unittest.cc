@@ -82,3 +82,34 @@ TEST(SubsequenceStringKernel, psd_random_feat)
 	SG_UNREF(kernel);
 }
 
+
+TEST(SubsequenceStringKernel, get_kernel_row)
+{
+	const index_t num_strings=8;
+	const index_t max_len=15;
+	const index_t min_len=5;
+
+	SGStringList<char> list(num_strings, max_len);
+	for (index_t i=0; i<num_strings; ++i)
+	{
+		index_t cur_len=CMath::random(min_len, max_len);
+		SGString<char> str(cur_len);
+		for (index_t l=0; l<cur_len; ++l)
+			str.string[l]=char(CMath::random('A','D'));
+		list.strings[i]=str;
+	}
+
+	CStringFeatures<char>* s_feats=new CStringFeatures<char>(list, ALPHANUM);
+	CSubsequenceStringKernel* kernel=new CSubsequenceStringKernel(s_feats, s_feats, 3, 0.5);
+
+	SGMatrix<float64_t> kernel_matrix=kernel->get_kernel_matrix();
+	for (index_t i=0; i<num_strings; ++i)
+	{
+		SGVector<float64_t> row=kernel->get_kernel_row(i);
+		ASSERT_EQ(row.vlen, num_strings);
+		for (index_t j=0; j<num_strings; ++j)
+			EXPECT_NEAR(row[j], kernel_matrix(i,j), 1E-12);
+	}
+
+	SG_UNREF(kernel);
+}
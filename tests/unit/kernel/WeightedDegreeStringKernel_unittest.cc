@@ -0,0 +1,187 @@
+#include <shogun/kernel/string/WeightedDegreeStringKernel.h>
+#include <shogun/features/StringFeatures.h>
+#include <shogun/lib/SGStringList.h>
+#include <gtest/gtest.h>
+
+using namespace shogun;
+
+static SGStringList<char> generate_dna(int32_t num_vec, int32_t len, uint32_t seed)
+{
+	const char acgt[]="ACGT";
+	SGStringList<char> list(num_vec, len);
+	uint32_t state=seed;
+	for (int32_t i=0; i<num_vec; i++)
+	{
+		list.strings[i]=SGString<char>(len);
+		for (int32_t j=0; j<len; j++)
+		{
+			state=state*1664525u+1013904223u;
+			list.strings[i].string[j]=acgt[(state>>16) & 3];
+		}
+	}
+	return list;
+}
+
+TEST(WeightedDegreeStringKernel, flat_tables_match_tries)
+{
+	const int32_t num_sv=20;
+	const int32_t num_test=15;
+	const int32_t len=30;
+
+	SGStringList<char> train_list=generate_dna(num_sv, len, 17);
+	SGStringList<char> test_list=generate_dna(num_test, len, 4711);
+	// share some k-mers between train and test
+	for (int32_t i=0; i<num_test; i+=3)
+		for (int32_t j=0; j<len/2; j++)
+			test_list.strings[i].string[j]=train_list.strings[i].string[j];
+
+	CStringFeatures<char>* train=new CStringFeatures<char>(train_list, DNA);
+	CStringFeatures<char>* test=new CStringFeatures<char>(test_list, DNA);
+
+	SGVector<int32_t> idx(num_sv);
+	SGVector<float64_t> alphas(num_sv);
+	for (int32_t i=0; i<num_sv; i++)
+	{
+		idx[i]=i;
+		alphas[i]=(i%2 ? 1.0 : -0.5)*(i+1);
+	}
+
+	CWeightedDegreeStringKernel* kernel=new CWeightedDegreeStringKernel(train, test, 8);
+	SG_REF(kernel);
+
+	SGVector<float64_t> expected(num_test);
+	expected.zero();
+	for (int32_t j=0; j<num_test; j++)
+		for (int32_t i=0; i<num_sv; i++)
+			expected[j]+=alphas[i]*kernel->kernel(i, j);
+
+	kernel->init_optimization(num_sv, idx.vector, alphas.vector);
+	SGVector<float64_t> by_tree(num_test);
+	for (int32_t j=0; j<num_test; j++)
+		by_tree[j]=kernel->compute_optimized(j);
+	kernel->delete_optimization();
+
+	kernel->set_use_flat_tables(true);
+	kernel->init_optimization(num_sv, idx.vector, alphas.vector);
+	for (int32_t j=0; j<num_test; j++)
+	{
+		EXPECT_NEAR(kernel->compute_optimized(j), expected[j], 1e-10);
+		EXPECT_NEAR(kernel->compute_optimized(j), by_tree[j], 1e-5);
+	}
+	kernel->delete_optimization();
+
+	SGVector<int32_t> test_idx(num_test);
+	test_idx.range_fill();
+	SGVector<float64_t> batch(num_test);
+	batch.zero();
+	kernel->compute_batch(num_test, test_idx.vector, batch.vector,
+			num_sv, idx.vector, alphas.vector);
+	for (int32_t j=0; j<num_test; j++)
+		EXPECT_NEAR(batch[j], expected[j], 1e-10);
+
+	SG_UNREF(kernel);
+}
+
+TEST(WeightedDegreeStringKernel, flat_tables_position_weights)
+{
+	const int32_t num_sv=10;
+	const int32_t num_test=8;
+	const int32_t len=24;
+
+	SGStringList<char> train_list=generate_dna(num_sv, len, 3);
+	SGStringList<char> test_list=generate_dna(num_test, len, 5);
+	for (int32_t i=0; i<num_test; i+=2)
+		for (int32_t j=0; j<len; j+=2)
+			test_list.strings[i].string[j]=train_list.strings[i].string[j];
+
+	CStringFeatures<char>* train=new CStringFeatures<char>(train_list, DNA);
+	CStringFeatures<char>* test=new CStringFeatures<char>(test_list, DNA);
+
+	SGVector<int32_t> idx(num_sv);
+	SGVector<float64_t> alphas(num_sv);
+	for (int32_t i=0; i<num_sv; i++)
+	{
+		idx[i]=i;
+		alphas[i]=(i%3 ? 0.5 : -1.0)*(i+1);
+	}
+
+	CWeightedDegreeStringKernel* kernel=new CWeightedDegreeStringKernel(train, test, 6);
+	SG_REF(kernel);
+	kernel->set_use_block_computation(false);
+
+	SGVector<float64_t> pws(len);
+	for (int32_t i=0; i<len; i++)
+		pws[i]=(i%5==0) ? 0.0 : 1.0/(i+1);
+	kernel->set_position_weights(pws.vector, len);
+
+	SGVector<float64_t> expected(num_test);
+	expected.zero();
+	for (int32_t j=0; j<num_test; j++)
+		for (int32_t i=0; i<num_sv; i++)
+			expected[j]+=alphas[i]*kernel->kernel(i, j);
+
+	kernel->init_optimization(num_sv, idx.vector, alphas.vector);
+	for (int32_t j=0; j<num_test; j++)
+		EXPECT_NEAR(kernel->compute_optimized(j), expected[j], 1e-5);
+	kernel->delete_optimization();
+
+	kernel->set_use_flat_tables(true);
+	kernel->init_optimization(num_sv, idx.vector, alphas.vector);
+	for (int32_t j=0; j<num_test; j++)
+		EXPECT_NEAR(kernel->compute_optimized(j), expected[j], 1e-10);
+	kernel->delete_optimization();
+
+	SG_UNREF(kernel);
+}
+
+TEST(WeightedDegreeStringKernel, flat_tables_large_degree_uses_tries)
+{
+	const int32_t num_sv=6;
+	const int32_t num_test=4;
+	const int32_t len=40;
+
+	SGStringList<char> train_list=generate_dna(num_sv, len, 11);
+	SGStringList<char> test_list=generate_dna(num_test, len, 13);
+	// long shared stretches so that k-mers beyond degree 31 match
+	for (int32_t i=0; i<num_test; i++)
+		for (int32_t j=0; j<36; j++)
+			test_list.strings[i].string[j]=train_list.strings[i].string[j];
+
+	CStringFeatures<char>* train=new CStringFeatures<char>(train_list, DNA);
+	CStringFeatures<char>* test=new CStringFeatures<char>(test_list, DNA);
+
+	SGVector<int32_t> idx(num_sv);
+	SGVector<float64_t> alphas(num_sv);
+	for (int32_t i=0; i<num_sv; i++)
+	{
+		idx[i]=i;
+		alphas[i]=i%2 ? 1.0 : -2.0;
+	}
+
+	CWeightedDegreeStringKernel* kernel=new CWeightedDegreeStringKernel(train, test, 33);
+	SG_REF(kernel);
+
+	SGVector<float64_t> expected(num_test);
+	expected.zero();
+	for (int32_t j=0; j<num_test; j++)
+		for (int32_t i=0; i<num_sv; i++)
+			expected[j]+=alphas[i]*kernel->kernel(i, j);
+
+	// k-mers longer than 31 do not fit the packed codes, tries are used
+	kernel->set_use_flat_tables(true);
+	kernel->init_optimization(num_sv, idx.vector, alphas.vector);
+	for (int32_t j=0; j<num_test; j++)
+		EXPECT_NEAR(kernel->compute_optimized(j), expected[j], 1e-5);
+	kernel->delete_optimization();
+
+	SGVector<int32_t> test_idx(num_test);
+	test_idx.range_fill();
+	SGVector<float64_t> batch(num_test);
+	batch.zero();
+	kernel->compute_batch(num_test, test_idx.vector, batch.vector,
+			num_sv, idx.vector, alphas.vector);
+	for (int32_t j=0; j<num_test; j++)
+		EXPECT_NEAR(batch[j], expected[j], 1e-5);
+
+	SG_UNREF(kernel);
+}
@@ -0,0 +1,232 @@
+/*
+ * This software is distributed under BSD 3-clause license (see LICENSE file).
+ */
+
+#include <shogun/lib/config.h>
+#include <shogun/labels/RegressionLabels.h>
+#include <shogun/features/DenseFeatures.h>
+#include <shogun/kernel/GaussianKernel.h>
+#include <shogun/machine/gp/SVGPInferenceMethod.h>
+#include <shogun/machine/gp/ConstMean.h>
+#include <shogun/machine/gp/GaussianLikelihood.h>
+#include <shogun/machine/gp/GaussianARDSparseKernel.h>
+#include <shogun/optimization/SGDMinimizer.h>
+#include <shogun/optimization/AdamUpdater.h>
+#include <shogun/mathematics/Math.h>
+#include <gtest/gtest.h>
+
+using namespace shogun;
+
+static CSVGPInferenceMethod* create_svgp_inference(int32_t batch_size,
+	int32_t num_passes)
+{
+	index_t n=6;
+	index_t dim=2;
+	index_t m=3;
+
+	SGMatrix<float64_t> feat_train(dim, n);
+	SGMatrix<float64_t> lat_feat_train(dim, m);
+	SGVector<float64_t> lab_train(n);
+
+	feat_train(0,0)=-0.81263;
+	feat_train(0,1)=-0.99976;
+	feat_train(0,2)=1.17037;
+	feat_train(0,3)=1.51752;
+	feat_train(0,4)=1.57765;
+	feat_train(0,5)=3.89440;
+
+	feat_train(1,0)=0.5;
+	feat_train(1,1)=0.4576;
+	feat_train(1,2)=5.17637;
+	feat_train(1,3)=2.56752;
+	feat_train(1,4)=4.57765;
+	feat_train(1,5)=2.89440;
+
+	lat_feat_train(0,0)=1.00000;
+	lat_feat_train(0,1)=3.00000;
+	lat_feat_train(0,2)=4.00000;
+
+	lat_feat_train(1,0)=3.00000;
+	lat_feat_train(1,1)=2.00000;
+	lat_feat_train(1,2)=-5.00000;
+
+	lab_train[0]=0.46;
+	lab_train[1]=0.7;
+	lab_train[2]=-1.16;
+	lab_train[3]=1.5;
+	lab_train[4]=3.5;
+	lab_train[5]=-5.0;
+
+	CDenseFeatures<float64_t>* features_train=new CDenseFeatures<float64_t>(feat_train);
+	CDenseFeatures<float64_t>* inducing_features_train=new CDenseFeatures<float64_t>(lat_feat_train);
+	CRegressionLabels* labels_train=new CRegressionLabels(lab_train);
+
+	float64_t ell=log(2.0);
+	CKernel* kernel=new CGaussianKernel(10,2.0*exp(ell*2.0));
+	CConstMean* mean=new CConstMean(0.0);
+	CGaussianLikelihood* lik=new CGaussianLikelihood(0.5);
+
+	CSVGPInferenceMethod* inf=new CSVGPInferenceMethod(kernel, features_train,
+		mean, labels_train, lik, inducing_features_train);
+	inf->set_inducing_noise(1e-6);
+	inf->set_scale(1.5);
+	inf->enable_optimizing_inducing_features(false);
+	inf->set_batch_size(batch_size);
+
+	SGDMinimizer* opt=new SGDMinimizer();
+	AdamUpdater* updater=new AdamUpdater();
+	updater->set_learning_rate(0.01);
+	opt->set_gradient_updater(updater);
+	opt->set_number_passes(num_passes);
+	inf->register_minimizer(opt);
+
+	SG_REF(inf);
+	return inf;
+}
+
+/* leaves q(u) as it is, so that the negative evidence lower bound only
+ * changes with the hyperparameters */
+class FixedVariablesMinimizer: public SGDMinimizer
+{
+public:
+	virtual float64_t minimize()
+	{
+		init_minimization();
+		return m_fun->get_cost();
+	}
+};
+
+static float64_t* get_parameter_data(const TParameter* param)
+{
+	if (param->m_datatype.m_ctype==CT_SCALAR)
+		return (float64_t*) param->m_parameter;
+	return *(float64_t**) param->m_parameter;
+}
+
+TEST(SVGPInferenceMethod,get_negative_log_marginal_likelihood_full_batch)
+{
+	CSVGPInferenceMethod* inf=create_svgp_inference(6, 2000);
+
+	float64_t nlz=inf->get_negative_log_marginal_likelihood();
+
+	// at the optimum of q(u) the evidence lower bound equals the collapsed
+	// bound of the VarDTC inference method on the same data, see
+	// VarDTCInferenceMethod_unittest.cc
+	EXPECT_NEAR(nlz, 58.616164107936129, 1E-4);
+
+	SG_UNREF(inf);
+}
+
+TEST(SVGPInferenceMethod,get_negative_log_marginal_likelihood_mini_batch)
+{
+	CMath::init_random(17);
+	CSVGPInferenceMethod* inf=create_svgp_inference(2, 1500);
+
+	float64_t nlz=inf->get_negative_log_marginal_likelihood();
+
+	EXPECT_NEAR(nlz, 58.616164107936129, 1E-2);
+
+	SG_UNREF(inf);
+}
+
+TEST(SVGPInferenceMethod,get_posterior_mean)
+{
+	CSVGPInferenceMethod* inf=create_svgp_inference(6, 2000);
+
+	SGVector<float64_t> mu=inf->get_posterior_mean();
+
+	// optimal mean of q(u) for the Gaussian likelihood:
+	// Kuu*inv(Kuu+Kuf*Kfu/sigma^2)*Kuf*y/sigma^2
+	EXPECT_EQ(mu.vlen, 3);
+	EXPECT_NEAR(mu[0], 1.8524680277, 1E-4);
+	EXPECT_NEAR(mu[1], -3.5574175141, 1E-4);
+	EXPECT_NEAR(mu[2], -0.0069889838, 1E-4);
+
+	SG_UNREF(inf);
+}
+
+TEST(SVGPInferenceMethod,get_marginal_likelihood_derivatives)
+{
+	CSVGPInferenceMethod* inf=create_svgp_inference(6, 200);
+	CGaussianARDSparseKernel* kernel=new CGaussianARDSparseKernel(10);
+	kernel->set_scalar_weights(1.0/2.0);
+	inf->set_kernel(kernel);
+	inf->enable_optimizing_inducing_features(true);
+
+	// fit q(u) away from the prior, then keep it
+	inf->get_negative_log_marginal_likelihood();
+	FixedVariablesMinimizer* opt=new FixedVariablesMinimizer();
+	opt->set_gradient_updater(new AdamUpdater());
+	opt->set_number_passes(1);
+	inf->register_minimizer(opt);
+
+	CMap<TParameter*, CSGObject*>* parameter_dictionary=new CMap<TParameter*, CSGObject*>();
+	inf->build_gradient_parameter_dictionary(parameter_dictionary);
+	CMap<TParameter*, SGVector<float64_t> >* gradient=
+		inf->get_negative_log_marginal_likelihood_derivatives(parameter_dictionary);
+
+	// log_scale, log_inducing_noise, inducing_features, log_sigma, mean and
+	// log_weights
+	EXPECT_EQ(parameter_dictionary->get_num_elements(), 6);
+
+	// compare with central differences of the negative evidence lower bound
+	const float64_t h=1E-6;
+	for (index_t i=0; i<parameter_dictionary->get_num_elements(); i++)
+	{
+		TParameter* param=parameter_dictionary->get_node_ptr(i)->key;
+		SGVector<float64_t> deriv=gradient->get_element(param);
+		float64_t* data=get_parameter_data(param);
+		ASSERT_EQ(deriv.vlen, param->m_datatype.get_num_elements());
+
+		for (index_t k=0; k<deriv.vlen; k++)
+		{
+			float64_t value=data[k];
+			data[k]=value+h;
+			float64_t nlz_plus=inf->get_negative_log_marginal_likelihood();
+			data[k]=value-h;
+			float64_t nlz_minus=inf->get_negative_log_marginal_likelihood();
+			data[k]=value;
+
+			EXPECT_NEAR(deriv[k], (nlz_plus-nlz_minus)/(2.0*h), 1E-4)
+				<< "derivative wrt " << param->m_name << "[" << k << "]";
+		}
+	}
+
+	SG_UNREF(gradient);
+	SG_UNREF(parameter_dictionary);
+	SG_UNREF(inf);
+}
+
+TEST(SVGPInferenceMethod,learn_hyperparameters_mini_batch)
+{
+	CMath::init_random(17);
+	CSVGPInferenceMethod* inf=create_svgp_inference(2, 1500);
+	CGaussianARDSparseKernel* kernel=new CGaussianARDSparseKernel(10);
+	kernel->set_scalar_weights(1.0/2.0);
+	inf->set_kernel(kernel);
+	inf->enable_optimizing_inducing_features(true);
+	inf->enable_optimizing_hyperparameters(true);
+
+	CDenseFeatures<float64_t>* inducing_features=
+		(CDenseFeatures<float64_t>*) inf->get_inducing_features();
+	SGMatrix<float64_t> initial_inducing=inducing_features->get_feature_matrix().clone();
+	SG_UNREF(inducing_features);
+
+	float64_t nlz=inf->get_negative_log_marginal_likelihood();
+
+	// with the initial hyperparameters the negative evidence lower bound is
+	// at least 58.616164107936129, its value at the optimum of q(u) (see the
+	// full batch test), the collapsed bound drops below 31 once sigma>=0.8
+	EXPECT_LT(nlz, 31.0);
+
+	CLikelihoodModel* lik=inf->get_model();
+	EXPECT_GT(((CGaussianLikelihood*) lik)->get_sigma(), 0.5);
+	SG_UNREF(lik);
+
+	inducing_features=(CDenseFeatures<float64_t>*) inf->get_inducing_features();
+	SGMatrix<float64_t> learned_inducing=inducing_features->get_feature_matrix();
+	EXPECT_FALSE(learned_inducing.equals(initial_inducing));
+	SG_UNREF(inducing_features);
+
+	SG_UNREF(inf);
+}
@@ -4,6 +4,7 @@
 #include <shogun/lib/ShogunException.h>
 #include <shogun/lib/config.h>
 #include <shogun/mathematics/Math.h>
+#include <shogun/mathematics/eigen3.h>
 #include <shogun/mathematics/linalg/LinalgNamespace.h>
 #include <shogun/mathematics/linalg/LinalgSpecialPurposes.h>
 
@@ -549,6 +550,40 @@ TEST(LinalgBackendEigen, eigensolver_symmetric)
 	}
 }
 
+TEST(LinalgBackendEigen, eigensolver_symmetric_randomized)
+{
+	const index_t n = 50;
+	const index_t k = 3;
+
+	// A = U diag(2^-i) U^T with a random orthogonal U
+	SGMatrix<float64_t> U(n, n);
+	for (index_t i = 0; i < n * n; ++i)
+		U[i] = CMath::randn_double();
+	SGMatrix<float64_t>::EigenMatrixXtMap U_eig = U;
+	Eigen::HouseholderQR<Eigen::MatrixXd> qr(U_eig);
+	Eigen::MatrixXd Q = qr.householderQ();
+	Eigen::VectorXd spectrum(n);
+	for (index_t i = 0; i < n; ++i)
+		spectrum[i] = std::pow(2.0, -i);
+
+	SGMatrix<float64_t> m(n, n);
+	SGMatrix<float64_t>::EigenMatrixXtMap m_eig = m;
+	m_eig = Q * spectrum.asDiagonal() * Q.transpose();
+
+	SGMatrix<float64_t> eigenvectors(n, k);
+	SGVector<float64_t> eigenvalues(k);
+	eigen_solver_symmetric_randomized(m, eigenvalues, eigenvectors, k);
+
+	for (index_t i = 0; i < k; ++i)
+	{
+		EXPECT_NEAR(eigenvalues[i], spectrum[k - i - 1], 1e-10);
+
+		auto s = CMath::sign(eigenvectors[i * n] * Q(0, k - i - 1));
+		for (index_t j = 0; j < n; ++j)
+			EXPECT_NEAR(eigenvectors[i * n + j], s * Q(j, k - i - 1), 1e-8);
+	}
+}
+
 TEST(LinalgBackendEigen, SGMatrix_elementwise_product)
 {
 	const auto m = 3;
@@ -0,0 +1,117 @@
+#include <shogun/base/Parallel.h>
+#include <shogun/base/init.h>
+#include <shogun/classifier/svm/LibLinear.h>
+#include <shogun/features/DenseFeatures.h>
+#include <shogun/labels/MulticlassLabels.h>
+#include <shogun/machine/LinearMulticlassMachine.h>
+#include <shogun/mathematics/Math.h>
+#include <shogun/multiclass/MulticlassOneVsOneStrategy.h>
+#include <shogun/multiclass/MulticlassOneVsRestStrategy.h>
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+using namespace shogun;
+
+static CMulticlassLabels* train_and_apply(CMulticlassStrategy* strategy,
+		LIBLINEAR_SOLVER_TYPE solver_type, int32_t num_threads,
+		SGMatrix<float64_t>& weights)
+{
+	index_t num_vec=30;
+	index_t num_class=4;
+	float64_t distance=5;
+
+	SGMatrix<float64_t> matrix(num_class, num_vec);
+	CMulticlassLabels* labels=new CMulticlassLabels(num_vec);
+	for (index_t i=0; i<num_vec; ++i)
+	{
+		index_t label=i%num_class;
+		for (index_t j=0; j<num_class; ++j)
+			matrix(j, i)=std::sin(1.0+i*num_class+j);
+
+		matrix(label, i)+=distance;
+		labels->set_label(i, label);
+	}
+	CDenseFeatures<float64_t>* features=new CDenseFeatures<float64_t>(matrix);
+
+	CLibLinear* svm=new CLibLinear(solver_type);
+	svm->set_epsilon(1e-6);
+	CLinearMulticlassMachine* machine=new CLinearMulticlassMachine(strategy,
+			features, svm, labels);
+	SG_REF(machine);
+
+	int32_t old_num_threads=get_global_parallel()->get_num_threads();
+	get_global_parallel()->set_num_threads(num_threads);
+	CMath::init_random(17);
+	machine->train();
+	CMulticlassLabels* pred=machine->apply_multiclass(features);
+	get_global_parallel()->set_num_threads(old_num_threads);
+
+	int32_t num_machines=machine->get_num_machines();
+	weights=SGMatrix<float64_t>(num_class, num_machines);
+	for (int32_t i=0; i<num_machines; ++i)
+	{
+		CLinearMachine* submachine=(CLinearMachine*)machine->get_machine(i);
+		SGVector<float64_t> w=submachine->get_w();
+		for (index_t j=0; j<num_class; ++j)
+			weights(j, i)=w[j];
+		SG_UNREF(submachine);
+	}
+
+	SG_UNREF(machine);
+	return pred;
+}
+
+static void check_parallel_matches_serial(CMulticlassStrategy* serial,
+		CMulticlassStrategy* parallel, LIBLINEAR_SOLVER_TYPE solver_type=L2R_LR)
+{
+	SGMatrix<float64_t> w_serial;
+	SGMatrix<float64_t> w_parallel;
+	CMulticlassLabels* pred_serial=train_and_apply(serial, solver_type, 1,
+			w_serial);
+	CMulticlassLabels* pred_parallel=train_and_apply(parallel, solver_type, 4,
+			w_parallel);
+
+	ASSERT_EQ(w_serial.num_cols, w_parallel.num_cols);
+	for (index_t i=0; i<w_serial.num_rows*w_serial.num_cols; ++i)
+		EXPECT_NEAR(w_serial[i], w_parallel[i], 1e-10);
+
+	ASSERT_EQ(pred_serial->get_num_labels(), pred_parallel->get_num_labels());
+	for (index_t i=0; i<pred_serial->get_num_labels(); ++i)
+	{
+		EXPECT_EQ(pred_serial->get_label(i), pred_parallel->get_label(i));
+		SGVector<float64_t> conf_serial=pred_serial->get_multiclass_confidences(i);
+		SGVector<float64_t> conf_parallel=pred_parallel->get_multiclass_confidences(i);
+		for (index_t j=0; j<conf_serial.vlen; ++j)
+			EXPECT_NEAR(conf_serial[j], conf_parallel[j], 1e-10);
+	}
+
+	SG_UNREF(pred_serial);
+	SG_UNREF(pred_parallel);
+}
+
+TEST(LinearMulticlassMachine,parallel_one_vs_rest)
+{
+	check_parallel_matches_serial(new CMulticlassOneVsRestStrategy(),
+			new CMulticlassOneVsRestStrategy());
+}
+
+TEST(LinearMulticlassMachine,parallel_one_vs_one)
+{
+	check_parallel_matches_serial(new CMulticlassOneVsOneStrategy(),
+			new CMulticlassOneVsOneStrategy());
+}
+
+TEST(LinearMulticlassMachine,parallel_one_vs_rest_random_solver)
+{
+	// the dual solver permutes examples randomly, seeded runs must not
+	// depend on the number of threads
+	check_parallel_matches_serial(new CMulticlassOneVsRestStrategy(),
+			new CMulticlassOneVsRestStrategy(), L2R_L2LOSS_SVC_DUAL);
+}
+
+TEST(LinearMulticlassMachine,parallel_one_vs_one_random_solver)
+{
+	check_parallel_matches_serial(new CMulticlassOneVsOneStrategy(),
+			new CMulticlassOneVsOneStrategy(), L2R_L2LOSS_SVC_DUAL);
+}
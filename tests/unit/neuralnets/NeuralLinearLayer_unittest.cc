@@ -33,6 +33,10 @@
 
 #include <shogun/neuralnets/NeuralLinearLayer.h>
 #include <shogun/neuralnets/NeuralInputLayer.h>
+#include <shogun/neuralnets/NeuralLogisticLayer.h>
+#include <shogun/neuralnets/NeuralRectifiedLinearLayer.h>
+#include <shogun/neuralnets/NeuralLeakyRectifiedLinearLayer.h>
+#include <shogun/neuralnets/NeuralSoftmaxLayer.h>
 #include <shogun/lib/SGVector.h>
 #include <shogun/lib/SGMatrix.h>
 #include <shogun/mathematics/Math.h>
@@ -40,6 +44,18 @@
 
 using namespace shogun;
 
+/** Layer deriving from CNeuralLinearLayer without implementing the inference
+ * pass
+ */
+class CNeuralCustomLinearLayer : public CNeuralLinearLayer
+{
+public:
+	CNeuralCustomLinearLayer(int32_t num_neurons)
+	: CNeuralLinearLayer(num_neurons) { }
+
+	virtual const char* get_name() const { return "NeuralCustomLinearLayer"; }
+};
+
 /** Compares the activations computed using the layer against manually computed
  * activations
  */
@@ -409,3 +425,24 @@ TEST(NeuralLinearLayer, compute_parameter_gradients_hidden)
 
 	SG_UNREF(layers);
 }
+
+/** Only the layers whose inference pass has been verified opt in, derived
+ * layers fall back to the regular forward propagation by default
+ */
+TEST(NeuralLinearLayer, supports_inference)
+{
+	CNeuralLayer* layers[]={new CNeuralLinearLayer(3),
+		new CNeuralLogisticLayer(3), new CNeuralRectifiedLinearLayer(3),
+		new CNeuralLeakyRectifiedLinearLayer(3), new CNeuralSoftmaxLayer(3)};
+	for (int32_t i=0; i<5; i++)
+	{
+		SG_REF(layers[i]);
+		EXPECT_TRUE(layers[i]->supports_inference());
+		SG_UNREF(layers[i]);
+	}
+
+	CNeuralCustomLinearLayer* custom=new CNeuralCustomLinearLayer(3);
+	SG_REF(custom);
+	EXPECT_FALSE(custom->supports_inference());
+	SG_UNREF(custom);
+}
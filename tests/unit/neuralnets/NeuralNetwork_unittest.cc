@@ -45,6 +45,8 @@
 #include <shogun/neuralnets/NeuralRectifiedLinearLayer.h>
 #include <shogun/neuralnets/NeuralConvolutionalLayer.h>
 #include <shogun/neuralnets/NeuralLayers.h>
+#include <shogun/optimization/SGDMinimizer.h>
+#include <shogun/optimization/AdamUpdater.h>
 #include <gtest/gtest.h>
 
 using namespace shogun;
@@ -465,3 +467,367 @@ TEST(NeuralNetwork, gradient_descent)
 	SG_UNREF(features);
 	SG_UNREF(predictions);
 }
+
+/** tests a neural network (trained using a stochastic minimizer with the Adam
+ * updater) on the binary XOR problem
+ */
+TEST(NeuralNetwork, stochastic_minimizer)
+{
+	CMath::init_random(100);
+
+	SGMatrix<float64_t> inputs_matrix(2,4);
+	SGVector<float64_t> targets_vector(4);
+	inputs_matrix(0,0) = -1.0;
+	inputs_matrix(1,0) = -1.0;
+	targets_vector[0] = -1.0;
+
+	inputs_matrix(0,1) = -1.0;
+	inputs_matrix(1,1) = 1.0;
+	targets_vector[1] = 1.0;
+
+	inputs_matrix(0,2) = 1.0;
+	inputs_matrix(1,2) = -1.0;
+	targets_vector[2] = 1.0;
+
+	inputs_matrix(0,3) = 1.0;
+	inputs_matrix(1,3) = 1.0;
+	targets_vector[3] = -1.0;
+
+	CDenseFeatures<float64_t>* features =
+		new CDenseFeatures<float64_t>(inputs_matrix);
+
+	CBinaryLabels* labels = new CBinaryLabels(targets_vector);
+
+	CDynamicObjectArray* layers = new CDynamicObjectArray();
+	layers->append_element(new CNeuralInputLayer(2));
+	layers->append_element(new CNeuralLogisticLayer(8));
+	layers->append_element(new CNeuralLogisticLayer(1));
+
+	CNeuralNetwork* network = new CNeuralNetwork(layers);
+	network->quick_connect();
+	network->initialize_neural_network(0.5);
+
+	SGDMinimizer* minimizer = new SGDMinimizer();
+	minimizer->set_gradient_updater(new AdamUpdater(0.05, 1e-8, 0.9, 0.999));
+	network->set_minimizer(minimizer);
+	EXPECT_EQ(network->get_optimization_method(), NNOM_STOCHASTIC_MINIMIZER);
+
+	network->set_max_num_epochs(1000);
+
+	network->set_labels(labels);
+	network->train(features);
+
+	CBinaryLabels* predictions = network->apply_binary(features);
+
+	for (int32_t i=0; i<4; i++)
+		EXPECT_EQ(predictions->get_label(i), labels->get_label(i));
+
+	SG_UNREF(network);
+	SG_UNREF(features);
+	SG_UNREF(predictions);
+}
+
+/** tests that computing the gradients over slices of the batch in parallel
+ * gives the same result as computing them serially
+ */
+TEST(NeuralNetwork, parallel_gradients)
+{
+	int32_t N = 200;
+	SGMatrix<float64_t> inputs_matrix(3,N);
+	SGVector<float64_t> targets_vector(N);
+
+	CMath::init_random(100);
+	for (int32_t i=0; i<N; i++)
+	{
+		inputs_matrix(0,i) = CMath::random(-1.0,1.0);
+		inputs_matrix(1,i) = CMath::random(-1.0,1.0);
+		inputs_matrix(2,i) = CMath::random(-1.0,1.0);
+		targets_vector[i] = inputs_matrix(0,i)*inputs_matrix(1,i) +
+			inputs_matrix(2,i);
+	}
+
+	CDenseFeatures<float64_t>* features =
+		new CDenseFeatures<float64_t>(inputs_matrix);
+	CRegressionLabels* labels = new CRegressionLabels(targets_vector);
+	SG_REF(labels);
+
+	SGVector<float64_t> params[2];
+	int32_t num_threads[2] = {1, 4};
+	int32_t old_num_threads = features->parallel->get_num_threads();
+
+	for (int32_t t=0; t<2; t++)
+	{
+		CDynamicObjectArray* layers = new CDynamicObjectArray();
+		layers->append_element(new CNeuralInputLayer(3));
+		layers->append_element(new CNeuralLogisticLayer(10));
+		layers->append_element(new CNeuralLinearLayer(1));
+
+		CMath::init_random(10);
+		CNeuralNetwork* network = new CNeuralNetwork(layers);
+		network->quick_connect();
+		network->initialize_neural_network();
+		network->parallel->set_num_threads(num_threads[t]);
+
+		network->set_optimization_method(NNOM_GRADIENT_DESCENT);
+		network->set_l2_coefficient(0.01);
+		network->set_max_num_epochs(20);
+		network->set_labels(labels);
+		network->train(features);
+
+		params[t] = network->get_parameters().clone();
+		SG_UNREF(network);
+	}
+	features->parallel->set_num_threads(old_num_threads);
+
+	for (int32_t i=0; i<params[0].vlen; i++)
+		EXPECT_NEAR(params[0][i], params[1][i], 1e-10);
+
+	SG_UNREF(labels);
+	SG_UNREF(features);
+}
+
+/** tests that training with dropout and input noise gives the same parameters
+ * for serial and parallel computation of the gradients
+ */
+TEST(NeuralNetwork, parallel_gradients_dropout)
+{
+	int32_t N = 200;
+	SGMatrix<float64_t> inputs_matrix(3,N);
+	SGVector<float64_t> targets_vector(N);
+
+	CMath::init_random(100);
+	for (int32_t i=0; i<N; i++)
+	{
+		inputs_matrix(0,i) = CMath::random(-1.0,1.0);
+		inputs_matrix(1,i) = CMath::random(-1.0,1.0);
+		inputs_matrix(2,i) = CMath::random(-1.0,1.0);
+		targets_vector[i] = inputs_matrix(0,i)*inputs_matrix(1,i) +
+			inputs_matrix(2,i);
+	}
+
+	CDenseFeatures<float64_t>* features =
+		new CDenseFeatures<float64_t>(inputs_matrix);
+	CRegressionLabels* labels = new CRegressionLabels(targets_vector);
+	SG_REF(labels);
+
+	SGVector<float64_t> params[2];
+	int32_t num_threads[2] = {1, 4};
+	int32_t old_num_threads = features->parallel->get_num_threads();
+
+	for (int32_t t=0; t<2; t++)
+	{
+		CDynamicObjectArray* layers = new CDynamicObjectArray();
+		CNeuralInputLayer* input = new CNeuralInputLayer(3);
+		input->gaussian_noise = 0.1;
+		layers->append_element(input);
+		layers->append_element(new CNeuralLogisticLayer(10));
+		layers->append_element(new CNeuralLinearLayer(1));
+
+		CMath::init_random(10);
+		CNeuralNetwork* network = new CNeuralNetwork(layers);
+		network->quick_connect();
+		network->initialize_neural_network();
+		network->parallel->set_num_threads(num_threads[t]);
+
+		network->set_optimization_method(NNOM_GRADIENT_DESCENT);
+		network->set_dropout_input(0.2);
+		network->set_dropout_hidden(0.5);
+		network->set_max_num_epochs(20);
+		network->set_labels(labels);
+		network->train(features);
+
+		params[t] = network->get_parameters().clone();
+		SG_UNREF(network);
+	}
+	features->parallel->set_num_threads(old_num_threads);
+
+	for (int32_t i=0; i<params[0].vlen; i++)
+		EXPECT_NEAR(params[0][i], params[1][i], 1e-10);
+
+	SG_UNREF(labels);
+	SG_UNREF(features);
+}
+
+/** tests that training in single precision gives nearly the same parameters
+ * as training in double precision
+ */
+TEST(NeuralNetwork, single_precision_training)
+{
+	int32_t N = 100;
+	SGMatrix<float64_t> inputs_matrix(4,N);
+	SGVector<float64_t> targets_vector(N);
+
+	CMath::init_random(100);
+	for (int32_t i=0; i<N; i++)
+	{
+		for (int32_t j=0; j<4; j++)
+			inputs_matrix(j,i) = CMath::random(-1.0,1.0);
+		targets_vector[i] = inputs_matrix(0,i)-inputs_matrix(3,i);
+	}
+
+	CDenseFeatures<float64_t>* features =
+		new CDenseFeatures<float64_t>(inputs_matrix);
+	CRegressionLabels* labels = new CRegressionLabels(targets_vector);
+	SG_REF(labels);
+
+	SGVector<float64_t> params[2];
+	for (int32_t t=0; t<2; t++)
+	{
+		CDynamicObjectArray* layers = new CDynamicObjectArray();
+		layers->append_element(new CNeuralInputLayer(4));
+		layers->append_element(new CNeuralRectifiedLinearLayer(8));
+		layers->append_element(new CNeuralLinearLayer(1));
+
+		CMath::init_random(10);
+		CNeuralNetwork* network = new CNeuralNetwork(layers);
+		network->quick_connect();
+		network->initialize_neural_network(0.5);
+		network->set_single_precision(t==1);
+
+		network->set_optimization_method(NNOM_GRADIENT_DESCENT);
+		network->set_max_num_epochs(10);
+		network->set_labels(labels);
+		network->train(features);
+
+		params[t] = network->get_parameters().clone();
+		SG_UNREF(network);
+	}
+
+	for (int32_t i=0; i<params[0].vlen; i++)
+		EXPECT_NEAR(params[0][i], params[1][i], 1e-4);
+
+	SG_UNREF(labels);
+	SG_UNREF(features);
+}
+
+/** tests that single precision computations give nearly the same outputs as
+ * double precision computations
+ */
+TEST(NeuralNetwork, single_precision)
+{
+	CMath::init_random(100);
+
+	int32_t N = 20;
+	SGMatrix<float64_t> inputs_matrix(4,N);
+	for (int32_t i=0; i<inputs_matrix.num_rows*N; i++)
+		inputs_matrix[i] = CMath::random(-1.0,1.0);
+
+	CDenseFeatures<float64_t>* features =
+		new CDenseFeatures<float64_t>(inputs_matrix);
+
+	CDynamicObjectArray* layers = new CDynamicObjectArray();
+	layers->append_element(new CNeuralInputLayer(4));
+	layers->append_element(new CNeuralRectifiedLinearLayer(8));
+	layers->append_element(new CNeuralSoftmaxLayer(3));
+
+	CNeuralNetwork* network = new CNeuralNetwork(layers);
+	network->quick_connect();
+	network->initialize_neural_network(0.5);
+
+	CDenseFeatures<float64_t>* outputs = network->transform(features);
+	SGMatrix<float64_t> outputs_double = outputs->get_feature_matrix();
+	SG_UNREF(outputs);
+
+	network->set_single_precision(true);
+	EXPECT_TRUE(network->get_single_precision());
+
+	outputs = network->transform(features);
+	SGMatrix<float64_t> outputs_single = outputs->get_feature_matrix();
+	SG_UNREF(outputs);
+
+	for (int32_t i=0; i<outputs_double.num_rows*N; i++)
+		EXPECT_NEAR(outputs_double[i], outputs_single[i], 1e-5);
+
+	SG_UNREF(network);
+	SG_UNREF(features);
+}
+
+/** Tests the inference forward pass used by transform() against outputs
+ * computed by hand, with inputs split over several inference batches and
+ * dropout on the hidden layer. Then checks that concurrent calls to
+ * transform() give the same outputs.
+ */
+TEST(NeuralNetwork, inference_forward_pass)
+{
+	CMath::init_random(100);
+
+	int32_t N = 20;
+	SGMatrix<float64_t> inputs_matrix(3,N);
+	for (int32_t i=0; i<inputs_matrix.num_rows*N; i++)
+		inputs_matrix[i] = CMath::random(-1.0,1.0);
+
+	CDenseFeatures<float64_t>* features =
+		new CDenseFeatures<float64_t>(inputs_matrix);
+
+	CDynamicObjectArray* layers = new CDynamicObjectArray();
+	layers->append_element(new CNeuralInputLayer(3));
+	layers->append_element(new CNeuralLogisticLayer(4));
+	layers->append_element(new CNeuralLinearLayer(2));
+
+	CNeuralNetwork* network = new CNeuralNetwork(layers);
+	network->quick_connect();
+	network->initialize_neural_network(0.5);
+	network->set_max_inference_batch_size(7);
+
+	CNeuralLayer* hidden = (CNeuralLayer*)layers->element(1);
+	hidden->dropout_prop = 0.5;
+	SG_UNREF(hidden);
+
+	SGVector<float64_t>* params_1 = network->get_layer_parameters(1);
+	SGVector<float64_t>* params_2 = network->get_layer_parameters(2);
+	float64_t* b1 = params_1->vector;
+	float64_t* W1 = b1+4;
+	float64_t* b2 = params_2->vector;
+	float64_t* W2 = b2+2;
+
+	SGMatrix<float64_t> expected(2,N);
+	for (int32_t j=0; j<N; j++)
+	{
+		float64_t h[4];
+		for (int32_t i=0; i<4; i++)
+		{
+			float64_t z = b1[i];
+			for (int32_t k=0; k<3; k++)
+				z += W1[i+4*k]*inputs_matrix(k,j);
+			h[i] = 0.5/(1.0+std::exp(-z));
+		}
+
+		for (int32_t i=0; i<2; i++)
+		{
+			expected(i,j) = b2[i];
+			for (int32_t k=0; k<4; k++)
+				expected(i,j) += W2[i+2*k]*h[k];
+		}
+	}
+	delete params_1;
+	delete params_2;
+
+	CDenseFeatures<float64_t>* outputs = network->transform(features);
+	SGMatrix<float64_t> outputs_matrix = outputs->get_feature_matrix();
+	SG_UNREF(outputs);
+
+	EXPECT_EQ(2, outputs_matrix.num_rows);
+	EXPECT_EQ(N, outputs_matrix.num_cols);
+	for (int32_t i=0; i<2*N; i++)
+		EXPECT_NEAR(expected[i], outputs_matrix[i], 1e-12);
+
+	int32_t num_calls = 8;
+	SGVector<float64_t> max_diffs(num_calls);
+	#pragma omp parallel for num_threads(4)
+	for (int32_t t=0; t<num_calls; t++)
+	{
+		CDenseFeatures<float64_t>* o = network->transform(features);
+		SGMatrix<float64_t> m = o->get_feature_matrix();
+		max_diffs[t] = 0;
+		for (int32_t i=0; i<2*N; i++)
+			max_diffs[t] = CMath::max(max_diffs[t],
+				CMath::abs(m[i]-outputs_matrix[i]));
+		SG_UNREF(o);
+	}
+
+	for (int32_t t=0; t<num_calls; t++)
+		EXPECT_NEAR(0.0, max_diffs[t], 1e-12);
+
+	SG_UNREF(network);
+	SG_UNREF(features);
+}
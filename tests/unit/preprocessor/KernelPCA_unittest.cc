@@ -94,3 +94,52 @@ TEST(KernelPCA, apply_to_feature_vector)
 	SG_UNREF(kpca);
 	SG_UNREF(kernel);
 }
+
+TEST(KernelPCA, apply_to_feature_matrix_approximate_methods)
+{
+	index_t num_test_vectors = 2;
+
+	SGMatrix<float64_t> train_matrix(num_features, num_vectors);
+	SGMatrix<float64_t> test_matrix(num_features, num_test_vectors);
+	load_data(train_matrix, test_matrix);
+
+	CDenseFeatures<float64_t>* train_feats =
+	    new CDenseFeatures<float64_t>(train_matrix);
+
+	CDenseFeatures<float64_t>* test_feats =
+	    new CDenseFeatures<float64_t>(test_matrix);
+
+	SG_REF(train_feats)
+	SG_REF(test_feats)
+
+	CGaussianKernel* kernel = new CGaussianKernel();
+	SG_REF(kernel)
+	kernel->set_width(1);
+
+	// both methods are exact when the subspace, respectively the set of
+	// landmarks, covers all training vectors
+	EKernelPCAMethod methods[] = {KPCA_RANDOMIZED, KPCA_NYSTROEM};
+	for (auto method : methods)
+	{
+		CKernelPCA* kpca = new CKernelPCA(kernel);
+		SG_REF(kpca)
+		kpca->set_method(method);
+		kpca->set_num_landmarks(num_vectors);
+		kpca->set_target_dim(target_dim);
+		kpca->init(train_feats);
+
+		SGMatrix<float64_t> embedding =
+		    kpca->apply_to_feature_matrix(test_feats);
+
+		// allow embedding with opposite sign
+		for (index_t i = 0; i < num_test_vectors * target_dim; ++i)
+			EXPECT_NEAR(
+			    CMath::abs(embedding[i]), CMath::abs(resdata[i]), 1E-6);
+
+		SG_UNREF(kpca);
+	}
+
+	SG_UNREF(train_feats)
+	SG_UNREF(test_feats)
+	SG_UNREF(kernel);
+}
@@ -7,6 +7,7 @@
 #include <gtest/gtest.h>
 #include <shogun/mathematics/Math.h>
 #include <shogun/features/DenseFeatures.h>
+#include <shogun/features/streaming/StreamingDenseFeatures.h>
 #include <shogun/lib/SGMatrix.h>
 #include <shogun/lib/SGVector.h>
 #include <shogun/mathematics/linalg/LinalgNamespace.h>
@@ -615,3 +616,104 @@ TEST(PCA, PCA_WHITEN_EVD)
 	SG_UNREF(pca);
 	SG_UNREF(features);
 }
+
+TEST(PCA, PCA_INCREMENTAL)
+{
+	const index_t dim = 4;
+	const index_t num_vectors = 50;
+
+	SGMatrix<float64_t> data(dim, num_vectors);
+	for (index_t i = 0; i < dim * num_vectors; ++i)
+		data.matrix[i] = (i % dim + 1) * sg_rand->std_normal_distrib() + i % 3;
+
+	CDenseFeatures<float64_t>* features = new CDenseFeatures<float64_t>(data);
+	SG_REF(features);
+	CPCA* reference = new CPCA(SVD);
+	reference->set_target_dim(dim);
+	reference->init(features);
+
+	SGVector<float64_t> expected_eigenvalues = reference->get_eigenvalues();
+	SGMatrix<float64_t> expected_transmat =
+	    reference->get_transformation_matrix();
+	SGVector<float64_t> expected_mean = reference->get_mean();
+
+	// blocks do not divide the number of vectors
+	CFeatures* inputs[] = {
+	    features, new CStreamingDenseFeatures<float64_t>(
+	                  new CDenseFeatures<float64_t>(data.clone()))};
+	for (auto input : inputs)
+	{
+		CPCA* pca = new CPCA(INCREMENTAL);
+		pca->set_target_dim(dim);
+		pca->set_block_size(7);
+		pca->init(input);
+
+		SGVector<float64_t> eigenvalues = pca->get_eigenvalues();
+		SGMatrix<float64_t> transmat = pca->get_transformation_matrix();
+		SGVector<float64_t> mean = pca->get_mean();
+
+		ASSERT_EQ(dim, transmat.num_cols);
+		for (index_t i = 0; i < dim; ++i)
+		{
+			EXPECT_NEAR(expected_mean[i], mean[i], 1e-12);
+			EXPECT_NEAR(expected_eigenvalues[i], eigenvalues[i], 1e-10);
+			check_eigenvector_eq(
+			    expected_transmat.get_column(i), transmat.get_column(i));
+		}
+
+		SG_UNREF(pca);
+	}
+
+	SG_UNREF(inputs[1]);
+	SG_UNREF(reference);
+	SG_UNREF(features);
+}
+
+TEST(PCA, PCA_INCREMENTAL_target_dim_less_than_dim)
+{
+	const index_t dim = 6;
+	const index_t target_dim = 2;
+	const index_t num_vectors = 50;
+
+	// two dominant directions and small noise, so that the block factors
+	// truncated to the target dimension keep the leading subspace
+	SGMatrix<float64_t> data(dim, num_vectors);
+	for (index_t j = 0; j < num_vectors; ++j)
+	{
+		float64_t z0 = 5 * sg_rand->std_normal_distrib();
+		float64_t z1 = 3 * sg_rand->std_normal_distrib();
+		for (index_t i = 0; i < dim; ++i)
+			data(i, j) = z0 * (i % 3 - 0.5) + z1 * (i % 2 ? 1.0 : -0.5) +
+			             0.1 * sg_rand->std_normal_distrib() + i % 3;
+	}
+
+	CDenseFeatures<float64_t>* features = new CDenseFeatures<float64_t>(data);
+	SG_REF(features);
+	CPCA* reference = new CPCA(SVD);
+	reference->set_target_dim(target_dim);
+	reference->init(features);
+
+	SGVector<float64_t> expected_eigenvalues = reference->get_eigenvalues();
+	SGMatrix<float64_t> expected_transmat =
+	    reference->get_transformation_matrix();
+
+	CPCA* pca = new CPCA(INCREMENTAL);
+	pca->set_target_dim(target_dim);
+	pca->set_block_size(7);
+	pca->init(features);
+
+	SGVector<float64_t> eigenvalues = pca->get_eigenvalues();
+	SGMatrix<float64_t> transmat = pca->get_transformation_matrix();
+
+	ASSERT_EQ(target_dim, transmat.num_cols);
+	for (index_t i = 0; i < target_dim; ++i)
+	{
+		EXPECT_NEAR(expected_eigenvalues[i], eigenvalues[i], 1e-4);
+		check_eigenvector_eq(
+		    expected_transmat.get_column(i), transmat.get_column(i), 1e-6);
+	}
+
+	SG_UNREF(pca);
+	SG_UNREF(reference);
+	SG_UNREF(features);
+}
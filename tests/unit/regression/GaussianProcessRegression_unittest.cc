@@ -737,3 +737,80 @@ TEST(GaussianProcessRegression,fitc_regression)
 	SG_UNREF(latent_features_train);
 	SG_UNREF(gpr);
 }
+
+TEST(GaussianProcessRegression, prediction_cache_is_invalidated)
+{
+	index_t n=3;
+
+	SGMatrix<float64_t> X(1, n);
+	SGMatrix<float64_t> X_test(1, n);
+	SGVector<float64_t> Y(n);
+
+	X[0]=0;
+	X[1]=1.1;
+	X[2]=2.2;
+
+	X_test[0]=0.3;
+	X_test[1]=1.3;
+	X_test[2]=2.5;
+
+	for (index_t i=0; i<n; ++i)
+		Y[i]=std::sin(X(0, i));
+
+	CDenseFeatures<float64_t>* feat_train=new CDenseFeatures<float64_t>(X);
+	CDenseFeatures<float64_t>* feat_test=new CDenseFeatures<float64_t>(X_test);
+	SG_REF(feat_test);
+	uint32_t feat_test_hash=feat_test->m_hash;
+	CRegressionLabels* label_train=new CRegressionLabels(Y);
+
+	CGaussianKernel* kernel=new CGaussianKernel(10, 2.0);
+	CGaussianLikelihood* lik=new CGaussianLikelihood(1.0);
+	CExactInferenceMethod* inf=new CExactInferenceMethod(kernel, feat_train,
+			new CZeroMean(), label_train, lik);
+	CGaussianProcessRegression* gpr=new CGaussianProcessRegression(inf);
+	gpr->train();
+
+	SGVector<float64_t> mean_1=gpr->get_mean_vector(feat_test);
+	SGVector<float64_t> variance_1=gpr->get_variance_vector(feat_test);
+
+	// same posterior and same data: cached results
+	SGVector<float64_t> mean_2=gpr->get_mean_vector(feat_test);
+	for (index_t i=0; i<n; ++i)
+		EXPECT_EQ(mean_1[i], mean_2[i]);
+
+	// a new likelihood noise changes the posterior
+	lik->set_sigma(0.5);
+	SGVector<float64_t> mean_3=gpr->get_mean_vector(feat_test);
+	SGVector<float64_t> variance_3=gpr->get_variance_vector(feat_test);
+
+	CGaussianLikelihood* lik_ref=new CGaussianLikelihood(0.5);
+	CExactInferenceMethod* inf_ref=new CExactInferenceMethod(
+		new CGaussianKernel(10, 2.0), feat_train, new CZeroMean(), label_train,
+		lik_ref);
+	CGaussianProcessRegression* gpr_ref=new CGaussianProcessRegression(inf_ref);
+	gpr_ref->train();
+	SGVector<float64_t> mean_ref=gpr_ref->get_mean_vector(feat_test);
+	SGVector<float64_t> variance_ref=gpr_ref->get_variance_vector(feat_test);
+
+	for (index_t i=0; i<n; ++i)
+	{
+		EXPECT_NEAR(mean_3[i], mean_ref[i], 1E-12);
+		EXPECT_NEAR(variance_3[i], variance_ref[i], 1E-12);
+		EXPECT_GT(CMath::abs(variance_3[i]-variance_1[i]), 1E-3);
+	}
+
+	// changing the testing features in place changes the cross kernel
+	SGMatrix<float64_t> X_test_new=feat_test->get_feature_matrix();
+	X_test_new[0]=2.5;
+	X_test_new[2]=0.3;
+	SGVector<float64_t> mean_4=gpr->get_mean_vector(feat_test);
+	EXPECT_NEAR(mean_4[0], mean_3[2], 1E-12);
+	EXPECT_NEAR(mean_4[2], mean_3[0], 1E-12);
+
+	// the machine keeps its own hash of the testing features
+	EXPECT_EQ(feat_test->m_hash, feat_test_hash);
+
+	SG_UNREF(gpr_ref);
+	SG_UNREF(gpr);
+	SG_UNREF(feat_test);
+}
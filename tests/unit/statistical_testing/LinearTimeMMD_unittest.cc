@@ -31,13 +31,29 @@
 
 #include <shogun/base/some.h>
 #include <shogun/kernel/GaussianKernel.h>
+#include <shogun/mathematics/Math.h>
 #include <shogun/features/DenseFeatures.h>
 #include <shogun/features/streaming/generators/MeanShiftDataGenerator.h>
 #include <shogun/statistical_testing/TestEnums.h>
 #include <shogun/statistical_testing/LinearTimeMMD.h>
+#include <shogun/statistical_testing/internals/KernelManager.h>
+#include <shogun/statistical_testing/internals/mmd/ComputeMMD.h>
 #include <gtest/gtest.h>
 
 using namespace shogun;
+using namespace internal;
+
+namespace
+{
+class CLinearTimeMMDStatisticAndQ : public CLinearTimeMMD
+{
+public:
+	std::pair<SGVector<float64_t>, SGMatrix<float64_t> > statistic_and_Q(const KernelManager& kernel_mgr)
+	{
+		return compute_statistic_and_Q(kernel_mgr);
+	}
+};
+}
 
 TEST(LinearTimeMMD, biased_same_num_samples)
 {
@@ -439,3 +455,77 @@ TEST(LinearTimeMMD, perform_test_gaussian_unbiased_incomplete)
 	float64_t p_value_gaussian=mmd->compute_p_value(mmd->compute_statistic());
 	EXPECT_NEAR(p_value_gaussian, 0.40645354706402292, 1E-6);
 }
+
+TEST(LinearTimeMMD, statistic_and_Q_all_kernels)
+{
+	const index_t m=8;
+	const index_t d=3;
+	const index_t num_kernels=4;
+	const index_t B=2;
+	const index_t num_blocks=m/B;
+
+	SGMatrix<float64_t> data_p(d, m);
+	SGMatrix<float64_t> data_q(d, m);
+	for (index_t i=0; i<d*m; ++i)
+	{
+		data_p.matrix[i]=i/float64_t(d*m);
+		data_q.matrix[i]=CMath::pow(i/float64_t(d*m), 2)+0.1;
+	}
+
+	auto mmd=some<CLinearTimeMMDStatisticAndQ>();
+	mmd->set_p(new CDenseFeatures<float64_t>(data_p));
+	mmd->set_q(new CDenseFeatures<float64_t>(data_q));
+	mmd->set_statistic_type(ST_UNBIASED_FULL);
+	// two blocks per burst, so that the statistic and Q are accumulated
+	// over more than one burst
+	mmd->set_num_blocks_per_burst(2);
+
+	KernelManager kernel_mgr;
+	for (auto k=0; k<num_kernels; ++k)
+		kernel_mgr.push_back(new CGaussianKernel(10, CMath::pow(2.0, k-2)));
+
+	auto result=mmd->statistic_and_Q(kernel_mgr);
+	ASSERT_EQ(result.first.vlen, num_kernels);
+	ASSERT_EQ(result.second.num_rows, num_kernels);
+	ASSERT_EQ(result.second.num_cols, num_kernels);
+
+	// compute the block statistics kernel by kernel
+	mmd::ComputeMMD compute;
+	compute.m_n_x=B;
+	compute.m_n_y=B;
+	compute.m_stype=ST_UNBIASED_FULL;
+	SGMatrix<float64_t> block_mmds(num_blocks, num_kernels);
+	for (auto k=0; k<num_kernels; ++k)
+	{
+		auto kernel=some<CGaussianKernel>(10, CMath::pow(2.0, k-2));
+		for (auto i=0; i<num_blocks; ++i)
+		{
+			SGMatrix<float64_t> block(d, 2*B);
+			sg_memcpy(block.matrix, data_p.get_column_vector(i*B), sizeof(float64_t)*d*B);
+			sg_memcpy(block.matrix+d*B, data_q.get_column_vector(i*B), sizeof(float64_t)*d*B);
+			auto feats=some<CDenseFeatures<float64_t> >(block);
+			kernel->init(feats, feats);
+			block_mmds(i, k)=compute(kernel->get_kernel_matrix<float32_t>());
+			kernel->remove_lhs_and_rhs();
+		}
+	}
+
+	for (auto k=0; k<num_kernels; ++k)
+	{
+		float64_t statistic=0;
+		for (auto i=0; i<num_blocks; ++i)
+			statistic+=block_mmds(i, k);
+		EXPECT_NEAR(result.first[k], statistic/num_blocks, 1E-6);
+
+		for (auto l=0; l<num_kernels; ++l)
+		{
+			float64_t Q=0;
+			for (auto i=0; i<num_blocks; i+=2)
+			{
+				Q+=(block_mmds(i, k)-block_mmds(i+1, k))*
+					(block_mmds(i, l)-block_mmds(i+1, l));
+			}
+			EXPECT_NEAR(result.second(k, l), Q/(num_blocks/2), 1E-6);
+		}
+	}
+}
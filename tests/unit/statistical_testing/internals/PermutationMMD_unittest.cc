@@ -32,6 +32,8 @@
 
 #include <numeric>
 #include <algorithm>
+#include <shogun/base/Parallel.h>
+#include <shogun/base/init.h>
 #include <shogun/base/some.h>
 #include <shogun/lib/SGMatrix.h>
 #include <shogun/lib/SGVector.h>
@@ -541,3 +543,56 @@ TEST(PermutationMMD, unbiased_incomplete_multi_kernel)
 	}
 	SG_UNREF(merged_feats);
 }
+
+TEST(PermutationMMD, grouped_permutations_single_kernel)
+{
+	const index_t dim=2;
+	const index_t n=13;
+	const index_t m=7;
+	const index_t num_null_samples=50;
+	const auto stype=ST_UNBIASED_FULL;
+
+	SGMatrix<float64_t> data_p(dim, n);
+	std::iota(data_p.matrix, data_p.matrix+dim*n, 1);
+	std::for_each(data_p.matrix, data_p.matrix+dim*n, [&n](float64_t& val) { val/=n; });
+
+	SGMatrix<float64_t> data_q(dim, m);
+	std::iota(data_q.matrix, data_q.matrix+dim*m, n+1);
+	std::for_each(data_q.matrix, data_q.matrix+dim*m, [&m](float64_t& val) { val/=2*m; });
+
+	auto feats_p=new CDenseFeatures<float64_t>(data_p);
+	auto feats_q=new CDenseFeatures<float64_t>(data_q);
+	auto feats=feats_p->create_merged_copy(feats_q);
+	SG_REF(feats);
+	SG_UNREF(feats_p);
+	SG_UNREF(feats_q);
+
+	auto kernel=some<CGaussianKernel>();
+	kernel->set_width(2.0);
+	kernel->init(feats, feats);
+	auto kernel_matrix=kernel->get_kernel_matrix<float32_t>();
+
+	auto permutation_mmd=PermutationMMD();
+	permutation_mmd.m_n_x=n;
+	permutation_mmd.m_n_y=m;
+	permutation_mmd.m_stype=stype;
+	permutation_mmd.m_num_null_samples=num_null_samples;
+
+	// one permutation per sweep
+	permutation_mmd.m_group_size=1;
+	sg_rand->set_seed(12345);
+	SGVector<float32_t> result_1=permutation_mmd(kernel_matrix);
+
+	// groups of permutations per sweep, with a partial last group
+	auto num_threads=get_global_parallel()->get_num_threads();
+	get_global_parallel()->set_num_threads(2);
+	permutation_mmd.m_group_size=8;
+	sg_rand->set_seed(12345);
+	SGVector<float32_t> result_2=permutation_mmd(kernel_matrix);
+	get_global_parallel()->set_num_threads(num_threads);
+
+	for (auto i=0; i<num_null_samples; ++i)
+		EXPECT_NEAR(result_1[i], result_2[i], 1E-6);
+
+	SG_UNREF(feats);
+}
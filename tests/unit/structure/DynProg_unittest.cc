@@ -0,0 +1,178 @@
+#include <shogun/mathematics/Math.h>
+#include <shogun/structure/DynProg.h>
+#include <shogun/structure/PlifMatrix.h>
+#include <gtest/gtest.h>
+
+using namespace shogun;
+
+namespace
+{
+const int32_t num_states = 4;
+const int32_t num_plifs = 3;
+const int32_t num_limits = 4;
+const int32_t seq_len = 30;
+
+/* small fully connected segment model, every transition is scored by the
+ * sum of two length PLiFs (hence a CPlifArray) and the observation of its
+ * target state */
+CDynProg* create_model()
+{
+	CMath::init_random(17);
+
+	CPlifMatrix* pm = new CPlifMatrix();
+	pm->create_plifs(num_plifs, num_limits);
+
+	SGVector<int32_t> ids(num_plifs);
+	SGVector<float64_t> min_values(num_plifs);
+	SGVector<float64_t> max_values(num_plifs);
+	SGMatrix<float64_t> limits(num_plifs, num_limits);
+	SGMatrix<float64_t> penalties(num_plifs, num_limits);
+	for (int32_t i = 0; i < num_plifs; i++)
+	{
+		ids[i] = i;
+		min_values[i] = 1;
+		max_values[i] = 12 + 4 * i;
+		for (int32_t k = 0; k < num_limits; k++)
+		{
+			limits.matrix[i * num_limits + k] = 1 + 3 * k + i;
+			penalties.matrix[i * num_limits + k] = CMath::random(-1.0, 1.0);
+		}
+	}
+	pm->set_plif_ids(ids);
+	pm->set_plif_min_values(min_values);
+	pm->set_plif_max_values(max_values);
+	pm->set_plif_limits(limits);
+	pm->set_plif_penalties(penalties);
+
+	index_t pen_dims[] = {num_states, num_states, 2};
+	SGNDArray<float64_t> pen_ids(pen_dims, 3);
+	for (int32_t i = 0; i < num_states * num_states; i++)
+	{
+		pen_ids.array[i] = 1 + i % num_plifs;
+		pen_ids.array[i + num_states * num_states] = 1 + (i + 1) % num_plifs;
+	}
+	pm->compute_plif_matrix(pen_ids);
+	SGMatrix<int32_t> state_signals(num_states, 1);
+	state_signals.zero();
+	pm->compute_signal_plifs(state_signals);
+
+	CDynProg* dyn = new CDynProg();
+	dyn->set_num_states(num_states);
+
+	SGVector<int32_t> pos(seq_len);
+	pos[0] = 0;
+	for (int32_t t = 1; t < seq_len; t++)
+		pos[t] = pos[t - 1] + CMath::random(1, 3);
+	dyn->set_pos(pos);
+
+	SGVector<char> genestr(pos[seq_len - 1] + 1);
+	const char acgt[] = "acgt";
+	for (int32_t i = 0; i < genestr.vlen; i++)
+		genestr[i] = acgt[CMath::random(0, 3)];
+	dyn->set_gene_string(genestr);
+	dyn->init_content_svm_value_array(dyn->get_num_svms());
+
+	SGMatrix<int32_t> orf_info(num_states, 2);
+	orf_info.set_const(-1);
+	dyn->set_orf_info(orf_info);
+
+	SGVector<float64_t> p(num_states);
+	SGVector<float64_t> q(num_states);
+	for (int32_t i = 0; i < num_states; i++)
+	{
+		p[i] = CMath::random(-1.0, 0.0);
+		q[i] = CMath::random(-1.0, 0.0);
+	}
+	dyn->set_p_vector(p);
+	dyn->set_q_vector(q);
+
+	// transitions (from, to, score), ordered by target state
+	const int32_t num_trans = num_states * num_states;
+	SGMatrix<float64_t> a_trans(num_trans, 3);
+	for (int32_t i = 0; i < num_trans; i++)
+	{
+		a_trans(i, 0) = i % num_states;
+		a_trans(i, 1) = i / num_states;
+		a_trans(i, 2) = CMath::random(-1.0, 0.0);
+	}
+	dyn->set_a_trans_matrix(a_trans);
+
+	index_t obs_dims[] = {num_states, seq_len, 1};
+	SGNDArray<float64_t> obs(obs_dims, 3);
+	for (int32_t i = 0; i < num_states * seq_len; i++)
+		obs.array[i] = CMath::random(-1.0, 1.0);
+	dyn->set_observation_matrix(obs);
+
+	dyn->set_plif_matrices(pm);
+	return dyn;
+}
+
+void decode(
+    int32_t num_threads, bool tabulate, float64_t beam,
+    SGVector<float64_t>& scores, SGMatrix<int32_t>& states,
+    SGMatrix<int32_t>& positions)
+{
+	CDynProg* dyn = create_model();
+	SG_REF(dyn);
+	int32_t old_num_threads = dyn->parallel->get_num_threads();
+	dyn->parallel->set_num_threads(num_threads);
+	dyn->set_tabulate_penalties(tabulate);
+	if (beam >= 0)
+		dyn->set_pruning_beam(beam);
+
+	dyn->compute_nbest_paths(1, false, 1, false, false);
+	scores = dyn->get_scores();
+	states = dyn->get_states();
+	positions = dyn->get_positions();
+	dyn->parallel->set_num_threads(old_num_threads);
+	SG_UNREF(dyn);
+}
+}
+
+TEST(DynProg, compute_nbest_paths_consistent)
+{
+	SGVector<float64_t> scores;
+	SGMatrix<int32_t> states;
+	SGMatrix<int32_t> positions;
+	decode(1, false, -1, scores, states, positions);
+
+	ASSERT_EQ(scores.vlen, 1);
+	EXPECT_TRUE(CMath::is_finite(scores[0]));
+
+	// threads, tabulated penalties and a beam that cannot prune anything
+	const int32_t threads[] = {1, 4, 4, 4, 1};
+	const bool tabulate[] = {true, false, true, true, true};
+	const float64_t beam[] = {-1, -1, -1, CMath::INFTY, 1e10};
+	for (int32_t r = 0; r < 5; r++)
+	{
+		SGVector<float64_t> scores_r;
+		SGMatrix<int32_t> states_r;
+		SGMatrix<int32_t> positions_r;
+		decode(
+		    threads[r], tabulate[r], beam[r], scores_r, states_r, positions_r);
+
+		ASSERT_EQ(scores_r.vlen, 1);
+		EXPECT_EQ(scores_r[0], scores[0]);
+
+		ASSERT_EQ(states_r.num_rows, states.num_rows);
+		ASSERT_EQ(states_r.num_cols, states.num_cols);
+		for (int32_t i = 0; i < states.num_rows * states.num_cols; i++)
+		{
+			EXPECT_EQ(states_r.matrix[i], states.matrix[i]);
+			EXPECT_EQ(positions_r.matrix[i], positions.matrix[i]);
+		}
+	}
+}
+
+TEST(DynProg, set_pruning_beam)
+{
+	CDynProg* dyn = new CDynProg();
+	SG_REF(dyn);
+
+	EXPECT_FALSE(CMath::is_finite(dyn->get_pruning_beam()));
+	dyn->set_pruning_beam(5.0);
+	EXPECT_EQ(dyn->get_pruning_beam(), 5.0);
+	EXPECT_THROW(dyn->set_pruning_beam(-1.0), ShogunException);
+
+	SG_UNREF(dyn);
+}